@@ -117,7 +117,7 @@ bool Acquisition::isModeEnabled(ACQUISITION_MODE mode) {
  */
 bool Acquisition::enableMode(ACQUISITION_MODE mode) {
 	// If no acquisition file is open, open one.
-	if (m_storage == nullptr && mode != ACQUISITION_MODE::VOLTAGECALIBRATION) {
+	if (m_storage == nullptr && mode != ACQUISITION_MODE::VOLTAGECALIBRATION && mode != ACQUISITION_MODE::AUTOFOCUS) {
 		openFile();
 	}
 
@@ -129,6 +129,10 @@ bool Acquisition::enableMode(ACQUISITION_MODE mode) {
 	if (mode == ACQUISITION_MODE::VOLTAGECALIBRATION && m_enabledModes != ACQUISITION_MODE::NONE) {
 		return false;
 	}
+	// Check, that no other mode moves the stage while focusing
+	if (mode == ACQUISITION_MODE::AUTOFOCUS && m_enabledModes != ACQUISITION_MODE::NONE) {
+		return false;
+	}
 	// Check, that Brillouin and ODT don't run simultaneously.
 	if (((mode | m_enabledModes) & (ACQUISITION_MODE::BRILLOUIN | ACQUISITION_MODE::ODT))
 		== (ACQUISITION_MODE::BRILLOUIN | ACQUISITION_MODE::ODT)) {
@@ -1,5 +1,8 @@
 #include "stdafx.h"
 #include "AcquisitionMode.h"
+#include "src/helper/logger.h"
+
+#include <thread>
 
 /*
  * Public definitions
@@ -37,3 +40,182 @@ void AcquisitionMode::writeScaleCalibration(std::unique_ptr <StorageWrapper>& st
 
 	storage->setScaleCalibration(mode, { scaleCalibration, positionStage, positionScanner });
 }
+
+/*
+ * Stores the phase durations of the finished repetition in the file and reports them
+ */
+void AcquisitionMode::writePhaseTimes(std::unique_ptr <StorageWrapper>& storage, ACQUISITION_MODE mode) {
+	storage->setPhaseTimes(mode, m_phaseTimer.statistics(), m_phaseTimer.elapsed());
+	reportPhaseTimes(mode);
+}
+
+/*
+ * Logs the phase durations of the finished repetition and announces them
+ */
+void AcquisitionMode::reportPhaseTimes(ACQUISITION_MODE mode) {
+	auto phases = m_phaseTimer.statistics();
+	auto elapsed = m_phaseTimer.elapsed();
+
+	qInfo(logInfo()) << "Phase durations of the repetition (" << 1e-3 * elapsed << "s in total):";
+	for (const auto& phase : phases) {
+		qInfo(logInfo()) << "  " << phase.name.c_str() << ":" << phase.count << "x, total" << 1e-3 * phase.total << "s ("
+			<< 100 * phase.total / elapsed << "%), mean" << phase.mean() << "ms, 95th percentile"
+			<< phaseTimer::percentile(phase, 95) << "ms, max" << phase.max << "ms";
+	}
+
+	if (m_settleStatistics.waits) {
+		qInfo(logInfo()) << "Waiting for" << m_settleStatistics.waits << "motions to complete took" << 1e-3 * m_settleStatistics.actual
+			<< "s, which saved" << 1e-3 * m_settleStatistics.saved() << "s compared to fixed settle times.";
+	}
+
+	emit(s_phaseTimes(mode, phases, elapsed));
+}
+
+void AcquisitionMode::resetPhaseTimes() {
+	m_phaseTimer.reset();
+	m_settleStatistics = SETTLE_STATISTICS{};
+}
+
+void AcquisitionMode::settle(ScanPreset presetType, int fixedTime) {
+	auto waiting = m_phaseTimer.measure("settle");
+	auto timer = QElapsedTimer{};
+	timer.start();
+	auto confirmed{ false };
+	if (m_scanControl) {
+		onScanControl([&]() { confirmed = m_scanControl->waitForPreset(presetType, fixedTime); });
+	}
+	// if the device does not confirm the preset, we wait as long as we used to
+	if (!confirmed) {
+		auto remaining = fixedTime - (int)timer.elapsed();
+		if (remaining > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(remaining));
+		}
+	}
+	m_settleStatistics.waits++;
+	m_settleStatistics.fixed += fixedTime;
+	m_settleStatistics.actual += timer.elapsed();
+}
+
+void AcquisitionMode::moveTo(const POINT3& position, int fixedTime) {
+	auto timer = QElapsedTimer{};
+	timer.start();
+	// without a measured position we cannot know when the move completed
+	auto reached = moveOnScanControl(position, fixedTime);
+	if (!reached || !m_scanControl->supportsCapability(Capabilities::PositionReadback)) {
+		auto remaining = fixedTime - (int)timer.elapsed();
+		if (remaining > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(remaining));
+		}
+	}
+	m_settleStatistics.waits++;
+	m_settleStatistics.fixed += fixedTime;
+	m_settleStatistics.actual += timer.elapsed();
+}
+
+/*
+ * Moves to the position and waits until it is reached, but at most the timeout [ms].
+ * A move which did not arrive or failed with an error of the device is commanded once more.
+ */
+bool AcquisitionMode::moveStage(const POINT3& position, int timeout) {
+	for (gsl::index attempt{ 0 }; attempt < 2; attempt++) {
+		if (moveOnScanControl(position, timeout)) {
+			return true;
+		}
+		qWarning(logWarning()) << "The stage did not reach the position (" << position.x << "," << position.y << ","
+			<< position.z << ") within" << timeout << "ms.";
+	}
+	return false;
+}
+
+bool AcquisitionMode::moveStage(const POINT3& position) {
+	auto timeout{ 0 };
+	onScanControl([&]() {
+		try {
+			timeout = m_scanControl->getMoveTimeout(abs(m_scanControl->getPosition() - position));
+		} catch (...) {
+			timeout = m_moveTimeout;
+		}
+	});
+	return moveStage(position, timeout);
+}
+
+POINT3 AcquisitionMode::getStagePosition() {
+	auto position = POINT3{};
+	onScanControl([&]() {
+		try {
+			position = m_scanControl->getPosition();
+		} catch (...) {
+			qWarning(logWarning()) << "The position of the stage could not be read.";
+		}
+	});
+	return position;
+}
+
+bool AcquisitionMode::switchPreset(ScanPreset preset) {
+	auto presetSwitch = m_phaseTimer.measure("preset switch");
+	auto switched{ true };
+	onScanControl([&]() {
+		try {
+			m_scanControl->setPreset(preset);
+		} catch (...) {
+			switched = false;
+		}
+	});
+	if (!switched) {
+		qWarning(logWarning()) << "The optical elements could not be moved to the preset.";
+	}
+	return switched;
+}
+
+/*
+ * The switch is queued on the thread of the scan control, so that the acquisition thread can continue,
+ * e.g. to hand a frame over to the storage while the filters move.
+ */
+std::future<bool> AcquisitionMode::startPresetSwitch(ScanPreset preset) {
+	auto switched = std::make_shared<std::promise<bool>>();
+	auto presetSwitch = switched->get_future();
+	auto function = [scanControl = m_scanControl, preset, switched]() {
+		try {
+			scanControl->setPreset(preset);
+			switched->set_value(true);
+		} catch (...) {
+			switched->set_value(false);
+		}
+	};
+	// a queued call would never run while this thread waits for it
+	if (QThread::currentThread() == m_scanControl->thread()) {
+		function();
+	} else {
+		QMetaObject::invokeMethod(m_scanControl, function, Qt::QueuedConnection);
+	}
+	return presetSwitch;
+}
+
+bool AcquisitionMode::finishPresetSwitch(std::future<bool>& presetSwitch) {
+	if (!presetSwitch.valid()) {
+		return true;
+	}
+	auto presetWait = m_phaseTimer.measure("preset wait");
+	auto switched = presetSwitch.get();
+	if (!switched) {
+		qWarning(logWarning()) << "The optical elements could not be moved to the preset.";
+	}
+	return switched;
+}
+
+/*
+ * Private definitions
+ */
+
+bool AcquisitionMode::moveOnScanControl(const POINT3& position, int timeout) {
+	auto reached{ false };
+	onScanControl([&]() {
+		try {
+			reached = m_scanControl->moveTo(position, timeout);
+		} catch (...) {
+			// e.g. a _com_error of the Zeiss MTB, which must not escape into the event loop of the scan control
+			reached = false;
+		}
+	});
+	return reached;
+}
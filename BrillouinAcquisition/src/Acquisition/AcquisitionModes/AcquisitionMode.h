@@ -4,6 +4,8 @@
 #include <QtCore>
 #include <gsl/gsl>
 
+#include <future>
+
 #include "..\Acquisition.h"
 #include "..\..\Devices\ScanControls\ScanControl.h"
 
@@ -19,6 +21,16 @@ enum class ACQUISITION_STATUS {
 	RUNNING
 };
 
+struct SETTLE_STATISTICS {
+	int waits{ 0 };			// [1]	number of waits for the motion to complete
+	double fixed{ 0 };		// [ms]	sum of the fixed settle times previously waited
+	double actual{ 0 };		// [ms]	sum of the times actually waited
+
+	double saved() const {
+		return fixed - actual;
+	}
+};
+
 class AcquisitionMode : public QObject {
 	Q_OBJECT
 
@@ -41,11 +53,42 @@ protected:
 	void setAcquisitionStatus(ACQUISITION_STATUS);
 
 	void writeScaleCalibration(std::unique_ptr <StorageWrapper>& storage, ACQUISITION_MODE mode);
+	void writePhaseTimes(std::unique_ptr <StorageWrapper>& storage, ACQUISITION_MODE mode);
+	void reportPhaseTimes(ACQUISITION_MODE mode);
+	void resetPhaseTimes();
+
+	// waits until the preset is in place, but at most the fixed settle time [ms]
+	void settle(ScanPreset presetType, int fixedTime);
+	// moves to the position and waits until it is reached, but at most the fixed settle time [ms]
+	void moveTo(const POINT3& position, int fixedTime);
+	// moves to the position and waits until it is reached, returns false if it was not reached within two attempts
+	bool moveStage(const POINT3& position, int timeout);
+	// moves to the position with a timeout depending on the distance, e.g. to return to the start position
+	bool moveStage(const POINT3& position);
+	// reads the position on the thread of the scan control
+	POINT3 getStagePosition();
+	// switches the optical elements to the preset, returns false if the device reported an error
+	bool switchPreset(ScanPreset preset);
+	// starts switching the optical elements to the preset on the thread of the scan control without waiting for it
+	std::future<bool> startPresetSwitch(ScanPreset preset);
+	// waits until the started preset switch finished, returns false if the device reported an error
+	bool finishPresetSwitch(std::future<bool>& presetSwitch);
+
+	// runs the function on the thread of the scan control and waits until it returned
+	template <typename F>
+	void onScanControl(F function);
 
 	ACQUISITION_STATUS m_status{ ACQUISITION_STATUS::DISABLED };
 	Acquisition* m_acquisition{ nullptr };
 	ScanControl*& m_scanControl;
 
+	phaseTimer m_phaseTimer;		// durations of the phases of the current repetition
+	SETTLE_STATISTICS m_settleStatistics;	// time saved by waiting for the motion instead of fixed settle times
+	int m_moveTimeout{ 1000 };		// [ms]	maximum duration of a stage move between two positions
+
+private:
+	bool moveOnScanControl(const POINT3& position, int timeout);
+
 private slots:
 	virtual void acquire(std::unique_ptr <StorageWrapper> & storage) = 0;
 
@@ -53,6 +96,18 @@ signals:
 	void s_acquisitionStatus(ACQUISITION_STATUS);	// current acquisition state
 	void s_repetitionProgress(double, int);		// progress in percent and the remaining time in seconds
 	void s_totalProgress(int, int);				// repetitions
+	void s_phaseTimes(ACQUISITION_MODE, std::vector<PHASE_STATISTICS>, double);	// phase durations and the elapsed time [ms] of a repetition
 };
 
+template <typename F>
+void AcquisitionMode::onScanControl(F function) {
+	// the devices must only be accessed from the thread of the scan control,
+	// e.g. the COM objects of the Zeiss MTB are bound to it and the serial port of the ECU is not locked
+	if (QThread::currentThread() == m_scanControl->thread()) {
+		function();
+	} else {
+		QMetaObject::invokeMethod(m_scanControl, function, Qt::BlockingQueuedConnection);
+	}
+}
+
 #endif //ACQUISITIONMODE_H
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "stdafx.h"
+#include "Autofocus.h"
+#include "src/helper/logger.h"
+
+/*
+ * Public definitions
+ */
+
+Autofocus::Autofocus(QObject* parent, Acquisition* acquisition, Camera*& camera, ScanControl*& scanControl)
+	: AcquisitionMode(parent, acquisition, scanControl), m_camera(camera) {
+}
+
+Autofocus::~Autofocus() {}
+
+FOCUS_RESULT Autofocus::getResult() {
+	return m_result;
+}
+
+/*
+ * Public slots
+ */
+
+void Autofocus::startRepetitions() {
+	m_result = FOCUS_RESULT{};
+	// reset abort flag
+	m_abort = false;
+
+	bool allowed = m_acquisition->enableMode(ACQUISITION_MODE::AUTOFOCUS);
+	if (!allowed) {
+		qWarning(logWarning()) << "Autofocus is not possible while another mode is running.";
+		return;
+	}
+
+	// Check that we have camera and scancontrol
+	if (!m_camera || !m_scanControl) {
+		m_acquisition->disableMode(ACQUISITION_MODE::AUTOFOCUS);
+		return;
+	}
+
+	acquire();
+
+	m_acquisition->disableMode(ACQUISITION_MODE::AUTOFOCUS);
+}
+
+void Autofocus::setSettings(const AUTOFOCUS_SETTINGS& settings) {
+	m_settings = settings;
+}
+
+/*
+ * Private definitions
+ */
+
+void Autofocus::abortMode(std::unique_ptr <StorageWrapper>& storage) {}
+
+void Autofocus::abortMode() {
+	m_acquisition->disableMode(ACQUISITION_MODE::AUTOFOCUS);
+
+	m_scanControl->setPosition(m_startPosition);
+
+	QMetaObject::invokeMethod(
+		m_scanControl,
+		[scanControl = m_scanControl]() { scanControl->startAnnouncing(); },
+		Qt::AutoConnection
+	);
+
+	setAcquisitionStatus(ACQUISITION_STATUS::ABORTED);
+}
+
+template <typename T>
+void Autofocus::__acquire() {
+	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+
+	QMetaObject::invokeMethod(
+		m_scanControl,
+		[scanControl = m_scanControl]() { scanControl->stopAnnouncing(); },
+		Qt::AutoConnection
+	);
+	resetPhaseTimes();
+	// Set optical elements for brightfield imaging
+	auto presetSwitch = m_phaseTimer.measure("preset switch");
+	m_scanControl->setPreset(ScanPreset::SCAN_BRIGHTFIELD);
+	presetSwitch.stop();
+	settle(ScanPreset::SCAN_BRIGHTFIELD, 500);
+
+	// Get the current stage position
+	m_startPosition = m_scanControl->getPosition();
+
+	auto cameraSettings = m_camera->getSettings();
+	cameraSettings.frameCount = 1;
+	auto image = std::vector<std::byte>(cameraSettings.roi.bytesPerFrame);
+
+	m_camera->startAcquisition(cameraSettings);
+
+	auto hysteresisCompensation{ 5.0 };// [µm] distance for compensation of the stage hysteresis
+	auto lastPosition = m_startPosition.z;
+	auto measure = [&](double z) {
+		// the search is aborted by returning NaN
+		if (m_abort) {
+			return (double)NAN;
+		}
+
+		auto position = m_startPosition;
+		position.z = z;
+		// To prevent problems with the hysteresis of the stage, we always move to the desired point coming from lower values.
+		auto stageMove = m_phaseTimer.measure("stage move");
+		if (z < lastPosition) {
+			moveTo(position - POINT3{ 0, 0, hysteresisCompensation }, 100);
+		}
+		moveTo(position, 100);
+		lastPosition = z;
+		stageMove.stop();
+
+		auto frame = m_phaseTimer.measure("frame");
+		m_camera->getImageForAcquisition(&image[0], false);
+		frame.stop();
+
+		auto evaluation = m_phaseTimer.measure("sharpness");
+		return sharpness::evaluate((T*)&image[0], (int)cameraSettings.roi.width_binned, (int)cameraSettings.roi.height_binned,
+			m_settings.metric);
+	};
+	m_result = focusSearch::maximize(measure, m_startPosition.z, m_settings.search);
+
+	// Stop the camera acquisition
+	m_camera->stopAcquisition();
+
+	if (m_abort) {
+		this->abortMode();
+		return;
+	}
+
+	/*
+	 * Move to the focus, or back to the start if the image shows no structure
+	 */
+	auto target = m_startPosition;
+	if (m_result.valid) {
+		target.z = m_result.z;
+		qInfo(logInfo()) << "Autofocus found the focus at z =" << m_result.z << "µm (" << m_result.z - m_startPosition.z
+			<< "µm from the start) after" << m_result.evaluations << "images.";
+		if (m_result.atBorder) {
+			qWarning(logWarning()) << "The focus is at the border of the search range, it might lie outside of it.";
+		}
+	} else {
+		qWarning(logWarning()) << "Autofocus could not find a focus, the brightfield image shows too little structure.";
+	}
+	auto stageMove = m_phaseTimer.measure("stage move");
+	moveTo(target - POINT3{ 0, 0, hysteresisCompensation }, 100);
+	moveTo(target, 100);
+	stageMove.stop();
+
+	QMetaObject::invokeMethod(
+		m_scanControl,
+		[scanControl = m_scanControl]() { scanControl->startAnnouncing(); },
+		Qt::AutoConnection
+	);
+
+	reportPhaseTimes(ACQUISITION_MODE::AUTOFOCUS);
+
+	emit(s_autofocusFinished(m_result));
+
+	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
+}
+
+/*
+ * Private slots
+ */
+
+void Autofocus::acquire(std::unique_ptr <StorageWrapper>& storage) {}
+
+void Autofocus::acquire() {
+	auto dataType = m_camera->getSettings().readout.dataType;
+	if (dataType == "unsigned short") {
+		__acquire<unsigned short>();
+	} else if (dataType == "unsigned char") {
+		__acquire<unsigned char>();
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef AUTOFOCUS_H
+#define AUTOFOCUS_H
+
+#include <QtCore>
+#include <gsl/gsl>
+
+#include "AcquisitionMode.h"
+#include "../../Devices/Cameras/Camera.h"
+#include "../../Devices/ScanControls/ScanControl.h"
+#include "../../lib/math/focusSearch.h"
+#include "../../lib/math/sharpness.h"
+
+struct AUTOFOCUS_SETTINGS {
+	SHARPNESS_METRIC metric{ SHARPNESS_METRIC::TENENGRAD };
+	FOCUS_SEARCH_SETTINGS search;
+};
+
+/*
+ * Focuses the brightfield image by moving the stage in z-direction.
+ *
+ * The sharpness of the brightfield image is measured at the positions the focus search requests, the stage ends up at
+ * the sharpest position. If the image shows no structure, the stage returns to the start position.
+ */
+class Autofocus : public AcquisitionMode {
+	Q_OBJECT
+
+public:
+	Autofocus(QObject* parent, Acquisition* acquisition, Camera*& camera, ScanControl*& scanControl);
+	~Autofocus();
+
+	FOCUS_RESULT getResult();
+
+public slots:
+	void startRepetitions() override;
+
+	void setSettings(const AUTOFOCUS_SETTINGS& settings);
+
+private:
+	void abortMode(std::unique_ptr <StorageWrapper>& storage) override;
+	void abortMode();
+
+	template <typename T>
+	void __acquire();
+
+	Camera*& m_camera;
+	AUTOFOCUS_SETTINGS m_settings;
+	FOCUS_RESULT m_result;				// result of the last search
+	POINT3 m_startPosition{ 0, 0, 0 };
+
+private slots:
+	void acquire(std::unique_ptr <StorageWrapper>& storage) override;
+	void acquire();
+
+signals:
+	void s_autofocusFinished(FOCUS_RESULT);
+};
+
+#endif //AUTOFOCUS_H
@@ -5,6 +5,8 @@
 #include "filesystem"
 
 #include <chrono>
+#include <future>
+#include <limits>
 #include <thread>
 
 using namespace std::filesystem;
@@ -13,8 +15,8 @@ using namespace std::filesystem;
  * Public definitions
  */
 
-Brillouin::Brillouin(QObject* parent, Acquisition* acquisition, Camera*& andor, ScanControl*& scanControl)
-	: AcquisitionMode(parent, acquisition, scanControl), m_andor(andor) {
+Brillouin::Brillouin(QObject* parent, Acquisition* acquisition, Camera*& andor, ScanControl*& scanControl, Camera*& brightfieldCamera)
+	: AcquisitionMode(parent, acquisition, scanControl), m_andor(andor), m_brightfieldCamera(brightfieldCamera) {
 	static QMetaObject::Connection connection = QWidget::connect(
 		this,
 		&Brillouin::s_scanOrderChanged,
@@ -119,6 +121,73 @@ void Brillouin::waitForNextRepetition() {
 	}
 }
 
+/*
+ * Acquires a single repetition at the current stage position and only returns when it is finished.
+ * This is used by the job scheduler, which takes care of the timing and the file itself.
+ */
+void Brillouin::acquireSingleRepetition() {
+	bool allowed = m_acquisition->enableMode(ACQUISITION_MODE::BRILLOUIN);
+	if (!allowed) {
+		return;
+	}
+	m_abort = false;
+
+	m_acquisition->newRepetition(ACQUISITION_MODE::BRILLOUIN);
+
+	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+	acquire(m_acquisition->m_storage);
+
+	if (m_abort) {
+		this->abortMode(m_acquisition->m_storage);
+		return;
+	}
+	m_acquisition->disableMode(ACQUISITION_MODE::BRILLOUIN);
+}
+
+/*
+ * Continues the interrupted scan of the given file with the settings stored in its checkpoint.
+ * The positions already stored in the file are skipped.
+ */
+void Brillouin::resumeRepetition(const std::string& filename) {
+	if (m_acquisition->getEnabledModes() != ACQUISITION_MODE::NONE) {
+		qWarning(logWarning()) << "The scan cannot be resumed while another acquisition is running.";
+		return;
+	}
+	auto checkpoint = BRILLOUIN_CHECKPOINT{};
+	if (!readCheckpoint(filename, checkpoint)) {
+		return;
+	}
+
+	auto filePath = path(filename);
+	auto folder = filePath.parent_path().string();
+	m_acquisition->openFile(StoragePath{ filePath.filename().string(), folder.empty() ? "." : folder }, H5F_ACC_RDWR);
+	if (!m_acquisition->m_storage->resumeRepetition(ACQUISITION_MODE::BRILLOUIN, checkpoint.repetition)) {
+		qWarning(logWarning()) << "The file does not contain the repetition" << checkpoint.repetition << "of the interrupted scan.";
+		// do not keep the file opened for writing, another program might want to repair it
+		m_acquisition->closeFile();
+		return;
+	}
+
+	bool allowed = m_acquisition->enableMode(ACQUISITION_MODE::BRILLOUIN);
+	if (!allowed) {
+		m_acquisition->closeFile();
+		return;
+	}
+	m_abort = false;
+	m_checkpoint = checkpoint;
+	m_resuming = true;
+
+	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+	acquire(m_acquisition->m_storage);
+	m_resuming = false;
+
+	if (m_abort) {
+		this->abortMode(m_acquisition->m_storage);
+		return;
+	}
+	m_acquisition->disableMode(ACQUISITION_MODE::BRILLOUIN);
+}
+
 void Brillouin::finaliseRepetitions() {
 	finaliseRepetitions(m_settings.repetitions.count, -1);
 }
@@ -234,6 +303,11 @@ void Brillouin::setScanOrderAuto(bool automatical) {
 	determineScanOrder();
 }
 
+void Brillouin::setScanPath(SCAN_PATH path) {
+	m_settings.scanPath = path;
+	updatePositions();
+}
+
 void Brillouin::determineScanOrder() {
 	if (m_scanOrder.automatical) {
 		// determine scan order based on step numbers
@@ -253,8 +327,11 @@ void Brillouin::determineScanOrder() {
 	emit(s_scanOrderChanged(m_scanOrder));
 }
 
+/*
+ * Returns a decimated preview of the positions to measure relative to the start position
+ */
 std::vector<POINT3> Brillouin::getOrderedPositions() {
-	return m_orderedPositionsRelative;
+	return m_positions.preview(m_previewPositions);
 }
 
 /*
@@ -262,16 +339,22 @@ std::vector<POINT3> Brillouin::getOrderedPositions() {
  */
 
 void Brillouin::abortMode(std::unique_ptr <StorageWrapper>& storage) {
-	m_repetitionTimer->stop();
+	if (m_repetitionTimer) {
+		m_repetitionTimer->stop();
+	}
 	m_startOfLastRepetition.invalidate();
-	if (m_andor) {
-		m_andor->stopAcquisition();
+	stopCameras();
+	stopSpectrumAnalysis();
+	// the result of a running calibration fit is not needed anymore
+	if (m_calibrationFit.valid()) {
+		m_calibrationFit.wait();
+		m_calibrationFit = {};
 	}
 
 	if (m_scanControl) {
-		m_scanControl->setPreset(ScanPreset::SCAN_LASEROFF);
-		m_scanControl->setPosition(m_startPosition);
-		m_scanControl->enableMeasurementMode(false);
+		switchPreset(ScanPreset::SCAN_LASEROFF);
+		moveStage(m_startPosition);
+		onScanControl([scanControl = m_scanControl]() { scanControl->enableMeasurementMode(false); });
 		QMetaObject::invokeMethod(
 			m_scanControl,
 			[scanControl = m_scanControl]() { scanControl->startAnnouncing(); },
@@ -280,6 +363,7 @@ void Brillouin::abortMode(std::unique_ptr <StorageWrapper>& storage) {
 	}
 
 	m_acquisition->disableMode(ACQUISITION_MODE::BRILLOUIN);
+	m_resuming = false;
 
 	// Here we wait until the storage object indicate it finished to write to the file.
 	QEventLoop loop;
@@ -296,27 +380,37 @@ void Brillouin::abortMode(std::unique_ptr <StorageWrapper>& storage) {
 	);
 	loop.exec();
 
+	if (!m_checkpointFilename.empty() && QFile::exists(QString::fromStdString(m_checkpointFilename))) {
+		qInfo(logInfo()) << "The interrupted scan can be resumed from" << m_checkpointFilename.c_str() << ".";
+	}
+
 	setAcquisitionStatus(ACQUISITION_STATUS::ABORTED);
 	emit(s_positionChanged({ 0 , 0, 0 }, 0));
 	emit(s_timeToCalibration(0));
 }
 
 void Brillouin::calibrate(std::unique_ptr <StorageWrapper>& storage) {
+	auto calibrationPhase = m_phaseTimer.measure("calibration");
 	// announce calibration start
 	emit(s_calibrationRunning(true));
 
 	// set exposure time for calibration
 	if (m_andor) {
-		m_andor->setCalibrationExposureTime(m_settings.calibrationExposureTime);
+		auto configuration = m_phaseTimer.measure("camera configuration");
+		if (m_andor->switchConfiguration("calibration")) {
+			qInfo(logInfo()) << "Switched to calibration configuration in" << m_andor->getSwitchLatency() << "ms.";
+		} else {
+			m_andor->setCalibrationExposureTime(m_settings.calibrationExposureTime);
+		}
 	}
 
 	// move optical elements to position for calibration
 	if (m_scanControl) {
-		m_scanControl->setPreset(ScanPreset::SCAN_CALIBRATION);
+		switchPreset(ScanPreset::SCAN_CALIBRATION);
 	}
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	settle(ScanPreset::SCAN_CALIBRATION, 500);
 
-	auto shift = 5.088; // this is the shift for water
+	auto shift = m_settings.calibrationShift;
 
 	// acquire images
 	auto rank_cal = 3;
@@ -336,6 +430,7 @@ void Brillouin::calibrate(std::unique_ptr <StorageWrapper>& storage) {
 		auto pointerPos = (int64_t)m_settings.camera.roi.bytesPerFrame * mm;
 
 		if (m_andor) {
+			auto frame = m_phaseTimer.measure("calibration frame");
 			m_andor->getImageForAcquisition(&images[pointerPos]);
 		}
 	}
@@ -409,18 +504,886 @@ void Brillouin::calibrate(std::unique_ptr <StorageWrapper>& storage) {
 		);
 	}
 
+	// the frequency axis is fitted while the optical elements move back
+	startCalibrationFit(std::move(images));
+
 	nrCalibrations++;
 
 	// revert optical elements to position for brightfield/Brillouin imaging
 	if (m_scanControl) {
-		m_scanControl->setPreset(ScanPreset::SCAN_BRILLOUIN);
+		switchPreset(ScanPreset::SCAN_BRILLOUIN);
 	}
 
 	// reset exposure time
 	if (m_andor) {
-		m_andor->setCalibrationExposureTime(m_settings.camera.exposureTime);
+		auto configuration = m_phaseTimer.measure("camera configuration");
+		if (m_andor->switchConfiguration("measurement")) {
+			qInfo(logInfo()) << "Switched to measurement configuration in" << m_andor->getSwitchLatency() << "ms.";
+		} else {
+			m_andor->setCalibrationExposureTime(m_settings.camera.exposureTime);
+		}
+	}
+	settle(ScanPreset::SCAN_BRILLOUIN, 500);
+}
+
+/*
+ * Fits the frequency axis to the spectrum of the given calibration images on a worker thread
+ */
+void Brillouin::startCalibrationFit(std::vector<std::byte> images) {
+	// the previous fit is long finished at the next calibration
+	if (m_calibrationFit.valid()) {
+		m_calibrationFit.wait();
+	}
+	m_calibrationFitIndex = nrCalibrations;
+
+	auto width = (int)m_settings.camera.roi.width_binned;
+	auto height = (int)m_settings.camera.roi.height_binned;
+	m_calibrationFit = std::async(std::launch::async, [line = spectrumLine(), width, height, images = std::move(images),
+		count = m_settings.nrCalibrationImages, dataType = m_settings.camera.readout.dataType,
+		shift = m_settings.calibrationShift, freeSpectralRange = m_settings.freeSpectralRange]() {
+		auto extractor = spectrumExtractor(line, width, height);
+		auto spectrum = std::vector<double>(extractor.samples());
+		auto pixels = (gsl::index)width * height;
+		if (dataType == "unsigned short") {
+			extractor.extract((const unsigned short*)images.data(), count, pixels, spectrum.data());
+		} else if (dataType == "unsigned char") {
+			extractor.extract((const unsigned char*)images.data(), count, pixels, spectrum.data());
+		} else if (dataType == "unsigned int") {
+			extractor.extract((const unsigned int*)images.data(), count, pixels, spectrum.data());
+		}
+		return vipaCalibration(shift, freeSpectralRange).fit(spectrum.data(), (int)spectrum.size());
+	});
+}
+
+/*
+ * Waits for the fit of the last calibration, stores it and hands it to the spectrum analysis.
+ * If the fit failed, the spectra are still evaluated with the previous calibration.
+ */
+void Brillouin::applyCalibrationFit(std::unique_ptr <StorageWrapper>& storage) {
+	if (!m_calibrationFit.valid()) {
+		return;
+	}
+	auto calibration = m_calibrationFit.get();
+	if (calibration.valid) {
+		if (m_calibration.valid) {
+			qInfo(logInfo()) << "Calibration" << m_calibrationFitIndex << ": the peaks drifted by"
+				<< calibration.peaks[0] - m_calibration.peaks[0] << "and" << calibration.peaks[1] - m_calibration.peaks[1] << "pix.";
+		}
+		qInfo(logInfo()) << "Calibration" << m_calibrationFitIndex << ": the dispersion is" << calibration.dispersion << "GHz/pix.";
+		m_calibration = calibration;
+		if (m_spectrumAnalysis) {
+			m_spectrumAnalysis->setCalibration(calibration);
+		}
+	} else {
+		qWarning(logWarning()) << "The peaks of calibration" << m_calibrationFitIndex << "could not be fitted.";
+	}
+
+	auto fit = new CALIBRATION_FIT(m_calibrationFitIndex, calibration);
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage, fit]() { storage.get()->s_enqueueCalibrationFit(fit); },
+		Qt::AutoConnection
+	);
+}
+
+/*
+ * Acquires all frames of the given position into m_frames
+ */
+bool Brillouin::captureFrames(std::unique_ptr <StorageWrapper>& storage, const SCAN_POSITION& position) {
+	m_frames.resize((size_t)m_settings.camera.roi.bytesPerFrame * m_settings.camera.frameCount);
+
+	for (gsl::index mm{ 0 }; mm < m_settings.camera.frameCount; mm++) {
+		if (m_abort) {
+			m_abort = true;
+			return false;
+		}
+		emit(s_positionChanged(position.position, mm + 1));
+		// acquire images
+		auto pointerPos = (int64_t)m_settings.camera.roi.bytesPerFrame * mm;
+
+		if (m_andor) {
+			acquireFrame(storage, position.index, mm, &m_frames[pointerPos]);
+		} else {
+			m_abort = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Hands the frames of the position with the given index over to the storage, they are stored individually
+ */
+void Brillouin::handOffFrames(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims) {
+	// asynchronously write image to disk
+	// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+	auto date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
+		.toString(Qt::ISODateWithMs).toStdString();
+
+	if (m_settings.camera.readout.dataType == "unsigned short") {
+		// cast the image to unsigned short
+		auto images_ = (std::vector<unsigned short> *) & m_frames;
+		auto img = new IMAGE<unsigned short>(
+			index.x,
+			index.y,
+			index.z,
+			rank,
+			dims,
+			date,
+			*images_,
+			m_settings.camera.exposureTime,
+			m_settings.camera.gain,
+			m_settings.camera.roi
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
+			Qt::AutoConnection
+		);
+	} else if (m_settings.camera.readout.dataType == "unsigned char") {
+		// cast the image to unsigned char
+		auto images_ = (std::vector<unsigned char> *) & m_frames;
+		auto img = new IMAGE<unsigned char>(
+			index.x,
+			index.y,
+			index.z,
+			rank,
+			dims,
+			date,
+			*images_,
+			m_settings.camera.exposureTime,
+			m_settings.camera.gain,
+			m_settings.camera.roi
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
+			Qt::AutoConnection
+		);
+	} else if (m_settings.camera.readout.dataType == "unsigned int") {
+		// cast the image to unsigned char
+		auto images_ = (std::vector<unsigned int> *) & m_frames;
+		auto img = new IMAGE<unsigned int>(
+			index.x,
+			index.y,
+			index.z,
+			rank,
+			dims,
+			date,
+			*images_,
+			m_settings.camera.exposureTime,
+			m_settings.camera.gain,
+			m_settings.camera.roi
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
+			Qt::AutoConnection
+		);
+	}
+}
+
+/*
+ * Acquires all frames of the given position and sums them up in m_accumulator
+ */
+bool Brillouin::captureAccumulated(std::unique_ptr <StorageWrapper>& storage, const SCAN_POSITION& position) {
+	auto pixelCount = (size_t)m_settings.camera.roi.width_binned * m_settings.camera.roi.height_binned;
+	m_accumulator.reset(pixelCount, m_settings.storeVariance);
+
+	// the frames are summed up as they arrive, so we only need memory for a single frame
+	m_frames.resize(m_settings.camera.roi.bytesPerFrame);
+
+	for (gsl::index mm{ 0 }; mm < m_settings.camera.frameCount; mm++) {
+		if (m_abort) {
+			return false;
+		}
+		emit(s_positionChanged(position.position, mm + 1));
+
+		if (m_andor) {
+			acquireFrame(storage, position.index, mm, &m_frames[0]);
+		} else {
+			m_abort = true;
+			return false;
+		}
+		accumulateFrame(m_frames);
+	}
+
+	return true;
+}
+
+/*
+ * Hands the sum and optionally the variance of the frames of the position with the given index over to the storage
+ */
+void Brillouin::handOffAccumulated(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims) {
+	// asynchronously write image to disk
+	// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+	auto date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
+		.toString(Qt::ISODateWithMs).toStdString();
+
+	auto img = new IMAGE<unsigned int>(
+		index.x,
+		index.y,
+		index.z,
+		rank,
+		dims,
+		date,
+		m_accumulator.sum(),
+		m_settings.camera.exposureTime,
+		m_settings.camera.gain,
+		m_settings.camera.roi,
+		m_accumulator.count()
+	);
+
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
+		Qt::AutoConnection
+	);
+
+	if (m_settings.storeVariance) {
+		auto variance = new IMAGE<float>(
+			index.x,
+			index.y,
+			index.z,
+			rank,
+			dims,
+			date,
+			m_accumulator.variance(),
+			m_settings.camera.exposureTime,
+			m_settings.camera.gain,
+			m_settings.camera.roi,
+			m_accumulator.count()
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, variance]() { storage.get()->s_enqueuePayloadVariance(variance); },
+			Qt::AutoConnection
+		);
+	}
+}
+
+void Brillouin::accumulateFrame(const std::vector<std::byte>& frame) {
+	auto accumulation = m_phaseTimer.measure("accumulation");
+	if (m_settings.camera.readout.dataType == "unsigned short") {
+		m_accumulator.add((const unsigned short*)frame.data());
+	} else if (m_settings.camera.readout.dataType == "unsigned char") {
+		m_accumulator.add((const unsigned char*)frame.data());
+	} else if (m_settings.camera.readout.dataType == "unsigned int") {
+		m_accumulator.add((const unsigned int*)frame.data());
+	}
+}
+
+/*
+ * Acquires the frame mm of the position with the given index. For the first frame of a position an aligned
+ * brightfield image is acquired and stored as well, if brightfield tracking is enabled.
+ */
+void Brillouin::acquireFrame(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, gsl::index mm, std::byte* buffer) {
+	auto frame = m_phaseTimer.measure("frame");
+	if (!m_cameraSession || mm > 0) {
+		m_andor->getImageForAcquisition(buffer);
+		return;
+	}
+
+	auto aligned = m_cameraSession->acquire(buffer);
+	auto& brightfield = aligned.frames[1];
+	if (brightfield.data.empty()) {
+		return;
+	}
+
+	// the date has to reflect the time of the brightfield exposure
+	auto age = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - brightfield.timestamp);
+	auto date = QDateTime::currentDateTime().addMSecs(-age.count());
+	auto dateString = date.toOffsetFromUtc(date.offsetFromUtc()).toString(Qt::ISODateWithMs).toStdString();
+
+	auto settings = m_cameraSession->getSettings(1);
+	if (settings.readout.dataType == "unsigned char") {
+		auto data = (std::vector<unsigned char> *) & brightfield.data;
+		auto img = new IMAGE<unsigned char>(
+			index.x,
+			index.y,
+			index.z,
+			3,
+			m_dimsBrightfield,
+			dateString,
+			*data,
+			settings.exposureTime,
+			settings.gain,
+			settings.roi
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, img]() { storage.get()->s_enqueueBrightfield(img); },
+			Qt::AutoConnection
+		);
+	} else if (settings.readout.dataType == "unsigned short") {
+		auto data = (std::vector<unsigned short> *) & brightfield.data;
+		auto img = new IMAGE<unsigned short>(
+			index.x,
+			index.y,
+			index.z,
+			3,
+			m_dimsBrightfield,
+			dateString,
+			*data,
+			settings.exposureTime,
+			settings.gain,
+			settings.roi
+		);
+
+		QMetaObject::invokeMethod(
+			storage.get(),
+			[&storage = storage, img]() { storage.get()->s_enqueueBrightfield(img); },
+			Qt::AutoConnection
+		);
+	}
+}
+
+/*
+ * Determines the position to measure as number ll, returns false if the scan is finished.
+ * In adaptive mode the position depends on the features of the positions measured before.
+ */
+bool Brillouin::nextPosition(gsl::index ll, SCAN_POSITION& position) {
+	if (m_settings.adaptive) {
+		auto grid = INDEX3{};
+		if (!m_adaptiveScan.next(grid)) {
+			return false;
+		}
+		position = m_positions.fromGrid(grid);
+		// an adaptive scan has no lines, so a calibration is possible at every position
+		position.calibrationAllowed = true;
+		return true;
+	}
+	if (ll >= m_positions.size()) {
+		return false;
+	}
+	position = m_positions.at(ll);
+	return true;
+}
+
+/*
+ * Returns the spectral centroid of the frames of the current position
+ */
+double Brillouin::spectralFeature() {
+	auto width = (int)m_settings.camera.roi.width_binned;
+	auto height = (int)m_settings.camera.roi.height_binned;
+	if (m_settings.accumulateFrames) {
+		return adaptiveScan::centroid(m_accumulator.sum().data(), width, height, 1);
+	}
+	auto frameCount = m_settings.camera.frameCount;
+	if (m_settings.camera.readout.dataType == "unsigned short") {
+		return adaptiveScan::centroid((const unsigned short*)m_frames.data(), width, height, frameCount);
+	} else if (m_settings.camera.readout.dataType == "unsigned char") {
+		return adaptiveScan::centroid((const unsigned char*)m_frames.data(), width, height, frameCount);
+	} else if (m_settings.camera.readout.dataType == "unsigned int") {
+		return adaptiveScan::centroid((const unsigned int*)m_frames.data(), width, height, frameCount);
+	}
+	return 0;
+}
+
+/*
+ * Stores the comment, the positions and the scan path of the scan in the current repetition
+ */
+void Brillouin::writeScanGeometry(std::unique_ptr <StorageWrapper>& storage) {
+	auto commentIn = std::string{ "Brillouin data" };
+	storage->setComment(commentIn);
+
+	storage->setResolution("x", m_settings.xSteps);
+	storage->setResolution("y", m_settings.ySteps);
+	storage->setResolution("z", m_settings.zSteps);
+
+	writeScaleCalibration(storage, ACQUISITION_MODE::BRILLOUIN);
+
+	/*
+	 * Write the positions to the H5 file with row-major order: z, x, y.
+	 * They are written in blocks of complete rows, so that the positions of large scans never have to be held in memory at once.
+	 */
+	 // construct directions vectors
+	auto directionsX{ simplemath::linspace(m_settings.xMin, m_settings.xMax, m_settings.xSteps) };
+	auto directionsY{ simplemath::linspace(m_settings.yMin, m_settings.yMax, m_settings.ySteps) };
+	auto directionsZ{ simplemath::linspace(m_settings.zMin, m_settings.zMax, m_settings.zSteps) };
+
+	auto xSteps = (gsl::index)m_settings.xSteps;
+	auto ySteps = (gsl::index)m_settings.ySteps;
+	auto zSteps = (gsl::index)m_settings.zSteps;
+	auto rank{ 3 };
+	hsize_t dims[3] = { (hsize_t)zSteps, (hsize_t)xSteps, (hsize_t)ySteps };
+
+	// the positions of an adaptive scan depend on the sample, they are stored after the scan
+	auto storeOrder = !m_settings.adaptive;
+
+	auto rowsPerBlock = (std::max)(gsl::index{ 1 }, m_geometryBlockSize / ySteps);
+	auto positionsX = std::vector<double>((size_t)(rowsPerBlock * ySteps));
+	auto positionsY = std::vector<double>((size_t)(rowsPerBlock * ySteps));
+	auto positionsZ = std::vector<double>((size_t)(rowsPerBlock * ySteps));
+	// the step at which every position is measured
+	auto positionsOrder = std::vector<int>(storeOrder ? (size_t)(rowsPerBlock * ySteps) : 0);
+	for (gsl::index ii{ 0 }; ii < zSteps; ii++) {
+		for (gsl::index firstRow{ 0 }; firstRow < xSteps; firstRow += rowsPerBlock) {
+			auto rows = (std::min)(rowsPerBlock, xSteps - firstRow);
+			auto posIndex = gsl::index{ 0 };
+			for (gsl::index jj{ firstRow }; jj < firstRow + rows; jj++) {
+				for (gsl::index kk{ 0 }; kk < ySteps; kk++) {
+					positionsX[posIndex] = directionsX[jj] + m_startPosition.x;
+					positionsY[posIndex] = directionsY[kk] + m_startPosition.y;
+					positionsZ[posIndex] = directionsZ[ii] + m_startPosition.z;
+					if (storeOrder) {
+						positionsOrder[posIndex] = (int)m_positions.step(INDEX3{ (int)jj, (int)kk, (int)ii });
+					}
+					posIndex++;
+				}
+			}
+
+			hsize_t offset[3] = { (hsize_t)ii, (hsize_t)firstRow, 0 };
+			hsize_t count[3] = { 1, (hsize_t)rows, (hsize_t)ySteps };
+			storage->setPositions("x", positionsX, rank, dims, offset, count);
+			storage->setPositions("y", positionsY, rank, dims, offset, count);
+			storage->setPositions("z", positionsZ, rank, dims, offset, count);
+			if (storeOrder) {
+				storage->setScanPath(scanPath::toString(m_positions.path()), positionsOrder, rank, dims, offset, count);
+			}
+		}
+	}
+
+	if (storeOrder) {
+		qInfo(logInfo()) << "Using a" << scanPath::toString(m_positions.path()).c_str() << "scan path with a total stage travel of"
+			<< m_positions.travel() << "micrometer.";
+	}
+}
+
+/*
+ * Returns the step the interrupted scan continues at.
+ * The last position found in the file is acquired again, since the scan might have been interrupted while writing it.
+ */
+gsl::index Brillouin::resumeStep(std::unique_ptr <StorageWrapper>& storage) {
+	auto stored = gsl::index{ 0 };
+	while (stored < m_positions.size()) {
+		auto index = m_positions.at(stored).index;
+		if (!storage->isPayloadStored(index.x, index.y, index.z)) {
+			break;
+		}
+		stored++;
+	}
+	qInfo(logInfo()) << "Resuming the scan," << stored << "of" << m_positions.size() << "positions are stored in the file, the checkpoint recorded"
+		<< m_checkpoint.step << "positions.";
+	return (std::max)(stored - 1, (gsl::index)0);
+}
+
+/*
+ * Writes the settings and the progress of the running scan next to the file, so that the scan can be resumed
+ */
+void Brillouin::writeCheckpoint(gsl::index step) {
+	m_checkpointTimer.start();
+	// the positions of an adaptive scan depend on the spectra acquired before, so it cannot be resumed
+	if (m_settings.adaptive || m_checkpointFilename.empty()) {
+		return;
+	}
+	m_checkpoint.step = step;
+	m_checkpoint.calibrations = nrCalibrations - 1;
+
+	QSettings checkpoint(QString::fromStdString(m_checkpointFilename), QSettings::IniFormat);
+
+	checkpoint.beginGroup("progress");
+	checkpoint.setValue("repetition", m_checkpoint.repetition);
+	checkpoint.setValue("step", (qlonglong)m_checkpoint.step);
+	checkpoint.setValue("calibrations", m_checkpoint.calibrations);
+	checkpoint.setValue("start-x", m_checkpoint.startPosition.x);
+	checkpoint.setValue("start-y", m_checkpoint.startPosition.y);
+	checkpoint.setValue("start-z", m_checkpoint.startPosition.z);
+	checkpoint.setValue("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+	checkpoint.endGroup();
+
+	checkpoint.beginGroup("scan");
+	checkpoint.setValue("x-min", m_settings.xMin);
+	checkpoint.setValue("x-max", m_settings.xMax);
+	checkpoint.setValue("x-steps", m_settings.xSteps);
+	checkpoint.setValue("y-min", m_settings.yMin);
+	checkpoint.setValue("y-max", m_settings.yMax);
+	checkpoint.setValue("y-steps", m_settings.ySteps);
+	checkpoint.setValue("z-min", m_settings.zMin);
+	checkpoint.setValue("z-max", m_settings.zMax);
+	checkpoint.setValue("z-steps", m_settings.zSteps);
+	checkpoint.setValue("scan-order-x", m_scanOrder.x);
+	checkpoint.setValue("scan-order-y", m_scanOrder.y);
+	checkpoint.setValue("scan-order-z", m_scanOrder.z);
+	checkpoint.setValue("scan-path", (int)m_settings.scanPath);
+	checkpoint.endGroup();
+
+	checkpoint.beginGroup("calibration");
+	checkpoint.setValue("sample", QString::fromStdString(m_settings.sample));
+	checkpoint.setValue("pre-calibration", m_settings.preCalibration);
+	checkpoint.setValue("post-calibration", m_settings.postCalibration);
+	checkpoint.setValue("continuous-calibration", m_settings.conCalibration);
+	checkpoint.setValue("interval", m_settings.conCalibrationInterval);
+	checkpoint.setValue("images", m_settings.nrCalibrationImages);
+	checkpoint.setValue("exposure-time", m_settings.calibrationExposureTime);
+	checkpoint.setValue("shift", m_settings.calibrationShift);
+	checkpoint.setValue("free-spectral-range", m_settings.freeSpectralRange);
+	checkpoint.endGroup();
+
+	auto vertices = QVariantList{};
+	for (const auto& point : m_settings.spectrumLine.points) {
+		vertices << point.x << point.y;
+	}
+	checkpoint.beginGroup("storage");
+	checkpoint.setValue("accumulate-frames", m_settings.accumulateFrames);
+	checkpoint.setValue("store-variance", m_settings.storeVariance);
+	checkpoint.setValue("track-brightfield", m_settings.trackBrightfield);
+	checkpoint.setValue("analyse-spectra", m_settings.analyseSpectra);
+	checkpoint.setValue("store-spectra", m_settings.storeSpectra);
+	checkpoint.setValue("raw-frame-interval", m_settings.rawFrameInterval);
+	checkpoint.setValue("spectrum-line-vertices", vertices);
+	checkpoint.setValue("spectrum-line-samples", m_settings.spectrumLine.samples);
+	checkpoint.setValue("spectrum-line-half-width", m_settings.spectrumLine.halfWidth);
+	checkpoint.endGroup();
+
+	auto& camera = m_settings.camera;
+	checkpoint.beginGroup("camera");
+	checkpoint.setValue("exposure-time", camera.exposureTime);
+	checkpoint.setValue("frame-count", camera.frameCount);
+	checkpoint.setValue("gain", camera.gain);
+	checkpoint.setValue("spurious-noise-filter", camera.spuriousNoiseFilter);
+	checkpoint.setValue("roi-left", camera.roi.left);
+	checkpoint.setValue("roi-top", camera.roi.top);
+	checkpoint.setValue("roi-width-physical", camera.roi.width_physical);
+	checkpoint.setValue("roi-height-physical", camera.roi.height_physical);
+	checkpoint.setValue("binning", QString::fromStdWString(camera.roi.binning));
+	checkpoint.setValue("pixel-readout-rate", QString::fromStdWString(camera.readout.pixelReadoutRate));
+	checkpoint.setValue("pixel-encoding", QString::fromStdWString(camera.readout.pixelEncoding));
+	checkpoint.setValue("cycle-mode", QString::fromStdWString(camera.readout.cycleMode));
+	checkpoint.setValue("trigger-mode", QString::fromStdWString(camera.readout.triggerMode));
+	checkpoint.setValue("pre-amp-gain", QString::fromStdWString(camera.readout.preAmpGain));
+	checkpoint.endGroup();
+
+	checkpoint.sync();
+}
+
+/*
+ * Restores the settings of the interrupted scan of the given file from its checkpoint
+ */
+bool Brillouin::readCheckpoint(const std::string& filename, BRILLOUIN_CHECKPOINT& checkpoint) {
+	auto checkpointPath = QString::fromStdString(checkpointFilename(filename));
+	if (!QFile::exists(checkpointPath)) {
+		qWarning(logWarning()) << "There is no interrupted scan to resume in" << filename.c_str() << ".";
+		return false;
+	}
+	QSettings settings(checkpointPath, QSettings::IniFormat);
+
+	settings.beginGroup("progress");
+	checkpoint.repetition = settings.value("repetition", -1).toInt();
+	checkpoint.step = settings.value("step", 0).toLongLong();
+	checkpoint.calibrations = settings.value("calibrations", 0).toInt();
+	checkpoint.startPosition = POINT3{
+		settings.value("start-x", 0).toDouble(),
+		settings.value("start-y", 0).toDouble(),
+		settings.value("start-z", 0).toDouble()
+	};
+	auto date = settings.value("date").toString();
+	settings.endGroup();
+	if (checkpoint.repetition < 0) {
+		qWarning(logWarning()) << "The checkpoint of" << filename.c_str() << "is invalid.";
+		return false;
+	}
+
+	settings.beginGroup("scan");
+	m_settings.setXMin(settings.value("x-min", m_settings.xMin).toDouble());
+	m_settings.setXMax(settings.value("x-max", m_settings.xMax).toDouble());
+	m_settings.setXSteps(settings.value("x-steps", m_settings.xSteps).toInt());
+	m_settings.setYMin(settings.value("y-min", m_settings.yMin).toDouble());
+	m_settings.setYMax(settings.value("y-max", m_settings.yMax).toDouble());
+	m_settings.setYSteps(settings.value("y-steps", m_settings.ySteps).toInt());
+	m_settings.setZMin(settings.value("z-min", m_settings.zMin).toDouble());
+	m_settings.setZMax(settings.value("z-max", m_settings.zMax).toDouble());
+	m_settings.setZSteps(settings.value("z-steps", m_settings.zSteps).toInt());
+	// the order has to match the interrupted scan, even if the step numbers would result in a different automatic order
+	m_scanOrder.automatical = false;
+	m_scanOrder.x = settings.value("scan-order-x", m_scanOrder.x).toInt();
+	m_scanOrder.y = settings.value("scan-order-y", m_scanOrder.y).toInt();
+	m_scanOrder.z = settings.value("scan-order-z", m_scanOrder.z).toInt();
+	m_settings.scanPath = (SCAN_PATH)settings.value("scan-path", (int)m_settings.scanPath).toInt();
+	m_settings.adaptive = false;
+	settings.endGroup();
+
+	settings.beginGroup("calibration");
+	m_settings.sample = settings.value("sample", QString::fromStdString(m_settings.sample)).toString().toStdString();
+	m_settings.preCalibration = settings.value("pre-calibration", m_settings.preCalibration).toBool();
+	m_settings.postCalibration = settings.value("post-calibration", m_settings.postCalibration).toBool();
+	m_settings.conCalibration = settings.value("continuous-calibration", m_settings.conCalibration).toBool();
+	m_settings.conCalibrationInterval = settings.value("interval", m_settings.conCalibrationInterval).toDouble();
+	m_settings.nrCalibrationImages = settings.value("images", m_settings.nrCalibrationImages).toInt();
+	m_settings.calibrationExposureTime = settings.value("exposure-time", m_settings.calibrationExposureTime).toDouble();
+	m_settings.calibrationShift = settings.value("shift", m_settings.calibrationShift).toDouble();
+	m_settings.freeSpectralRange = settings.value("free-spectral-range", m_settings.freeSpectralRange).toDouble();
+	settings.endGroup();
+
+	settings.beginGroup("storage");
+	m_settings.accumulateFrames = settings.value("accumulate-frames", m_settings.accumulateFrames).toBool();
+	m_settings.storeVariance = settings.value("store-variance", m_settings.storeVariance).toBool();
+	m_settings.trackBrightfield = settings.value("track-brightfield", m_settings.trackBrightfield).toBool();
+	m_settings.analyseSpectra = settings.value("analyse-spectra", m_settings.analyseSpectra).toBool();
+	m_settings.storeSpectra = settings.value("store-spectra", m_settings.storeSpectra).toBool();
+	m_settings.rawFrameInterval = settings.value("raw-frame-interval", m_settings.rawFrameInterval).toInt();
+	auto vertices = settings.value("spectrum-line-vertices").toList();
+	m_settings.spectrumLine.points.clear();
+	for (gsl::index i{ 0 }; i + 1 < vertices.size(); i += 2) {
+		m_settings.spectrumLine.points.push_back({ vertices[i].toDouble(), vertices[i + 1].toDouble() });
+	}
+	m_settings.spectrumLine.samples = settings.value("spectrum-line-samples", m_settings.spectrumLine.samples).toInt();
+	m_settings.spectrumLine.halfWidth = settings.value("spectrum-line-half-width", m_settings.spectrumLine.halfWidth).toInt();
+	settings.endGroup();
+
+	auto& camera = m_settings.camera;
+	settings.beginGroup("camera");
+	camera.exposureTime = settings.value("exposure-time", camera.exposureTime).toDouble();
+	camera.frameCount = settings.value("frame-count", camera.frameCount).toLongLong();
+	camera.gain = settings.value("gain", camera.gain).toDouble();
+	camera.spuriousNoiseFilter = settings.value("spurious-noise-filter", camera.spuriousNoiseFilter).toBool();
+	camera.roi.left = settings.value("roi-left", camera.roi.left).toLongLong();
+	camera.roi.top = settings.value("roi-top", camera.roi.top).toLongLong();
+	camera.roi.width_physical = settings.value("roi-width-physical", camera.roi.width_physical).toLongLong();
+	camera.roi.height_physical = settings.value("roi-height-physical", camera.roi.height_physical).toLongLong();
+	camera.roi.binning = settings.value("binning", QString::fromStdWString(camera.roi.binning)).toString().toStdWString();
+	camera.readout.pixelReadoutRate = settings.value("pixel-readout-rate", QString::fromStdWString(camera.readout.pixelReadoutRate)).toString().toStdWString();
+	camera.readout.pixelEncoding = settings.value("pixel-encoding", QString::fromStdWString(camera.readout.pixelEncoding)).toString().toStdWString();
+	camera.readout.cycleMode = settings.value("cycle-mode", QString::fromStdWString(camera.readout.cycleMode)).toString().toStdWString();
+	camera.readout.triggerMode = settings.value("trigger-mode", QString::fromStdWString(camera.readout.triggerMode)).toString().toStdWString();
+	camera.readout.preAmpGain = settings.value("pre-amp-gain", QString::fromStdWString(camera.readout.preAmpGain)).toString().toStdWString();
+	settings.endGroup();
+
+	qInfo(logInfo()) << "Restored the settings of the scan interrupted after" << checkpoint.step << "positions at" << date << ".";
+	emit(s_scanOrderChanged(m_scanOrder));
+	return true;
+}
+
+void Brillouin::removeCheckpoint() {
+	if (!m_checkpointFilename.empty()) {
+		QFile::remove(QString::fromStdString(m_checkpointFilename));
+	}
+}
+
+std::string Brillouin::checkpointFilename(const std::string& filename) {
+	return filename + ".checkpoint";
+}
+
+/*
+ * Stores the measured positions of an adaptive scan together with their refinement tree
+ */
+void Brillouin::writeAdaptiveScan(std::unique_ptr <StorageWrapper>& storage) {
+	auto& points = m_adaptiveScan.points();
+	auto indices = std::vector<int>(3 * points.size());
+	auto levels = std::vector<int>(points.size());
+	auto parents = std::vector<int>(points.size());
+	auto values = std::vector<double>(points.size());
+	// the step at which every position was measured, -1 if it was skipped
+	auto positionsOrder = std::vector<int>((size_t)m_positions.size(), -1);
+	for (gsl::index i{ 0 }; i < (gsl::index)points.size(); i++) {
+		auto index = m_positions.fromGrid(points[i].grid).index;
+		indices[3 * i] = index.x;
+		indices[3 * i + 1] = index.y;
+		indices[3 * i + 2] = index.z;
+		levels[i] = points[i].level;
+		parents[i] = points[i].parent;
+		values[i] = points[i].value;
+		positionsOrder[((gsl::index)index.z * m_settings.xSteps + index.x) * m_settings.ySteps + index.y] = (int)i;
+	}
+	auto dims = std::vector<hsize_t>{ (hsize_t)m_settings.zSteps, (hsize_t)m_settings.xSteps, (hsize_t)m_settings.ySteps };
+
+	// the storage might still write images, so we let it write the tree itself
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage, indices, levels, parents, values, positionsOrder, dims]() {
+			storage.get()->setScanPath("adaptive", positionsOrder, 3, dims.data());
+			storage.get()->setAdaptiveScan(indices, levels, parents, values);
+		},
+		Qt::AutoConnection
+	);
+}
+
+/*
+ * Starts the workers which fit the spectra of the scan, if the spectrum analysis is enabled
+ */
+void Brillouin::startSpectrumAnalysis() {
+	m_spectrumResults.clear();
+	m_spectrumResultsTimer.start();
+	if (!m_settings.analyseSpectra) {
+		return;
+	}
+	auto width = (int)m_settings.camera.roi.width_binned;
+	auto height = (int)m_settings.camera.roi.height_binned;
+
+	auto dataType = m_settings.accumulateFrames ? std::string{ "unsigned int" } : m_settings.camera.readout.dataType;
+	m_spectrumAnalysis = std::make_unique<SpectrumAnalysis>();
+	m_spectrumAnalysis->start(spectrumLine(), width, height, dataType);
+	qInfo(logInfo()) << "Fitting the spectra on" << m_spectrumAnalysis->getThreadCount() << "threads.";
+}
+
+/*
+ * Queues the spectrum of the current position for fitting and forwards the results available so far.
+ * Without spectrum analysis only the spectral centroid is forwarded, which is cheap enough to compute for every position.
+ */
+void Brillouin::analyseSpectrum(const INDEX3& index) {
+	if (!m_spectrumAnalysis) {
+		auto result = SPECTRUM_RESULT{};
+		result.index = index;
+		result.centroid = spectralFeature();
+		m_spectrumResults.push_back(result);
+		forwardSpectrumResults();
+		return;
+	}
+	if (m_settings.accumulateFrames) {
+		m_spectrumAnalysis->enqueueAccumulated(index, m_accumulator.sum().data());
+	} else {
+		m_spectrumAnalysis->enqueue(index, m_frames.data(), m_settings.camera.frameCount);
+	}
+
+	auto results = m_spectrumAnalysis->takeResults();
+	m_spectrumResults.insert(m_spectrumResults.end(), results.begin(), results.end());
+	forwardSpectrumResults();
+}
+
+/*
+ * Emits the collected results, at most once per interval unless forced
+ */
+void Brillouin::forwardSpectrumResults(bool force) {
+	if (m_spectrumResults.empty()) {
+		return;
+	}
+	if (!force && m_spectrumResultsTimer.elapsed() < m_spectrumResultsInterval) {
+		return;
+	}
+	emit(s_spectraAnalysed(m_spectrumResults));
+	m_spectrumResults.clear();
+	m_spectrumResultsTimer.restart();
+}
+
+/*
+ * Returns the line through the spectrum on the camera, without a line of finite length we take the center row of the frame
+ */
+SPECTRUM_LINE Brillouin::spectrumLine() {
+	auto line = m_settings.spectrumLine;
+	auto length = double{ 0 };
+	for (gsl::index i{ 1 }; i < (gsl::index)line.points.size(); i++) {
+		length += abs(line.points[i] - line.points[i - 1]);
+	}
+	if (length == 0) {
+		auto width = (double)m_settings.camera.roi.width_binned;
+		auto height = (double)m_settings.camera.roi.height_binned;
+		line.points = { POINT2{ 0, 0.5 * (height - 1) }, POINT2{ width - 1, 0.5 * (height - 1) } };
+	}
+	return line;
+}
+
+/*
+ * Hands the spectra of the frames of the position with the given index over to the storage.
+ * In accumulation mode only the spectrum of the summed up frame is stored.
+ */
+void Brillouin::handOffSpectra(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims) {
+	// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+	auto date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
+		.toString(Qt::ISODateWithMs).toStdString();
+
+	auto samples = (gsl::index)m_storageExtractor.samples();
+	auto frameCount = m_settings.accumulateFrames ? 1 : m_settings.camera.frameCount;
+	auto spectra = std::vector<float>(frameCount * samples);
+
+	if (m_settings.accumulateFrames) {
+		m_storageExtractor.extractFrame(m_accumulator.sum().data(), &spectra[0]);
+	} else {
+		auto& dataType = m_settings.camera.readout.dataType;
+		for (gsl::index mm{ 0 }; mm < frameCount; mm++) {
+			auto frame = &m_frames[(size_t)m_settings.camera.roi.bytesPerFrame * mm];
+			if (dataType == "unsigned short") {
+				m_storageExtractor.extractFrame((const unsigned short*)frame, &spectra[mm * samples]);
+			} else if (dataType == "unsigned char") {
+				m_storageExtractor.extractFrame((const unsigned char*)frame, &spectra[mm * samples]);
+			} else if (dataType == "unsigned int") {
+				m_storageExtractor.extractFrame((const unsigned int*)frame, &spectra[mm * samples]);
+			}
+		}
+	}
+
+	auto img = new IMAGE<float>(
+		index.x,
+		index.y,
+		index.z,
+		rank,
+		dims,
+		date,
+		spectra,
+		m_settings.camera.exposureTime,
+		m_settings.camera.gain,
+		m_settings.camera.roi,
+		m_settings.accumulateFrames ? m_accumulator.count() : 0
+	);
+
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage, img]() { storage.get()->s_enqueuePayloadSpectra(img); },
+		Qt::AutoConnection
+	);
+}
+
+/*
+ * Waits for the remaining fits and stops the workers
+ */
+void Brillouin::stopSpectrumAnalysis() {
+	if (!m_spectrumAnalysis) {
+		forwardSpectrumResults(true);
+		return;
+	}
+	m_spectrumAnalysis->stop();
+
+	auto results = m_spectrumAnalysis->takeResults();
+	m_spectrumResults.insert(m_spectrumResults.end(), results.begin(), results.end());
+	forwardSpectrumResults(true);
+
+	auto statistics = m_spectrumAnalysis->getStatistics();
+	qInfo(logInfo()) << "Fitted" << statistics.fitted << "spectra (" << statistics.fitsPerSecond << "fits/s), at most"
+		<< statistics.maxBacklog << "spectra were waiting.";
+	if (statistics.dropped > 0) {
+		qWarning(logWarning()) << "The spectrum analysis could not keep up," << statistics.dropped << "spectra were not fitted.";
+	}
+	m_spectrumAnalysis.reset();
+}
+
+/*
+ * Starts the Brillouin camera and, if brightfield tracking is enabled, the brightfield camera in a common session
+ */
+void Brillouin::startCameras() {
+	auto useBrightfield = m_settings.trackBrightfield && m_brightfieldCamera && m_brightfieldCamera->getConnectionStatus();
+	// The brightfield camera might be used by another acquisition mode already
+	if (useBrightfield && m_brightfieldCamera->m_isAcquisitionRunning) {
+		qWarning(logWarning()) << "The brightfield camera is busy, Brillouin acquisition continues without brightfield tracking.";
+		useBrightfield = false;
+	}
+
+	if (!useBrightfield) {
+		m_andor->startAcquisition(m_settings.camera);
+		m_settings.camera = m_andor->getSettings();
+		return;
+	}
+
+	m_cameraSession = std::make_unique<CameraSession>(std::vector<Camera*>{ m_andor, m_brightfieldCamera });
+	m_cameraSession->start({ m_settings.camera, m_brightfieldCamera->getSettings() });
+	m_settings.camera = m_cameraSession->getSettings(0);
+
+	auto brightfieldSettings = m_cameraSession->getSettings(1);
+	m_dimsBrightfield[1] = (hsize_t)brightfieldSettings.roi.height_binned;
+	m_dimsBrightfield[2] = (hsize_t)brightfieldSettings.roi.width_binned;
+}
+
+void Brillouin::stopCameras() {
+	if (m_cameraSession) {
+		m_cameraSession->stop();
+		m_cameraSession.reset();
+	} else if (m_andor) {
+		m_andor->stopAcquisition();
 	}
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
 }
 
 /*
@@ -430,54 +1393,22 @@ void Brillouin::updatePositions() {
 	// Create a local copy of the settings object to prevent subscript-out-of-range error
 	// due to race-condition.
 	auto settings = m_settings;
-	auto nrPositions = settings.xSteps * settings.ySteps * settings.zSteps;
-
-	// Adjust positions vector
-	m_orderedPositions.resize(nrPositions);
-	m_orderedPositionsRelative.resize(nrPositions);
-	m_orderedIndices.resize(nrPositions);
-	// vector indicating if a new line just started and a calibration is allowed
-	m_calibrationAllowed.resize(nrPositions);
-	// Reset its values to false
-	std::fill(m_calibrationAllowed.begin(), m_calibrationAllowed.end(), false);
-
-	// construct directions vector
-	std::vector<std::vector<double>> directions(3);
-	directions[m_scanOrder.x] = simplemath::linspace(settings.xMin, settings.xMax, settings.xSteps);
-	directions[m_scanOrder.y] = simplemath::linspace(settings.yMin, settings.yMax, settings.ySteps);
-	directions[m_scanOrder.z] = simplemath::linspace(settings.zMin, settings.zMax, settings.zSteps);
-
-	gsl::index ll{ 0 };
-	std::vector<double> position(3);
-	std::vector<int> indices(3);
-	for (gsl::index ii{ 0 }; ii < directions[2].size(); ii++) {
-		for (gsl::index jj{ 0 }; jj < directions[1].size(); jj++) {
-			// Allow to calibrate if a new line starts
-			m_calibrationAllowed[ll] = true;
-			for (gsl::index kk{ 0 }; kk < directions[0].size(); kk++) {
-
-				// construct indices vector
-				indices[0] = kk;
-				indices[1] = jj;
-				indices[2] = ii;
-
-				// construct position vector
-				position[0] = directions[0][kk];
-				position[1] = directions[1][jj];
-				position[2] = directions[2][ii];
-
-				// calculate stage positions
-				m_orderedPositionsRelative[ll] = POINT3{ position[m_scanOrder.x], position[m_scanOrder.y], position[m_scanOrder.z] };
-				m_orderedPositions[ll] = m_orderedPositionsRelative[ll] + m_startPosition;
-
-				// fill index vectors
-				m_orderedIndices[ll] = INDEX3{ indices[m_scanOrder.x], indices[m_scanOrder.y], indices[m_scanOrder.z] };
-
-				ll++;
-			}
-		}
+
+	// The positions are only generated on demand, so large scans don't need to be held in memory.
+	m_positions = scanPositions(
+		POINT3{ settings.xMin, settings.yMin, settings.zMin },
+		POINT3{ settings.xMax, settings.yMax, settings.zMax },
+		INDEX3{ settings.xSteps, settings.ySteps, settings.zSteps },
+		INDEX3{ m_scanOrder.x, m_scanOrder.y, m_scanOrder.z },
+		settings.scanPath
+	);
+	if (m_positions.path() != settings.scanPath) {
+		qWarning(logWarning()) << "Too many positions for a" << scanPath::toString(settings.scanPath).c_str()
+			<< "scan path, using a" << scanPath::toString(m_positions.path()).c_str() << "scan path instead.";
 	}
-	emit(s_orderedPositionsChanged(m_orderedPositionsRelative));
+
+	// The GUI only shows a decimated preview of the positions
+	emit(s_orderedPositionsChanged(m_positions.preview(m_previewPositions)));
 }
 
 std::string Brillouin::getRepetitionFilename() {
@@ -502,11 +1433,18 @@ std::string Brillouin::getRepetitionFilename() {
 
 void Brillouin::acquire(std::unique_ptr <StorageWrapper>& storage) {
 	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+	resetPhaseTimes();
 	// prepare camera for image acquisition
 
 	if (m_andor) {
-		m_andor->startAcquisition(m_settings.camera);
-		m_settings.camera = m_andor->getSettings();
+		auto preparation = m_phaseTimer.measure("camera preparation");
+		startCameras();
+
+		// arm the configurations we switch between for the calibrations
+		m_andor->armConfiguration("measurement", m_settings.camera);
+		auto calibration = m_settings.camera;
+		calibration.exposureTime = m_settings.calibrationExposureTime;
+		m_andor->armConfiguration("calibration", calibration);
 	} else {
 		m_abort = true;
 		return;
@@ -519,74 +1457,76 @@ void Brillouin::acquire(std::unique_ptr <StorageWrapper>& storage) {
 			Qt::AutoConnection
 		);
 		// set optical elements for brightfield/Brillouin imaging
-		m_scanControl->setPreset(ScanPreset::SCAN_BRILLOUIN);
+		switchPreset(ScanPreset::SCAN_BRILLOUIN);
 	} else {
 		m_abort = true;
 		return;
 	}
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	settle(ScanPreset::SCAN_BRILLOUIN, 500);
 
-	// get current stage position
+	// get current stage position, a resumed scan continues relative to the start position of the interrupted scan
 	if (m_scanControl) {
-		m_startPosition = m_scanControl->getPosition();
+		m_startPosition = m_resuming ? m_checkpoint.startPosition : getStagePosition();
 		// Enable measurement mode (so the AOI display is correct).
-		m_scanControl->enableMeasurementMode(true);
+		onScanControl([scanControl = m_scanControl]() { scanControl->enableMeasurementMode(true); });
 	} else {
 		m_abort = true;
 		return;
 	}
 
-	auto commentIn = std::string{ "Brillouin data" };
-	storage->setComment(commentIn);
-
-	storage->setResolution("x", m_settings.xSteps);
-	storage->setResolution("y", m_settings.ySteps);
-	storage->setResolution("z", m_settings.zSteps);
-
-	auto resolutionXout = storage->getResolution("x");
-
-	writeScaleCalibration(storage, ACQUISITION_MODE::BRILLOUIN);
-
 	/*
 	 * Update the positions vector
 	 */
 	updatePositions();
 
-	/*
-	 * Construct positions vector for H5 file with row-major order: z, x, y
-	 */
-	 // construct directions vectors
-	auto directionsX{ simplemath::linspace(m_settings.xMin, m_settings.xMax, m_settings.xSteps) };
-	auto directionsY{ simplemath::linspace(m_settings.yMin, m_settings.yMax, m_settings.ySteps) };
-	auto directionsZ{ simplemath::linspace(m_settings.zMin, m_settings.zMax, m_settings.zSteps) };
+	// the steps are stored as int in the file
+	if (m_positions.size() > (std::numeric_limits<int>::max)()) {
+		qWarning(logWarning()) << "The scan has" << m_positions.size() << "positions, at most" << (std::numeric_limits<int>::max)()
+			<< "positions can be stored.";
+		m_abort = true;
+		return;
+	}
 
-	// total number of positions to measure
-	auto nrPositions = m_settings.xSteps * m_settings.ySteps * m_settings.zSteps;
-	auto positionsX = std::vector<double>(nrPositions);
-	auto positionsY = std::vector<double>(nrPositions);
-	auto positionsZ = std::vector<double>(nrPositions);
-	auto posIndex{ 0 };
-	for (gsl::index ii{ 0 }; ii < m_settings.zSteps; ii++) {
-		for (gsl::index jj{ 0 }; jj < m_settings.xSteps; jj++) {
-			for (gsl::index kk{ 0 }; kk < m_settings.ySteps; kk++) {
-				positionsX[posIndex] = directionsX[jj] + m_startPosition.x;
-				positionsY[posIndex] = directionsY[kk] + m_startPosition.y;
-				positionsZ[posIndex] = directionsZ[ii] + m_startPosition.z;
-				posIndex++;
-			}
-		}
+	// a resumed scan continues the repetition of the interrupted scan, which already contains the geometry of the scan
+	auto firstStep = gsl::index{ 0 };
+	if (m_resuming) {
+		firstStep = resumeStep(storage);
+		m_checkpoint.calibrations = (std::max)(m_checkpoint.calibrations, storage->getCalibrationCount());
+	} else {
+		writeScanGeometry(storage);
+		m_checkpoint = BRILLOUIN_CHECKPOINT{ storage->getModeHandle(ACQUISITION_MODE::BRILLOUIN)->repetitionCount, m_startPosition };
 	}
+	m_checkpointFilename = checkpointFilename(m_acquisition->getCurrentFolder() + '/' + m_acquisition->getCurrentFilename());
 
-	auto rank{ 3 };
-	auto dims = new hsize_t[rank];
-	dims[0] = m_settings.zSteps;
-	dims[1] = m_settings.xSteps;
-	dims[2] = m_settings.ySteps;
+	if (m_settings.adaptive) {
+		// the positions of an adaptive scan depend on the sample
+		m_adaptiveScan = adaptiveScan(m_positions.gridSize(), m_settings.adaptiveCoarseStride,
+			m_settings.adaptiveThreshold, (gsl::index)(m_settings.adaptiveBudget * m_positions.size()));
+	}
 
-	storage->setPositions("x", positionsX, rank, dims);
-	storage->setPositions("y", positionsY, rank, dims);
-	storage->setPositions("z", positionsZ, rank, dims);
-	delete[] dims;
+	// in spectrum storage mode we store the geometry of the line the spectra are extracted along
+	if (m_settings.storeSpectra) {
+		auto line = spectrumLine();
+		m_storageExtractor = spectrumExtractor(line, (int)m_settings.camera.roi.width_binned, (int)m_settings.camera.roi.height_binned);
+
+		auto vertices = std::vector<double>{};
+		for (const auto& point : line.points) {
+			vertices.insert(vertices.end(), { point.x, point.y });
+		}
+		auto samplePositions = std::vector<double>{};
+		for (const auto& point : m_storageExtractor.positions()) {
+			samplePositions.insert(samplePositions.end(), { point.x, point.y });
+		}
+		storage->setSpectrumLine(vertices, samplePositions, line.halfWidth);
+
+		auto frameBytes = (double)m_settings.camera.roi.bytesPerFrame;
+		auto spectrumBytes = (double)sizeof(float) * m_storageExtractor.samples();
+		qInfo(logInfo()) << "Storing spectra of" << m_storageExtractor.samples() << "samples instead of the frames, this reduces the data by a factor of"
+			<< frameBytes / spectrumBytes << ".";
+		if (m_settings.rawFrameInterval > 0) {
+			qInfo(logInfo()) << "Additionally storing the frames of one in" << m_settings.rawFrameInterval << "positions.";
+		}
+	}
 
 	// do actual measurement
 	QMetaObject::invokeMethod(
@@ -601,13 +1541,29 @@ void Brillouin::acquire(std::unique_ptr <StorageWrapper>& storage) {
 		(hsize_t)m_settings.camera.roi.height_binned,
 		(hsize_t)m_settings.camera.roi.width_binned
 	};
+	// in accumulation mode only a single summed up frame is stored per position
+	hsize_t dims_accumulated[3] = {
+		1,
+		(hsize_t)m_settings.camera.roi.height_binned,
+		(hsize_t)m_settings.camera.roi.width_binned
+	};
+	// in spectrum storage mode a spectrum is stored per frame
+	auto rank_spectra{ 2 };
+	hsize_t dims_spectra[2] = {
+		(hsize_t)(m_settings.accumulateFrames ? 1 : m_settings.camera.frameCount),
+		(hsize_t)m_storageExtractor.samples()
+	};
 
-	// reset number of calibrations
-	nrCalibrations = 1;
-	// do pre calibration
-	if (m_settings.preCalibration) {
+	startSpectrumAnalysis();
+
+	// reset number of calibrations, a resumed scan continues after the calibrations already stored
+	nrCalibrations = m_checkpoint.calibrations + 1;
+	m_calibration = VIPA_CALIBRATION{};
+	// do pre calibration, a resumed scan is calibrated again since the spectrometer might have drifted in the meantime
+	if (m_settings.preCalibration || (m_resuming && m_settings.conCalibration)) {
 		calibrate(storage);
 	}
+	writeCheckpoint(firstStep);
 
 	auto measurementTimer = QElapsedTimer{};
 	measurementTimer.start();
@@ -615,158 +1571,146 @@ void Brillouin::acquire(std::unique_ptr <StorageWrapper>& storage) {
 	auto calibrationTimer = QElapsedTimer{};
 	calibrationTimer.start();
 
-	// move stage to first position, wait 50 ms for it to finish
-	if (m_scanControl) {
-		m_scanControl->setPosition(m_orderedPositions[0]);
-	} else {
+	// move stage to first position and wait for it to arrive
+	auto position = SCAN_POSITION{};
+	if (!nextPosition(firstStep, position)) {
 		m_abort = true;
 		return;
 	}
-	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	if (!m_scanControl) {
+		m_abort = true;
+		return;
+	}
+	auto firstMove = m_phaseTimer.measure("stage move");
+	if (!moveStage(position.position + m_startPosition, m_moveTimeout)) {
+		m_abort = true;
+		return;
+	}
+	firstMove.stop();
+	// the spectra are evaluated with the pre calibration from the first position on
+	applyCalibrationFit(storage);
 
-	for (gsl::index ll{ 0 }; ll < nrPositions; ll++) {
+	// an adaptive scan measures at most as many positions as its budget allows
+	auto plannedPositions = m_settings.adaptive ? m_adaptiveScan.budget() : m_positions.size();
 
+	/*
+	 * The positions are acquired in a pipeline: As soon as the frames of a position are captured,
+	 * they are handed over to the storage and analysed on a worker thread while the stage moves to the next position.
+	 * The stage is moved from the thread of the scan control, since the devices must not be accessed from other threads.
+	 * The frames of the next position are only captured after the stage arrived there and the hand-off finished,
+	 * because they reuse the buffers.
+	 */
+	auto ll = firstStep;
+	while (true) {
 		// do live calibration if required and possible at the moment
-		if (m_settings.conCalibration && m_calibrationAllowed[ll]) {
+		if (m_settings.conCalibration && position.calibrationAllowed) {
 			if (calibrationTimer.elapsed() > (60e3 * m_settings.conCalibrationInterval)) {
 				calibrate(storage);
 				calibrationTimer.start();
 				// After we calibrated, we move back to the current position
-				if (m_scanControl) {
-					m_scanControl->setPosition(m_orderedPositions[ll]);
-				} else {
+				auto stageMove = m_phaseTimer.measure("stage move");
+				if (!m_scanControl || !moveStage(position.position + m_startPosition, m_moveTimeout)) {
 					m_abort = true;
 					return;
 				}
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				stageMove.stop();
+				applyCalibrationFit(storage);
 			}
 		}
 
 		auto nextCalibration = int{ (int)(100 * (1e-3 * calibrationTimer.elapsed()) / (60 * m_settings.conCalibrationInterval)) };
 		emit(s_timeToCalibration(nextCalibration));
 
-		std::vector<std::byte> images(m_settings.camera.roi.bytesPerFrame * m_settings.camera.frameCount);
+		auto captured = m_settings.accumulateFrames ? captureAccumulated(storage, position) : captureFrames(storage, position);
+		if (!captured) {
+			return;
+		}
 
-		for (gsl::index mm{ 0 }; mm < m_settings.camera.frameCount; mm++) {
-			if (m_abort) {
-				m_abort = true;
-				return;
+		// the next position of an adaptive scan depends on the spectrum just acquired
+		if (m_settings.adaptive) {
+			m_adaptiveScan.setValue(spectralFeature());
+		}
+
+		// hand the frames over to the storage and analyse them while the stage moves
+		// in spectrum storage mode the frames are only kept at the requested interval for quality control
+		auto storeFrames = !m_settings.storeSpectra || (m_settings.rawFrameInterval > 0 && ll % m_settings.rawFrameInterval == 0);
+		auto handOff = std::async(std::launch::async, [&, index = position.index, storeFrames]() {
+			auto handingOff = m_phaseTimer.measure("hand-off");
+			if (m_settings.storeSpectra) {
+				handOffSpectra(storage, index, rank_spectra, dims_spectra);
+			}
+			if (storeFrames && m_settings.accumulateFrames) {
+				handOffAccumulated(storage, index, rank_data, dims_accumulated);
+			} else if (storeFrames) {
+				handOffFrames(storage, index, rank_data, dims_data);
 			}
-			emit(s_positionChanged(m_orderedPositions[ll] - m_startPosition, mm + 1));
-			// acquire images
-			auto pointerPos = (int64_t)m_settings.camera.roi.bytesPerFrame * mm;
+			handingOff.stop();
+			auto analysis = m_phaseTimer.measure("spectrum analysis");
+			analyseSpectrum(index);
+		});
 
-			if (m_andor) {
-				m_andor->getImageForAcquisition(&images[pointerPos]);
-			} else {
+		// move stage to next position
+		auto next = SCAN_POSITION{};
+		auto hasNext = nextPosition(ll + 1, next);
+		if (hasNext) {
+			auto stageMove = m_phaseTimer.measure("stage move");
+			if (!m_scanControl || !moveStage(next.position + m_startPosition, m_moveTimeout)) {
+				qWarning(logWarning()) << "The scan is aborted, since the stage does not move.";
+				handOff.get();
 				m_abort = true;
 				return;
 			}
 		}
+		ll++;
 
+		auto percentage{ 100 * (double)ll / plannedPositions };
+		auto remaining{ (int)(1e-3 * measurementTimer.elapsed() / (ll - firstStep) * ((int64_t)plannedPositions - ll)) };
+		emit(s_repetitionProgress(percentage, remaining));
 
-		// asynchronously write image to disk
-		// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
-		auto date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
-			.toString(Qt::ISODateWithMs).toStdString();
-
-		if (m_settings.camera.readout.dataType == "unsigned short") {
-			// cast the image to unsigned short
-			auto images_ = (std::vector<unsigned short> *) & images;
-			auto img = new IMAGE<unsigned short>(
-				m_orderedIndices[ll].x,
-				m_orderedIndices[ll].y,
-				m_orderedIndices[ll].z,
-				rank_data,
-				dims_data,
-				date,
-				*images_,
-				m_settings.camera.exposureTime,
-				m_settings.camera.gain,
-				m_settings.camera.roi
-			);
+		// wait for the hand-off to release the buffers, the time the pipeline stalls is recorded separately
+		auto handOffWait = m_phaseTimer.measure("hand-off wait");
+		handOff.get();
+		handOffWait.stop();
 
-			QMetaObject::invokeMethod(
-				storage.get(),
-				[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
-				Qt::AutoConnection
-			);
-		} else if (m_settings.camera.readout.dataType == "unsigned char") {
-			// cast the image to unsigned char
-			auto images_ = (std::vector<unsigned char> *) & images;
-			auto img = new IMAGE<unsigned char>(
-				m_orderedIndices[ll].x,
-				m_orderedIndices[ll].y,
-				m_orderedIndices[ll].z,
-				rank_data,
-				dims_data,
-				date,
-				*images_,
-				m_settings.camera.exposureTime,
-				m_settings.camera.gain,
-				m_settings.camera.roi
-			);
-
-			QMetaObject::invokeMethod(
-				storage.get(),
-				[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
-				Qt::AutoConnection
-			);
-		} else if (m_settings.camera.readout.dataType == "unsigned int") {
-			// cast the image to unsigned char
-			auto images_ = (std::vector<unsigned int> *) & images;
-			auto img = new IMAGE<unsigned int>(
-				m_orderedIndices[ll].x,
-				m_orderedIndices[ll].y,
-				m_orderedIndices[ll].z,
-				rank_data,
-				dims_data,
-				date,
-				*images_,
-				m_settings.camera.exposureTime,
-				m_settings.camera.gain,
-				m_settings.camera.roi
-			);
-
-			QMetaObject::invokeMethod(
-				storage.get(),
-				[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
-				Qt::AutoConnection
-			);
+		// record the progress, so that the scan can be resumed if it is interrupted
+		if (m_checkpointTimer.elapsed() > m_checkpointInterval) {
+			writeCheckpoint(ll);
 		}
-
-		// move stage to next position
-		if (ll < ((gsl::index)nrPositions - 1)) {
-			if (m_scanControl) {
-				m_scanControl->setPosition(m_orderedPositions[ll + 1]);
-			} else {
-				m_abort = true;
-				return;
-			}
+		if (!hasNext) {
+			break;
 		}
+		position = next;
+	}
 
-		auto percentage{ 100 * (double)(ll + 1) / nrPositions };
-		auto remaining{ (int)(1e-3 * measurementTimer.elapsed() / (ll + 1) * ((int64_t)nrPositions - ll + 1)) };
-		emit(s_repetitionProgress(percentage, remaining));
+	auto measurementDuration = 1e-3 * measurementTimer.elapsed();
+	if (measurementDuration > 0) {
+		qInfo(logInfo()) << "Acquired" << ll - firstStep << "positions in" << measurementDuration << "s ("
+			<< (ll - firstStep) / measurementDuration << "points/s).";
+	}
+	stopSpectrumAnalysis();
+	if (m_settings.adaptive) {
+		qInfo(logInfo()) << "The adaptive scan measured" << ll << "of" << m_positions.size() << "positions.";
+		writeAdaptiveScan(storage);
 	}
 	// do post calibration
 	if (m_settings.postCalibration) {
 		calibrate(storage);
+		applyCalibrationFit(storage);
 	}
 
 	// close camera libraries, clear buffers
 	if (m_andor) {
-		m_andor->stopAcquisition();
+		stopCameras();
 	} else {
 		m_abort = true;
 		return;
 	}
 
 	if (m_scanControl) {
-		m_scanControl->setPreset(ScanPreset::SCAN_LASEROFF);
+		switchPreset(ScanPreset::SCAN_LASEROFF);
 
-		m_scanControl->setPosition(m_startPosition);
-		m_scanControl->enableMeasurementMode(false);
+		moveStage(m_startPosition);
+		onScanControl([scanControl = m_scanControl]() { scanControl->enableMeasurementMode(false); });
 		emit(s_positionChanged({ 0, 0, 0 }, 0));
 		QMetaObject::invokeMethod(
 			m_scanControl,
@@ -791,7 +1735,12 @@ void Brillouin::acquire(std::unique_ptr <StorageWrapper>& storage) {
 		[&storage = storage]() { storage.get()->s_finishedQueueing(); },
 		Qt::AutoConnection
 	);
+	auto flush = m_phaseTimer.measure("storage flush");
 	loop.exec();
+	flush.stop();
+
+	writePhaseTimes(storage, ACQUISITION_MODE::BRILLOUIN);
+	removeCheckpoint();
 
 	auto info = std::string{ "Acquisition finished." };
 	qInfo(logInfo()) << info.c_str();
@@ -3,9 +3,15 @@
 
 #include "AcquisitionMode.h"
 #include "../../Devices/Cameras/Camera.h"
+#include "../../Devices/Cameras/CameraSession.h"
 #include "../../helper/thread.h"
+#include "../SpectrumAnalysis.h"
 #include "src/lib/buffer_circular.h"
+#include "src/lib/math/accumulator.h"
+#include "src/lib/math/adaptiveScan.h"
+#include "src/lib/math/scanPositions.h"
 
+#include <future>
 
 struct SCAN_ORDER {
 	bool automatical{ true };
@@ -59,6 +65,20 @@ struct BRILLOUIN_SETTINGS {
 			conCalibrationInterval = settings.conCalibrationInterval;
 			nrCalibrationImages = settings.nrCalibrationImages;
 			calibrationExposureTime = settings.calibrationExposureTime;
+			calibrationShift = settings.calibrationShift;
+			freeSpectralRange = settings.freeSpectralRange;
+			accumulateFrames = settings.accumulateFrames;
+			storeVariance = settings.storeVariance;
+			trackBrightfield = settings.trackBrightfield;
+			scanPath = settings.scanPath;
+			adaptive = settings.adaptive;
+			adaptiveThreshold = settings.adaptiveThreshold;
+			adaptiveBudget = settings.adaptiveBudget;
+			adaptiveCoarseStride = settings.adaptiveCoarseStride;
+			analyseSpectra = settings.analyseSpectra;
+			spectrumLine = settings.spectrumLine;
+			storeSpectra = settings.storeSpectra;
+			rawFrameInterval = settings.rawFrameInterval;
 			repetitions = settings.repetitions;
 			camera = settings.camera;
 			return *this;
@@ -71,6 +91,32 @@ struct BRILLOUIN_SETTINGS {
 		double conCalibrationInterval{ 10 };		// interval of continuous calibrations
 		int nrCalibrationImages{ 10 };				// number of calibration images
 		double calibrationExposureTime{ 1 };		// exposure time for calibration images
+		double calibrationShift{ 5.088 };			// [GHz]	Brillouin shift of the calibration sample
+		double freeSpectralRange{ 15 };				// [GHz]	free spectral range of the VIPA
+
+		// frame accumulation parameters
+		bool accumulateFrames{ false };				// store only the sum of the frames of a position
+		bool storeVariance{ false };				// additionally store the per-pixel variance of the accumulated frames
+
+		// brightfield tracking parameters
+		bool trackBrightfield{ false };				// acquire an aligned brightfield image for every position
+
+		// scan path parameters
+		SCAN_PATH scanPath{ SCAN_PATH::RASTER };	// order in which the positions are visited
+
+		// adaptive scan parameters
+		bool adaptive{ false };						// refine the scan only where the spectra change
+		double adaptiveThreshold{ 1 };				// [pix]	minimum change of the spectral centroid to refine a region
+		double adaptiveBudget{ 0.25 };				// [1]	maximum fraction of the positions to measure
+		int adaptiveCoarseStride{ 4 };				// [1]	distance of the positions of the coarse grid
+
+		// spectrum analysis parameters
+		bool analyseSpectra{ false };				// fit the spectra while they are acquired
+		SPECTRUM_LINE spectrumLine;					// polyline through the spectrum, without vertices the center row is used
+
+		// spectrum storage parameters
+		bool storeSpectra{ false };					// store only the spectra extracted along the spectrum line
+		int rawFrameInterval{ 0 };					// [1]	additionally store the frames of every n-th position, 0 never
 
 		// repetition parameters
 		REPETITIONS repetitions;
@@ -143,17 +189,26 @@ struct BRILLOUIN_SETTINGS {
 		CAMERA_SETTINGS camera;
 };
 
+struct BRILLOUIN_CHECKPOINT {
+	int repetition{ -1 };				// [1]	index of the interrupted repetition in the file
+	POINT3 startPosition{ 0, 0, 0 };	// [µm]	absolute stage position the scan positions are relative to
+	gsl::index step{ 0 };				// [1]	number of positions handed over to the storage
+	int calibrations{ 0 };				// [1]	number of calibrations acquired
+};
+
 class Brillouin : public AcquisitionMode {
 	Q_OBJECT
 
 public:
-	Brillouin(QObject* parent, Acquisition* acquisition, Camera*& andor, ScanControl*& scanControl);
+	Brillouin(QObject* parent, Acquisition* acquisition, Camera*& andor, ScanControl*& scanControl, Camera*& brightfieldCamera);
 	~Brillouin();
 
 	BRILLOUIN_SETTINGS& settings{ m_settings };
 
 public slots:
 	void startRepetitions() override;
+	void acquireSingleRepetition();
+	void resumeRepetition(const std::string& filename);
 
 	void waitForNextRepetition();
 	void finaliseRepetitions();
@@ -182,6 +237,8 @@ public slots:
 
 	void setScanOrderAuto(bool automatical);
 
+	void setScanPath(SCAN_PATH path);
+
 	void determineScanOrder();
 
 	std::vector<POINT3> getOrderedPositions();
@@ -190,12 +247,43 @@ private:
 	void abortMode(std::unique_ptr <StorageWrapper>& storage) override;
 
 	void calibrate(std::unique_ptr <StorageWrapper>& storage);
+	void startCalibrationFit(std::vector<std::byte> images);
+	void applyCalibrationFit(std::unique_ptr <StorageWrapper>& storage);
+
+	bool nextPosition(gsl::index ll, SCAN_POSITION& position);
+	bool captureFrames(std::unique_ptr <StorageWrapper>& storage, const SCAN_POSITION& position);
+	void handOffFrames(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims);
+	bool captureAccumulated(std::unique_ptr <StorageWrapper>& storage, const SCAN_POSITION& position);
+	void handOffAccumulated(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims);
+	void accumulateFrame(const std::vector<std::byte>& frame);
+	void acquireFrame(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, gsl::index mm, std::byte* buffer);
+	double spectralFeature();
+	void writeAdaptiveScan(std::unique_ptr <StorageWrapper>& storage);
+	void startSpectrumAnalysis();
+	void analyseSpectrum(const INDEX3& index);
+	void stopSpectrumAnalysis();
+	void forwardSpectrumResults(bool force = false);
+	SPECTRUM_LINE spectrumLine();
+	void handOffSpectra(std::unique_ptr <StorageWrapper>& storage, const INDEX3& index, int rank, hsize_t* dims);
+	void writeScanGeometry(std::unique_ptr <StorageWrapper>& storage);
+
+	gsl::index resumeStep(std::unique_ptr <StorageWrapper>& storage);
+	void writeCheckpoint(gsl::index step);
+	bool readCheckpoint(const std::string& filename, BRILLOUIN_CHECKPOINT& checkpoint);
+	void removeCheckpoint();
+	static std::string checkpointFilename(const std::string& filename);
+
+	void startCameras();
+	void stopCameras();
 
 	std::string getRepetitionFilename();
 
 	BRILLOUIN_SETTINGS m_settings;
 	SCAN_ORDER m_scanOrder;
 	Camera*& m_andor;
+	Camera*& m_brightfieldCamera;
+	std::unique_ptr<CameraSession> m_cameraSession;	// synchronises the Brillouin and the brightfield camera
+	hsize_t m_dimsBrightfield[3]{ 1, 0, 0 };		// dimensions of the stored brightfield images
 	bool m_running{ false };				// is acquisition currently running
 	POINT3 m_startPosition{ 0, 0, 0 };
 
@@ -204,13 +292,30 @@ private:
 	int m_currentRepetition{ 0 };
 
 	int nrCalibrations{ 1 };
+	std::future<VIPA_CALIBRATION> m_calibrationFit;	// Fits the frequency axis of the last calibration
+	int m_calibrationFitIndex{ 0 };					// Index of the calibration which is fitted
+	VIPA_CALIBRATION m_calibration;					// Last valid calibration
 
 	std::string m_baseFilename{ "" };
 
-	std::vector<POINT3> m_orderedPositions;	// The positions to measure in absolute values
-	std::vector<POINT3> m_orderedPositionsRelative;	// The positions to measure relative to start position
-	std::vector<INDEX3> m_orderedIndices;	// The associated indices
-	std::vector<bool> m_calibrationAllowed;	// If a calibration is allowed for this position
+	scanPositions m_positions;				// The positions to measure relative to start position, generated on demand
+	gsl::index m_geometryBlockSize{ 1000000 };	// Maximum number of positions written to the file at once
+	gsl::index m_previewPositions{ 10000 };	// Maximum number of positions shown in the GUI
+	adaptiveScan m_adaptiveScan;			// Plans the positions of an adaptive scan
+
+	bool m_resuming{ false };				// Continue the interrupted scan of m_checkpoint
+	BRILLOUIN_CHECKPOINT m_checkpoint;		// Progress of the interrupted scan
+	std::string m_checkpointFilename;		// File the progress of the running scan is written to
+	QElapsedTimer m_checkpointTimer;
+	int m_checkpointInterval{ 10000 };		// [ms]	Minimum interval between two checkpoints
+
+	std::vector<std::byte> m_frames;			// The frames of the current position
+	accumulator<unsigned int> m_accumulator;	// Sums up the frames of a position in accumulation mode
+	std::unique_ptr<SpectrumAnalysis> m_spectrumAnalysis;	// Fits the spectra while the scan is running
+	std::vector<SPECTRUM_RESULT> m_spectrumResults;			// Results not forwarded to the GUI yet
+	QElapsedTimer m_spectrumResultsTimer;
+	int m_spectrumResultsInterval{ 100 };					// [ms]	Minimum interval between two forwarded batches of results
+	spectrumExtractor m_storageExtractor;					// Extracts the spectra to store in spectrum storage mode
 
 private slots:
 	void acquire(std::unique_ptr <StorageWrapper>& storage) override;
@@ -224,6 +329,7 @@ signals:
 	void s_calibrationRunning(bool);	// is calibration running
 	void s_scanOrderChanged(SCAN_ORDER);
 	void s_orderedPositionsChanged(std::vector<POINT3>);
+	void s_spectraAnalysed(std::vector<SPECTRUM_RESULT>);	// results of the positions analysed since the last emit
 };
 
 #endif //BRILLOUIN_H
\ No newline at end of file
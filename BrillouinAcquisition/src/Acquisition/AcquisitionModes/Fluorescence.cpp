@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Fluorescence.h"
+#include "src/helper/logger.h"
 
 /*
  * Public definitions
@@ -54,8 +55,11 @@ void Fluorescence::startRepetitions(std::vector<FLUORESCENCE_MODE> modes) {
 
 	// reset abort flag
 	m_abort = false;
+	resetPhaseTimes();
 
+	auto preparation = m_phaseTimer.measure("camera preparation");
 	configureCamera();
+	preparation.stop();
 
 	m_acquisition->newRepetition(ACQUISITION_MODE::FLUORESCENCE);
 
@@ -114,6 +118,14 @@ void Fluorescence::setGain(FLUORESCENCE_MODE mode, int gain) {
 	emit(s_acqSettingsChanged(m_settings));
 }
 
+void Fluorescence::setStack(const FLUORESCENCE_STACK& stack) {
+	m_settings.stack = stack;
+	m_settings.stack.planes = std::max(stack.planes, 1);
+	m_settings.stack.tiles_x = std::max(stack.tiles_x, 1);
+	m_settings.stack.tiles_y = std::max(stack.tiles_y, 1);
+	emit(s_acqSettingsChanged(m_settings));
+}
+
 void Fluorescence::startStopPreview(FLUORESCENCE_MODE mode) {
 	if (mode == m_currentPreviewChannel || mode == FLUORESCENCE_MODE::NONE) {
 		// stop preview
@@ -253,6 +265,105 @@ void Fluorescence::configureCamera() {
 	m_settings.camera.frameCount = 1;
 }
 
+/*
+ * Applies the exposure time and gain of the channel. The camera is started for the first channel and stays armed
+ * afterwards, so that only the changed settings have to be applied.
+ */
+void Fluorescence::configureChannel(const ChannelSettings* channel, bool first) {
+	/*
+	 * We have to check if the exposure time or gain settings will change.
+	 * If they will, then we have to trash the first image after the change,
+	 * as the settings might not be applied already (valid for trigger mode).
+	 * Might be worse for free running mode.
+	 * See https://www.ptgrey.com/KB/10086
+	 */
+	auto changed{ false };
+	if (((int)(1e3 * m_settings.camera.exposureTime) != channel->exposure) || (m_settings.camera.gain != channel->gain)) {
+		changed = true;
+	}
+
+	m_settings.camera.exposureTime = 1e-3 * channel->exposure;
+	m_settings.camera.gain = channel->gain;
+
+	if (first) {
+		// start image acquisition, the camera is only started once while the filters of the first channel move
+		auto cameraStart = m_phaseTimer.measure("camera start");
+		m_settings.camera.frameCount = 1;
+		if (m_camera) {
+			m_camera->startAcquisition(m_settings.camera);
+		}
+	} else if (changed && m_camera) {
+		// exposure time and gain can be changed while the camera is armed
+		auto cameraSettings = m_phaseTimer.measure("camera settings");
+		m_camera->setSettings(m_settings.camera);
+	}
+
+	// Settings might change after acquisition start (e.g. binning size and bytes per frame)
+	if (m_camera) {
+		m_settings.camera = m_camera->getSettings();
+	}
+
+	// the discarded frames are taken while the filters are still moving
+	if (changed && m_camera) {
+		auto discard = m_phaseTimer.measure("discarded frames");
+		m_camera->getImageForAcquisition(nullptr, false);
+		m_camera->getImageForAcquisition(nullptr, false);
+	}
+}
+
+/*
+ * Returns the positions of a stack in the order they are visited. The tiles are visited in a serpentine
+ * and the direction of the z-scan alternates from tile to tile, so that the stage never travels back.
+ */
+std::vector<STACK_POSITION> Fluorescence::getStackPositions() {
+	auto& stack = m_settings.stack;
+	auto positions = std::vector<STACK_POSITION>{};
+	positions.reserve((size_t)stack.planes * stack.tiles_x * stack.tiles_y);
+	for (gsl::index j{ 0 }; j < stack.tiles_y; j++) {
+		for (gsl::index ii{ 0 }; ii < stack.tiles_x; ii++) {
+			auto i = (j % 2) ? stack.tiles_x - 1 - ii : ii;
+			auto reverse = (positions.size() / stack.planes) % 2;
+			for (gsl::index kk{ 0 }; kk < stack.planes; kk++) {
+				auto k = reverse ? stack.planes - 1 - kk : kk;
+				auto position = STACK_POSITION{};
+				position.plane = (int)k;
+				position.tile = (int)(i + stack.tiles_x * j);
+				position.offset = POINT3{
+					(i - 0.5 * (stack.tiles_x - 1)) * stack.tileDistance,
+					(j - 0.5 * (stack.tiles_y - 1)) * stack.tileDistance,
+					(k - 0.5 * (stack.planes - 1)) * stack.planeDistance
+				};
+				positions.push_back(position);
+			}
+		}
+	}
+	return positions;
+}
+
+template <typename T>
+void Fluorescence::captureFrame(std::vector<std::byte>& images) {
+	if (!m_camera) {
+		return;
+	}
+	m_camera->getImageForAcquisition(&images[0], true);
+
+	// cast the vector to type T
+	auto images_ = (std::vector<T> *) & images;
+
+	// Sometimes the uEye camera returns a black image (only zeros), we try to catch this here by
+	// repeating the acquisition a maximum of 5 times
+	unsigned char sum = simplemath::sum(*images_);
+	int i{ 0 };
+	while (sum == 0 && 5 > i++) {
+		m_camera->getImageForAcquisition(&images[0], true);
+
+		// cast the vector type T
+		images_ = (std::vector<T> *) & images;
+
+		sum = simplemath::sum(*images_);
+	}
+}
+
 template <typename T>
 void Fluorescence::__acquire(std::unique_ptr <StorageWrapper>& storage, std::vector<ChannelSettings*> channels) {
 	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
@@ -268,6 +379,10 @@ void Fluorescence::__acquire(std::unique_ptr <StorageWrapper>& storage, std::vec
 
 	writeScaleCalibration(storage, ACQUISITION_MODE::FLUORESCENCE);
 
+	if (m_camera) {
+		m_camera->resetReconfigurations();
+	}
+
 	QMetaObject::invokeMethod(
 		storage.get(),
 		[&storage = storage]() { storage.get()->startWritingQueues(); },
@@ -277,89 +392,57 @@ void Fluorescence::__acquire(std::unique_ptr <StorageWrapper>& storage, std::vec
 	QElapsedTimer measurementTimer;
 	measurementTimer.start();
 
+	/*
+	 * The camera stays armed for all channels, only the exposure time and gain are changed in between.
+	 * The filters are switched on the thread of the scan control, since the devices must not be accessed
+	 * from other threads. The filters of the next channel move while the frame of the current channel is handed
+	 * over to the storage and the camera is configured, the switch is only waited for right before the capture.
+	 */
 	int rank_data{ 3 };
+	hsize_t dims_data[3] = { 1, 0, 0 };
+	auto presetSwitch = std::future<bool>{};
+	if (m_scanControl) {
+		presetSwitch = startPresetSwitch(channels[0]->preset);
+	}
 	// Loop through the different modes
 	int imageNumber{ 0 };
-	for (auto const& channel : channels) {
+	for (gsl::index c{ 0 }; c < (gsl::index)channels.size(); c++) {
+		auto channel = channels[c];
 		// Abort if requested
 		if (m_abort) {
-			this->abortMode(storage);
-			return;
-		}
-
-		// move to Fluorescence configuration
-		if (m_scanControl) {
-			m_scanControl->setPreset(channel->preset);
-		}
-
-		/*
-		 * We have to check if the exposure time or gain settings will change.
-		 * If they will, then we have to trash the first image after the change,
-		 * as the settings might not be applied already (valid for trigger mode).
-		 * Might be worse for free running mode.
-		 * See https://www.ptgrey.com/KB/10086
-		 */
-		auto changed{ false };
-		if (((int)(1e3 * m_settings.camera.exposureTime) != channel->exposure) || (m_settings.camera.gain != channel->gain)) {
-			changed = true;
-		}
-
-		m_settings.camera.exposureTime = 1e-3 * channel->exposure;
-		m_settings.camera.gain = channel->gain;
-
-		if (changed) {
-			m_settings.camera.frameCount = 2;
-			if (m_camera) {
-				m_camera->startAcquisition(m_settings.camera);
-				// Settings might change after acquisition start (e.g. binning size and bytes per frame)
-				m_settings.camera = m_camera->getSettings();
-				m_camera->getImageForAcquisition(nullptr, false);
-				m_camera->getImageForAcquisition(nullptr, false);
+			finishPresetSwitch(presetSwitch);
+			if (m_camera && imageNumber > 0) {
 				m_camera->stopAcquisition();
 			}
+			this->abortMode(storage);
+			return;
 		}
 
-		// start image acquisition
-		m_settings.camera.frameCount = 1;
-		if (m_camera) {
-			m_camera->startAcquisition(m_settings.camera);
-		}
+		configureChannel(channel, imageNumber == 0);
+		dims_data[1] = (hsize_t)m_settings.camera.roi.height_binned;
+		dims_data[2] = (hsize_t)m_settings.camera.roi.width_binned;
 
-		// Settings might change after acquisition start (e.g. binning size and bytes per frame)
-		if (m_camera) {
-			m_settings.camera = m_camera->getSettings();
-		}
-		hsize_t dims_data[3] = { 1, (hsize_t)m_settings.camera.roi.height_binned, (hsize_t)m_settings.camera.roi.width_binned };
+		finishPresetSwitch(presetSwitch);
 
 		// read images from camera
 		std::vector<std::byte> images(m_settings.camera.roi.bytesPerFrame);
 
 		// acquire images
-		if (m_camera) {
-			m_camera->getImageForAcquisition(&images[0], true);
+		auto frame = m_phaseTimer.measure("frame");
+		captureFrame<T>(images);
+		frame.stop();
+
+		if (m_scanControl && c + 1 < (gsl::index)channels.size()) {
+			presetSwitch = startPresetSwitch(channels[c + 1]->preset);
 		}
 
-		// cast the vector to unsigned short
+		// cast the vector to type T
 		auto images_ = (std::vector<T> *) & images;
 
-		// Sometimes the uEye camera returns a black image (only zeros), we try to catch this here by
-		// repeating the acquisition a maximum of 5 times
-		unsigned char sum = simplemath::sum(*images_);
-		int i{ 0 };
-		while (sum == 0 && 5 > i++) {
-			if (m_camera) {
-				m_camera->getImageForAcquisition(&images[0], true);
-			}
-
-			// cast the vector type T
-			images_ = (std::vector<T> *) & images;
-
-			sum = simplemath::sum(*images_);
-		}
-
 		// store images
 		// asynchronously write image to disk
 		// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+		auto handOff = m_phaseTimer.measure("hand-off");
 		std::string date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
 			.toString(Qt::ISODateWithMs).toStdString();
 		auto img = new FLUOIMAGE<T>(
@@ -379,17 +462,23 @@ void Fluorescence::__acquire(std::unique_ptr <StorageWrapper>& storage, std::vec
 			[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
 			Qt::AutoConnection
 		);
+		handOff.stop();
 
-		// configure camera for preview
-		if (m_camera) {
-			m_camera->stopAcquisition();
-		}
 		imageNumber++;
 		double percentage = 100 * (double)imageNumber / channels.size();
 		int remaining = 1e-3 * measurementTimer.elapsed() / imageNumber * ((int64_t)channels.size() - imageNumber);
 		emit(s_repetitionProgress(percentage, remaining));
 	}
 
+	// configure camera for preview
+	if (m_camera) {
+		m_camera->stopAcquisition();
+	}
+
+	auto measurementDuration = measurementTimer.elapsed();
+	qInfo(logInfo()) << "Acquired" << imageNumber << "channels in" << 1e-3 * measurementDuration << "s ("
+		<< measurementDuration / imageNumber << "ms per channel).";
+
 	// Here we wait until the storage object indicate it finished to write to the file.
 	QEventLoop loop;
 	auto connection = QWidget::connect(
@@ -403,7 +492,194 @@ void Fluorescence::__acquire(std::unique_ptr <StorageWrapper>& storage, std::vec
 		[&storage = storage]() { storage.get()->s_finishedQueueing(); },
 		Qt::AutoConnection
 	);
+	auto flush = m_phaseTimer.measure("storage flush");
 	loop.exec();
+	flush.stop();
+
+	writePhaseTimes(storage, ACQUISITION_MODE::FLUORESCENCE);
+
+	if (m_camera) {
+		auto reconfigurations = m_camera->getReconfigurations();
+		qInfo(logInfo()) << "Camera reconfigurations: full" << reconfigurations.full
+			<< ", partial" << reconfigurations.partial << ", skipped" << reconfigurations.skipped;
+	}
+
+	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
+}
+
+/*
+ * Acquires every enabled channel at every plane of every tile and stores them as one [channel, plane, tile, height, width] stack.
+ *
+ * Changing the filters takes much longer than moving the stage by a plane or a tile, so the channel loop is the outermost
+ * one and the filters only change once per channel. Every other channel visits the positions in reverse order, so that
+ * the filters change in place without moving the stage. The stage only moves to the next position once the frame
+ * is handed over to the storage and never while the filters change, since both share the connection to the microscope.
+ */
+template <typename T>
+void Fluorescence::__acquireStack(std::unique_ptr <StorageWrapper>& storage, std::vector<ChannelSettings*> channels) {
+	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+
+	// If the provided channel settings vector is empty, acquire the enabled channels.
+	if (!channels.size()) {
+		channels = getEnabledChannels();
+		// If no channels are enabled, return.
+		if (!channels.size()) {
+			return;
+		}
+	}
+
+	// Planes and tiles can only be acquired when the position can be set
+	if (!m_scanControl) {
+		qWarning(logWarning()) << "Fluorescence stacks require a scan control, the acquisition was aborted.";
+		setAcquisitionStatus(ACQUISITION_STATUS::ABORTED);
+		return;
+	}
+
+	writeScaleCalibration(storage, ACQUISITION_MODE::FLUORESCENCE);
+
+	if (m_camera) {
+		m_camera->resetReconfigurations();
+	}
+
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage]() { storage.get()->startWritingQueues(); },
+		Qt::AutoConnection
+	);
+
+	auto startPosition = getStagePosition();
+	auto positions = getStackPositions();
+	auto positionCount = (int)positions.size();
+	auto frameCount = (int)channels.size() * positionCount;
+
+	// the layout is shared by all frames, its frame size is known once the camera is started
+	auto layout = std::make_shared<FLUOSTACK_LAYOUT>();
+	for (const auto& channel : channels) {
+		layout->channels.push_back(channel->name);
+		layout->exposures.push_back(1e-3 * channel->exposure);
+		layout->gains.push_back(channel->gain);
+	}
+	layout->planes.resize(m_settings.stack.planes);
+	layout->tiles.resize((size_t)m_settings.stack.tiles_x * m_settings.stack.tiles_y);
+	for (const auto& position : positions) {
+		layout->planes[position.plane] = position.offset.z;
+		layout->tiles[position.tile] = POINT2{ position.offset.x, position.offset.y };
+	}
+
+	QElapsedTimer measurementTimer;
+	measurementTimer.start();
+
+	/*
+	 * The filters and the stage are moved one after the other from the thread of the scan control,
+	 * since they share the connection to the microscope and must not be accessed from other threads.
+	 */
+	auto imageNumber{ 0 };
+	for (gsl::index c{ 0 }; c < (gsl::index)channels.size(); c++) {
+		auto channel = channels[c];
+		// the camera is configured while the filters move, the stage stays in place until they arrived
+		auto presetSwitch = startPresetSwitch(channel->preset);
+		configureChannel(channel, c == 0);
+		finishPresetSwitch(presetSwitch);
+		if (c == 0) {
+			layout->height = (hsize_t)m_settings.camera.roi.height_binned;
+			layout->width = (hsize_t)m_settings.camera.roi.width_binned;
+		}
+
+		for (gsl::index kk{ 0 }; kk < positionCount; kk++) {
+			auto k = (c % 2) ? positionCount - 1 - kk : kk;
+			const auto& position = positions[k];
+
+			if (!m_abort) {
+				auto stageMove = m_phaseTimer.measure("stage move");
+				if (!moveStage(startPosition + position.offset, m_moveTimeout)) {
+					qWarning(logWarning()) << "The stack is aborted, since the stage does not move.";
+					m_abort = true;
+				}
+			}
+
+			// Abort if requested
+			if (m_abort) {
+				if (m_camera) {
+					m_camera->stopAcquisition();
+				}
+				moveStage(startPosition);
+				this->abortMode(storage);
+				return;
+			}
+
+			// read images from camera
+			std::vector<std::byte> images(m_settings.camera.roi.bytesPerFrame);
+
+			auto frame = m_phaseTimer.measure("frame");
+			captureFrame<T>(images);
+			frame.stop();
+
+			// store images
+			// asynchronously write image to disk
+			// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+			auto handOff = m_phaseTimer.measure("hand-off");
+			std::string date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
+				.toString(Qt::ISODateWithMs).toStdString();
+			auto img = new FLUOSTACK<T>(
+				layout,
+				(int)c,
+				position.plane,
+				position.tile,
+				date,
+				*(std::vector<T> *) & images,
+				m_settings.camera.roi
+			);
+
+			QMetaObject::invokeMethod(
+				storage.get(),
+				[&storage = storage, img]() { storage.get()->s_enqueuePayload(img); },
+				Qt::AutoConnection
+			);
+			handOff.stop();
+
+			imageNumber++;
+			double percentage = 100 * (double)imageNumber / frameCount;
+			int remaining = 1e-3 * measurementTimer.elapsed() / imageNumber * ((int64_t)frameCount - imageNumber);
+			emit(s_repetitionProgress(percentage, remaining));
+		}
+	}
+
+	// configure camera for preview
+	if (m_camera) {
+		m_camera->stopAcquisition();
+	}
+
+	// move back to the start position
+	moveStage(startPosition);
+
+	auto measurementDuration = measurementTimer.elapsed();
+	qInfo(logInfo()) << "Acquired" << channels.size() << "channels at" << m_settings.stack.planes << "planes of"
+		<< layout->tiles.size() << "tiles in" << 1e-3 * measurementDuration << "s (" << measurementDuration / imageNumber << "ms per frame).";
+
+	// Here we wait until the storage object indicate it finished to write to the file.
+	QEventLoop loop;
+	auto connection = QWidget::connect(
+		storage.get(),
+		&StorageWrapper::finished,
+		&loop,
+		&QEventLoop::quit
+	);
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage]() { storage.get()->s_finishedQueueing(); },
+		Qt::AutoConnection
+	);
+	auto flush = m_phaseTimer.measure("storage flush");
+	loop.exec();
+	flush.stop();
+
+	writePhaseTimes(storage, ACQUISITION_MODE::FLUORESCENCE);
+
+	if (m_camera) {
+		auto reconfigurations = m_camera->getReconfigurations();
+		qInfo(logInfo()) << "Camera reconfigurations: full" << reconfigurations.full
+			<< ", partial" << reconfigurations.partial << ", skipped" << reconfigurations.skipped;
+	}
 
 	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
 }
@@ -417,7 +693,14 @@ void Fluorescence::acquire(std::unique_ptr <StorageWrapper>& storage) {
 }
 
 void Fluorescence::acquire(std::unique_ptr<StorageWrapper>& storage, const std::vector<ChannelSettings*>& channels) {
-	if (m_settings.camera.readout.dataType == "unsigned short") {
+	// a single plane of a single tile is stored as one image per channel like before
+	if (m_settings.stack.isStack()) {
+		if (m_settings.camera.readout.dataType == "unsigned short") {
+			__acquireStack<unsigned short>(storage, channels);
+		} else if (m_settings.camera.readout.dataType == "unsigned char") {
+			__acquireStack<unsigned char>(storage, channels);
+		}
+	} else if (m_settings.camera.readout.dataType == "unsigned short") {
 		__acquire<unsigned short>(storage, channels);
 	} else if (m_settings.camera.readout.dataType == "unsigned char") {
 		__acquire<unsigned char>(storage, channels);
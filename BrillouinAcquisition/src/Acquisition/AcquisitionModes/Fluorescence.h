@@ -23,12 +23,31 @@ struct ChannelSettings {
 	ScanPreset preset;
 };
 
+struct FLUORESCENCE_STACK {
+	int planes{ 1 };				// [1]	number of z-planes, centred on the start position
+	double planeDistance{ 1 };		// [µm]	distance between two planes
+	int tiles_x{ 1 };				// [1]	number of tiles in x-direction, centred on the start position
+	int tiles_y{ 1 };				// [1]	number of tiles in y-direction
+	double tileDistance{ 100 };		// [µm]	distance between the centres of two tiles
+
+	bool isStack() const {
+		return planes > 1 || tiles_x * tiles_y > 1;
+	}
+};
+
+struct STACK_POSITION {
+	int plane{ 0 };					// [1]	index of the plane
+	int tile{ 0 };					// [1]	index of the tile, tiles are numbered row by row
+	POINT3 offset{ 0, 0, 0 };		// [µm]	position relative to the start position
+};
+
 struct FLUORESCENCE_SETTINGS {
 	ChannelSettings blue{ true, 900, 10, "Blue", FLUORESCENCE_MODE::BLUE, ScanPreset::SCAN_EPIFLUOBLUE };
 	ChannelSettings green{ true, 900, 10, "Green", FLUORESCENCE_MODE::GREEN, ScanPreset::SCAN_EPIFLUOGREEN };
 	ChannelSettings red{ true, 900, 10, "Red", FLUORESCENCE_MODE::RED, ScanPreset::SCAN_EPIFLUORED };
 	ChannelSettings brightfield{ true, 4, 0, "Brightfield", FLUORESCENCE_MODE::BRIGHTFIELD, ScanPreset::SCAN_BRIGHTFIELD };
 	CAMERA_SETTINGS camera;
+	FLUORESCENCE_STACK stack;
 };
 
 class Fluorescence : public AcquisitionMode {
@@ -46,6 +65,7 @@ public slots:
 	void setChannel(FLUORESCENCE_MODE, bool);
 	void setExposure(FLUORESCENCE_MODE, int);
 	void setGain(FLUORESCENCE_MODE mode, int gain);
+	void setStack(const FLUORESCENCE_STACK& stack);
 	void startStopPreview(FLUORESCENCE_MODE);
 
 private:
@@ -54,9 +74,15 @@ private:
 	ChannelSettings* getChannelSettings(FLUORESCENCE_MODE mode);
 	std::vector<ChannelSettings*> getEnabledChannels();
 	void configureCamera();
+	void configureChannel(const ChannelSettings* channel, bool first);
+	std::vector<STACK_POSITION> getStackPositions();
 
+	template <typename T>
+	void captureFrame(std::vector<std::byte>& images);
 	template <typename T>
 	void __acquire(std::unique_ptr <StorageWrapper>& storage, std::vector<ChannelSettings*> channels);
+	template <typename T>
+	void __acquireStack(std::unique_ptr <StorageWrapper>& storage, std::vector<ChannelSettings*> channels);
 
 	Camera*& m_camera;
 
@@ -3,6 +3,7 @@
 #include <thread>
 
 #include "ODT.h"
+#include "src/helper/logger.h"
 #include "src/lib/math/simplemath.h"
 
 /*
@@ -11,6 +12,8 @@
 
 ODT::ODT(QObject* parent, Acquisition* acquisition, Camera*& camera, ODTControl*& ODTControl)
 	: AcquisitionMode(parent, acquisition, (ScanControl*&)ODTControl), m_camera(camera), m_ODTControl(ODTControl) {
+	// unwrapping dominates the phase retrieval, half the resolution is sufficient to judge the tomogram
+	m_phaseRetrieval.setDownsampling(2);
 }
 
 ODT::~ODT() {
@@ -54,24 +57,15 @@ void ODT::startRepetitions() {
 
 	// reset abort flag
 	m_abort = false;
+	resetPhaseTimes();
 
 	// configure camera for measurement
-	CAMERA_SETTINGS settings = m_camera->getSettings();
-	// set ROI and readout parameters to default ODT values, exposure time and gain will be kept
-	settings.roi.left = 128;
-	settings.roi.top = 0;
-	settings.roi.width_physical = 1024;
-	settings.roi.height_physical = 1024;
-	settings.readout.triggerMode = L"External";
-	settings.readout.cycleMode = L"Continuous";
-	settings.frameCount = m_acqSettings.numberPoints;
-	settings.exposureTime = m_cameraSettings.exposureTime;
-	settings.gain = m_cameraSettings.gain;
-
-	m_camera->startAcquisition(settings);
+	auto preparation = m_phaseTimer.measure("camera preparation");
+	m_camera->startAcquisition(getAcquisitionCameraSettings(m_acqSettings.numberPoints));
 
 	// read back the applied settings
 	m_cameraSettings = m_camera->getSettings();
+	preparation.stop();
 
 	m_acquisition->newRepetition(ACQUISITION_MODE::ODT);
 
@@ -84,6 +78,51 @@ void ODT::startRepetitions() {
 	// configure camera for preview
 	m_camera->stopAcquisition();
 
+	// the frames of a streamed tomogram are still in the pool
+	if (m_acqSettings.streaming && getStatus() == ACQUISITION_STATUS::FINISHED) {
+		retrievePhase();
+		if (m_acqSettings.reconstruct) {
+			reconstructTomogram();
+		}
+	}
+
+	m_acquisition->disableMode(ACQUISITION_MODE::ODT);
+}
+
+/*
+ * Acquires an image of an empty field of view at normal incidence. It is used to locate the carrier and to correct
+ * the phase of all following streamed tomograms, so it has to be acquired again if the illumination changes.
+ */
+void ODT::acquireBackground() {
+	if (m_algnRunning || m_status >= ACQUISITION_STATUS::WAITFORREPETITION) {
+		qWarning(logWarning()) << "The ODT background can only be acquired while neither the alignment nor an acquisition is running.";
+		return;
+	}
+	bool allowed = m_acquisition->enableMode(ACQUISITION_MODE::ODT);
+	if (!allowed) {
+		return;
+	}
+
+	m_camera->startAcquisition(getAcquisitionCameraSettings(1));
+	m_cameraSettings = m_camera->getSettings();
+	switchPreset(ScanPreset::SCAN_ODT);
+
+	m_ODTControl->setVoltage({ 0, 0 });
+	m_ODTControl->setAcquisitionVoltages(getAcquisitionVoltages(std::vector<VOLTAGE2>{ { 0, 0 } }), false);
+	auto background = std::vector<std::byte>(m_cameraSettings.roi.bytesPerFrame);
+	m_camera->prepareImagesForAcquisition(1);
+	m_ODTControl->startAcquisitionVoltages();
+	auto framesRead = m_camera->getImagesForAcquisition(background.data(), 1);
+	m_camera->stopAcquisition();
+
+	if (framesRead == 1) {
+		m_phaseRetrieval.setBackground(background.data(), m_cameraSettings.readout.dataType, m_cameraSettings.roi.width_binned,
+			m_cameraSettings.roi.height_binned);
+		qInfo(logInfo()) << "Acquired the ODT background, the phase of the following streamed tomograms is corrected with it.";
+	} else {
+		qWarning(logWarning()) << "The camera did not deliver the ODT background, the previous background is kept.";
+	}
+
 	m_acquisition->disableMode(ACQUISITION_MODE::ODT);
 }
 
@@ -179,6 +218,12 @@ void ODT::setSettings(ODT_MODE mode, ODT_SETTING settingType, double value) {
 				m_algnTimer->start(1e3 / (m_algnSettings.scanRate * m_algnSettings.numberPoints));
 			}
 			break;
+		case ODT_SETTING::STREAMING:
+			settings->streaming = (bool)value;
+			break;
+		case ODT_SETTING::RECONSTRUCT:
+			settings->reconstruct = (bool)value;
+			break;
 	}
 }
 
@@ -237,6 +282,43 @@ void ODT::abortMode() {
 	setAcquisitionStatus(ACQUISITION_STATUS::ABORTED);
 }
 
+/*
+ * Sets ROI and readout parameters to the default ODT values, exposure time and gain are kept
+ */
+CAMERA_SETTINGS ODT::getAcquisitionCameraSettings(int frameCount) {
+	CAMERA_SETTINGS settings = m_camera->getSettings();
+	settings.roi.left = 128;
+	settings.roi.top = 0;
+	settings.roi.width_physical = 1024;
+	settings.roi.height_physical = 1024;
+	settings.readout.triggerMode = L"External";
+	settings.readout.cycleMode = L"Continuous";
+	settings.frameCount = frameCount;
+	settings.exposureTime = m_cameraSettings.exposureTime;
+	settings.gain = m_cameraSettings.gain;
+	return settings;
+}
+
+/*
+ * Constructs the analog voltage vector of the mirror and the trigger vector of the camera for the given angles
+ */
+ACQ_VOLTAGES ODT::getAcquisitionVoltages(const std::vector<VOLTAGE2>& angles) {
+	ACQ_VOLTAGES voltages;
+	int samplesPerAngle{ 10 };
+	int numberChannels{ 2 };
+	auto numberPoints = angles.size();
+	voltages.numberSamples = (int)numberPoints * samplesPerAngle;
+	voltages.trigger = std::vector<uInt8>(numberPoints * samplesPerAngle, 0);
+	voltages.mirror = std::vector<float64>(numberPoints * samplesPerAngle * numberChannels, 0);
+	for (gsl::index i{ 0 }; i < numberPoints; i++) {
+		voltages.trigger[i * samplesPerAngle + 2] = 1;
+		voltages.trigger[i * samplesPerAngle + 3] = 1;
+		std::fill_n(voltages.mirror.begin() + i * samplesPerAngle, samplesPerAngle, angles[i].Ux);
+		std::fill_n(voltages.mirror.begin() + i * samplesPerAngle + numberPoints * samplesPerAngle, samplesPerAngle, angles[i].Uy);
+	}
+	return voltages;
+}
+
 void ODT::calculateVoltages(ODT_MODE mode) {
 	if (mode == ODT_MODE::ALGN) {
 		double Ux{ 0 };
@@ -311,37 +393,35 @@ void ODT::__acquire(std::unique_ptr <StorageWrapper> & storage) {
 	);
 
 	// move to ODT configuration
+	auto presetSwitch = m_phaseTimer.measure("preset switch");
 	m_ODTControl->setPreset(ScanPreset::SCAN_ODT);
+	presetSwitch.stop();
 
 	// Set first mirror voltage already
 	m_ODTControl->setVoltage(m_acqSettings.voltages[0]);
+	auto settle = m_phaseTimer.measure("settle");
 	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	settle.stop();
 
 	writeScaleCalibration(storage, ACQUISITION_MODE::ODT);
 
-	ACQ_VOLTAGES voltages;
-
-	/*
-	 * Set the mirror voltage and trigger the camera
-	 */
-	// Construct the analog voltage vector and the trigger vector
-	int samplesPerAngle{ 10 };
-	int numberChannels{ 2 };
-	voltages.numberSamples = m_acqSettings.numberPoints * samplesPerAngle;
-	voltages.trigger = std::vector<uInt8>((size_t)m_acqSettings.numberPoints * samplesPerAngle, 0);
-	voltages.mirror = std::vector<float64>((size_t)m_acqSettings.numberPoints * samplesPerAngle * numberChannels, 0);
-	for (gsl::index i{ 0 }; i < m_acqSettings.numberPoints; i++) {
-		voltages.trigger[i * samplesPerAngle + 2] = 1;
-		voltages.trigger[i * samplesPerAngle + 3] = 1;
-		std::fill_n(voltages.mirror.begin() + i * samplesPerAngle, samplesPerAngle, m_acqSettings.voltages[i].Ux);
-		std::fill_n(voltages.mirror.begin() + i * samplesPerAngle + (size_t)m_acqSettings.numberPoints * samplesPerAngle, samplesPerAngle, m_acqSettings.voltages[i].Uy);
-	}
-	// Apply voltages to NIDAQ board
-	m_ODTControl->setAcquisitionVoltages(voltages);
+	// Apply voltages to NIDAQ board, a stream only starts triggering once the camera captures
+	auto voltageUpload = m_phaseTimer.measure("voltage upload");
+	m_ODTControl->setAcquisitionVoltages(getAcquisitionVoltages(m_acqSettings.voltages), !m_acqSettings.streaming);
+	voltageUpload.stop();
 
 	int rank_data{ 3 };
 	hsize_t dims_data[3] = { 1, (hsize_t)m_cameraSettings.roi.height_binned, (hsize_t)m_cameraSettings.roi.width_binned };
-	if (m_cameraSettings.roi.bytesPerFrame) {
+	if (m_cameraSettings.roi.bytesPerFrame && m_acqSettings.streaming) {
+		if (m_abort) {
+			this->abortMode(storage);
+			return;
+		}
+		if (!__acquireStream<T>(storage)) {
+			this->abortMode(storage);
+			return;
+		}
+	} else if (m_cameraSettings.roi.bytesPerFrame) {
 		for (gsl::index i{ 0 }; i < m_acqSettings.numberPoints; i++) {
 
 			// read images from camera
@@ -353,12 +433,15 @@ void ODT::__acquire(std::unique_ptr <StorageWrapper> & storage) {
 			}
 
 			// acquire images
+			auto frame = m_phaseTimer.measure("frame");
 			m_camera->getImageForAcquisition(&images[0], false);
+			frame.stop();
 
 
 			// store images
 			// asynchronously write image to disk
 			// the datetime has to be set here, otherwise it would be determined by the time the queue is processed
+			auto handOff = m_phaseTimer.measure("hand-off");
 			std::string date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
 				.toString(Qt::ISODateWithMs).toStdString();
 
@@ -396,11 +479,100 @@ void ODT::__acquire(std::unique_ptr <StorageWrapper> & storage) {
 		[&storage = storage]() { storage.get()->s_finishedQueueing(); },
 		Qt::AutoConnection
 	);
+	auto flush = m_phaseTimer.measure("storage flush");
 	loop.exec();
+	flush.stop();
+
+	writePhaseTimes(storage, ACQUISITION_MODE::ODT);
 
 	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
 }
 
+/*
+ * Returns false if the camera did not deliver all angles, the incomplete stack is neither stored nor reconstructed
+ */
+template <typename T>
+bool ODT::__acquireStream(std::unique_ptr <StorageWrapper>& storage) {
+	// the pool holds all angles and is only reallocated if the tomogram grows,
+	// it is not touched again before the storage has finished writing it
+	m_framePool.resize((size_t)m_cameraSettings.roi.bytesPerFrame * m_acqSettings.numberPoints);
+
+	// the datetime of the stack is the start of the stream
+	std::string date = QDateTime::currentDateTime().toOffsetFromUtc(QDateTime::currentDateTime().offsetFromUtc())
+		.toString(Qt::ISODateWithMs).toStdString();
+
+	// the NIDAQ board triggers every frame, so the camera delivers them back to back at the trigger rate,
+	// the camera has to capture before the first trigger is fired
+	auto stream = m_phaseTimer.measure("stream");
+	m_camera->prepareImagesForAcquisition(m_acqSettings.numberPoints);
+	m_ODTControl->startAcquisitionVoltages();
+	auto framesRead = m_camera->getImagesForAcquisition(m_framePool.data(), m_acqSettings.numberPoints);
+	stream.stop();
+	if (framesRead < m_acqSettings.numberPoints) {
+		qWarning(logWarning()) << "The camera only delivered" << framesRead << "of" << m_acqSettings.numberPoints
+			<< "angles, the incomplete tomogram is dropped.";
+		return false;
+	}
+
+	// asynchronously write all angles as one dataset to disk
+	auto handOff = m_phaseTimer.measure("hand-off");
+	auto stack = new ODTSTACK<T>(
+		m_acqSettings.numberPoints,
+		m_cameraSettings.roi.height_binned,
+		m_cameraSettings.roi.width_binned,
+		date,
+		(T*)m_framePool.data(),
+		m_cameraSettings.exposureTime,
+		m_cameraSettings.gain,
+		m_cameraSettings.roi
+	);
+
+	QMetaObject::invokeMethod(
+		storage.get(),
+		[&storage = storage, stack]() { storage.get()->s_enqueuePayload(stack); },
+		Qt::AutoConnection
+	);
+	return true;
+}
+
+void ODT::retrievePhase() {
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	m_phaseStack = m_phaseRetrieval.calculate(
+		m_framePool.data(),
+		m_cameraSettings.readout.dataType,
+		m_acqSettings.numberPoints,
+		m_cameraSettings.roi.width_binned,
+		m_cameraSettings.roi.height_binned
+	);
+
+	qInfo(logInfo()) << "Retrieved the phase of" << m_phaseStack.angles << "angles in" << 1e-3 * timer.elapsed() << "s using"
+		<< m_phaseRetrieval.getThreadCount() << "threads.";
+}
+
+void ODT::reconstructTomogram() {
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	auto settings = m_reconstruction.getSettings();
+	settings.pixelSize = phase::PIXEL_SIZE * m_cameraSettings.roi.binX;
+	m_reconstruction.setSettings(settings);
+
+	auto volume = m_reconstruction.reconstruct(m_phaseStack, m_acqSettings.voltages);
+	if (volume.dim < 1) {
+		return;
+	}
+	if (!volume.calibrated) {
+		qWarning(logWarning()) << "The illumination angles could not be fitted to the mirror voltages, the measured phase ramps are used instead.";
+	}
+
+	qInfo(logInfo()) << "Reconstructed a tomogram of" << volume.dim << "voxels per direction from" << volume.angles << "angles in"
+		<< 1e-3 * timer.elapsed() << "s using" << m_reconstruction.getThreadCount() << "threads.";
+
+	emit(s_tomogramReconstructed(ODTReconstruction::getSlices(volume)));
+}
+
 /*
  * Private slots
  */
@@ -2,6 +2,8 @@
 #define ODT_H
 
 #include "AcquisitionMode.h"
+#include "../ODTReconstruction.h"
+#include "../PhaseRetrieval.h"
 #include "src/Devices/Cameras/Camera.h"
 #include "src/Devices/ScanControls/ODTControl.h"
 #include "src/lib/buffer_circular.h"
@@ -9,7 +11,9 @@
 enum class ODT_SETTING {
 	VOLTAGE,
 	NRPOINTS,
-	SCANRATE
+	SCANRATE,
+	STREAMING,
+	RECONSTRUCT
 };
 
 enum class ODT_MODE {
@@ -22,6 +26,8 @@ struct ODT_SETTINGS {
 	int numberPoints{ 30 };			// [1]	number of points
 	double scanRate{ 1 };			// [Hz]	scan rate, for alignment: rate for one rotation, for acquisition: rate for one step
 	std::vector<VOLTAGE2> voltages;	// [V]	voltages to apply
+	bool streaming{ false };		// [1]	stream all angles into one dataset instead of storing every angle separately
+	bool reconstruct{ false };		// [1]	reconstruct the refractive index after every streamed tomogram
 };
 
 class ODT : public AcquisitionMode {
@@ -45,6 +51,7 @@ public slots:
 	void initialize();
 	void startAlignment();
 	void centerAlignment();
+	void acquireBackground();
 	void setSettings(ODT_MODE, ODT_SETTING, double);
 	void setCameraSetting(CAMERA_SETTING, double);
 
@@ -53,9 +60,15 @@ private:
 	void abortMode();
 
 	void calculateVoltages(ODT_MODE);
+	CAMERA_SETTINGS getAcquisitionCameraSettings(int frameCount);
+	ACQ_VOLTAGES getAcquisitionVoltages(const std::vector<VOLTAGE2>& angles);
 
 	template <typename T>
 	void __acquire(std::unique_ptr <StorageWrapper>& storage);
+	template <typename T>
+	bool __acquireStream(std::unique_ptr <StorageWrapper>& storage);
+	void retrievePhase();
+	void reconstructTomogram();
 
 	ODT_SETTINGS m_acqSettings{
 		0.3,
@@ -71,6 +84,12 @@ private:
 
 	int m_algnPositionIndex{ 0 };
 
+	std::vector<std::byte> m_framePool;		// frames of a streamed acquisition, reused for every tomogram
+
+	PhaseRetrieval m_phaseRetrieval;
+	PHASE_STACK m_phaseStack;				// unwrapped phase of the last streamed tomogram
+	ODTReconstruction m_reconstruction;
+
 	QTimer* m_algnTimer{ nullptr };
 
 private slots:
@@ -83,6 +102,7 @@ signals:
 	void s_algnSettingsChanged(ODT_SETTINGS);				// emit the alignment voltages
 	void s_cameraSettingsChanged(CAMERA_SETTINGS);			// emit the camera settings
 	void s_mirrorVoltageChanged(VOLTAGE2, ODT_MODE);		// emit the mirror voltage
+	void s_tomogramReconstructed(ODT_SLICES);				// emit the central planes of the reconstructed tomogram
 };
 
 #endif //ODT_H
\ No newline at end of file
@@ -3,9 +3,7 @@
 #include "ScaleCalibration.h"
 
 #include "src/helper/h5_helper.h"
-
-#include "opencv2/core.hpp"
-#include "opencv2/highgui.hpp"
+#include "src/helper/logger.h"
 
 #include <chrono>
 #include <thread>
@@ -163,10 +161,14 @@ void ScaleCalibration::save(std::vector<std::vector<T>> images, std::vector<POIN
 			(hsize_t)m_cameraSettings.roi.width_binned
 		};
 		auto names = std::vector<std::string>{ "origin", "dx", "dy" };
+		// Additional translations are numbered consecutively
+		for (auto j = names.size(); j < images.size(); j++) {
+			names.push_back("shift-" + std::to_string(j));
+		}
 		auto i = gsl::index{ 0 };
 		for (const auto& image : images) {
 			// Check that we don't run into trouble iterating over two arrays
-			if (i >= names.size()) {
+			if (i >= positions.size()) {
 				continue;
 			}
 			auto dataspace = H5::DataSpace(3, dims, dims);
@@ -261,19 +263,29 @@ void ScaleCalibration::__acquire() {
 		[scanControl = m_scanControl]() { scanControl->stopAnnouncing(); },
 		Qt::AutoConnection
 	);
+	resetPhaseTimes();
 	// Set optical elements for brightfield/Brillouin imaging
+	auto presetSwitch = m_phaseTimer.measure("preset switch");
 	m_scanControl->setPreset(ScanPreset::SCAN_BRIGHTFIELD);
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	presetSwitch.stop();
+	settle(ScanPreset::SCAN_BRIGHTFIELD, 500);
 
 	// Get the current stage position
 	m_startPosition = m_scanControl->getPosition();
 
 	/*
-	 * We acquire three images here, one at the origin, and one each shifted in x- and y-direction.
+	 * We acquire one image at the origin and one for every translation. The first two translations are in x- and
+	 * y-direction, further translations in the opposite and the diagonal directions average out the error of the shifts.
 	 */
 	auto hysteresisCompensation{ 10.0 };// [µm] distance for compensation of the stage hysteresis
+	auto directions = std::vector<POINT2>{ { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 } };
+	auto translations = std::vector<POINT2>{};
+	for (gsl::index i{ 0 }; i < m_shiftCount && i < (gsl::index)directions.size(); i++) {
+		translations.push_back({ directions[i].x * m_Ds.x, directions[i].y * m_Ds.y });
+	}
 	// Construct the positions
-	auto positions = std::vector<POINT2>{ { 0, 0 }, { m_Ds.x, 0 }, { 0, m_Ds.y } };
+	auto positions = std::vector<POINT2>{ { 0, 0 } };
+	positions.insert(positions.end(), translations.begin(), translations.end());
 
 	// Acquire memory for image acquisition
 	auto images = std::vector<std::vector<std::byte>>(positions.size());
@@ -297,16 +309,17 @@ void ScaleCalibration::__acquire() {
 		 */
 		auto positionAbsolute = m_startPosition + POINT3{ position.x, position.y, 0 };
 		// To prevent problems with the hysteresis of the stage, we always move to the desired point coming from lower values.
-		m_scanControl->setPosition(positionAbsolute - POINT3{ hysteresisCompensation, hysteresisCompensation, 0 });
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		m_scanControl->setPosition(positionAbsolute);
-		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		auto stageMove = m_phaseTimer.measure("stage move");
+		moveTo(positionAbsolute - POINT3{ hysteresisCompensation, hysteresisCompensation, 0 }, 100);
+		moveTo(positionAbsolute, 200);
+		stageMove.stop();
 
 		/*
 		 * Acquire the camera image
 		 */
 
 		 // acquire images
+		auto frame = m_phaseTimer.measure("frame");
 		m_camera->getImageForAcquisition(&(images[iteration])[0], false);
 
 		// Sometimes the uEye camera returns a black image (only zeros), we try to catch this here by
@@ -322,6 +335,7 @@ void ScaleCalibration::__acquire() {
 			images_ = (std::vector<T> *) &(images[iteration]);
 			sum = simplemath::sum(*images_);
 		}
+		frame.stop();
 
 		++iteration;
 		emit(s_scaleCalibrationAcquisitionProgress(iteration * 100.0 / images.size()));
@@ -330,63 +344,39 @@ void ScaleCalibration::__acquire() {
 	// Stop the camera acquisition
 	m_camera->stopAcquisition();
 
-	// Create input matrices for OpenCV from camera images
-	auto imagesCV = std::vector<cv::Mat>(images.size());
-	for (gsl::index i{ 0 }; i < images.size(); i++) {
-		imagesCV[i] = cv::Mat(m_cameraSettings.roi.height_binned, m_cameraSettings.roi.width_binned, CV_8UC1, &(images[i])[0]);
-	}
-
 	/*
 	 * Determine the shift in pixels
 	 */
-
-#ifdef _DEBUG
-	 // Show the input images for debugging
-	cv::imshow("Origin", imagesCV[0]);
-	cv::imshow("Dx", imagesCV[1]);
-	cv::imshow("Dy", imagesCV[2]);
-#endif
-
-	// We use template matching, so we have to create a template from the origin image
-	auto padding = 200.0;
-	auto size = imagesCV[0].size();
-	auto templateROI = cv::Rect(padding, padding, size.width - 2 * padding, size.height - 2 * padding);
-	auto templ = imagesCV[0](templateROI);
-
-#ifdef _DEBUG
-	cv::imshow("Template", templ);
-#endif
-
-	auto outputX = cv::Mat{};
-	cv::matchTemplate(imagesCV[1], templ, outputX, cv::TemplateMatchModes::TM_SQDIFF);
-	auto outputY = cv::Mat{};
-	cv::matchTemplate(imagesCV[2], templ, outputY, cv::TemplateMatchModes::TM_SQDIFF);
-
-	cv::normalize(outputX, outputX, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
-	cv::normalize(outputY, outputY, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
-
-	auto minValX = double{};
-	auto maxValX = double{};
-	auto minLocX = cv::Point{};
-	auto maxLocX = cv::Point{};
-	cv::minMaxLoc(outputX, &minValX, &maxValX, &minLocX, &maxLocX, cv::Mat());
-	auto shiftDx = minLocX - cv::Point(padding, padding);
-
-	auto minValY = double{};
-	auto maxValY = double{};
-	auto minLocY = cv::Point{};
-	auto maxLocY = cv::Point{};
-	cv::minMaxLoc(outputY, &minValY, &maxValY, &minLocY, &maxLocY, cv::Mat());
-	auto shiftDy = minLocY - cv::Point(padding, padding);
+	auto correlation = m_phaseTimer.measure("phase correlation");
+	auto shifts = std::vector<POINT2>{};
+	auto peaks = std::vector<double>{};
+	auto registration = phaseCorrelation{};
+	registration.setReference((T*)&(images[0])[0], m_cameraSettings.roi.width_binned, m_cameraSettings.roi.height_binned);
+	for (gsl::index i{ 1 }; i < (gsl::index)images.size(); i++) {
+		auto estimate = registration.shift((T*)&(images[i])[0]);
+		shifts.push_back(estimate.shift);
+		peaks.push_back(estimate.peak);
+	}
+	correlation.stop();
 
 	/*
 	 * Construct the scale calibration
 	 */
-	m_scaleCalibration.micrometerToPixX = { -1.0 * shiftDx.x / m_Ds.x, shiftDx.y / m_Ds.x };
-	m_scaleCalibration.micrometerToPixY = { -1.0 * shiftDy.x / m_Ds.y, shiftDy.y / m_Ds.y };
 	try {
-		// Can throw an exception (if the provided calibration is invalid):
-		ScaleCalibrationHelper::initializeCalibrationFromMicrometer(&m_scaleCalibration);
+		// Can throw an exception (if the translations do not span the plane or the calibration is invalid):
+		ScaleCalibrationHelper::initializeCalibrationFromShifts(&m_scaleCalibration, translations, shifts);
+
+		// Report how well the fitted matrix reproduces the single shifts
+		auto shiftMatrix = ScaleCalibrationHelper::fitShifts(translations, shifts);
+		auto residual{ 0.0 };
+		for (gsl::index i{ 0 }; i < (gsl::index)shifts.size(); i++) {
+			const auto& t = translations[i];
+			residual += pow(shiftMatrix.a * t.x + shiftMatrix.b * t.y - shifts[i].x, 2)
+				+ pow(shiftMatrix.c * t.x + shiftMatrix.d * t.y - shifts[i].y, 2);
+		}
+		residual = sqrt(residual / shifts.size());
+		qInfo(logInfo()) << "Scale calibration fitted to" << shifts.size() << "shifts, residual" << residual
+			<< "pix, minimal correlation peak" << *std::min_element(peaks.begin(), peaks.end());
 
 		// Store the calibration in a file
 
@@ -409,6 +399,8 @@ void ScaleCalibration::__acquire() {
 		Qt::AutoConnection
 	);
 
+	reportPhaseTimes(ACQUISITION_MODE::SCALECALIBRATION);
+
 	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
 }
 
@@ -434,6 +426,7 @@ void ScaleCalibration::initialize() {
 	emit(s_scaleCalibrationAcquisitionProgress(0.0));
 	emit(s_scaleCalibrationChanged(m_scaleCalibration));
 	emit(s_Ds_changed(m_Ds));
+	emit(s_shiftCount_changed(m_shiftCount));
 }
 
 void ScaleCalibration::apply() {
@@ -457,6 +450,12 @@ void ScaleCalibration::setTranslationDistanceY(double dy) {
 	emit(s_Ds_changed(m_Ds));
 }
 
+void ScaleCalibration::setShiftCount(int count) {
+	// At least one translation in x- and y-direction is required
+	m_shiftCount = std::clamp(count, 2, 8);
+	emit(s_shiftCount_changed(m_shiftCount));
+}
+
 void ScaleCalibration::setMicrometerToPixX_x(double value) {
 	m_scaleCalibration.micrometerToPixX.x = value;
 	try {
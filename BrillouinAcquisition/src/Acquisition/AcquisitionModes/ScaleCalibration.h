@@ -5,10 +5,9 @@
 #include <gsl/gsl>
 #include "H5Cpp.h"
 
-#include "opencv2/imgproc.hpp"
-
 #include "AcquisitionMode.h"
 #include "ScaleCalibrationHelper.h"
+#include "../../lib/math/phaseCorrelation.h"
 #include "../../Devices/Cameras/Camera.h"
 #include "../../Devices/ScanControls/ScanControl.h"
 
@@ -35,6 +34,7 @@ public slots:
 
 	void setTranslationDistanceX(double dx);
 	void setTranslationDistanceY(double dy);
+	void setShiftCount(int count);
 
 	void setMicrometerToPixX_x(double value);
 	void setMicrometerToPixX_y(double value);
@@ -69,9 +69,11 @@ private:
 
 	ScaleCalibrationData m_scaleCalibration;
 	POINT2 m_Ds{ 10.0, 10.0 };	// [µm]	shift in x- and y-direction
+	int m_shiftCount{ 2 };		// [1]	number of translations the calibration is fitted to
 
 signals:
 	void s_Ds_changed(POINT2);
+	void s_shiftCount_changed(int);
 	void s_scaleCalibrationChanged(ScaleCalibrationData);
 	void s_scaleCalibrationAcquisitionProgress(double);
 	void s_scaleCalibrationStatus(std::string title, std::string message);
@@ -3,6 +3,8 @@
 
 #include "../../lib/math/points.h"
 
+#include <vector>
+
 struct ScaleCalibrationData {
 	POINT2 micrometerToPixX{ 0, 0 };	// [pix/micrometer]
 	POINT2 micrometerToPixY{ 0, 0 };	// [pix/micrometer]
@@ -51,6 +53,59 @@ public:
 		calibration->micrometerToPixY = POINT2{ inverted.b, inverted.d };
 	}
 
+	/*
+	 * Fits the calibration to the shifts of the image content [pix] measured for the given stage translations [µm].
+	 * The matrix mapping the translations to the shifts is the least squares solution of all translations, so
+	 * measuring more translations than the two needed averages out the error of the single shifts.
+	 */
+	static void initializeCalibrationFromShifts(ScaleCalibrationData* calibration, const std::vector<POINT2>& translations,
+		const std::vector<POINT2>& shifts) {
+		auto shiftMatrix = fitShifts(translations, shifts);
+
+		// the image content moves opposite to the stage in x-direction
+		calibration->micrometerToPixX = POINT2{ -1.0 * shiftMatrix.a, shiftMatrix.c };
+		calibration->micrometerToPixY = POINT2{ -1.0 * shiftMatrix.b, shiftMatrix.d };
+
+		initializeCalibrationFromMicrometer(calibration);
+	}
+
+	/*
+	 * Returns the matrix M minimising the sum of |M * translation - shift|^2
+	 */
+	static Matrix2 fitShifts(const std::vector<POINT2>& translations, const std::vector<POINT2>& shifts) {
+		// normal equations: M * (T * T^t) = S * T^t
+		auto TT = Matrix2{};
+		auto ST = Matrix2{};
+		for (size_t i{ 0 }; i < translations.size() && i < shifts.size(); i++) {
+			const auto& t = translations[i];
+			const auto& s = shifts[i];
+			TT.a += t.x * t.x;
+			TT.b += t.x * t.y;
+			TT.d += t.y * t.y;
+			ST.a += s.x * t.x;
+			ST.b += s.x * t.y;
+			ST.c += s.y * t.x;
+			ST.d += s.y * t.y;
+		}
+		TT.c = TT.b;
+
+		// Check that the translations span the plane
+		if (!isBasis({ TT.a, TT.c }, { TT.b, TT.d })) {
+			throw std::exception("Provided translations are not a basis.");
+		}
+
+		return multiply(ST, invert(TT));
+	}
+
+	static Matrix2 multiply(Matrix2 left, Matrix2 right) {
+		return Matrix2{
+			left.a * right.a + left.b * right.c,
+			left.a * right.b + left.b * right.d,
+			left.c * right.a + left.d * right.c,
+			left.c * right.b + left.d * right.d
+		};
+	}
+
 	static bool isBasis(POINT2 e_0, POINT2 e_1) {
 		// Check that the absolute value of the determinant is not zero
 		return abs(determinate({ e_0.x, e_1.x, e_0.y, e_1.y })) > 1e-10;
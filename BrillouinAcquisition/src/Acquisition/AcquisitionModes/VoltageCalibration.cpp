@@ -2,6 +2,7 @@
 #include "filesystem"
 #include "VoltageCalibration.h"
 #include "src/lib/math/simplemath.h"
+#include "src/lib/math/spotLocator.h"
 
 #include <chrono>
 #include <thread>
@@ -227,10 +228,13 @@ void VoltageCalibration::save() {
 template <typename T>
 void VoltageCalibration::__acquire() {
 	setAcquisitionStatus(ACQUISITION_STATUS::STARTED);
+	resetPhaseTimes();
 
 	// move to Brillouin configuration
+	auto presetSwitch = m_phaseTimer.measure("preset switch");
 	m_ODTControl->setPreset(ScanPreset::SCAN_BRILLOUIN);
 	m_ODTControl->setLEDLamp(false);
+	presetSwitch.stop();
 
 	std::vector<double> Ux_valid;
 	std::vector<double> Uy_valid;
@@ -254,7 +258,9 @@ void VoltageCalibration::__acquire() {
 
 	for (gsl::index chunk{ 0 }; chunk < nrChunks; chunk++) {
 
+		auto cameraStart = m_phaseTimer.measure("camera start");
 		m_camera->startAcquisition(m_cameraSettings);
+		cameraStart.stop();
 
 		int chunkBegin = chunk * nrImages;
 		int chunkEnd = (chunk + 1) * nrImages - 1;
@@ -265,7 +271,9 @@ void VoltageCalibration::__acquire() {
 
 		// Set first mirror voltage already
 		m_ODTControl->setVoltage(m_acqSettings.voltages[chunkBegin]);
+		auto settle = m_phaseTimer.measure("settle");
 		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		settle.stop();
 
 		ACQ_VOLTAGES voltages;
 
@@ -285,46 +293,48 @@ void VoltageCalibration::__acquire() {
 			std::fill_n(voltages.mirror.begin() + i * samplesPerAngle + (size_t)chunkSize * samplesPerAngle, samplesPerAngle, m_acqSettings.voltages[i + chunkBegin].Uy);
 		}
 		// Apply voltages to NIDAQ board
+		auto voltageUpload = m_phaseTimer.measure("voltage upload");
 		m_ODTControl->setAcquisitionVoltages(voltages);
+		voltageUpload.stop();
 
-		int rank_data{ 3 };
-		hsize_t dims_data[3] = { 1, (hsize_t)m_cameraSettings.roi.height_binned, (hsize_t)m_cameraSettings.roi.width_binned };
+		// read all images of the chunk from the camera, the spots are located afterwards on all cores at once
+		auto bytesPerFrame = (int64_t)m_cameraSettings.roi.bytesPerFrame;
+		std::vector<std::byte> images(bytesPerFrame * chunkSize);
 		for (gsl::index i{ 0 }; i < chunkSize; i++) {
-
-			// read images from camera
-			std::vector<std::byte> images(m_cameraSettings.roi.bytesPerFrame);
-
-			for (gsl::index mm{ 0 }; mm < 1; mm++) {
-				if (m_abort) {
-					this->abortMode();
-					return;
-				}
-
-				// acquire images
-				int64_t pointerPos = (int64_t)m_cameraSettings.roi.bytesPerFrame * mm;
-				m_camera->getImageForAcquisition(&images[pointerPos], false);
+			if (m_abort) {
+				this->abortMode();
+				return;
 			}
 
-			// cast the image to type T
-			auto images_ = (std::vector<T> *) &images;
+			// acquire images
+			auto frame = m_phaseTimer.measure("frame");
+			m_camera->getImageForAcquisition(&images[bytesPerFrame * i], false);
+		}
 
-			// Extract spot position from camera image
-			auto iterator_max = std::max_element((*images_).begin(), (*images_).end());
-			auto index = std::distance((*images_).begin(), iterator_max);
-			if (*iterator_max > m_minimalIntensity) {
-				int y = m_cameraSettings.roi.height_binned - floor(index / m_cameraSettings.roi.width_binned);
-				int x = index % m_cameraSettings.roi.width_binned;
+		m_camera->stopAcquisition();
 
-				POINT2 pos = m_ODTControl->pixToMicroMeter({ (double)x, (double)y });
+		// Extract spot positions from camera images
+		auto spotLocation = m_phaseTimer.measure("spot location");
+		auto spotSettings = SPOT_SETTINGS{};
+		spotSettings.minimalIntensity = m_minimalIntensity;
+		auto spots = spotLocator::locate((const T*)&images[0], chunkSize, m_cameraSettings.roi.width_binned,
+			m_cameraSettings.roi.height_binned, spotSettings);
+		spotLocation.stop();
 
-				Ux_valid.push_back(m_acqSettings.voltages[i + chunkBegin].Ux);
-				Uy_valid.push_back(m_acqSettings.voltages[i + chunkBegin].Uy);
-				x_valid.push_back(pos.x);
-				y_valid.push_back(pos.y);
+		for (gsl::index i{ 0 }; i < chunkSize; i++) {
+			if (!spots[i].valid) {
+				continue;
 			}
-		}
+			auto y = m_cameraSettings.roi.height_binned - spots[i].y;
+			auto x = spots[i].x;
 
-		m_camera->stopAcquisition();
+			POINT2 pos = m_ODTControl->pixToMicroMeter({ x, y });
+
+			Ux_valid.push_back(m_acqSettings.voltages[i + chunkBegin].Ux);
+			Uy_valid.push_back(m_acqSettings.voltages[i + chunkBegin].Uy);
+			x_valid.push_back(pos.x);
+			y_valid.push_back(pos.y);
+		}
 	}
 
 	// Construct spatial calibration object
@@ -343,6 +353,8 @@ void VoltageCalibration::__acquire() {
 
 	m_ODTControl->setPreset(ScanPreset::SCAN_BRILLOUIN);
 
+	reportPhaseTimes(ACQUISITION_MODE::VOLTAGECALIBRATION);
+
 	setAcquisitionStatus(ACQUISITION_STATUS::FINISHED);
 }
 
@@ -52,7 +52,7 @@ private:
 	Camera*& m_camera;
 	ODTControl*& m_ODTControl;
 
-	double m_minimalIntensity{ 100 };		// [1] minimum peak intensity for valid peaks
+	double m_minimalIntensity{ 100 };		// [1] minimum peak intensity above the background for valid peaks
 
 	VoltageCalibrationData m_voltageCalibration;
 
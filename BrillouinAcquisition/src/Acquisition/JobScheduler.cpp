@@ -0,0 +1,248 @@
+#include "stdafx.h"
+#include "JobScheduler.h"
+#include "src/helper/logger.h"
+
+/*
+ * Public definitions
+ */
+
+JobScheduler::JobScheduler(QObject* parent, Acquisition* acquisition, ScanControl*& scanControl,
+	Brillouin*& brillouin, ODT*& odt, Fluorescence*& fluorescence, Autofocus*& autofocus)
+	: QObject(parent), m_acquisition(acquisition), m_scanControl(scanControl),
+	m_Brillouin(brillouin), m_ODT(odt), m_Fluorescence(fluorescence), m_Autofocus(autofocus) {}
+
+JobScheduler::~JobScheduler() {
+	if (m_roundTimer) {
+		m_roundTimer->stop();
+		m_roundTimer->deleteLater();
+	}
+}
+
+bool JobScheduler::isRunning() {
+	return m_running;
+}
+
+/*
+ * Aborts the experiment, this is called from the GUI thread while the acquisition thread might be busy with a job
+ */
+void JobScheduler::abort() {
+	m_abort = true;
+	auto mode = m_currentMode;
+	if (mode) {
+		mode->m_abort = true;
+	}
+	// if we wait for the next round, we can stop right away
+	QMetaObject::invokeMethod(
+		this,
+		[this]() {
+			if (m_running && m_roundTimer->isActive()) {
+				finish(true);
+			}
+		},
+		Qt::QueuedConnection
+	);
+}
+
+/*
+ * Public slots
+ */
+
+void JobScheduler::init() {
+	m_roundTimer = new QTimer();
+	m_roundTimer->setSingleShot(true);
+	m_roundTimer->setTimerType(Qt::PreciseTimer);
+	auto connection = QWidget::connect(
+		m_roundTimer,
+		&QTimer::timeout,
+		this,
+		&JobScheduler::runRound
+	);
+}
+
+void JobScheduler::start(const EXPERIMENT_PLAN& plan) {
+	if (m_running || !m_scanControl) {
+		return;
+	}
+	m_plan = plan;
+
+	m_tasks.clear();
+	if (m_plan.fluorescence && m_Fluorescence) {
+		m_tasks.push_back(TASK::FLUORESCENCE);
+	}
+	if (m_plan.odt) {
+		if (m_ODT) {
+			m_tasks.push_back(TASK::ODT);
+		} else {
+			qWarning(logWarning()) << "The microscope does not support ODT, the ODT jobs are skipped.";
+		}
+	}
+	if (m_plan.brillouin && m_Brillouin) {
+		m_tasks.push_back(TASK::BRILLOUIN);
+	}
+	if (m_tasks.empty()) {
+		qWarning(logWarning()) << "The experiment plan contains no modes to acquire.";
+		return;
+	}
+
+	auto savedPositions = m_scanControl->getSavedPositions();
+	m_positions.clear();
+	if (m_plan.positions.empty()) {
+		m_positions = savedPositions;
+	}
+	for (auto index : m_plan.positions) {
+		if (index >= 0 && index < (int)savedPositions.size()) {
+			m_positions.push_back(savedPositions[index]);
+		} else {
+			qWarning(logWarning()) << "There is no saved position" << index + 1 << ", it is skipped.";
+		}
+	}
+	// without saved positions we acquire at the current position
+	auto currentPosition = m_scanControl->getPosition();
+	if (m_positions.empty()) {
+		m_positions.push_back(currentPosition);
+	}
+
+	m_jobs = jobOrder::plan(m_positions, currentPosition, (int)m_tasks.size(), m_plan.costs);
+	qInfo(logInfo()) << "Experiment plan with" << m_jobs.size() << "jobs per round at" << m_positions.size() << "positions, switching presets and moving the stage take about"
+		<< jobOrder::duration(m_jobs, m_positions, currentPosition, m_plan.costs) << "s per round.";
+
+	m_abort = false;
+	m_running = true;
+	m_currentRound = 0;
+	emit(s_running(true));
+
+	m_experimentTimer.start();
+	runRound();
+}
+
+/*
+ * Private definitions
+ */
+
+void JobScheduler::runRound() {
+	if (!m_running) {
+		return;
+	}
+	auto jobCount = (int)m_jobs.size();
+	m_focused.assign(m_positions.size(), false);
+	for (gsl::index i{ 0 }; i < jobCount; i++) {
+		if (m_abort) {
+			finish(true);
+			return;
+		}
+		auto& job = m_jobs[i];
+		emit(s_jobStarted(m_currentRound + 1, m_plan.rounds, i + 1, jobCount, describe(m_tasks[job.task])));
+		if (!runJob(job)) {
+			finish(true);
+			return;
+		}
+	}
+
+	m_currentRound++;
+	if (m_currentRound >= m_plan.rounds) {
+		finish(false);
+		return;
+	}
+
+	// the rounds start at fixed intervals after the start of the first round
+	auto remaining = (qint64)(60e3 * m_plan.interval * m_currentRound) - m_experimentTimer.elapsed();
+	if (remaining < 0) {
+		qWarning(logWarning()) << "Round" << m_currentRound << "took longer than the interval, the next round starts immediately.";
+		remaining = 0;
+	}
+	emit(s_waitingForRound(m_currentRound + 1, (int)(1e-3 * remaining)));
+	m_roundTimer->start((int)remaining);
+}
+
+/*
+ * Moves the stage to the position of the job and acquires its mode, returns false if the job was aborted.
+ * A job whose position is not reached is skipped, since the mode would take the moving stage as its start position.
+ */
+bool JobScheduler::runJob(const JOB& job) {
+	auto position = m_positions[job.position];
+	if (!moveStage(position)) {
+		qWarning(logWarning()) << "The stage did not reach position" << job.position + 1 << ", the" << describe(m_tasks[job.task]).c_str()
+			<< "job is skipped.";
+		return !m_abort;
+	}
+
+	if (m_plan.autofocus && m_Autofocus && !m_focused[job.position]) {
+		m_currentMode = m_Autofocus;
+		m_Autofocus->startRepetitions();
+		if (m_currentMode->m_abort || m_abort) {
+			m_currentMode = nullptr;
+			return false;
+		}
+		// the following jobs and rounds start at the focused height
+		auto result = m_Autofocus->getResult();
+		if (result.valid) {
+			m_positions[job.position].z = result.z;
+		}
+		m_focused[job.position] = true;
+	}
+
+	switch (m_tasks[job.task]) {
+		case TASK::FLUORESCENCE:
+			m_currentMode = m_Fluorescence;
+			m_Fluorescence->startRepetitions(m_plan.fluorescenceChannels);
+			break;
+		case TASK::ODT:
+			m_currentMode = m_ODT;
+			m_ODT->startRepetitions();
+			break;
+		case TASK::BRILLOUIN:
+			m_currentMode = m_Brillouin;
+			m_Brillouin->acquireSingleRepetition();
+			break;
+	}
+	auto aborted = m_currentMode->m_abort;
+	m_currentMode = nullptr;
+	return !aborted && !m_abort;
+}
+
+/*
+ * Moves to the position on the thread of the scan control and waits until it is reached. The saved positions can be
+ * millimetres apart, so the timeout depends on the distance. A move which did not arrive is commanded once more.
+ */
+bool JobScheduler::moveStage(const POINT3& position) {
+	auto reached{ false };
+	auto move = [&]() {
+		try {
+			auto timeout = m_scanControl->getMoveTimeout(abs(m_scanControl->getPosition() - position));
+			for (gsl::index attempt{ 0 }; attempt < 2 && !reached; attempt++) {
+				reached = m_scanControl->moveTo(position, timeout);
+			}
+		} catch (...) {
+			// e.g. a _com_error of the Zeiss MTB, which must not escape into the event loop of the scan control
+			reached = false;
+		}
+	};
+	if (QThread::currentThread() == m_scanControl->thread()) {
+		move();
+	} else {
+		QMetaObject::invokeMethod(m_scanControl, move, Qt::BlockingQueuedConnection);
+	}
+	return reached;
+}
+
+void JobScheduler::finish(bool aborted) {
+	m_running = false;
+	m_roundTimer->stop();
+	if (aborted) {
+		qInfo(logInfo()) << "Experiment plan aborted in round" << m_currentRound + 1 << "after" << 1e-3 * m_experimentTimer.elapsed() << "s.";
+	} else {
+		qInfo(logInfo()) << "Experiment plan finished after" << 1e-3 * m_experimentTimer.elapsed() << "s.";
+	}
+	emit(s_running(false));
+}
+
+std::string JobScheduler::describe(TASK task) {
+	switch (task) {
+		case TASK::FLUORESCENCE:
+			return "Fluorescence";
+		case TASK::ODT:
+			return "ODT";
+		default:
+			return "Brillouin";
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include "AcquisitionModes/Autofocus.h"
+#include "AcquisitionModes/Brillouin.h"
+#include "AcquisitionModes/Fluorescence.h"
+#include "AcquisitionModes/ODT.h"
+#include "../lib/math/jobOrder.h"
+
+struct EXPERIMENT_PLAN {
+	bool fluorescence{ false };							// acquire fluorescence images at every position
+	std::vector<FLUORESCENCE_MODE> fluorescenceChannels;	// channels to acquire, empty acquires the enabled channels
+	bool odt{ false };									// acquire an ODT repetition at every position
+	bool brillouin{ true };								// acquire a Brillouin scan around every position
+	bool autofocus{ false };							// focus the brightfield image before the first job at every position
+	std::vector<int> positions;							// indices of the saved positions, empty uses all saved positions
+	int rounds{ 1 };									// [1]	number of times all jobs are acquired
+	double interval{ 30 };								// [min]	interval between the starts of two rounds
+	JOB_ORDER_COSTS costs;								// estimated costs used to order the jobs
+};
+
+/*
+ * Runs an experiment plan, which acquires the selected modes at the saved stage positions in one or more rounds.
+ *
+ * The jobs of a round run back-to-back in the acquisition thread, ordered to minimise preset switches and stage travel.
+ * Every job is written as a repetition of its mode to the currently opened file. The rounds start at fixed intervals
+ * measured from the start of the first round, so that a long round does not delay the following ones. With autofocus,
+ * every position is focused once per round and keeps the focused height for the following jobs and rounds.
+ */
+class JobScheduler : public QObject {
+	Q_OBJECT
+
+public:
+	JobScheduler(QObject* parent, Acquisition* acquisition, ScanControl*& scanControl,
+		Brillouin*& brillouin, ODT*& odt, Fluorescence*& fluorescence, Autofocus*& autofocus);
+	~JobScheduler();
+
+	bool isRunning();
+	void abort();
+
+public slots:
+	void init();
+	void start(const EXPERIMENT_PLAN& plan);
+
+private:
+	enum class TASK {
+		FLUORESCENCE,
+		ODT,
+		BRILLOUIN
+	};
+
+	void runRound();
+	bool runJob(const JOB& job);
+	bool moveStage(const POINT3& position);
+	void finish(bool aborted);
+	std::string describe(TASK task);
+
+	Acquisition* m_acquisition{ nullptr };
+	ScanControl*& m_scanControl;
+	Brillouin*& m_Brillouin;
+	ODT*& m_ODT;
+	Fluorescence*& m_Fluorescence;
+	Autofocus*& m_Autofocus;
+
+	EXPERIMENT_PLAN m_plan;
+	std::vector<TASK> m_tasks;				// the modes to acquire, in the order of the plan
+	std::vector<POINT3> m_positions;		// [µm]	absolute positions of the jobs
+	std::vector<JOB> m_jobs;				// jobs of a round in the order they are acquired
+	std::vector<bool> m_focused;			// the positions already focused in the current round
+
+	bool m_running{ false };
+	bool m_abort{ false };
+	AcquisitionMode* m_currentMode{ nullptr };	// the mode of the job which is currently acquired
+	int m_currentRound{ 0 };
+	QElapsedTimer m_experimentTimer;		// measures the time since the start of the first round
+	QTimer* m_roundTimer{ nullptr };
+
+signals:
+	void s_running(bool);
+	void s_jobStarted(int round, int rounds, int job, int jobs, std::string description);
+	void s_waitingForRound(int round, int seconds);	// the next round and the time until it starts
+};
+
+#endif // JOBSCHEDULER_H
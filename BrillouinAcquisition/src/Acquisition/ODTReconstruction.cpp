@@ -0,0 +1,348 @@
+#include "stdafx.h"
+#include "ODTReconstruction.h"
+#include "../lib/parallel.h"
+
+/*
+ * Public definitions
+ */
+
+ODTReconstruction::ODTReconstruction(int threadCount) : m_threadCount(threadCount) {
+	// leave one core for the acquisition itself
+	if (m_threadCount < 1) {
+		m_threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 1);
+	}
+}
+
+ODTReconstruction::~ODTReconstruction() {
+	releaseSpectrum();
+}
+
+void ODTReconstruction::setSettings(const ODT_RECONSTRUCTION_SETTINGS& settings) {
+	m_settings = settings;
+	m_settings.binning = std::max(m_settings.binning, 1);
+}
+
+ODT_RECONSTRUCTION_SETTINGS ODTReconstruction::getSettings() {
+	return m_settings;
+}
+
+/*
+ * Reconstructs the refractive index from the given stack, the voltages have to be in the order the angles were acquired
+ */
+ODT_VOLUME ODTReconstruction::reconstruct(const PHASE_STACK& stack, const std::vector<VOLTAGE2>& voltages) {
+	auto volume = ODT_VOLUME{};
+	auto angles = std::min((gsl::index)stack.angles, (gsl::index)voltages.size());
+	auto dim_field = std::min(stack.dim_x, stack.dim_y);
+	dim_field -= dim_field % m_settings.binning;
+	if (angles < 1 || dim_field < m_settings.binning || stack.logAmplitude.size() != stack.phase.size()) {
+		return volume;
+	}
+	initialize(dim_field, dim_field / m_settings.binning);
+	m_offset_x = (stack.dim_x - dim_field) / 2;
+	m_offset_y = (stack.dim_y - dim_field) / 2;
+
+	// Determine the illumination of every angle
+	auto illuminations = std::vector<ILLUMINATION>(angles);
+	runParallel(angles, [this, &stack, &illuminations](WORKSPACE&, gsl::index angle) {
+		illuminations[angle] = fitRamp(stack, angle);
+	});
+	volume.calibrated = calibrateIllumination(illuminations, voltages);
+
+	// Map the spectra of all angles onto their Ewald spheres
+	auto voxels = (gsl::index)m_dim * m_dim * m_dim;
+	std::fill_n(&m_spectrum[0][0], 2 * voxels, 0.0);
+	std::fill(std::begin(m_counts), std::end(m_counts), 0.0f);
+	runParallel(angles, [this, &stack, &illuminations](WORKSPACE& workspace, gsl::index angle) {
+		getField(workspace, stack, angle, illuminations[angle]);
+		fftw_execute(workspace.FFT);
+		mapSpectrum(workspace, illuminations[angle]);
+	});
+
+	for (gsl::index i{ 0 }; i < voxels; i++) {
+		if (m_counts[i] > 0) {
+			m_spectrum[i][0] /= m_counts[i];
+			m_spectrum[i][1] /= m_counts[i];
+		}
+	}
+	fftw_execute(m_IFFT);
+
+	// Convert the scattering potential to the refractive index and move the focal plane to the center
+	auto length = m_dim_field * m_settings.pixelSize;
+	auto norm = 1 / pow(length, 3);
+	auto k0 = 2 * M_PI / phase::LAMBDA;
+	auto mediumIndex2 = pow(m_settings.mediumIndex, 2);
+
+	volume.dim = m_dim;
+	volume.voxelSize = length / m_dim;
+	volume.angles = angles;
+	volume.index.resize(voxels);
+	auto plane = (gsl::index)m_dim * m_dim;
+	for (gsl::index z{ 0 }; z < m_dim; z++) {
+		auto source = ((z + m_dim - m_dim / 2) % m_dim) * plane;
+		for (gsl::index i{ 0 }; i < plane; i++) {
+			auto potential = norm * m_spectrum[source + i][0];
+			volume.index[z * plane + i] = sqrt(std::max(mediumIndex2 + potential / pow(k0, 2), 0.0));
+		}
+	}
+
+	// the spectrum is several times larger than the volume and only needed during the reconstruction
+	releaseSpectrum();
+
+	return volume;
+}
+
+/*
+ * Extracts the three central planes of the volume
+ */
+ODT_SLICES ODTReconstruction::getSlices(const ODT_VOLUME& volume) {
+	auto slices = ODT_SLICES{ volume.dim, volume.voxelSize };
+	gsl::index dim = volume.dim;
+	if (dim < 1 || volume.index.size() != (size_t)dim * dim * dim) {
+		return slices;
+	}
+	auto center = dim / 2;
+	slices.xy.resize((size_t)dim * dim);
+	slices.xz.resize((size_t)dim * dim);
+	slices.yz.resize((size_t)dim * dim);
+	for (gsl::index i{ 0 }; i < dim; i++) {
+		for (gsl::index j{ 0 }; j < dim; j++) {
+			slices.xy[i * dim + j] = volume.index[(center * dim + i) * dim + j];
+			slices.xz[i * dim + j] = volume.index[(i * dim + center) * dim + j];
+			slices.yz[i * dim + j] = volume.index[(i * dim + j) * dim + center];
+		}
+	}
+	return slices;
+}
+
+int ODTReconstruction::getThreadCount() {
+	return m_threadCount;
+}
+
+/*
+ * Private definitions
+ */
+
+ODTReconstruction::WORKSPACE::WORKSPACE(int dim) {
+	field = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * dim * dim);
+	FFT = fftw_plan_dft_2d(dim, dim, field, field, FFTW_FORWARD, FFTW_ESTIMATE);
+}
+
+ODTReconstruction::WORKSPACE::~WORKSPACE() {
+	fftw_destroy_plan(FFT);
+	fftw_free(field);
+}
+
+/*
+ * The workspaces and the spectrum have to be recreated whenever the size of the images or the volume changes
+ */
+void ODTReconstruction::initialize(int dim_field, int dim) {
+	// FFTW plans must not be created concurrently, so all of them are created here
+	if (m_dim_field != dim_field || m_workspaces.empty()) {
+		m_dim_field = dim_field;
+		m_workspaces.clear();
+		for (gsl::index i{ 0 }; i < m_threadCount; i++) {
+			m_workspaces.push_back(std::make_unique<WORKSPACE>(dim_field));
+		}
+	}
+
+	if (m_dim != dim || !m_spectrum) {
+		m_dim = dim;
+		releaseSpectrum();
+		auto voxels = (size_t)dim * dim * dim;
+		m_spectrum = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * voxels);
+		m_counts.resize(voxels);
+
+		// only the volume is transformed by several threads, all other plans stay single-threaded
+		fftw_plan_with_nthreads(m_threadCount);
+		m_IFFT = fftw_plan_dft_3d(dim, dim, dim, m_spectrum, m_spectrum, FFTW_BACKWARD, FFTW_ESTIMATE);
+		fftw_plan_with_nthreads(1);
+	}
+}
+
+void ODTReconstruction::releaseSpectrum() {
+	if (m_IFFT) {
+		fftw_destroy_plan(m_IFFT);
+		m_IFFT = nullptr;
+	}
+	if (m_spectrum) {
+		fftw_free(m_spectrum);
+		m_spectrum = nullptr;
+	}
+	m_counts = std::vector<float>{};
+}
+
+/*
+ * Every worker uses its own workspace
+ */
+template <typename Function>
+void ODTReconstruction::runParallel(gsl::index count, Function work) {
+	parallel::forEach(count, (int)m_workspaces.size(), [this, &work](gsl::index worker, gsl::index index) {
+		work(*m_workspaces[worker], index);
+	});
+}
+
+/*
+ * Fits a plane to the phase of the cropped square, the coordinates are centered so the slopes and the mean decouple
+ */
+ODTReconstruction::ILLUMINATION ODTReconstruction::fitRamp(const PHASE_STACK& stack, gsl::index angle) {
+	auto illumination = ILLUMINATION{};
+	auto center = (m_dim_field - 1) / 2.0;
+	auto phase = &stack.phase[angle * stack.dim_x * stack.dim_y];
+
+	double sum{ 0 }, sum_x{ 0 }, sum_y{ 0 };
+	for (gsl::index y{ 0 }; y < m_dim_field; y++) {
+		auto row = phase + (y + m_offset_y) * stack.dim_x + m_offset_x;
+		double sum_row{ 0 };
+		for (gsl::index x{ 0 }; x < m_dim_field; x++) {
+			sum_row += row[x];
+			sum_x += (x - center) * row[x];
+		}
+		sum += sum_row;
+		sum_y += (y - center) * sum_row;
+	}
+
+	// sum of (x - center)^2 over the whole square
+	auto norm = (double)m_dim_field * m_dim_field * (pow(m_dim_field, 2) - 1) / 12;
+	illumination.ramp_x = sum_x / norm;
+	illumination.ramp_y = sum_y / norm;
+	illumination.offset = sum / pow(m_dim_field, 2);
+	return illumination;
+}
+
+/*
+ * Fits the measured ramps with an affine function of the mirror voltages. The constant part is caused by the tilt
+ * of the reference and is removed from the phase, but not added to the illumination. If the fit is not possible,
+ * the measured ramps are used directly. Returns whether the fit succeeded.
+ */
+bool ODTReconstruction::calibrateIllumination(std::vector<ILLUMINATION>& illuminations, const std::vector<VOLTAGE2>& voltages) {
+	auto A = std::array<std::array<double, 3>, 3>{};
+	auto b_x = std::array<double, 3>{};
+	auto b_y = std::array<double, 3>{};
+	for (gsl::index i{ 0 }; i < illuminations.size(); i++) {
+		auto u = std::array<double, 3>{ voltages[i].Ux, voltages[i].Uy, 1 };
+		for (gsl::index row{ 0 }; row < 3; row++) {
+			for (gsl::index col{ 0 }; col < 3; col++) {
+				A[row][col] += u[row] * u[col];
+			}
+			b_x[row] += u[row] * illuminations[i].ramp_x;
+			b_y[row] += u[row] * illuminations[i].ramp_y;
+		}
+	}
+	auto c_x = std::array<double, 3>{};
+	auto c_y = std::array<double, 3>{};
+	auto calibrated = illuminations.size() >= 3 && solve(A, b_x, c_x) && solve(A, b_y, c_y);
+
+	auto k0 = 2 * M_PI / phase::LAMBDA;
+	auto k_medium = k0 * m_settings.mediumIndex;
+	auto k_aperture = k0 * phase::NA;
+	for (gsl::index i{ 0 }; i < illuminations.size(); i++) {
+		auto& illumination = illuminations[i];
+		if (calibrated) {
+			auto tilt_x = c_x[0] * voltages[i].Ux + c_x[1] * voltages[i].Uy;
+			auto tilt_y = c_y[0] * voltages[i].Ux + c_y[1] * voltages[i].Uy;
+			illumination.ramp_x = tilt_x + c_x[2];
+			illumination.ramp_y = tilt_y + c_y[2];
+			illumination.kx = tilt_x / m_settings.pixelSize;
+			illumination.ky = tilt_y / m_settings.pixelSize;
+		} else {
+			illumination.kx = illumination.ramp_x / m_settings.pixelSize;
+			illumination.ky = illumination.ramp_y / m_settings.pixelSize;
+		}
+
+		// the objective cannot transmit steeper illuminations
+		auto lateral = sqrt(pow(illumination.kx, 2) + pow(illumination.ky, 2));
+		if (lateral > k_aperture) {
+			illumination.kx *= k_aperture / lateral;
+			illumination.ky *= k_aperture / lateral;
+		}
+		illumination.kz = sqrt(pow(k_medium, 2) - pow(illumination.kx, 2) - pow(illumination.ky, 2));
+	}
+	return calibrated;
+}
+
+/*
+ * Solves the linear system A * x = b by Cramer's rule
+ */
+bool ODTReconstruction::solve(const std::array<std::array<double, 3>, 3>& A, const std::array<double, 3>& b, std::array<double, 3>& x) {
+	auto determinant = [](const std::array<std::array<double, 3>, 3>& M) {
+		return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+			- M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+			+ M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+	};
+	auto det = determinant(A);
+	if (abs(det) < 1e-12) {
+		return false;
+	}
+	for (gsl::index col{ 0 }; col < 3; col++) {
+		auto M = A;
+		for (gsl::index row{ 0 }; row < 3; row++) {
+			M[row][col] = b[row];
+		}
+		x[col] = determinant(M) / det;
+	}
+	return true;
+}
+
+/*
+ * Writes the scattered field of the given angle relative to the illumination to workspace.field
+ */
+void ODTReconstruction::getField(WORKSPACE& workspace, const PHASE_STACK& stack, gsl::index angle, const ILLUMINATION& illumination) {
+	auto center = (m_dim_field - 1) / 2.0;
+	auto offset = angle * stack.dim_x * stack.dim_y;
+
+	for (gsl::index y{ 0 }; y < m_dim_field; y++) {
+		auto source = offset + (y + m_offset_y) * stack.dim_x + m_offset_x;
+		auto phase_y = illumination.ramp_y * (y - center) + illumination.offset;
+		for (gsl::index x{ 0 }; x < m_dim_field; x++) {
+			double phase = stack.phase[source + x] - illumination.ramp_x * (x - center) - phase_y;
+			double logAmplitude = stack.logAmplitude[source + x];
+			auto& value = workspace.field[x + m_dim_field * y];
+			if (m_settings.approximation == ODT_APPROXIMATION::RYTOV) {
+				value[0] = logAmplitude;
+				value[1] = phase;
+			} else {
+				auto amplitude = exp(logAmplitude);
+				value[0] = amplitude * cos(phase) - 1;
+				value[1] = amplitude * sin(phase);
+			}
+		}
+	}
+}
+
+/*
+ * Adds the spectrum in workspace.field to the spectrum of the scattering potential, following the Fourier diffraction
+ * theorem F(k - k_i) = -2i * k_z * U(k_x - k_ix, k_y - k_iy)
+ */
+void ODTReconstruction::mapSpectrum(WORKSPACE& workspace, const ILLUMINATION& illumination) {
+	gsl::index dim = m_dim;
+	gsl::index dim_field = m_dim_field;
+	auto dk = 2 * M_PI / (dim_field * m_settings.pixelSize);
+	auto k0 = 2 * M_PI / phase::LAMBDA;
+	auto k_medium2 = pow(k0 * m_settings.mediumIndex, 2);
+	auto k_aperture2 = pow(k0 * phase::NA, 2);
+	// the discrete transform lacks the area of a pixel
+	auto scale = 2 * pow(m_settings.pixelSize, 2);
+	auto wrap = [](gsl::index index, gsl::index size) { return index < 0 ? index + size : index; };
+
+	std::lock_guard<std::mutex> lockGuard(m_spectrumMutex);
+	for (gsl::index p_y{ -dim / 2 }; p_y < dim - dim / 2; p_y++) {
+		auto k_y = p_y * dk + illumination.ky;
+		for (gsl::index p_x{ -dim / 2 }; p_x < dim - dim / 2; p_x++) {
+			auto k_x = p_x * dk + illumination.kx;
+			auto lateral2 = pow(k_x, 2) + pow(k_y, 2);
+			if (lateral2 > k_aperture2) {
+				continue;
+			}
+			auto k_z = sqrt(k_medium2 - lateral2);
+			auto p_z = (gsl::index)lround((k_z - illumination.kz) / dk);
+			if (p_z < -dim / 2 || p_z >= dim - dim / 2) {
+				continue;
+			}
+			auto source = wrap(p_y, dim_field) * dim_field + wrap(p_x, dim_field);
+			auto target = (wrap(p_z, dim) * dim + wrap(p_y, dim)) * dim + wrap(p_x, dim);
+			m_spectrum[target][0] += scale * k_z * workspace.field[source][1];
+			m_spectrum[target][1] -= scale * k_z * workspace.field[source][0];
+			m_counts[target]++;
+		}
+	}
+}
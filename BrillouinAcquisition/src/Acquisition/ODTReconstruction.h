@@ -0,0 +1,115 @@
+#ifndef ODTRECONSTRUCTION_H
+#define ODTRECONSTRUCTION_H
+
+#include "PhaseRetrieval.h"
+#include "../Devices/ScanControls/ODTControl.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+enum class ODT_APPROXIMATION {
+	RYTOV,
+	BORN
+};
+
+struct ODT_RECONSTRUCTION_SETTINGS {
+	ODT_APPROXIMATION approximation{ ODT_APPROXIMATION::RYTOV };
+	int binning{ 4 };						// [1]	number of camera pixels per voxel edge
+	double pixelSize{ phase::PIXEL_SIZE };	// [µm]	pixel size of the phase images in the sample plane
+	double mediumIndex{ 1.337 };			// [1]	refractive index of the medium
+};
+
+struct ODT_VOLUME {
+	int dim{ 0 };						// [1]	number of voxels in every direction
+	double voxelSize{ 0 };				// [µm]	edge length of a voxel
+	int angles{ 0 };					// [1]	number of angles mapped into the volume
+	bool calibrated{ false };			// the illumination angles were fitted to the mirror voltages
+	std::vector<float> index;			// [1]	refractive index, [z, y, x] in row-major order, focal plane at z = dim / 2
+};
+
+struct ODT_SLICES {
+	int dim{ 0 };						// [1]	number of voxels in every direction
+	double voxelSize{ 0 };				// [µm]	edge length of a voxel
+	std::vector<float> xy;				// [1]	refractive index in the focal plane, [y, x]
+	std::vector<float> xz;				// [1]	refractive index in the central xz-plane, [z, x]
+	std::vector<float> yz;				// [1]	refractive index in the central yz-plane, [z, y]
+};
+
+/*
+ * Reconstructs the refractive index of the sample from the phase and amplitude of all angles of an ODT acquisition.
+ *
+ * The illumination of every angle is taken from the phase ramp it leaves in the phase image. The ramps are fitted
+ * against the mirror voltages, so that the lateral wave vector of every angle follows from its voltage, zero volts
+ * being normal incidence. The field of every angle is transformed by its own worker and mapped onto the Ewald sphere
+ * in the three-dimensional spectrum of the scattering potential, where overlapping contributions are averaged.
+ * A single multithreaded inverse FFT yields the scattering potential and thereby the refractive index.
+ *
+ * Only the part of the spectrum fitting into the volume is used, so binning low-pass filters the field instead of
+ * aliasing it. The spectrum is freed after every reconstruction, the workspaces are kept for the next acquisition.
+ * FFTW has to be initialised for threads before the first reconstruction.
+ */
+class ODTReconstruction {
+
+public:
+	ODTReconstruction(int threadCount = 0);
+	~ODTReconstruction();
+
+	void setSettings(const ODT_RECONSTRUCTION_SETTINGS& settings);
+	ODT_RECONSTRUCTION_SETTINGS getSettings();
+
+	ODT_VOLUME reconstruct(const PHASE_STACK& stack, const std::vector<VOLTAGE2>& voltages);
+
+	static ODT_SLICES getSlices(const ODT_VOLUME& volume);
+
+	int getThreadCount();
+
+private:
+	struct WORKSPACE {
+		WORKSPACE(int dim);
+		~WORKSPACE();
+
+		fftw_complex* field{ nullptr };
+		fftw_plan FFT{ nullptr };			// in-place forward transform of the field
+	};
+
+	struct ILLUMINATION {
+		double ramp_x{ 0 };		// [rad/pix]	phase gradient the illumination leaves in the phase image
+		double ramp_y{ 0 };
+		double offset{ 0 };		// [rad]	mean phase of the image
+		double kx{ 0 };			// [rad/µm]	wave vector of the illumination in the medium
+		double ky{ 0 };
+		double kz{ 0 };
+	};
+
+	void initialize(int dim_field, int dim);
+	void releaseSpectrum();
+
+	template <typename Function>
+	void runParallel(gsl::index count, Function work);
+
+	ILLUMINATION fitRamp(const PHASE_STACK& stack, gsl::index angle);
+	bool calibrateIllumination(std::vector<ILLUMINATION>& illuminations, const std::vector<VOLTAGE2>& voltages);
+	static bool solve(const std::array<std::array<double, 3>, 3>& A, const std::array<double, 3>& b, std::array<double, 3>& x);
+
+	void getField(WORKSPACE& workspace, const PHASE_STACK& stack, gsl::index angle, const ILLUMINATION& illumination);
+	void mapSpectrum(WORKSPACE& workspace, const ILLUMINATION& illumination);
+
+	int m_threadCount{ 1 };
+	std::vector<std::unique_ptr<WORKSPACE>> m_workspaces;
+
+	ODT_RECONSTRUCTION_SETTINGS m_settings;
+
+	int m_dim_field{ 0 };					// [pix]	edge length of the square cropped from the phase images
+	int m_offset_x{ 0 };					// [pix]	position of the cropped square in the phase images
+	int m_offset_y{ 0 };
+	int m_dim{ 0 };							// [1]	number of voxels in every direction
+
+	fftw_complex* m_spectrum{ nullptr };	// spectrum of the scattering potential, FFTW order
+	fftw_plan m_IFFT{ nullptr };			// in-place, multithreaded inverse transform of the spectrum
+	std::vector<float> m_counts;			// [1]	number of contributions to every voxel of the spectrum
+	std::mutex m_spectrumMutex;
+};
+
+#endif // ODTRECONSTRUCTION_H
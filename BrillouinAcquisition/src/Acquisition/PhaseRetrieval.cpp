@@ -0,0 +1,240 @@
+#include "stdafx.h"
+#include "PhaseRetrieval.h"
+#include "../lib/parallel.h"
+
+/*
+ * Public definitions
+ */
+
+PhaseRetrieval::PhaseRetrieval(int threadCount) : m_threadCount(threadCount) {
+	// leave one core for the acquisition itself
+	if (m_threadCount < 1) {
+		m_threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 1);
+	}
+}
+
+PhaseRetrieval::~PhaseRetrieval() {
+}
+
+/*
+ * Uses the given image of an empty field of view to locate the carrier and to correct the phase of all angles
+ */
+void PhaseRetrieval::setBackground(const std::byte* image, const std::string& dataType, int dim_x, int dim_y) {
+	if (dataType == "unsigned short") {
+		__setBackground((const unsigned short*)image, dim_x, dim_y);
+	} else if (dataType == "unsigned char") {
+		__setBackground((const unsigned char*)image, dim_x, dim_y);
+	}
+}
+
+void PhaseRetrieval::clearBackground() {
+	m_background.clear();
+}
+
+void PhaseRetrieval::setDownsampling(int downsampling) {
+	m_downsampling = std::max(downsampling, 1);
+}
+
+/*
+ * Calculates the unwrapped phase of all angles of the given stack, which is ordered [angle, y, x]
+ */
+PHASE_STACK PhaseRetrieval::calculate(const std::byte* images, const std::string& dataType, int angles, int dim_x, int dim_y) {
+	if (dataType == "unsigned short") {
+		return __calculate((const unsigned short*)images, angles, dim_x, dim_y);
+	} else if (dataType == "unsigned char") {
+		return __calculate((const unsigned char*)images, angles, dim_x, dim_y);
+	}
+	return PHASE_STACK{};
+}
+
+int PhaseRetrieval::getThreadCount() {
+	return m_threadCount;
+}
+
+/*
+ * Private definitions
+ */
+
+PhaseRetrieval::WORKSPACE::WORKSPACE(int dim_x, int dim_y) {
+	auto N = (size_t)dim_x * dim_y;
+	in = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+	out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+	// the forward transform writes the spectrum to out, the masked spectrum is transformed back from in
+	FFT = fftw_plan_dft_2d(dim_y, dim_x, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
+	IFFT = fftw_plan_dft_2d(dim_y, dim_x, in, out, FFTW_BACKWARD, FFTW_ESTIMATE);
+}
+
+PhaseRetrieval::WORKSPACE::~WORKSPACE() {
+	fftw_destroy_plan(FFT);
+	fftw_destroy_plan(IFFT);
+	fftw_free(in);
+	fftw_free(out);
+}
+
+/*
+ * The workspaces have to be recreated whenever the image size changes
+ */
+void PhaseRetrieval::initialize(int dim_x, int dim_y) {
+	if (m_dim_x == dim_x && m_dim_y == dim_y && !m_workspaces.empty()) {
+		return;
+	}
+	m_dim_x = dim_x;
+	m_dim_y = dim_y;
+	m_mask = phase::createMask(dim_x, dim_y, phase::maskRadius(dim_x));
+	m_background.clear();
+
+	// FFTW plans must not be created concurrently, so all of them are created here
+	m_workspaces.clear();
+	for (gsl::index i{ 0 }; i < m_threadCount; i++) {
+		m_workspaces.push_back(std::make_unique<WORKSPACE>(dim_x, dim_y));
+	}
+}
+
+template <typename T>
+void PhaseRetrieval::locateCarrier(WORKSPACE& workspace, const T* image) {
+	for (gsl::index i{ 0 }; i < (gsl::index)m_dim_x * m_dim_y; i++) {
+		workspace.in[i][0] = image[i];
+		workspace.in[i][1] = 0.0;
+	}
+	fftw_execute(workspace.FFT);
+
+	phase::findCarrier(workspace.out, m_dim_x, m_dim_y, m_max_x, m_max_y);
+}
+
+/*
+ * Calculates the complex field of the given hologram, it is stored in workspace.out
+ */
+template <typename T>
+void PhaseRetrieval::getField(WORKSPACE& workspace, const T* image) {
+	for (gsl::index i{ 0 }; i < (gsl::index)m_dim_x * m_dim_y; i++) {
+		workspace.in[i][0] = image[i];
+		workspace.in[i][1] = 0.0;
+	}
+	fftw_execute(workspace.FFT);
+
+	// Shift the carrier to the center and mask everything outside of the aperture in one pass
+	for (gsl::index y{ 0 }; y < m_dim_y; y++) {
+		auto y_source = ((y + m_max_y) % m_dim_y + m_dim_y) % m_dim_y;
+		for (gsl::index x{ 0 }; x < m_dim_x; x++) {
+			auto x_source = ((x + m_max_x) % m_dim_x + m_dim_x) % m_dim_x;
+			auto index = x + m_dim_x * y;
+			auto source = x_source + m_dim_x * y_source;
+			workspace.in[index][0] = m_mask[index] * workspace.out[source][0];
+			workspace.in[index][1] = m_mask[index] * workspace.out[source][1];
+		}
+	}
+	fftw_execute(workspace.IFFT);
+}
+
+/*
+ * Calculates the logarithm of the amplitude of the field in workspace.out relative to its median
+ */
+void PhaseRetrieval::getLogAmplitude(WORKSPACE& workspace, float* logAmplitude) {
+	auto N = (gsl::index)m_dim_x * m_dim_y;
+
+	// Divide by background, the intensity is clamped to keep the logarithm finite
+	for (gsl::index i{ 0 }; i < N; i++) {
+		double intensity = pow(workspace.out[i][0], 2) + pow(workspace.out[i][1], 2);
+		if (!m_background.empty()) {
+			intensity /= std::max(std::norm(m_background[i]), 1e-12);
+		}
+		logAmplitude[i] = 0.5 * log(std::max(intensity, 1e-12));
+	}
+
+	workspace.amplitude.assign(logAmplitude, logAmplitude + N);
+	auto median = simplemath::median(std::begin(workspace.amplitude), std::end(workspace.amplitude));
+	for (gsl::index i{ 0 }; i < N; i++) {
+		logAmplitude[i] -= median;
+	}
+}
+
+/*
+ * Calculates the unwrapped phase of the field in workspace.out
+ */
+void PhaseRetrieval::getPhase(WORKSPACE& workspace, float* phase) {
+	auto N = (gsl::index)m_dim_x * m_dim_y;
+
+	// Divide by background and calculate the phase angle
+	if (m_background.empty()) {
+		for (gsl::index i{ 0 }; i < N; i++) {
+			phase[i] = atan2(workspace.out[i][1], workspace.out[i][0]);
+		}
+	} else {
+		for (gsl::index i{ 0 }; i < N; i++) {
+			double a = workspace.out[i][0];
+			double b = workspace.out[i][1];
+			double c = m_background[i].real();
+			double d = m_background[i].imag();
+			phase[i] = atan2((b * c - a * d), (a * c + b * d));
+		}
+	}
+
+	// Downsample the image to speed up unwrapping
+	int dim_x_new{ m_dim_x / m_downsampling };
+	int dim_y_new{ m_dim_y / m_downsampling };
+	workspace.wrapped.resize((size_t)dim_x_new * dim_y_new);
+	workspace.unwrapped.resize((size_t)dim_x_new * dim_y_new);
+	if (m_downsampling > 1) {
+		xsample::resample(phase, &workspace.wrapped[0], m_dim_x, m_dim_y, dim_x_new, dim_y_new, RESAMPLE_MODE::NEAREST);
+	} else {
+		std::copy(phase, phase + N, std::begin(workspace.wrapped));
+	}
+
+	workspace.unwrapper.unwrap2DWrapped(&workspace.wrapped[0], &workspace.unwrapped[0], dim_x_new, dim_y_new, false, false);
+
+	// Subtract median value, the wrapped phase is not needed anymore
+	workspace.wrapped = workspace.unwrapped;
+	auto median = simplemath::median(std::begin(workspace.wrapped), std::end(workspace.wrapped));
+	for (auto& value : workspace.unwrapped) {
+		value -= median;
+	}
+
+	// Upsample the image to match input resolution
+	if (m_downsampling > 1) {
+		xsample::resample(&workspace.unwrapped[0], phase, dim_x_new, dim_y_new, m_dim_x, m_dim_y, RESAMPLE_MODE::LINEAR);
+	} else {
+		std::copy(std::begin(workspace.unwrapped), std::end(workspace.unwrapped), phase);
+	}
+}
+
+template <typename T>
+void PhaseRetrieval::__setBackground(const T* image, int dim_x, int dim_y) {
+	initialize(dim_x, dim_y);
+
+	auto& workspace = *m_workspaces[0];
+	locateCarrier(workspace, image);
+	getField(workspace, image);
+
+	auto N = (gsl::index)dim_x * dim_y;
+	m_background.resize(N);
+	for (gsl::index i{ 0 }; i < N; i++) {
+		m_background[i] = { workspace.out[i][0], workspace.out[i][1] };
+	}
+}
+
+template <typename T>
+PHASE_STACK PhaseRetrieval::__calculate(const T* images, int angles, int dim_x, int dim_y) {
+	auto stack = PHASE_STACK{ angles, dim_x, dim_y };
+	if (angles < 1 || dim_x < 1 || dim_y < 1) {
+		return stack;
+	}
+	initialize(dim_x, dim_y);
+	stack.phase.resize((size_t)angles * dim_x * dim_y);
+	stack.logAmplitude.resize((size_t)angles * dim_x * dim_y);
+
+	// Without a background, the carrier of the first angle is used for all angles
+	if (m_background.empty()) {
+		locateCarrier(*m_workspaces[0], images);
+	}
+
+	// every worker uses its own workspace
+	auto pixels = (gsl::index)dim_x * dim_y;
+	parallel::forEach(angles, (int)m_workspaces.size(), [this, images, pixels, &stack](gsl::index worker, gsl::index angle) {
+		auto& workspace = *m_workspaces[worker];
+		getField(workspace, images + angle * pixels);
+		getLogAmplitude(workspace, &stack.logAmplitude[angle * pixels]);
+		getPhase(workspace, &stack.phase[angle * pixels]);
+	});
+
+	return stack;
+}
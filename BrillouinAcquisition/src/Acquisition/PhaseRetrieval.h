@@ -0,0 +1,86 @@
+#ifndef PHASERETRIEVAL_H
+#define PHASERETRIEVAL_H
+
+#include "../lib/math/phase.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+
+struct PHASE_STACK {
+	int angles{ 0 };			// [1]		number of angles
+	int dim_x{ 0 };				// [pix]	width of the phase images
+	int dim_y{ 0 };				// [pix]	height of the phase images
+	std::vector<float> phase;	// [rad]	unwrapped phase of all angles, [angle, y, x] in row-major order
+	std::vector<float> logAmplitude;	// [1]	logarithm of the amplitude of all angles, same order as the phase
+};
+
+/*
+ * Retrieves the quantitative phase of all angles of an ODT acquisition at once.
+ *
+ * The angles are distributed over a pool of worker threads. Every worker owns its FFT buffers, FFTW plans and
+ * phase unwrapper, the plans are created before the workers start, since FFTW only allows to execute plans
+ * concurrently. The position of the carrier and the background field are determined once and shared by all angles.
+ * Besides the phase, the logarithm of the amplitude is kept, since the tomographic reconstruction needs the full field.
+ * Without a background image, the carrier is located in the first angle and the phase is not corrected for the
+ * background.
+ */
+class PhaseRetrieval {
+
+public:
+	PhaseRetrieval(int threadCount = 0);
+	~PhaseRetrieval();
+
+	void setBackground(const std::byte* image, const std::string& dataType, int dim_x, int dim_y);
+	void clearBackground();
+
+	void setDownsampling(int downsampling);
+
+	PHASE_STACK calculate(const std::byte* images, const std::string& dataType, int angles, int dim_x, int dim_y);
+
+	int getThreadCount();
+
+private:
+	struct WORKSPACE {
+		WORKSPACE(int dim_x, int dim_y);
+		~WORKSPACE();
+
+		fftw_complex* in{ nullptr };
+		fftw_complex* out{ nullptr };
+		fftw_plan FFT{ nullptr };
+		fftw_plan IFFT{ nullptr };
+		unwrap2Wrapper unwrapper;
+		std::vector<float> wrapped;			// wrapped phase at the resolution used for unwrapping
+		std::vector<float> unwrapped;		// unwrapped phase at the resolution used for unwrapping
+		std::vector<float> amplitude;		// copy of the log-amplitude for calculating its median
+	};
+
+	void initialize(int dim_x, int dim_y);
+
+	template <typename T>
+	void locateCarrier(WORKSPACE& workspace, const T* image);
+	template <typename T>
+	void getField(WORKSPACE& workspace, const T* image);
+	void getLogAmplitude(WORKSPACE& workspace, float* logAmplitude);
+	void getPhase(WORKSPACE& workspace, float* phase);
+
+	template <typename T>
+	void __setBackground(const T* image, int dim_x, int dim_y);
+	template <typename T>
+	PHASE_STACK __calculate(const T* images, int angles, int dim_x, int dim_y);
+
+	int m_threadCount{ 1 };
+	std::vector<std::unique_ptr<WORKSPACE>> m_workspaces;
+
+	int m_dim_x{ 0 };
+	int m_dim_y{ 0 };
+	int m_downsampling{ 1 };				// [1]	factor by which the phase is downsampled for unwrapping
+	std::vector<int> m_mask;				// aperture of the objective in the Fourier space
+
+	int m_max_x{ 0 };						// [pix]	shift of the carrier peak from the center of the spectrum
+	int m_max_y{ 0 };
+	std::vector<std::complex<double>> m_background;	// background field, empty if no background image was set
+};
+
+#endif // PHASERETRIEVAL_H
@@ -0,0 +1,185 @@
+#include "stdafx.h"
+#include "SpectrumAnalysis.h"
+
+/*
+ * Public definitions
+ */
+
+SpectrumAnalysis::SpectrumAnalysis(int threadCount) : m_threadCount(threadCount) {
+	// leave one core for the acquisition itself
+	if (m_threadCount < 1) {
+		m_threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 1);
+	}
+}
+
+SpectrumAnalysis::~SpectrumAnalysis() {
+	stop();
+}
+
+void SpectrumAnalysis::start(const SPECTRUM_LINE& line, int width, int height, const std::string& dataType) {
+	stop();
+
+	m_extractor = spectrumExtractor(line, width, height);
+	m_dataType = dataType;
+	m_pixelsPerFrame = (gsl::index)width * height;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_queue.clear();
+		m_stop = false;
+		m_statistics = SPECTRUM_STATISTICS{};
+		m_start = std::chrono::steady_clock::now();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_resultMutex);
+		m_results.clear();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_calibrationMutex);
+		m_calibration = VIPA_CALIBRATION{};
+	}
+
+	for (gsl::index i{ 0 }; i < m_threadCount; i++) {
+		m_workers.emplace_back(&SpectrumAnalysis::work, this);
+	}
+}
+
+/*
+ * Waits until all queued spectra are fitted and stops the workers
+ */
+void SpectrumAnalysis::stop() {
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_stop = true;
+	}
+	m_queueChanged.notify_all();
+	for (auto& worker : m_workers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+	m_workers.clear();
+}
+
+/*
+ * Extracts the mean spectrum of the given frames and queues it for fitting
+ */
+void SpectrumAnalysis::enqueue(const INDEX3& index, const std::byte* frames, int frameCount) {
+	if (m_dataType == "unsigned short") {
+		extract(index, (const unsigned short*)frames, frameCount);
+	} else if (m_dataType == "unsigned char") {
+		extract(index, (const unsigned char*)frames, frameCount);
+	} else if (m_dataType == "unsigned int") {
+		extract(index, (const unsigned int*)frames, frameCount);
+	}
+}
+
+void SpectrumAnalysis::enqueueAccumulated(const INDEX3& index, const unsigned int* sum) {
+	extract(index, sum, 1);
+}
+
+/*
+ * Sets the calibration used for the spectra fitted from now on, the spectra are always evaluated with the latest calibration
+ */
+void SpectrumAnalysis::setCalibration(const VIPA_CALIBRATION& calibration) {
+	std::lock_guard<std::mutex> lock(m_calibrationMutex);
+	m_calibration = calibration;
+}
+
+/*
+ * Returns the results fitted since the last call
+ */
+std::vector<SPECTRUM_RESULT> SpectrumAnalysis::takeResults() {
+	std::lock_guard<std::mutex> lock(m_resultMutex);
+	auto results = std::vector<SPECTRUM_RESULT>{};
+	results.swap(m_results);
+	return results;
+}
+
+SPECTRUM_STATISTICS SpectrumAnalysis::getStatistics() {
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	auto statistics = m_statistics;
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	statistics.fitsPerSecond = (elapsed > 0) ? statistics.fitted / elapsed : 0;
+	return statistics;
+}
+
+int SpectrumAnalysis::getThreadCount() {
+	return m_threadCount;
+}
+
+/*
+ * Private definitions
+ */
+
+template <typename T>
+void SpectrumAnalysis::extract(const INDEX3& index, const T* frames, int frameCount) {
+	auto job = JOB{ index, std::vector<double>(m_extractor.samples()) };
+	m_extractor.extract(frames, frameCount, m_pixelsPerFrame, job.spectrum.data());
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		// the acquisition must never wait for the evaluation, so we rather drop the oldest spectrum
+		if ((gsl::index)m_queue.size() >= m_maxQueue) {
+			m_queue.pop_front();
+			m_statistics.dropped++;
+		}
+		m_queue.push_back(std::move(job));
+		m_statistics.maxBacklog = std::max(m_statistics.maxBacklog, (gsl::index)m_queue.size());
+	}
+	m_queueChanged.notify_one();
+}
+
+void SpectrumAnalysis::work() {
+	// every worker reuses its own fitter, so the fits don't allocate
+	auto fitter = lorentzian(2);
+	auto batch = std::vector<JOB>{};
+	auto results = std::vector<SPECTRUM_RESULT>{};
+	while (true) {
+		batch.clear();
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueChanged.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+			// on stop the remaining spectra are fitted first
+			if (m_queue.empty()) {
+				return;
+			}
+			while (!m_queue.empty() && (gsl::index)batch.size() < m_batchSize) {
+				batch.push_back(std::move(m_queue.front()));
+				m_queue.pop_front();
+			}
+		}
+
+		auto calibration = VIPA_CALIBRATION{};
+		{
+			std::lock_guard<std::mutex> lock(m_calibrationMutex);
+			calibration = m_calibration;
+		}
+
+		results.clear();
+		for (const auto& job : batch) {
+			auto fit = fitter.fit(job.spectrum.data(), (int)job.spectrum.size());
+
+			auto result = SPECTRUM_RESULT{};
+			result.index = job.index;
+			result.iterations = fit.iterations;
+			result.valid = fit.converged && fit.peakCount == 2;
+			if (result.valid) {
+				result.shift = fit.peaks[1].position - fit.peaks[0].position;
+				result.linewidth = 0.5 * (fit.peaks[0].width + fit.peaks[1].width);
+				result.intensity = 0.5 * (fit.peaks[0].amplitude + fit.peaks[1].amplitude);
+				result.frequency = calibration.shift(fit.peaks[0].position, fit.peaks[1].position);
+			}
+			results.push_back(result);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_resultMutex);
+			m_results.insert(m_results.end(), results.begin(), results.end());
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_statistics.fitted += (gsl::index)batch.size();
+		}
+	}
+}
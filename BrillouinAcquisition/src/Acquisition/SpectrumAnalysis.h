@@ -0,0 +1,96 @@
+#ifndef SPECTRUMANALYSIS_H
+#define SPECTRUMANALYSIS_H
+
+#include "../lib/math/lorentzian.h"
+#include "../lib/math/points.h"
+#include "../lib/math/spectrum.h"
+#include "../lib/math/vipa.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct SPECTRUM_RESULT {
+	INDEX3 index;				// [1]	index of the position in the x, y and z direction
+	double shift{ NAN };		// [pix]	distance between the two fitted peaks
+	double linewidth{ NAN };	// [pix]	mean full width at half maximum of the peaks
+	double intensity{ NAN };	// [1]	mean amplitude of the peaks
+	double centroid{ NAN };		// [pix]	intensity weighted centroid, a cheap proxy if the spectra are not fitted
+	double frequency{ NAN };	// [GHz]	Brillouin shift according to the latest calibration
+	int iterations{ 0 };		// number of iterations of the fit
+	bool valid{ false };		// the fit converged
+};
+
+struct SPECTRUM_STATISTICS {
+	gsl::index fitted{ 0 };		// number of fitted spectra
+	gsl::index dropped{ 0 };	// number of spectra dropped because the workers could not keep up
+	gsl::index maxBacklog{ 0 };	// maximum number of spectra waiting to be fitted
+	double fitsPerSecond{ 0 };	// [1/s]	throughput since the start
+};
+
+/*
+ * Fits the Brillouin spectra of a scan while it is acquired.
+ *
+ * The spectrum is extracted from the frames in the calling thread, which only takes a pass over the pixels
+ * of the line. The much more expensive Lorentzian fits run on a pool of worker threads, so that
+ * the acquisition never waits for the evaluation. The workers take the spectra from the queue in batches,
+ * so that they only synchronise once per batch. The results are collected until they are taken.
+ * As soon as a calibration is set, the shifts are additionally converted to frequencies.
+ */
+class SpectrumAnalysis {
+
+public:
+	SpectrumAnalysis(int threadCount = 0);
+	~SpectrumAnalysis();
+
+	void start(const SPECTRUM_LINE& line, int width, int height, const std::string& dataType);
+	void stop();
+
+	void enqueue(const INDEX3& index, const std::byte* frames, int frameCount);
+	void enqueueAccumulated(const INDEX3& index, const unsigned int* sum);
+
+	void setCalibration(const VIPA_CALIBRATION& calibration);
+
+	std::vector<SPECTRUM_RESULT> takeResults();
+	SPECTRUM_STATISTICS getStatistics();
+
+	int getThreadCount();
+
+private:
+	struct JOB {
+		INDEX3 index;
+		std::vector<double> spectrum;
+	};
+
+	template <typename T>
+	void extract(const INDEX3& index, const T* frames, int frameCount);
+	void work();
+
+	int m_threadCount{ 1 };
+	std::vector<std::thread> m_workers;
+
+	spectrumExtractor m_extractor;
+	std::string m_dataType;
+	gsl::index m_pixelsPerFrame{ 0 };
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueChanged;
+	std::deque<JOB> m_queue;
+	gsl::index m_maxQueue{ 10000 };				// maximum number of spectra waiting to be fitted
+	gsl::index m_batchSize{ 16 };				// maximum number of spectra a worker takes at once
+	bool m_stop{ false };
+
+	std::mutex m_calibrationMutex;
+	VIPA_CALIBRATION m_calibration;				// converts the distance of the peaks to the Brillouin shift
+
+	std::mutex m_resultMutex;
+	std::vector<SPECTRUM_RESULT> m_results;
+
+	SPECTRUM_STATISTICS m_statistics;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#endif // SPECTRUMANALYSIS_H
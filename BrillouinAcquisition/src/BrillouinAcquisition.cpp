@@ -116,6 +116,22 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 		[this](int repNumber, int timeToNext) { showRepProgress(repNumber, timeToNext); }
 	);
 
+	// slot to show the analysed spectra in the live map
+	connection = QWidget::connect(
+		m_Brillouin,
+		&Brillouin::s_spectraAnalysed,
+		this,
+		[this](std::vector<SPECTRUM_RESULT> results) { updateLiveMap(results); }
+	);
+
+	// slot to show the phase durations of a repetition
+	connection = QWidget::connect(
+		m_Brillouin,
+		&Brillouin::s_phaseTimes,
+		this,
+		[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+	);
+
 	// slot to update the scan order
 	connection = QWidget::connect(
 		m_Brillouin,
@@ -132,8 +148,54 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 		[this](std::vector<POINT3> orderedPositions) { AOI_changed(orderedPositions); }
 	);
 
+	// slots to show the result and timing of the autofocus
+	connection = QWidget::connect(
+		m_autofocus,
+		&Autofocus::s_autofocusFinished,
+		this,
+		[this](FOCUS_RESULT result) { showAutofocusResult(result); }
+	);
+	connection = QWidget::connect(
+		m_autofocus,
+		&Autofocus::s_phaseTimes,
+		this,
+		[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+	);
+
+	// slot to show the progress of an experiment plan
+	connection = QWidget::connect(
+		m_jobScheduler,
+		&JobScheduler::s_running,
+		this,
+		[this](bool running) { showExperimentRunning(running); }
+	);
+	connection = QWidget::connect(
+		m_jobScheduler,
+		&JobScheduler::s_jobStarted,
+		this,
+		[this](int round, int rounds, int job, int jobs, std::string description) {
+			ui->statusBar->showMessage(QString("Experiment round %1/%2, job %3/%4: %5")
+				.arg(round).arg(rounds).arg(job).arg(jobs).arg(QString::fromStdString(description)));
+		}
+	);
+	connection = QWidget::connect(
+		m_jobScheduler,
+		&JobScheduler::s_waitingForRound,
+		this,
+		[this](int round, int seconds) {
+			ui->statusBar->showMessage(QString("Experiment round %1 starts in %2").arg(round).arg(formatSeconds(seconds)));
+		}
+	);
+
 	m_Brillouin->determineScanOrder();
 
+	// only one scan path can be selected at a time
+	auto scanPathGroup = new QActionGroup(this);
+	scanPathGroup->addAction(ui->actionScan_Path_Raster);
+	scanPathGroup->addAction(ui->actionScan_Path_Serpentine);
+	scanPathGroup->addAction(ui->actionScan_Path_Hilbert);
+	scanPathGroup->addAction(ui->actionScan_Path_Nearest_Neighbour);
+
 	qRegisterMetaType<std::string>("std::string");
 	qRegisterMetaType<AT_64>("AT_64");
 	qRegisterMetaType<StoragePath>("StoragePath");
@@ -170,8 +232,12 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 	qRegisterMetaType<ODT_SETTINGS>("ODT_SETTINGS");
 	qRegisterMetaType<ODTIMAGE<unsigned char>*>("ODTIMAGE<unsigned char>*");
 	qRegisterMetaType<ODTIMAGE<unsigned short>*>("ODTIMAGE<unsigned short>*");
+	qRegisterMetaType<ODTSTACK<unsigned char>*>("ODTSTACK<unsigned char>*");
+	qRegisterMetaType<ODTSTACK<unsigned short>*>("ODTSTACK<unsigned short>*");
 	qRegisterMetaType<FLUOIMAGE<unsigned char>*>("FLUOIMAGE<unsigned char>*");
 	qRegisterMetaType<FLUOIMAGE<unsigned short>*>("FLUOIMAGE<unsigned short>*");
+	qRegisterMetaType<FLUOSTACK<unsigned char>*>("FLUOSTACK<unsigned char>*");
+	qRegisterMetaType<FLUOSTACK<unsigned short>*>("FLUOSTACK<unsigned short>*");
 	qRegisterMetaType<FLUORESCENCE_SETTINGS>("FLUORESCENCE_SETTINGS");
 	qRegisterMetaType<FLUORESCENCE_MODE>("FLUORESCENCE_MODE");
 	qRegisterMetaType<PLOT_SETTINGS*>("PLOT_SETTINGS*");
@@ -183,6 +249,11 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 	qRegisterMetaType<VoltageCalibrationData>("VoltageCalibrationData");
 	qRegisterMetaType<ScaleCalibrationData>("ScaleCalibrationData");
 	qRegisterMetaType<SCAN_ORDER>("SCAN_ORDER");
+	qRegisterMetaType<std::vector<SPECTRUM_RESULT>>("std::vector<SPECTRUM_RESULT>");
+	qRegisterMetaType<EXPERIMENT_PLAN>("EXPERIMENT_PLAN");
+	qRegisterMetaType<std::vector<PHASE_STATISTICS>>("std::vector<PHASE_STATISTICS>");
+	qRegisterMetaType<ODT_SLICES>("ODT_SLICES");
+	qRegisterMetaType<FOCUS_RESULT>("FOCUS_RESULT");
 	
 	// Set up icons
 	m_icons.disconnected.addFile(":/BrillouinAcquisition/assets/00disconnected10px.png", QSize(10, 10));
@@ -286,6 +357,10 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 	m_acquisitionThread.startWorker(m_acquisition);
 	// start Brillouin thread
 	m_acquisitionThread.startWorker(m_Brillouin);
+	// start the autofocus
+	m_acquisitionThread.startWorker(m_autofocus);
+	// start the experiment scheduler
+	m_acquisitionThread.startWorker(m_jobScheduler);
 	// start plotting thread
 	m_plottingThread.startWorker(m_converter);
 
@@ -319,6 +394,9 @@ BrillouinAcquisition::BrillouinAcquisition(QWidget *parent) noexcept :
 	// set up the camera image plot
 	BrillouinAcquisition::initializePlot(m_BrillouinPlot);
 	BrillouinAcquisition::initializePlot(m_ODTPlot);
+	initializeLiveMap();
+	initializePhaseTimes();
+	initializeTomogram();
 
 	connection = QWidget::connect(
 		m_ODTPlot.plotHandle,
@@ -385,6 +463,14 @@ BrillouinAcquisition::~BrillouinAcquisition() {
 		m_ODT->deleteLater();
 		m_ODT = nullptr;
 	}
+	if (m_jobScheduler) {
+		m_jobScheduler->deleteLater();
+		m_jobScheduler = nullptr;
+	}
+	if (m_autofocus) {
+		m_autofocus->deleteLater();
+		m_autofocus = nullptr;
+	}
 	if (m_converter) {
 		m_converter->deleteLater();
 		m_converter = nullptr;
@@ -825,6 +911,16 @@ void BrillouinAcquisition::on_acquisitionRate_ODT_valueChanged(double rate) {
 	m_ODT->setSettings(ODT_MODE::ACQ, ODT_SETTING::SCANRATE, rate);
 }
 
+void BrillouinAcquisition::on_acquisitionStream_ODT_toggled(bool streaming) {
+	m_ODT->setSettings(ODT_MODE::ACQ, ODT_SETTING::STREAMING, (double)streaming);
+	// only streamed tomograms are kept in memory for the reconstruction
+	ui->acquisitionReconstruct_ODT->setEnabled(streaming);
+}
+
+void BrillouinAcquisition::on_acquisitionReconstruct_ODT_toggled(bool reconstruct) {
+	m_ODT->setSettings(ODT_MODE::ACQ, ODT_SETTING::RECONSTRUCT, (double)reconstruct);
+}
+
 void BrillouinAcquisition::on_acquisitionStartODT_clicked() {
 	if (m_ODT->getStatus() < ACQUISITION_STATUS::STARTED) {
 		QMetaObject::invokeMethod(
@@ -915,6 +1011,16 @@ void BrillouinAcquisition::on_setBackground_clicked() {
 		},
 		Qt::AutoConnection
 	);
+	// the streamed tomograms are corrected with a background image acquired at normal incidence
+	if (m_ODT) {
+		QMetaObject::invokeMethod(
+			m_ODT,
+			[&m_ODT = m_ODT]() {
+				m_ODT->acquireBackground();
+			},
+			Qt::AutoConnection
+		);
+	}
 }
 
 void BrillouinAcquisition::on_acquisitionStartFluorescence_clicked() {
@@ -1097,6 +1203,7 @@ void BrillouinAcquisition::updateFluorescenceSettings(const FLUORESCENCE_SETTING
 	ui->fluoGreenGain->setValue(settings.green.gain);
 	ui->fluoRedGain->setValue(settings.red.gain);
 	ui->fluoBrightfieldGain->setValue(settings.brightfield.gain);
+	m_fluorescenceStack = settings.stack;
 }
 
 void BrillouinAcquisition::showEnabledModes(ACQUISITION_MODE modes) {
@@ -1150,6 +1257,7 @@ void BrillouinAcquisition::showBrillouinStatus(ACQUISITION_STATUS status) {
 		case ACQUISITION_STATUS::STARTED:
 			string = "Acquisition started.";
 			ui->progressBar->setValue(0);
+			resetLiveMap();
 			[[fallthrough]];
 		case ACQUISITION_STATUS::RUNNING:
 			ui->BrillouinStart->setText("Cancel");
@@ -1169,6 +1277,7 @@ void BrillouinAcquisition::showBrillouinStatus(ACQUISITION_STATUS status) {
 	ui->progressBar->setFormat(string);
 
 	ui->actionOpen_Acquisition->setDisabled(running);
+	ui->actionResume_Acquisition->setDisabled(running);
 	ui->actionNew_Acquisition->setDisabled(running);
 	ui->actionClose_Acquisition->setDisabled(running);
 
@@ -1235,6 +1344,7 @@ void BrillouinAcquisition::showODTStatus(ACQUISITION_STATUS status) {
 	}
 
 	ui->actionOpen_Acquisition->setDisabled(running);
+	ui->actionResume_Acquisition->setDisabled(running);
 	ui->actionNew_Acquisition->setDisabled(running);
 	ui->actionClose_Acquisition->setDisabled(running);
 
@@ -1474,6 +1584,315 @@ void BrillouinAcquisition::applyGradient(const PLOT_SETTINGS& plotSettings) {
 	plotSettings.colorMap->setGradient(gradient);
 }
 
+/*
+ * Sets up the window showing the map of the Brillouin scan while it is acquired
+ */
+void BrillouinAcquisition::initializeLiveMap() {
+	m_liveMapDialog = new QDialog(this, Qt::Window | Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	m_liveMapDialog->setWindowTitle("Live map");
+	m_liveMapDialog->resize(600, 500);
+
+	m_liveMap = new QCustomPlot(m_liveMapDialog);
+	auto layout = new QVBoxLayout(m_liveMapDialog);
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->addWidget(m_liveMap);
+
+	m_liveMap->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+	m_liveMap->axisRect()->setupFullAxesBox(true);
+	m_liveMap->setBackground(QColor(240, 240, 240, 255));
+	m_liveMap->axisRect()->setBackground(Qt::white);
+
+	m_liveMapColorMap = new QCPColorMap(m_liveMap->xAxis, m_liveMap->yAxis);
+	m_liveMapColorMap->setInterpolate(false);
+
+	auto colorScale = new QCPColorScale(m_liveMap);
+	m_liveMap->plotLayout()->addElement(0, 1, colorScale);
+	colorScale->setType(QCPAxis::atRight);
+	m_liveMapColorMap->setColorScale(colorScale);
+
+	// positions not measured yet stay transparent
+	auto gradient = QCPColorGradient();
+	setColormap(&gradient, CustomGradientPreset::gpViridis);
+	gradient.setNanHandling(QCPColorGradient::nhTransparent);
+	m_liveMapColorMap->setGradient(gradient);
+
+	auto marginGroup = new QCPMarginGroup(m_liveMap);
+	m_liveMap->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+	colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+	// the map is only redrawn once per interval, no matter how fast the results arrive
+	m_liveMapTimer.setSingleShot(true);
+	auto connection = QWidget::connect(
+		&m_liveMapTimer,
+		&QTimer::timeout,
+		this,
+		[this]() { redrawLiveMap(); }
+	);
+
+	resetLiveMap();
+}
+
+/*
+ * Clears the live map and adapts it to the current scan.
+ * The two directions with the most positions are shown, the remaining direction is shown plane by plane.
+ */
+void BrillouinAcquisition::resetLiveMap() {
+	auto& settings = m_Brillouin->settings;
+	m_liveMapShift = settings.analyseSpectra;
+	m_liveMapFrequency = settings.analyseSpectra && settings.preCalibration;
+	m_liveMapSize = { settings.xSteps, settings.ySteps, settings.zSteps };
+	m_liveMapAxes = { 0, 1, 2 };
+	std::stable_sort(m_liveMapAxes.begin(), m_liveMapAxes.end(),
+		[this](int a, int b) { return m_liveMapSize[a] > m_liveMapSize[b]; });
+	// keep the natural order of the two directions shown
+	if (m_liveMapAxes[0] > m_liveMapAxes[1]) {
+		std::swap(m_liveMapAxes[0], m_liveMapAxes[1]);
+	}
+	m_liveMapValues.assign((size_t)m_liveMapSize[0] * m_liveMapSize[1] * m_liveMapSize[2], NAN);
+	m_liveMapPlane = 0;
+
+	auto minimum = std::array<double, 3>{ settings.xMin, settings.yMin, settings.zMin };
+	auto maximum = std::array<double, 3>{ settings.xMax, settings.yMax, settings.zMax };
+	auto names = std::array<QString, 3>{ "x", "y", "z" };
+	auto horizontal = m_liveMapAxes[0];
+	auto vertical = m_liveMapAxes[1];
+
+	m_liveMapColorMap->data()->setSize(m_liveMapSize[horizontal], m_liveMapSize[vertical]);
+	m_liveMapColorMap->data()->setRange(
+		QCPRange(minimum[horizontal], maximum[horizontal]),
+		QCPRange(minimum[vertical], maximum[vertical])
+	);
+	m_liveMapColorMap->data()->fill(NAN);
+	m_liveMap->xAxis->setLabel(names[horizontal] + " [" + QChar(0xb5) + "m]");
+	m_liveMap->yAxis->setLabel(names[vertical] + " [" + QChar(0xb5) + "m]");
+	auto label = m_liveMapFrequency ? "Brillouin shift [GHz]" : (m_liveMapShift ? "Brillouin shift [pix]" : "Spectral centroid [pix]");
+	m_liveMapColorMap->colorScale()->axis()->setLabel(label);
+	m_liveMap->rescaleAxes();
+
+	m_liveMapTimer.stop();
+	redrawLiveMap();
+}
+
+/*
+ * Stores the results and schedules a redraw, the map itself is only redrawn by the timer
+ */
+void BrillouinAcquisition::updateLiveMap(const std::vector<SPECTRUM_RESULT>& results) {
+	if (results.empty()) {
+		return;
+	}
+	auto horizontal = m_liveMapAxes[0];
+	auto vertical = m_liveMapAxes[1];
+	auto plane = m_liveMapAxes[2];
+	for (auto& result : results) {
+		auto index = std::array<int, 3>{ result.index.x, result.index.y, result.index.z };
+		if (index[0] >= m_liveMapSize[0] || index[1] >= m_liveMapSize[1] || index[2] >= m_liveMapSize[2]) {
+			continue;
+		}
+		auto value = result.centroid;
+		if (m_liveMapFrequency) {
+			value = result.frequency;
+		} else if (m_liveMapShift) {
+			value = result.valid ? result.shift : NAN;
+		}
+		m_liveMapValues[((size_t)index[2] * m_liveMapSize[1] + index[1]) * m_liveMapSize[0] + index[0]] = value;
+
+		// the map follows the plane which is currently measured
+		if (index[plane] != m_liveMapPlane) {
+			m_liveMapPlane = index[plane];
+			for (int jj{ 0 }; jj < m_liveMapSize[vertical]; jj++) {
+				for (int kk{ 0 }; kk < m_liveMapSize[horizontal]; kk++) {
+					auto cell = std::array<int, 3>{};
+					cell[horizontal] = kk;
+					cell[vertical] = jj;
+					cell[plane] = m_liveMapPlane;
+					m_liveMapColorMap->data()->setCell(kk, jj,
+						m_liveMapValues[((size_t)cell[2] * m_liveMapSize[1] + cell[1]) * m_liveMapSize[0] + cell[0]]);
+				}
+			}
+		} else {
+			m_liveMapColorMap->data()->setCell(index[horizontal], index[vertical], value);
+		}
+	}
+	if (!m_liveMapTimer.isActive()) {
+		m_liveMapTimer.start(m_liveMapInterval);
+	}
+}
+
+void BrillouinAcquisition::redrawLiveMap() {
+	if (!m_liveMapDialog->isVisible()) {
+		return;
+	}
+	// the data range is only valid once a position was measured
+	m_liveMapColorMap->data()->recalculateDataBounds();
+	auto bounds = m_liveMapColorMap->data()->dataBounds();
+	if (bounds.lower <= bounds.upper) {
+		m_liveMapColorMap->setDataRange(bounds);
+	}
+	auto plane = m_liveMapAxes[2];
+	auto names = std::array<QString, 3>{ "x", "y", "z" };
+	m_liveMapDialog->setWindowTitle(m_liveMapSize[plane] > 1
+		? QString("Live map, %1-plane %2 of %3").arg(names[plane]).arg(m_liveMapPlane + 1).arg(m_liveMapSize[plane])
+		: QString("Live map"));
+	m_liveMap->replot(QCustomPlot::rpQueuedReplot);
+}
+
+/*
+ * Sets up the window showing the phase durations of the last repetition
+ */
+void BrillouinAcquisition::initializePhaseTimes() {
+	m_phaseTimesDialog = new QDialog(this, Qt::Window | Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	m_phaseTimesDialog->setWindowTitle("Phase timing");
+	m_phaseTimesDialog->resize(700, 350);
+
+	m_phaseTimesTable = new QTableWidget(0, 8, m_phaseTimesDialog);
+	m_phaseTimesTable->setHorizontalHeaderLabels({ "Phase", "Count", "Total [s]", "Share [%]",
+		"Mean [ms]", "Median [ms]", "95% [ms]", "Max [ms]" });
+	m_phaseTimesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	m_phaseTimesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	m_phaseTimesTable->verticalHeader()->setVisible(false);
+
+	auto layout = new QVBoxLayout(m_phaseTimesDialog);
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->addWidget(m_phaseTimesTable);
+}
+
+/*
+ * Sets up the window showing the central planes of the last reconstructed tomogram, all planes share one color scale
+ */
+void BrillouinAcquisition::initializeTomogram() {
+	m_tomogramDialog = new QDialog(this, Qt::Window | Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	m_tomogramDialog->setWindowTitle("Tomogram");
+	m_tomogramDialog->resize(1200, 420);
+
+	m_tomogramPlot = new QCustomPlot(m_tomogramDialog);
+	auto layout = new QVBoxLayout(m_tomogramDialog);
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->addWidget(m_tomogramPlot);
+
+	m_tomogramPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+	m_tomogramPlot->setBackground(QColor(240, 240, 240, 255));
+	m_tomogramPlot->plotLayout()->clear();
+
+	auto colorScale = new QCPColorScale(m_tomogramPlot);
+	colorScale->setType(QCPAxis::atRight);
+	colorScale->axis()->setLabel("Refractive index");
+	auto marginGroup = new QCPMarginGroup(m_tomogramPlot);
+
+	auto names = std::array<std::pair<QString, QString>, 3>{ { { "x", "y" }, { "x", "z" }, { "y", "z" } } };
+	for (gsl::index i{ 0 }; i < 3; i++) {
+		auto axisRect = new QCPAxisRect(m_tomogramPlot);
+		m_tomogramPlot->plotLayout()->addElement(0, (int)i, axisRect);
+		axisRect->setupFullAxesBox(true);
+		axisRect->setBackground(Qt::white);
+		axisRect->axis(QCPAxis::atBottom)->setLabel(names[i].first + " [" + QChar(0xb5) + "m]");
+		axisRect->axis(QCPAxis::atLeft)->setLabel(names[i].second + " [" + QChar(0xb5) + "m]");
+		axisRect->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+		m_tomogramColorMaps[i] = new QCPColorMap(axisRect->axis(QCPAxis::atBottom), axisRect->axis(QCPAxis::atLeft));
+		m_tomogramColorMaps[i]->setInterpolate(false);
+		m_tomogramColorMaps[i]->setColorScale(colorScale);
+	}
+	m_tomogramPlot->plotLayout()->addElement(0, 3, colorScale);
+	colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+	auto gradient = QCPColorGradient();
+	setColormap(&gradient, CustomGradientPreset::gpGrayscale);
+	colorScale->setGradient(gradient);
+}
+
+/*
+ * Shows the central planes of a tomogram, the focal plane is at z = 0
+ */
+void BrillouinAcquisition::showTomogram(const ODT_SLICES& slices) {
+	if (slices.dim < 1) {
+		return;
+	}
+	auto extent = slices.dim * slices.voxelSize;
+	auto lateral = QCPRange(0, extent);
+	auto axial = QCPRange(-extent / 2, extent / 2);
+	auto planes = std::array<const std::vector<float>*, 3>{ &slices.xy, &slices.xz, &slices.yz };
+
+	auto bounds = QCPRange(INFINITY, -INFINITY);
+	for (gsl::index i{ 0 }; i < 3; i++) {
+		auto data = m_tomogramColorMaps[i]->data();
+		data->setSize(slices.dim, slices.dim);
+		data->setRange(lateral, i == 0 ? lateral : axial);
+		for (gsl::index row{ 0 }; row < slices.dim; row++) {
+			for (gsl::index col{ 0 }; col < slices.dim; col++) {
+				auto value = (*planes[i])[row * slices.dim + col];
+				data->setCell((int)col, (int)row, value);
+				bounds.lower = std::min(bounds.lower, (double)value);
+				bounds.upper = std::max(bounds.upper, (double)value);
+			}
+		}
+	}
+	m_tomogramColorMaps[0]->colorScale()->setDataRange(bounds);
+	m_tomogramPlot->rescaleAxes();
+
+	m_tomogramDialog->setWindowTitle(QString("Tomogram, %1 voxels of %2 %3m")
+		.arg(slices.dim).arg(slices.voxelSize, 0, 'f', 3).arg(QChar(0xb5)));
+	m_tomogramDialog->show();
+	m_tomogramDialog->raise();
+	m_tomogramPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void BrillouinAcquisition::showPhaseTimes(ACQUISITION_MODE mode, const std::vector<PHASE_STATISTICS>& phases, double elapsed) {
+	auto modeName = QString{};
+	switch (mode) {
+		case ACQUISITION_MODE::BRILLOUIN:
+			modeName = "Brillouin";
+			break;
+		case ACQUISITION_MODE::ODT:
+			modeName = "ODT";
+			break;
+		case ACQUISITION_MODE::FLUORESCENCE:
+			modeName = "Fluorescence";
+			break;
+		case ACQUISITION_MODE::VOLTAGECALIBRATION:
+			modeName = "Voltage calibration";
+			break;
+		case ACQUISITION_MODE::SCALECALIBRATION:
+			modeName = "Scale calibration";
+			break;
+		case ACQUISITION_MODE::AUTOFOCUS:
+			modeName = "Autofocus";
+			break;
+		default:
+			modeName = "Acquisition";
+	}
+	m_phaseTimesDialog->setWindowTitle(QString("Phase timing - %1 (%2 s)").arg(modeName).arg(1e-3 * elapsed, 0, 'f', 1));
+
+	auto setCell = [this](int row, int column, const QString& text) {
+		auto item = new QTableWidgetItem(text);
+		if (column > 0) {
+			item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+		}
+		m_phaseTimesTable->setItem(row, column, item);
+	};
+	m_phaseTimesTable->setRowCount((int)phases.size());
+	auto longest = phases.cend();
+	for (auto it = phases.cbegin(); it != phases.cend(); it++) {
+		auto row = (int)std::distance(phases.cbegin(), it);
+		setCell(row, 0, QString::fromStdString(it->name));
+		setCell(row, 1, QString::number(it->count));
+		setCell(row, 2, QString::number(1e-3 * it->total, 'f', 2));
+		setCell(row, 3, QString::number(100 * it->total / elapsed, 'f', 1));
+		setCell(row, 4, QString::number(it->mean(), 'f', 2));
+		setCell(row, 5, QString::number(phaseTimer::percentile(*it, 50), 'f', 2));
+		setCell(row, 6, QString::number(phaseTimer::percentile(*it, 95), 'f', 2));
+		setCell(row, 7, QString::number(it->max, 'f', 2));
+		if (longest == phases.cend() || it->total > longest->total) {
+			longest = it;
+		}
+	}
+
+	if (longest != phases.cend()) {
+		ui->statusBar->showMessage(QString("%1 repetition took %2 s, %3 % of it in \"%4\".").arg(modeName)
+			.arg(1e-3 * elapsed, 0, 'f', 1).arg(100 * longest->total / elapsed, 0, 'f', 0)
+			.arg(QString::fromStdString(longest->name)), 10000);
+	}
+}
+
 void BrillouinAcquisition::initializeLaserPositionLocation() {
 	// If the scanControl supports capability LaserScanner, there is no need to set the laser position manually.
 	if (m_scanControl != nullptr && m_scanControl->supportsCapability(Capabilities::LaserScanner)) {
@@ -2310,6 +2729,415 @@ void BrillouinAcquisition::on_action_Voltage_calibration_load_triggered() {
 	m_voltageCalibration->load(m_voltageCalibrationFilePath);
 }
 
+void BrillouinAcquisition::on_actionAccumulate_Frames_toggled(bool checked) {
+	m_Brillouin->settings.accumulateFrames = checked;
+	ui->actionStore_Variance->setEnabled(checked);
+}
+
+void BrillouinAcquisition::on_actionStore_Variance_toggled(bool checked) {
+	m_Brillouin->settings.storeVariance = checked;
+}
+
+void BrillouinAcquisition::on_actionTrack_Brightfield_toggled(bool checked) {
+	m_Brillouin->settings.trackBrightfield = checked;
+}
+
+void BrillouinAcquisition::on_actionAdaptive_Scan_toggled(bool checked) {
+	m_Brillouin->settings.adaptive = checked;
+}
+
+void BrillouinAcquisition::on_actionAdaptive_Scan_Settings_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Adaptive scan");
+
+	auto threshold = new QDoubleSpinBox(&dialog);
+	threshold->setRange(0, 1000);
+	threshold->setDecimals(2);
+	threshold->setSuffix(" pix");
+	threshold->setValue(m_Brillouin->settings.adaptiveThreshold);
+
+	auto budget = new QDoubleSpinBox(&dialog);
+	budget->setRange(1, 100);
+	budget->setDecimals(0);
+	budget->setSuffix(" %");
+	budget->setValue(100 * m_Brillouin->settings.adaptiveBudget);
+
+	auto coarseStride = new QSpinBox(&dialog);
+	coarseStride->setRange(1, 1024);
+	coarseStride->setValue(m_Brillouin->settings.adaptiveCoarseStride);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Refinement threshold", threshold);
+	layout->addRow("Maximum positions", budget);
+	layout->addRow("Coarse grid spacing", coarseStride);
+	layout->addRow(buttons);
+
+	if (dialog.exec() == QDialog::Accepted) {
+		m_Brillouin->settings.adaptiveThreshold = threshold->value();
+		m_Brillouin->settings.adaptiveBudget = 1e-2 * budget->value();
+		m_Brillouin->settings.adaptiveCoarseStride = coarseStride->value();
+	}
+}
+
+void BrillouinAcquisition::on_actionAnalyse_Spectra_toggled(bool checked) {
+	m_Brillouin->settings.analyseSpectra = checked;
+}
+
+void BrillouinAcquisition::on_actionSpectrum_Line_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Spectrum line");
+
+	auto& line = m_Brillouin->settings.spectrumLine;
+	auto points = new QLineEdit(QString::fromStdString(spectrumExtractor::toString(line.points)), &dialog);
+	points->setPlaceholderText("x1, y1; x2, y2; ...");
+	points->setMinimumWidth(250);
+
+	auto halfWidth = new QSpinBox(&dialog);
+	halfWidth->setRange(0, 100);
+	halfWidth->setSuffix(" pix");
+	halfWidth->setValue(line.halfWidth);
+
+	auto samples = new QSpinBox(&dialog);
+	samples->setRange(0, 10000);
+	samples->setSpecialValueText("One per pixel");
+	samples->setValue(line.samples);
+
+	auto rawFrameInterval = new QSpinBox(&dialog);
+	rawFrameInterval->setRange(0, 1000000);
+	rawFrameInterval->setPrefix("every ");
+	rawFrameInterval->setSuffix(" positions");
+	rawFrameInterval->setSpecialValueText("Never");
+	rawFrameInterval->setValue(m_Brillouin->settings.rawFrameInterval);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Vertices [pix]", points);
+	layout->addRow("Half width", halfWidth);
+	layout->addRow("Samples", samples);
+	layout->addRow("Keep frames", rawFrameInterval);
+	layout->addRow(new QLabel("Without vertices the center row of the camera is used.\n"
+		"When storing spectra only, the frames are kept at the given interval.", &dialog));
+	layout->addRow(buttons);
+
+	if (dialog.exec() == QDialog::Accepted) {
+		line.points = spectrumExtractor::fromString(points->text().toStdString());
+		line.halfWidth = halfWidth->value();
+		line.samples = samples->value();
+		m_Brillouin->settings.rawFrameInterval = rawFrameInterval->value();
+	}
+}
+
+void BrillouinAcquisition::on_actionStore_Spectra_toggled(bool checked) {
+	m_Brillouin->settings.storeSpectra = checked;
+}
+
+void BrillouinAcquisition::on_actionCalibration_Fit_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Calibration fit");
+
+	auto shift = new QDoubleSpinBox(&dialog);
+	shift->setRange(0, 100);
+	shift->setDecimals(3);
+	shift->setSuffix(" GHz");
+	shift->setValue(m_Brillouin->settings.calibrationShift);
+
+	auto freeSpectralRange = new QDoubleSpinBox(&dialog);
+	freeSpectralRange->setRange(0, 1000);
+	freeSpectralRange->setDecimals(3);
+	freeSpectralRange->setSuffix(" GHz");
+	freeSpectralRange->setValue(m_Brillouin->settings.freeSpectralRange);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Shift of the calibration sample", shift);
+	layout->addRow("Free spectral range", freeSpectralRange);
+	layout->addRow(new QLabel("The peaks of every calibration are fitted along the spectrum line.", &dialog));
+	layout->addRow(buttons);
+
+	if (dialog.exec() == QDialog::Accepted) {
+		m_Brillouin->settings.calibrationShift = shift->value();
+		m_Brillouin->settings.freeSpectralRange = freeSpectralRange->value();
+	}
+}
+
+void BrillouinAcquisition::on_actionFluorescence_Stack_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Planes and tiles");
+
+	auto planes = new QSpinBox(&dialog);
+	planes->setRange(1, 1000);
+	planes->setValue(m_fluorescenceStack.planes);
+
+	auto planeDistance = new QDoubleSpinBox(&dialog);
+	planeDistance->setRange(0.01, 1000);
+	planeDistance->setDecimals(2);
+	planeDistance->setSuffix(" µm");
+	planeDistance->setValue(m_fluorescenceStack.planeDistance);
+
+	auto tiles_x = new QSpinBox(&dialog);
+	tiles_x->setRange(1, 100);
+	tiles_x->setValue(m_fluorescenceStack.tiles_x);
+
+	auto tiles_y = new QSpinBox(&dialog);
+	tiles_y->setRange(1, 100);
+	tiles_y->setValue(m_fluorescenceStack.tiles_y);
+
+	auto tileDistance = new QDoubleSpinBox(&dialog);
+	tileDistance->setRange(1, 10000);
+	tileDistance->setDecimals(1);
+	tileDistance->setSuffix(" µm");
+	tileDistance->setValue(m_fluorescenceStack.tileDistance);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Planes", planes);
+	layout->addRow("Plane distance", planeDistance);
+	layout->addRow("Tiles in x", tiles_x);
+	layout->addRow("Tiles in y", tiles_y);
+	layout->addRow("Tile distance", tileDistance);
+	layout->addRow(new QLabel("Planes and tiles are centred on the current position.", &dialog));
+	layout->addRow(buttons);
+
+	if (dialog.exec() == QDialog::Accepted) {
+		auto stack = FLUORESCENCE_STACK{ planes->value(), planeDistance->value(), tiles_x->value(), tiles_y->value(), tileDistance->value() };
+		QMetaObject::invokeMethod(
+			m_Fluorescence,
+			[&m_Fluorescence = m_Fluorescence, stack]() { m_Fluorescence->setStack(stack); },
+			Qt::AutoConnection
+		);
+	}
+}
+
+void BrillouinAcquisition::on_actionExperiment_Plan_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Experiment plan");
+
+	auto& plan = m_experimentPlan;
+	auto fluorescence = new QCheckBox("Fluorescence", &dialog);
+	fluorescence->setChecked(plan.fluorescence);
+	fluorescence->setEnabled(m_Fluorescence != nullptr);
+	auto odt = new QCheckBox("ODT", &dialog);
+	odt->setChecked(plan.odt);
+	odt->setEnabled(m_ODT != nullptr);
+	auto brillouin = new QCheckBox("Brillouin", &dialog);
+	brillouin->setChecked(plan.brillouin);
+	auto autofocus = new QCheckBox("Focus every position before its first job", &dialog);
+	autofocus->setChecked(plan.autofocus);
+	autofocus->setEnabled(m_brightfieldCamera != nullptr);
+
+	// the positions are numbered as in the list of saved positions
+	auto positionList = QStringList{};
+	for (auto position : plan.positions) {
+		positionList << QString::number(position + 1);
+	}
+	auto positions = new QLineEdit(positionList.join(", "), &dialog);
+	positions->setPlaceholderText("All saved positions");
+
+	auto rounds = new QSpinBox(&dialog);
+	rounds->setRange(1, 10000);
+	rounds->setValue(plan.rounds);
+
+	auto interval = new QDoubleSpinBox(&dialog);
+	interval->setRange(0, 10000);
+	interval->setDecimals(1);
+	interval->setSuffix(" min");
+	interval->setValue(plan.interval);
+
+	auto presetSwitchTime = new QDoubleSpinBox(&dialog);
+	presetSwitchTime->setRange(0, 1000);
+	presetSwitchTime->setDecimals(1);
+	presetSwitchTime->setSuffix(" s");
+	presetSwitchTime->setValue(plan.costs.presetSwitchTime);
+
+	auto stageSpeed = new QDoubleSpinBox(&dialog);
+	stageSpeed->setRange(1, 100000);
+	stageSpeed->setDecimals(0);
+	stageSpeed->setSuffix(QString(" %1m/s").arg(QChar(0x00B5)));
+	stageSpeed->setValue(plan.costs.stageSpeed);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	buttons->button(QDialogButtonBox::Ok)->setText("Start");
+	buttons->button(QDialogButtonBox::Ok)->setEnabled(!m_jobScheduler->isRunning());
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Modes", fluorescence);
+	layout->addRow("", odt);
+	layout->addRow("", brillouin);
+	layout->addRow("Autofocus", autofocus);
+	layout->addRow("Saved positions", positions);
+	layout->addRow("Rounds", rounds);
+	layout->addRow("Interval", interval);
+	layout->addRow("Preset switch time", presetSwitchTime);
+	layout->addRow("Stage speed", stageSpeed);
+	layout->addRow(new QLabel("Every job is stored as a repetition in the opened file.\n"
+		"The jobs are ordered to minimise preset switches and stage travel.", &dialog));
+	layout->addRow(buttons);
+
+	if (dialog.exec() != QDialog::Accepted) {
+		return;
+	}
+	plan.fluorescence = fluorescence->isChecked();
+	plan.odt = odt->isChecked();
+	plan.brillouin = brillouin->isChecked();
+	plan.autofocus = autofocus->isChecked() && m_brightfieldCamera != nullptr;
+	plan.positions.clear();
+	for (const auto& entry : positions->text().split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts)) {
+		auto ok{ false };
+		auto position = entry.toInt(&ok);
+		if (ok) {
+			plan.positions.push_back(position - 1);
+		}
+	}
+	plan.rounds = rounds->value();
+	plan.interval = interval->value();
+	plan.costs.presetSwitchTime = presetSwitchTime->value();
+	plan.costs.stageSpeed = stageSpeed->value();
+
+	if (plan.brillouin) {
+		applyBrillouinCameraROI();
+	}
+	QMetaObject::invokeMethod(
+		m_jobScheduler,
+		[&m_jobScheduler = m_jobScheduler, plan]() {
+			m_jobScheduler->start(plan);
+		},
+		Qt::AutoConnection
+	);
+}
+
+void BrillouinAcquisition::on_actionStop_Experiment_triggered() {
+	m_jobScheduler->abort();
+}
+
+void BrillouinAcquisition::on_actionAutofocus_triggered() {
+	if (!m_brightfieldCamera) {
+		ui->statusBar->showMessage("Autofocus needs the brightfield camera.");
+		return;
+	}
+	ui->statusBar->showMessage("Focusing...");
+	QMetaObject::invokeMethod(
+		m_autofocus,
+		[&m_autofocus = m_autofocus]() { m_autofocus->startRepetitions(); },
+		Qt::AutoConnection
+	);
+}
+
+void BrillouinAcquisition::on_actionAutofocus_Settings_triggered() {
+	QDialog dialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
+	dialog.setWindowTitle("Autofocus settings");
+
+	auto& settings = m_autofocusSettings;
+	auto metric = new QComboBox(&dialog);
+	metric->addItem("Tenengrad", (int)SHARPNESS_METRIC::TENENGRAD);
+	metric->addItem("Normalized variance", (int)SHARPNESS_METRIC::NORMALIZED_VARIANCE);
+	metric->setCurrentIndex(metric->findData((int)settings.metric));
+
+	auto range = new QDoubleSpinBox(&dialog);
+	range->setRange(0.5, 1000);
+	range->setDecimals(1);
+	range->setSuffix(QString(" %1m").arg(QChar(0x00B5)));
+	range->setValue(settings.search.range);
+
+	auto steps = new QSpinBox(&dialog);
+	steps->setRange(3, 101);
+	steps->setValue(settings.search.steps);
+
+	auto tolerance = new QDoubleSpinBox(&dialog);
+	tolerance->setRange(0.01, 100);
+	tolerance->setDecimals(2);
+	tolerance->setSuffix(QString(" %1m").arg(QChar(0x00B5)));
+	tolerance->setValue(settings.search.tolerance);
+
+	auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	QWidget::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	QWidget::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+	auto layout = new QFormLayout(&dialog);
+	layout->addRow("Sharpness", metric);
+	layout->addRow("Search range", range);
+	layout->addRow("Coarse steps", steps);
+	layout->addRow("Tolerance", tolerance);
+	layout->addRow(new QLabel("The range is centred on the current position.
+"
+		"The sharpest coarse step is refined by a golden-section search.", &dialog));
+	layout->addRow(buttons);
+
+	if (dialog.exec() != QDialog::Accepted) {
+		return;
+	}
+	settings.metric = (SHARPNESS_METRIC)metric->currentData().toInt();
+	settings.search.range = range->value();
+	settings.search.steps = steps->value();
+	settings.search.tolerance = tolerance->value();
+
+	QMetaObject::invokeMethod(
+		m_autofocus,
+		[&m_autofocus = m_autofocus, settings]() { m_autofocus->setSettings(settings); },
+		Qt::AutoConnection
+	);
+}
+
+void BrillouinAcquisition::showAutofocusResult(FOCUS_RESULT result) {
+	if (!result.valid) {
+		ui->statusBar->showMessage("Autofocus found no focus, the brightfield image shows too little structure.");
+		return;
+	}
+	auto message = QString("Focused at z = %1 %2m after %3 images").arg(result.z, 0, 'f', 2).arg(QChar(0x00B5)).arg(result.evaluations);
+	if (result.atBorder) {
+		message += ", the focus might lie outside of the search range";
+	}
+	ui->statusBar->showMessage(message);
+}
+
+void BrillouinAcquisition::showExperimentRunning(bool running) {
+	ui->actionStop_Experiment->setEnabled(running);
+	if (!running) {
+		ui->statusBar->showMessage("Experiment finished.", 5000);
+	}
+}
+
+void BrillouinAcquisition::on_actionPhase_Timing_triggered() {
+	m_phaseTimesDialog->show();
+	m_phaseTimesDialog->raise();
+}
+
+void BrillouinAcquisition::on_actionLive_Map_triggered() {
+	m_liveMapDialog->show();
+	m_liveMapDialog->raise();
+	redrawLiveMap();
+}
+
+void BrillouinAcquisition::on_actionScan_Path_Raster_triggered() {
+	m_Brillouin->setScanPath(SCAN_PATH::RASTER);
+}
+
+void BrillouinAcquisition::on_actionScan_Path_Serpentine_triggered() {
+	m_Brillouin->setScanPath(SCAN_PATH::SERPENTINE);
+}
+
+void BrillouinAcquisition::on_actionScan_Path_Hilbert_triggered() {
+	m_Brillouin->setScanPath(SCAN_PATH::HILBERT);
+}
+
+void BrillouinAcquisition::on_actionScan_Path_Nearest_Neighbour_triggered() {
+	m_Brillouin->setScanPath(SCAN_PATH::NEAREST_NEIGHBOUR);
+}
+
 void BrillouinAcquisition::on_action_Scale_calibration_acquire_triggered() {
 	if (!m_scaleCalibrationDialog) {
 		m_scaleCalibrationDialog = new QDialog(this, Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
@@ -2366,6 +3194,12 @@ void BrillouinAcquisition::on_action_Scale_calibration_acquire_triggered() {
 		this,
 		[this](double dy) { setTranslationDistanceY(dy); }
 	);
+	connection = QWidget::connect<void(QSpinBox::*)(int)>(
+		m_scaleCalibrationDialogUi.shiftCount,
+		&QSpinBox::valueChanged,
+		this,
+		[this](int count) { setShiftCount(count); }
+	);
 
 	// Connect scale calibration boxes
 	connection = QWidget::connect<void(QDoubleSpinBox::*)(double)>(
@@ -2430,6 +3264,11 @@ void BrillouinAcquisition::updateScaleCalibrationTranslationValue(POINT2 transla
 	m_scaleCalibrationDialogUi.dy->setValue(translation.y);
 }
 
+void BrillouinAcquisition::updateScaleCalibrationShiftCount(int count) {
+	const QSignalBlocker blocker(m_scaleCalibrationDialogUi.shiftCount);
+	m_scaleCalibrationDialogUi.shiftCount->setValue(count);
+}
+
 void BrillouinAcquisition::updateScaleCalibrationData(ScaleCalibrationData scaleCalibration) {
 	// We have to block the signals so that programmatically setting new values
 	// doesn't trigger a new round of calculations
@@ -2504,6 +3343,10 @@ void BrillouinAcquisition::setTranslationDistanceY(double dy) {
 	m_scaleCalibration->setTranslationDistanceY(dy);
 }
 
+void BrillouinAcquisition::setShiftCount(int count) {
+	m_scaleCalibration->setShiftCount(count);
+}
+
 void BrillouinAcquisition::setMicrometerToPixX_x(double value) {
 	m_scaleCalibration->setMicrometerToPixX_x(value);
 }
@@ -2921,6 +3764,22 @@ void BrillouinAcquisition::initODT() {
 			[this](double progress, int seconds) { showODTProgress(progress, seconds); }
 		);
 
+		// slot to show the phase durations of a repetition
+		connection = QWidget::connect(
+			m_ODT,
+			&ODT::s_phaseTimes,
+			this,
+			[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+		);
+
+		// slot to show the reconstructed tomogram
+		connection = QWidget::connect(
+			m_ODT,
+			&ODT::s_tomogramReconstructed,
+			this,
+			[this](ODT_SLICES slices) { showTomogram(slices); }
+		);
+
 		// start ODT thread
 		m_acquisitionThread.startWorker(m_ODT);
 		m_ODT->initialize();
@@ -2951,6 +3810,12 @@ void BrillouinAcquisition::initVoltageCalibration() {
 			this,
 			[this](std::string title, std::string message) { showScaleCalibrationStatus(title, message); }
 		);
+		connection = QWidget::connect(
+			m_voltageCalibration,
+			&VoltageCalibration::s_phaseTimes,
+			this,
+			[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+		);
 
 		// start Calibration thread
 		m_acquisitionThread.startWorker(m_voltageCalibration);
@@ -2978,6 +3843,12 @@ void BrillouinAcquisition::initScaleCalibration() {
 			this,
 			[this](POINT2 translation) { updateScaleCalibrationTranslationValue(translation); }
 		);
+		connection = QWidget::connect(
+			m_scaleCalibration,
+			&ScaleCalibration::s_shiftCount_changed,
+			this,
+			[this](int count) { updateScaleCalibrationShiftCount(count); }
+		);
 		connection = QWidget::connect(
 			m_scaleCalibration,
 			&ScaleCalibration::s_scaleCalibrationChanged,
@@ -3002,6 +3873,12 @@ void BrillouinAcquisition::initScaleCalibration() {
 			this,
 			[this]() { closeScaleCalibrationDialog(); }
 		);
+		connection = QWidget::connect(
+			m_scaleCalibration,
+			&ScaleCalibration::s_phaseTimes,
+			this,
+			[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+		);
 	}
 }
 
@@ -3051,6 +3928,14 @@ void BrillouinAcquisition::initFluorescence() {
 			[this](FLUORESCENCE_MODE mode) { showFluorescencePreviewRunning(mode); }
 		);
 
+		// slot to show the phase durations of a repetition
+		connection = QWidget::connect(
+			m_Fluorescence,
+			&Fluorescence::s_phaseTimes,
+			this,
+			[this](ACQUISITION_MODE mode, std::vector<PHASE_STATISTICS> phases, double elapsed) { showPhaseTimes(mode, phases, elapsed); }
+		);
+
 		// start Fluorescence thread
 		m_acquisitionThread.startWorker(m_Fluorescence);
 		m_Fluorescence->initialize();
@@ -3405,12 +4290,7 @@ void BrillouinAcquisition::on_camera_singleShot_clicked() {
 
 void BrillouinAcquisition::on_BrillouinStart_clicked() {
 	if (m_Brillouin->getStatus() < ACQUISITION_STATUS::STARTED) {
-		// set camera ROI
-		m_Brillouin->settings.camera.roi.top = m_deviceSettings.camera.roi.top;
-		m_Brillouin->settings.camera.roi.left = m_deviceSettings.camera.roi.left;
-		m_Brillouin->settings.camera.roi.width_physical = m_deviceSettings.camera.roi.width_physical;
-		m_Brillouin->settings.camera.roi.height_physical = m_deviceSettings.camera.roi.height_physical;
-		m_Brillouin->setSettings(m_Brillouin->settings);
+		applyBrillouinCameraROI();
 		QMetaObject::invokeMethod(
 			m_Brillouin,
 			[&m_Brillouin = m_Brillouin]() {
@@ -3423,6 +4303,14 @@ void BrillouinAcquisition::on_BrillouinStart_clicked() {
 	}
 }
 
+void BrillouinAcquisition::applyBrillouinCameraROI() {
+	m_Brillouin->settings.camera.roi.top = m_deviceSettings.camera.roi.top;
+	m_Brillouin->settings.camera.roi.left = m_deviceSettings.camera.roi.left;
+	m_Brillouin->settings.camera.roi.width_physical = m_deviceSettings.camera.roi.width_physical;
+	m_Brillouin->settings.camera.roi.height_physical = m_deviceSettings.camera.roi.height_physical;
+	m_Brillouin->setSettings(m_Brillouin->settings);
+}
+
 void BrillouinAcquisition::updateFilename(const std::string& filename) {
 	m_storagePath.filename = filename;
 	updateBrillouinSettings();
@@ -3451,6 +4339,25 @@ void BrillouinAcquisition::updateBrillouinSettings() {
 	ui->calibrationExposureTime->setValue(m_Brillouin->settings.calibrationExposureTime);
 	ui->sampleSelection->setCurrentText(QString::fromStdString(m_Brillouin->settings.sample));
 
+	// accumulation settings
+	ui->actionAccumulate_Frames->setChecked(m_Brillouin->settings.accumulateFrames);
+	ui->actionStore_Variance->setChecked(m_Brillouin->settings.storeVariance);
+	ui->actionStore_Variance->setEnabled(m_Brillouin->settings.accumulateFrames);
+	ui->actionTrack_Brightfield->setChecked(m_Brillouin->settings.trackBrightfield);
+
+	// adaptive scan settings
+	ui->actionAdaptive_Scan->setChecked(m_Brillouin->settings.adaptive);
+
+	// spectrum analysis settings
+	ui->actionAnalyse_Spectra->setChecked(m_Brillouin->settings.analyseSpectra);
+	ui->actionStore_Spectra->setChecked(m_Brillouin->settings.storeSpectra);
+
+	// scan path settings
+	ui->actionScan_Path_Raster->setChecked(m_Brillouin->settings.scanPath == SCAN_PATH::RASTER);
+	ui->actionScan_Path_Serpentine->setChecked(m_Brillouin->settings.scanPath == SCAN_PATH::SERPENTINE);
+	ui->actionScan_Path_Hilbert->setChecked(m_Brillouin->settings.scanPath == SCAN_PATH::HILBERT);
+	ui->actionScan_Path_Nearest_Neighbour->setChecked(m_Brillouin->settings.scanPath == SCAN_PATH::NEAREST_NEIGHBOUR);
+
 	// repetition settings
 	ui->repetitionCount->setValue(m_Brillouin->settings.repetitions.count);
 	ui->repetitionInterval->setValue(m_Brillouin->settings.repetitions.interval);
@@ -3843,6 +4750,28 @@ void BrillouinAcquisition::on_actionOpen_Acquisition_triggered() {
 	);
 }
 
+/*
+ * Continues an interrupted Brillouin scan in the selected file
+ */
+void BrillouinAcquisition::on_actionResume_Acquisition_triggered() {
+	QString fullPath = QFileDialog::getOpenFileName(this, tr("Resume interrupted Brillouin scan"),
+		QString::fromStdString(m_storagePath.folder), tr("Brillouin data (*.h5)"));
+
+	if (fullPath.isEmpty()) {
+		return;
+	}
+
+	m_storagePath = splitFilePath(fullPath);
+
+	QMetaObject::invokeMethod(
+		m_Brillouin,
+		[&m_Brillouin = m_Brillouin, filename = fullPath.toStdString()]() {
+			m_Brillouin->resumeRepetition(filename);
+		},
+		Qt::AutoConnection
+	);
+}
+
 void BrillouinAcquisition::on_actionClose_Acquisition_triggered() {
 	int ret = m_acquisition->closeFile();
 	if (ret == 0) {
@@ -3971,6 +4900,22 @@ void BrillouinAcquisition::writeSettings() {
 	settings.setValue("brillouin-con-calibrate-interval", m_Brillouin->settings.conCalibrationInterval);
 	settings.setValue("brillouin-nr-calibration-images", m_Brillouin->settings.nrCalibrationImages);
 	settings.setValue("brillouin-calibration-exposure-time", m_Brillouin->settings.calibrationExposureTime);
+	settings.setValue("brillouin-calibration-shift", m_Brillouin->settings.calibrationShift);
+	settings.setValue("brillouin-free-spectral-range", m_Brillouin->settings.freeSpectralRange);
+	settings.setValue("brillouin-accumulate-frames", m_Brillouin->settings.accumulateFrames);
+	settings.setValue("brillouin-store-variance", m_Brillouin->settings.storeVariance);
+	settings.setValue("brillouin-track-brightfield", m_Brillouin->settings.trackBrightfield);
+	settings.setValue("brillouin-scan-path", (int)m_Brillouin->settings.scanPath);
+	settings.setValue("brillouin-adaptive", m_Brillouin->settings.adaptive);
+	settings.setValue("brillouin-adaptive-threshold", m_Brillouin->settings.adaptiveThreshold);
+	settings.setValue("brillouin-adaptive-budget", m_Brillouin->settings.adaptiveBudget);
+	settings.setValue("brillouin-adaptive-coarse-stride", m_Brillouin->settings.adaptiveCoarseStride);
+	settings.setValue("brillouin-analyse-spectra", m_Brillouin->settings.analyseSpectra);
+	settings.setValue("brillouin-spectrum-line-points", QString::fromStdString(spectrumExtractor::toString(m_Brillouin->settings.spectrumLine.points)));
+	settings.setValue("brillouin-spectrum-line-half-width", m_Brillouin->settings.spectrumLine.halfWidth);
+	settings.setValue("brillouin-spectrum-line-samples", m_Brillouin->settings.spectrumLine.samples);
+	settings.setValue("brillouin-store-spectra", m_Brillouin->settings.storeSpectra);
+	settings.setValue("brillouin-raw-frame-interval", m_Brillouin->settings.rawFrameInterval);
 	settings.setValue("brillouin-camera-roi-left", m_deviceSettings.camera.roi.left);
 	settings.setValue("brillouin-camera-roi-top", m_deviceSettings.camera.roi.top);
 	settings.setValue("brillouin-camera-roi-width-physical", m_deviceSettings.camera.roi.width_physical);
@@ -3978,6 +4923,15 @@ void BrillouinAcquisition::writeSettings() {
 	settings.setValue("brillouin-camera-exposure-time", m_Brillouin->settings.camera.exposureTime);
 	settings.setValue("brillouin-camera-frame-count", m_Brillouin->settings.camera.frameCount);
 	settings.endGroup();
+	settings.beginGroup("experiment");
+	settings.setValue("fluorescence", m_experimentPlan.fluorescence);
+	settings.setValue("odt", m_experimentPlan.odt);
+	settings.setValue("brillouin", m_experimentPlan.brillouin);
+	settings.setValue("rounds", m_experimentPlan.rounds);
+	settings.setValue("interval", m_experimentPlan.interval);
+	settings.setValue("preset-switch-time", m_experimentPlan.costs.presetSwitchTime);
+	settings.setValue("stage-speed", m_experimentPlan.costs.stageSpeed);
+	settings.endGroup();
 }
 
 void BrillouinAcquisition::readSettings() {
@@ -4063,5 +5017,32 @@ void BrillouinAcquisition::readSettings() {
 	m_Brillouin->settings.conCalibrationInterval = settings.value("brillouin-con-calibrate-interval", m_Brillouin->settings.conCalibrationInterval).toDouble();
 	m_Brillouin->settings.nrCalibrationImages = settings.value("brillouin-nr-calibration-images", m_Brillouin->settings.nrCalibrationImages).toInt();
 	m_Brillouin->settings.calibrationExposureTime = settings.value("brillouin-calibration-exposure-time", m_Brillouin->settings.calibrationExposureTime).toDouble();
+	m_Brillouin->settings.calibrationShift = settings.value("brillouin-calibration-shift", m_Brillouin->settings.calibrationShift).toDouble();
+	m_Brillouin->settings.freeSpectralRange = settings.value("brillouin-free-spectral-range", m_Brillouin->settings.freeSpectralRange).toDouble();
+	m_Brillouin->settings.accumulateFrames = settings.value("brillouin-accumulate-frames", m_Brillouin->settings.accumulateFrames).toBool();
+	m_Brillouin->settings.storeVariance = settings.value("brillouin-store-variance", m_Brillouin->settings.storeVariance).toBool();
+	m_Brillouin->settings.trackBrightfield = settings.value("brillouin-track-brightfield", m_Brillouin->settings.trackBrightfield).toBool();
+	m_Brillouin->setScanPath((SCAN_PATH)settings.value("brillouin-scan-path", (int)m_Brillouin->settings.scanPath).toInt());
+	m_Brillouin->settings.adaptive = settings.value("brillouin-adaptive", m_Brillouin->settings.adaptive).toBool();
+	m_Brillouin->settings.adaptiveThreshold = settings.value("brillouin-adaptive-threshold", m_Brillouin->settings.adaptiveThreshold).toDouble();
+	m_Brillouin->settings.adaptiveBudget = settings.value("brillouin-adaptive-budget", m_Brillouin->settings.adaptiveBudget).toDouble();
+	m_Brillouin->settings.adaptiveCoarseStride = settings.value("brillouin-adaptive-coarse-stride", m_Brillouin->settings.adaptiveCoarseStride).toInt();
+	m_Brillouin->settings.analyseSpectra = settings.value("brillouin-analyse-spectra", m_Brillouin->settings.analyseSpectra).toBool();
+	auto& spectrumLine = m_Brillouin->settings.spectrumLine;
+	spectrumLine.points = spectrumExtractor::fromString(settings.value("brillouin-spectrum-line-points", "").toString().toStdString());
+	spectrumLine.halfWidth = settings.value("brillouin-spectrum-line-half-width", spectrumLine.halfWidth).toInt();
+	spectrumLine.samples = settings.value("brillouin-spectrum-line-samples", spectrumLine.samples).toInt();
+	m_Brillouin->settings.storeSpectra = settings.value("brillouin-store-spectra", m_Brillouin->settings.storeSpectra).toBool();
+	m_Brillouin->settings.rawFrameInterval = settings.value("brillouin-raw-frame-interval", m_Brillouin->settings.rawFrameInterval).toInt();
+	settings.endGroup();
+
+	settings.beginGroup("experiment");
+	m_experimentPlan.fluorescence = settings.value("fluorescence", m_experimentPlan.fluorescence).toBool();
+	m_experimentPlan.odt = settings.value("odt", m_experimentPlan.odt).toBool();
+	m_experimentPlan.brillouin = settings.value("brillouin", m_experimentPlan.brillouin).toBool();
+	m_experimentPlan.rounds = settings.value("rounds", m_experimentPlan.rounds).toInt();
+	m_experimentPlan.interval = settings.value("interval", m_experimentPlan.interval).toDouble();
+	m_experimentPlan.costs.presetSwitchTime = settings.value("preset-switch-time", m_experimentPlan.costs.presetSwitchTime).toDouble();
+	m_experimentPlan.costs.stageSpeed = settings.value("stage-speed", m_experimentPlan.costs.stageSpeed).toDouble();
 	settings.endGroup();
 }
\ No newline at end of file
@@ -25,17 +25,20 @@
 #include "lib/h5bm.h"
 #include "lib/tableModel.h"
 
+#include "Acquisition/AcquisitionModes/Autofocus.h"
 #include "Acquisition/AcquisitionModes/Brillouin.h"
 #include "Acquisition/AcquisitionModes/ODT.h"
 #include "Acquisition/AcquisitionModes/Fluorescence.h"
 #include "Acquisition/AcquisitionModes/ScaleCalibration.h"
 #include "Acquisition/AcquisitionModes/VoltageCalibration.h"
+#include "Acquisition/JobScheduler.h"
 
 #include "lib/converter.h"
 
 #include <QtWidgets/QMainWindow>
 #include "ui_BrillouinAcquisition.h"
 
+#include <array>
 #include <vector>
 #include <string>
 
@@ -89,8 +92,12 @@ Q_DECLARE_METATYPE(ODT_SETTING);
 Q_DECLARE_METATYPE(ODT_SETTINGS);
 Q_DECLARE_METATYPE(ODTIMAGE<unsigned char>*);
 Q_DECLARE_METATYPE(ODTIMAGE<unsigned short>*);
+Q_DECLARE_METATYPE(ODTSTACK<unsigned char>*);
+Q_DECLARE_METATYPE(ODTSTACK<unsigned short>*);
 Q_DECLARE_METATYPE(FLUOIMAGE<unsigned char>*);
 Q_DECLARE_METATYPE(FLUOIMAGE<unsigned short>*);
+Q_DECLARE_METATYPE(FLUOSTACK<unsigned char>*);
+Q_DECLARE_METATYPE(FLUOSTACK<unsigned short>*);
 Q_DECLARE_METATYPE(FLUORESCENCE_SETTINGS);
 Q_DECLARE_METATYPE(FLUORESCENCE_MODE);
 Q_DECLARE_METATYPE(PLOT_SETTINGS*);
@@ -101,6 +108,11 @@ Q_DECLARE_METATYPE(bool*);
 Q_DECLARE_METATYPE(VoltageCalibrationData);
 Q_DECLARE_METATYPE(ScaleCalibrationData);
 Q_DECLARE_METATYPE(SCAN_ORDER);
+Q_DECLARE_METATYPE(std::vector<SPECTRUM_RESULT>);
+Q_DECLARE_METATYPE(EXPERIMENT_PLAN);
+Q_DECLARE_METATYPE(std::vector<PHASE_STATISTICS>);
+Q_DECLARE_METATYPE(ODT_SLICES);
+Q_DECLARE_METATYPE(FOCUS_RESULT);
 
 class BrillouinAcquisition : public QMainWindow {
 	Q_OBJECT
@@ -131,6 +143,15 @@ private:
 	template<typename T>
 	void plotting(PLOT_SETTINGS* plotSettings, long long dim_x, long long dim_y, const std::vector<T>& unpackedBuffer);
 
+	void initializeLiveMap();
+	void resetLiveMap();
+	void redrawLiveMap();
+
+	void initializePhaseTimes();
+	void initializeTomogram();
+	void showTomogram(const ODT_SLICES& slices);
+	void showPhaseTimes(ACQUISITION_MODE mode, const std::vector<PHASE_STATISTICS>& phases, double elapsed);
+
 	Ui::BrillouinAcquisitionClass* ui;
 	ScanControl::SCAN_DEVICE m_scanControllerType = ScanControl::SCAN_DEVICE::ZEISSECU;
 	ScanControl::SCAN_DEVICE m_scanControllerTypeTemporary = m_scanControllerType;
@@ -206,15 +227,41 @@ private:
 	Thread m_acquisitionThread;
 	Thread m_plottingThread;
 
-	Brillouin* m_Brillouin = new Brillouin(nullptr, m_acquisition, m_andor, m_scanControl);
+	Brillouin* m_Brillouin = new Brillouin(nullptr, m_acquisition, m_andor, m_scanControl, m_brightfieldCamera);
 	ODT* m_ODT{ nullptr };
 	Fluorescence* m_Fluorescence{ nullptr };
 	VoltageCalibration* m_voltageCalibration{ nullptr };
 	ScaleCalibration* m_scaleCalibration{ nullptr };
+	Autofocus* m_autofocus = new Autofocus(nullptr, m_acquisition, m_brightfieldCamera, m_scanControl);
+	AUTOFOCUS_SETTINGS m_autofocusSettings;
+	JobScheduler* m_jobScheduler = new JobScheduler(nullptr, m_acquisition, m_scanControl, m_Brillouin, m_ODT, m_Fluorescence, m_autofocus);
+	EXPERIMENT_PLAN m_experimentPlan;
 
 	PLOT_SETTINGS m_BrillouinPlot;
 	PLOT_SETTINGS m_ODTPlot;
 
+	// live map of the Brillouin scan
+	QDialog* m_liveMapDialog{ nullptr };
+	QCustomPlot* m_liveMap{ nullptr };
+	QCPColorMap* m_liveMapColorMap{ nullptr };
+	QTimer m_liveMapTimer;						// redraws the live map at most once per interval
+	int m_liveMapInterval{ 250 };				// [ms]	minimum interval between two redraws
+	bool m_liveMapShift{ false };				// show the fitted shift instead of the spectral centroid
+	bool m_liveMapFrequency{ false };			// show the fitted shift in GHz, requires a calibration before the scan
+	std::array<int, 3> m_liveMapAxes{ 0, 1, 2 };	// directions shown horizontally, vertically and as planes
+	std::array<int, 3> m_liveMapSize{ 1, 1, 1 };	// [1]	number of positions in x, y and z
+	std::vector<double> m_liveMapValues;		// values of all positions, NaN if not measured yet
+	int m_liveMapPlane{ 0 };					// plane currently shown
+
+	// durations of the phases of the last repetition
+	QDialog* m_phaseTimesDialog{ nullptr };
+	QTableWidget* m_phaseTimesTable{ nullptr };
+
+	// central planes of the last reconstructed tomogram
+	QDialog* m_tomogramDialog{ nullptr };
+	QCustomPlot* m_tomogramPlot{ nullptr };
+	std::array<QCPColorMap*, 3> m_tomogramColorMaps{};	// xy-, xz- and yz-plane
+
 	converter* m_converter = new converter();
 
 	SETTINGS_DEVICES m_deviceSettings;
@@ -226,6 +273,7 @@ private:
 	ACQUISITION_MODE m_enabledModes{ ACQUISITION_MODE::NONE };
 
 	bool m_hasFluorescence{ false };
+	FLUORESCENCE_STACK m_fluorescenceStack;
 
 	TableModel* tableModel = new TableModel(0);
 	ButtonDelegate buttonDelegate;
@@ -298,7 +346,31 @@ private slots:
 	void on_action_Scale_calibration_load_triggered();
 	void loadScaleCalibrationFile();
 
+	void on_actionAccumulate_Frames_toggled(bool checked);
+	void on_actionStore_Variance_toggled(bool checked);
+	void on_actionTrack_Brightfield_toggled(bool checked);
+	void on_actionAdaptive_Scan_toggled(bool checked);
+	void on_actionAdaptive_Scan_Settings_triggered();
+	void on_actionAnalyse_Spectra_toggled(bool checked);
+	void on_actionSpectrum_Line_triggered();
+	void on_actionStore_Spectra_toggled(bool checked);
+	void on_actionCalibration_Fit_triggered();
+	void on_actionFluorescence_Stack_triggered();
+	void on_actionExperiment_Plan_triggered();
+	void on_actionStop_Experiment_triggered();
+	void on_actionAutofocus_triggered();
+	void on_actionAutofocus_Settings_triggered();
+	void showAutofocusResult(FOCUS_RESULT result);
+	void on_actionPhase_Timing_triggered();
+	void showExperimentRunning(bool running);
+	void on_actionLive_Map_triggered();
+	void on_actionScan_Path_Raster_triggered();
+	void on_actionScan_Path_Serpentine_triggered();
+	void on_actionScan_Path_Hilbert_triggered();
+	void on_actionScan_Path_Nearest_Neighbour_triggered();
+
 	void updateScaleCalibrationTranslationValue(POINT2 translation);
+	void updateScaleCalibrationShiftCount(int count);
 	void updateScaleCalibrationData(ScaleCalibrationData scaleCalibration);
 	void updateScaleCalibrationAcquisitionProgress(double progress);
 	void showScaleCalibrationStatus(std::string title, std::string message);
@@ -309,6 +381,7 @@ private slots:
 
 	void setTranslationDistanceX(double dx);
 	void setTranslationDistanceY(double dy);
+	void setShiftCount(int count);
 
 	void setMicrometerToPixX_x(double value);
 	void setMicrometerToPixX_y(double value);
@@ -394,10 +467,12 @@ private slots:
 	void showCalibrationInterval(int);
 	void showCalibrationRunning(bool);
 	void updateFilename(const std::string&);
+	void applyBrillouinCameraROI();
 
 	void showEnabledModes(ACQUISITION_MODE mode);
 	void showBrillouinStatus(ACQUISITION_STATUS state);
 	void showBrillouinProgress(double progress, int seconds);
+	void updateLiveMap(const std::vector<SPECTRUM_RESULT>& results);
 	void showODTStatus(ACQUISITION_STATUS state);
 	void showODTProgress(double progress, int seconds);
 	void showFluorescenceStatus(ACQUISITION_STATUS state);
@@ -412,6 +487,8 @@ private slots:
 	void on_acquisitionUR_ODT_valueChanged(double);
 	void on_acquisitionNumber_ODT_valueChanged(int);
 	void on_acquisitionRate_ODT_valueChanged(double);
+	void on_acquisitionStream_ODT_toggled(bool);
+	void on_acquisitionReconstruct_ODT_toggled(bool);
 	void on_acquisitionStartODT_clicked();
 	void on_exposureTimeODT_valueChanged(double);
 	void on_gainODT_valueChanged(double);
@@ -473,6 +550,7 @@ private slots:
 
 	void on_actionNew_Acquisition_triggered();
 	void on_actionOpen_Acquisition_triggered();
+	void on_actionResume_Acquisition_triggered();
 	void on_actionClose_Acquisition_triggered();
 
 	// acquisition AOI
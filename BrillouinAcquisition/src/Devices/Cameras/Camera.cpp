@@ -13,6 +13,14 @@ CAMERA_SETTINGS Camera::getSettings() {
 	return m_settings;
 }
 
+CAMERA_RECONFIGURATIONS Camera::getReconfigurations() {
+	return m_reconfigurations;
+}
+
+void Camera::resetReconfigurations() {
+	m_reconfigurations = CAMERA_RECONFIGURATIONS{};
+}
+
 /*
  * Public slots
  */
@@ -25,7 +33,21 @@ void Camera::setSettings(CAMERA_SETTINGS settings) {
 		settings.readout.pixelEncoding = m_options.pixelEncodings[0];
 	}
 
-	applySettings(settings);
+	// Only push the settings to the camera which differ from the applied ones
+	auto changes = m_isApplied ? compareSettings(m_appliedSettings, settings) : CAMERA_SETTINGS_CHANGE::OTHER;
+	if (changes == CAMERA_SETTINGS_CHANGE::NONE) {
+		m_reconfigurations.skipped++;
+		return;
+	}
+
+	if (!(bool)(changes & CAMERA_SETTINGS_CHANGE::OTHER) && applyAcquisitionSettings(settings, changes)) {
+		m_reconfigurations.partial++;
+	} else {
+		applySettings(settings);
+		m_reconfigurations.full++;
+	}
+	m_appliedSettings = settings;
+	m_isApplied = true;
 }
 
 void Camera::setSetting(CAMERA_SETTING setting, double value) {
@@ -53,6 +75,13 @@ void Camera::setSetting(CAMERA_SETTING setting, const std::wstring& value) {
 	setSettings(m_settings);
 }
 
+int Camera::getImagesForAcquisition(std::byte* buffer, int frameCount) {
+	for (gsl::index i{ 0 }; i < frameCount; i++) {
+		getImageForAcquisition(buffer + i * m_settings.roi.bytesPerFrame, false);
+	}
+	return frameCount;
+}
+
 int Camera::getCameraNumber() {
 	return m_cameraNumber;
 }
@@ -65,6 +94,146 @@ int Camera::getNumberCameras() {
 	return m_numberCameras;
 }
 
+void Camera::armConfiguration(const std::string& name, const CAMERA_SETTINGS& settings) {
+	m_configurations[name] = settings;
+}
+
+/*
+ * Switches to a pre-armed configuration while the acquisition is running. Only the exposure time and gain are
+ * applied and only if they differ from the current ones. Returns false if the configuration is not armed, differs
+ * in other settings or the camera cannot change the settings in place, the caller has to reconfigure the camera then.
+ */
+bool Camera::switchConfiguration(const std::string& name) {
+	auto configuration = m_configurations.find(name);
+	if (configuration == m_configurations.end()) {
+		return false;
+	}
+
+	auto timer = QElapsedTimer{};
+	timer.start();
+
+	auto changes = m_isApplied ? compareSettings(m_appliedSettings, configuration->second) : CAMERA_SETTINGS_CHANGE::OTHER;
+	if ((bool)(changes & CAMERA_SETTINGS_CHANGE::OTHER)) {
+		return false;
+	}
+	if (changes == CAMERA_SETTINGS_CHANGE::NONE) {
+		m_reconfigurations.skipped++;
+	} else if (applyAcquisitionSettings(configuration->second, changes)) {
+		m_appliedSettings.exposureTime = configuration->second.exposureTime;
+		m_appliedSettings.gain = configuration->second.gain;
+		m_reconfigurations.partial++;
+	} else {
+		return false;
+	}
+
+	m_switchLatency = 1e-6 * timer.nsecsElapsed();
+	return true;
+}
+
+double Camera::getSwitchLatency() {
+	return m_switchLatency;
+}
+
+/*
+ * Protected definitions
+ */
+
+/*
+ * Determines which of the requested settings differ from the applied ones.
+ * Values derived by the camera (e.g. the binned size or the data type) are not compared.
+ */
+CAMERA_SETTINGS_CHANGE Camera::compareSettings(const CAMERA_SETTINGS& applied, const CAMERA_SETTINGS& requested) {
+	auto changes = CAMERA_SETTINGS_CHANGE::NONE;
+	if (applied.exposureTime != requested.exposureTime) {
+		changes |= CAMERA_SETTINGS_CHANGE::EXPOSURE;
+	}
+	if (applied.gain != requested.gain) {
+		changes |= CAMERA_SETTINGS_CHANGE::GAIN;
+	}
+
+	auto& a = applied;
+	auto& r = requested;
+	if (a.frameCount != r.frameCount
+		|| a.spuriousNoiseFilter != r.spuriousNoiseFilter
+		|| a.roi.left != r.roi.left
+		|| a.roi.top != r.roi.top
+		|| a.roi.width_physical != r.roi.width_physical
+		|| a.roi.height_physical != r.roi.height_physical
+		|| a.roi.binning != r.roi.binning
+		|| a.readout.pixelReadoutRate != r.readout.pixelReadoutRate
+		|| a.readout.pixelEncoding != r.readout.pixelEncoding
+		|| a.readout.cycleMode != r.readout.cycleMode
+		|| a.readout.triggerMode != r.readout.triggerMode
+		|| a.readout.preAmpGain != r.readout.preAmpGain
+	) {
+		changes |= CAMERA_SETTINGS_CHANGE::OTHER;
+	}
+	return changes;
+}
+
+/*
+ * Selects the binning factor and crops the physical ROI to a multiple of it,
+ * so that the hardware does not transfer pixels we would discard anyway.
+ */
+void Camera::setSoftwareBinning(CAMERA_ROI& roi) {
+	if (std::find(m_options.imageBinnings.begin(), m_options.imageBinnings.end(), roi.binning) ==
+		m_options.imageBinnings.end()
+	) {
+		roi.binning = L"1x1";
+	}
+	auto factor = binning::factor(roi.binning);
+	if (factor == 1) {
+		roi.binning = L"1x1";
+	}
+	roi.binX = factor;
+	roi.binY = factor;
+
+	// Verify that the image size is a multiple of the binning number
+	roi.width_physical -= roi.width_physical % roi.binX;
+	roi.height_physical -= roi.height_physical % roi.binY;
+}
+
+/*
+ * Calculates the binned image size from the physical ROI the camera actually applied.
+ */
+void Camera::updateSoftwareBinning(int bytesPerPixel) {
+	m_softwareBinningBytesPerPixel = bytesPerPixel;
+
+	m_settings.roi.width_binned = m_settings.roi.width_physical / m_settings.roi.binX;
+	m_settings.roi.height_binned = m_settings.roi.height_physical / m_settings.roi.binY;
+
+	m_settings.roi.bytesPerFrame = m_settings.roi.width_binned * m_settings.roi.height_binned * bytesPerPixel;
+}
+
+/*
+ * Bins the raw image of the physical ROI into the provided buffer of size bytesPerFrame.
+ */
+void Camera::applySoftwareBinning(const std::byte* raw, std::byte* buffer) {
+	if (raw == nullptr || buffer == nullptr) {
+		return;
+	}
+
+	if (m_settings.roi.binX == 1) {
+		memcpy(buffer, raw, m_settings.roi.bytesPerFrame);
+		return;
+	}
+
+	auto dim_x = (int)m_settings.roi.width_physical;
+	auto dim_y = (int)m_settings.roi.height_physical;
+	auto factor = (int)m_settings.roi.binX;
+	switch (m_softwareBinningBytesPerPixel) {
+		case 1:
+			binning::bin((const unsigned char*)raw, (unsigned char*)buffer, dim_x, dim_y, factor, m_softwareBinningMode);
+			break;
+		case 2:
+			binning::bin((const unsigned short*)raw, (unsigned short*)buffer, dim_x, dim_y, factor, m_softwareBinningMode);
+			break;
+		case 4:
+			binning::bin((const unsigned int*)raw, (unsigned int*)buffer, dim_x, dim_y, factor, m_softwareBinningMode);
+			break;
+	}
+}
+
 /*
  * Protected slots
  */
@@ -3,11 +3,14 @@
 
 #include <QtCore>
 #include <gsl/gsl>
+#include <map>
 
 #include "../Device.h"
 
 #include "cameraParameters.h"
 #include "../../lib/buffer_preview.h"
+#include "../../lib/math/binning.h"
+#include "../../lib/TypesafeBitmask.h"
 
 typedef enum class enCameraTemperatureStatus {
 	COOLER_OFF,
@@ -26,11 +29,28 @@ typedef struct SensorTemperature {
 	CAMERA_TEMPERATURE_STATUS status = enCameraTemperatureStatus::COOLER_OFF;
 } SensorTemperature;
 
+enum class CAMERA_SETTINGS_CHANGE {
+	NONE = 0x0,
+	EXPOSURE = 0x1,		// can be applied without reconfiguring the camera
+	GAIN = 0x2,			// can be applied without reconfiguring the camera
+	OTHER = 0x4			// requires a full reconfiguration
+};
+ENABLE_BITMASK_OPERATORS(CAMERA_SETTINGS_CHANGE)
+
+struct CAMERA_RECONFIGURATIONS {
+	int full{ 0 };		// the complete settings were applied
+	int partial{ 0 };	// only the exposure time and gain were applied
+	int skipped{ 0 };	// the settings did not change
+};
+
 class Camera : public Device {
 	Q_OBJECT
 
 public:
-	Camera() {};
+	Camera() {
+		// The applied settings are unknown after (dis-)connecting the camera
+		QObject::connect(this, &Device::connectedDevice, [this](bool) { m_isApplied = false; });
+	};
 	~Camera() {
 		if (m_previewBuffer) {
 			delete m_previewBuffer;
@@ -41,6 +61,9 @@ public:
 	CAMERA_OPTIONS getOptions();
 	CAMERA_SETTINGS getSettings();
 
+	CAMERA_RECONFIGURATIONS getReconfigurations();
+	void resetReconfigurations();
+
 	bool m_isPreviewRunning{ false };
 	bool m_isAcquisitionRunning{ false };
 
@@ -56,6 +79,14 @@ public slots:
 	virtual void startAcquisition(const CAMERA_SETTINGS&) = 0;
 	virtual void stopAcquisition() = 0;
 	virtual void getImageForAcquisition(std::byte* buffer, bool preview = true) = 0;
+	/*
+	 * Reads the given number of consecutive frames into one contiguous buffer without updating the preview.
+	 * Cameras which capture into a ring buffer arm it in prepareImagesForAcquisition, which has to be called before
+	 * the trigger source starts. Returns the number of frames read, which is smaller than requested if the camera
+	 * stopped delivering frames. The default reads the frames one by one.
+	 */
+	virtual void prepareImagesForAcquisition(int frameCount) {};
+	virtual int getImagesForAcquisition(std::byte* buffer, int frameCount);
 
 	virtual void setCalibrationExposureTime(double) {};
 	virtual void setSensorCooling(bool cooling) {};
@@ -69,12 +100,32 @@ public slots:
 	void setCameraNumber(int cameraNumber);
 	int getNumberCameras();
 
+	/*
+	 * Pre-armed configurations, which can be switched to during a running acquisition
+	 */
+	void armConfiguration(const std::string& name, const CAMERA_SETTINGS& settings);
+	bool switchConfiguration(const std::string& name);
+	double getSwitchLatency();
+
 protected:
 	virtual int acquireImage(std::byte* buffer) = 0;
 
 	virtual void readOptions() = 0;
 	virtual void readSettings() = 0;
 	virtual void applySettings(const CAMERA_SETTINGS& settings) = 0;
+	/*
+	 * Applies only the changed exposure time and gain, returns false if the camera does not support this
+	 */
+	virtual bool applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) { return false; };
+
+	static CAMERA_SETTINGS_CHANGE compareSettings(const CAMERA_SETTINGS& applied, const CAMERA_SETTINGS& requested);
+
+	/*
+	 * Software binning for cameras which cannot bin in hardware
+	 */
+	void setSoftwareBinning(CAMERA_ROI& roi);
+	void updateSoftwareBinning(int bytesPerPixel);
+	void applySoftwareBinning(const std::byte* raw, std::byte* buffer);
 
 	int m_cameraNumber{ 0 };
 	int m_numberCameras{ 1 };
@@ -82,10 +133,20 @@ protected:
 	CAMERA_OPTIONS m_options;
 	CAMERA_SETTINGS m_settings;
 
+	CAMERA_SETTINGS m_appliedSettings;			// the settings last pushed to the camera
+	bool m_isApplied{ false };					// whether m_appliedSettings reflects the state of the camera
+	CAMERA_RECONFIGURATIONS m_reconfigurations;
+
 	std::mutex m_mutex;
 
 	bool m_wasPreviewRunning{ false };		// Was the preview running before we started an acquisition?
 
+	std::map<std::string, CAMERA_SETTINGS> m_configurations;	// pre-armed configurations by name
+	double m_switchLatency{ 0 };								// [ms] duration of the last configuration switch
+
+	BINNING_MODE m_softwareBinningMode{ BINNING_MODE::MEAN };	// sum or average the binned pixels
+	int m_softwareBinningBytesPerPixel{ 1 };					// [byte] size of a pixel of the raw image
+
 protected slots:
 	virtual void getImageForPreview();
 
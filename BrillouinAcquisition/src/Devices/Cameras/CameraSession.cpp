@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include "CameraSession.h"
+
+#include <future>
+
+/*
+ * Public definitions
+ */
+
+CameraSession::CameraSession(const std::vector<Camera*>& cameras)
+	: m_cameras(cameras) {
+	m_settings.resize(m_cameras.size());
+}
+
+CameraSession::~CameraSession() {
+	stop();
+}
+
+void CameraSession::start(const std::vector<CAMERA_SETTINGS>& settings) {
+	if (m_isRunning) {
+		return;
+	}
+	for (gsl::index i{ 0 }; i < (gsl::index)m_cameras.size(); i++) {
+		if (m_cameras[i] == nullptr) {
+			continue;
+		}
+		m_cameras[i]->startAcquisition(settings[i]);
+		// the camera might have adjusted the settings, e.g. the ROI
+		m_settings[i] = m_cameras[i]->getSettings();
+	}
+	m_triggerIndex = 0;
+	m_isRunning = true;
+}
+
+void CameraSession::stop() {
+	if (!m_isRunning) {
+		return;
+	}
+	for (auto camera : m_cameras) {
+		if (camera) {
+			camera->stopAcquisition();
+		}
+	}
+	m_isRunning = false;
+}
+
+CAMERA_SETTINGS CameraSession::getSettings(gsl::index camera) {
+	return m_settings[camera];
+}
+
+/*
+ * Acquires a frame on the primary camera and the aligned frames of all other cameras.
+ * The data of the primary frame is written to primaryBuffer and not copied into the returned tuple.
+ */
+ALIGNED_FRAMES CameraSession::acquire(std::byte* primaryBuffer) {
+	auto aligned = ALIGNED_FRAMES{};
+	if (!m_isRunning || m_cameras.empty()) {
+		return aligned;
+	}
+	aligned.index = m_triggerIndex++;
+	aligned.frames.resize(m_cameras.size());
+
+	// Trigger the secondary cameras in parallel to the primary camera,
+	// every camera blocks until its exposure is finished.
+	std::vector<std::future<TIMESTAMPED_FRAME>> secondary;
+	for (gsl::index i{ 1 }; i < (gsl::index)m_cameras.size(); i++) {
+		secondary.push_back(std::async(std::launch::async, &CameraSession::grab, this, i, aligned.index, nullptr));
+	}
+	aligned.frames[0] = grab(0, aligned.index, primaryBuffer);
+	for (gsl::index i{ 1 }; i < (gsl::index)m_cameras.size(); i++) {
+		aligned.frames[i] = secondary[i - 1].get();
+	}
+	return aligned;
+}
+
+/*
+ * Private definitions
+ */
+
+TIMESTAMPED_FRAME CameraSession::grab(gsl::index camera, int64_t index, std::byte* buffer) {
+	auto frame = TIMESTAMPED_FRAME{};
+	frame.index = index;
+	if (m_cameras[camera] == nullptr) {
+		return frame;
+	}
+
+	// Secondary frames are returned with the tuple
+	if (buffer == nullptr) {
+		frame.data.resize(m_settings[camera].roi.bytesPerFrame);
+		buffer = frame.data.data();
+	}
+
+	// The cameras return as soon as the exposure is read out, so we use
+	// the center of the call as the best estimate for the center of the exposure.
+	auto start = std::chrono::steady_clock::now();
+	m_cameras[camera]->getImageForAcquisition(buffer);
+	auto end = std::chrono::steady_clock::now();
+	frame.timestamp = start + (end - start) / 2;
+
+	return frame;
+}
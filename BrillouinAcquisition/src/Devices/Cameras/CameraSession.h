@@ -0,0 +1,52 @@
+#ifndef CAMERASESSION_H
+#define CAMERASESSION_H
+
+#include "Camera.h"
+
+#include <chrono>
+
+typedef std::chrono::steady_clock::time_point FRAME_TIME;
+
+struct TIMESTAMPED_FRAME {
+	int64_t index{ -1 };			// trigger index of the frame
+	FRAME_TIME timestamp;			// center of the exposure
+	std::vector<std::byte> data;	// image data, empty for the primary camera
+};
+
+struct ALIGNED_FRAMES {
+	int64_t index{ -1 };					// trigger index of the tuple
+	std::vector<TIMESTAMPED_FRAME> frames;	// one frame per camera in the order of the session
+};
+
+/*
+ * Runs an acquisition on several cameras at the same time and aligns their frames.
+ * All cameras are triggered together for every frame and block until their exposure is read out.
+ *
+ * The first camera is the primary camera, its frames are written into the buffer provided by the caller.
+ * The frames of all other cameras are returned together with their timestamps, so that they can be
+ * co-registered with the primary frame.
+ */
+class CameraSession {
+
+public:
+	CameraSession(const std::vector<Camera*>& cameras);
+	~CameraSession();
+
+	void start(const std::vector<CAMERA_SETTINGS>& settings);
+	void stop();
+
+	CAMERA_SETTINGS getSettings(gsl::index camera);
+
+	ALIGNED_FRAMES acquire(std::byte* primaryBuffer);
+
+private:
+	TIMESTAMPED_FRAME grab(gsl::index camera, int64_t index, std::byte* buffer = nullptr);
+
+	std::vector<Camera*> m_cameras;
+	std::vector<CAMERA_SETTINGS> m_settings;
+
+	int64_t m_triggerIndex{ 0 };
+	bool m_isRunning{ false };
+};
+
+#endif // CAMERASESSION_H
@@ -99,6 +99,7 @@ void MockCamera::getImageForAcquisition(std::byte* buffer, bool preview) {
 
 void MockCamera::setCalibrationExposureTime(double exposureTime) {
 	m_settings.exposureTime = exposureTime;
+	m_appliedSettings.exposureTime = exposureTime;
 }
 
 /*
@@ -237,6 +238,12 @@ void MockCamera::applySettings(const CAMERA_SETTINGS& settings) {
 	}
 }
 
+bool MockCamera::applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) {
+	m_settings.exposureTime = settings.exposureTime;
+	m_settings.gain = settings.gain;
+	return true;
+}
+
 void MockCamera::preparePreview() {
 	// always use full camera image for live preview
 	m_settings.roi.width_physical = m_options.ROIWidthLimits[1];
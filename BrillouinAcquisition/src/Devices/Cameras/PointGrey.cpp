@@ -128,6 +128,23 @@ void PointGrey::getImageForAcquisition(std::byte* buffer, bool preview) {
 	}
 }
 
+/*
+ * In the continuous cycle mode the driver buffers as many frames as requested, so externally triggered frames are
+ * queued in its ring buffer while the previous frames are converted and only have to be drained here.
+ */
+int PointGrey::getImagesForAcquisition(std::byte* buffer, int frameCount) {
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	for (gsl::index i{ 0 }; i < frameCount; i++) {
+		if (m_settings.readout.triggerMode == L"Software") {
+			FireSoftwareTrigger();
+		}
+		if (!acquireImage(buffer + i * m_settings.roi.bytesPerFrame)) {
+			return (int)i;
+		}
+	}
+	return frameCount;
+}
+
 /*
  * Private definitions
  */
@@ -135,6 +152,9 @@ void PointGrey::getImageForAcquisition(std::byte* buffer, bool preview) {
 int PointGrey::acquireImage(std::byte* buffer) {
 	auto rawImage = FlyCapture2::Image{};
 	auto tmp = m_camera.RetrieveBuffer(&rawImage);
+	if (tmp != FlyCapture2::PGRERROR_OK) {
+		return 0;
+	}
 
 	// Convert the raw image
 	auto convertedImage = FlyCapture2::Image{};
@@ -143,9 +163,9 @@ int PointGrey::acquireImage(std::byte* buffer) {
 	// Get access to raw data
 	auto data = static_cast<unsigned char*>(convertedImage.GetData());
 
-	// Copy data to provided buffer
+	// Copy data to provided buffer, the camera cannot bin in hardware
 	if (data != NULL && buffer != nullptr) {
-		memcpy(buffer, data, m_settings.roi.bytesPerFrame);
+		applySoftwareBinning((std::byte*)data, buffer);
 		return 1;
 	}
 	return 0;
@@ -246,6 +266,9 @@ void PointGrey::readSettings() {
 void PointGrey::applySettings(const CAMERA_SETTINGS& settings) {
 	m_settings = settings;
 
+	// Select the software binning and crop the ROI accordingly
+	setSoftwareBinning(m_settings.roi);
+
 	if (m_settings.readout.pixelEncoding == L"Raw8") {
 		m_settings.readout.dataType = "unsigned char";
 	} else if (m_settings.readout.pixelEncoding == L"Mono8") {
@@ -263,35 +286,12 @@ void PointGrey::applySettings(const CAMERA_SETTINGS& settings) {
 	/*
 	* Set the exposure time
 	*/
-	auto prop = FlyCapture2::Property{};
-	//Define the property to adjust.
-	prop.type = FlyCapture2::SHUTTER;
-	//Ensure the property is on.
-	prop.onOff = true;
-	// Ensure auto - adjust mode is off.
-	prop.autoManualMode = false;
-	//Ensure the property is set up to use absolute value control.
-	prop.absControl = true;
-	//Set the absolute value of shutter
-	prop.absValue = 1e3 * m_settings.exposureTime;
-	//Set the property.
-	auto i_retCode = m_camera.SetProperty(&prop);
-
+	setExposureTime(m_settings.exposureTime);
 
 	/*
 	 * Set the camera gain
 	 */
-	auto propGain = FlyCapture2::Property{};
-	// Define the property to adjust.
-	propGain.type = FlyCapture2::GAIN;
-	// Ensure auto-adjust mode is off.
-	propGain.autoManualMode = false;
-	// Ensure the property is set up to use absolute value control.
-	propGain.absControl = true;
-	//Set the absolute value of gain to 10.5 dB.
-	propGain.absValue = m_settings.gain;
-	//Set the property.
-	i_retCode = m_camera.SetProperty(&propGain);
+	setGain(m_settings.gain);
 
 
 	/*
@@ -321,17 +321,15 @@ void PointGrey::applySettings(const CAMERA_SETTINGS& settings) {
 	// Height
 	fmt7ImageSettings.height = m_settings.roi.height_physical;
 
-	m_settings.roi.width_binned = m_settings.roi.width_physical;
-	m_settings.roi.height_binned = m_settings.roi.height_physical;
-
 	m_settings.roi.bottom = m_options.ROIHeightLimits[1] - m_settings.roi.top - m_settings.roi.height_physical + 2;
 	m_settings.roi.right = m_options.ROIWidthLimits[1] - m_settings.roi.left - m_settings.roi.width_physical + 2;
 
-	m_settings.roi.bytesPerFrame = m_settings.roi.width_binned * m_settings.roi.height_binned;
+	// The images are always transferred with 8 bit per pixel
+	updateSoftwareBinning(1);
 
 	auto fmt7PacketInfo = FlyCapture2::Format7PacketInfo{};
 	auto valid{ false };
-	i_retCode = m_camera.ValidateFormat7Settings(&fmt7ImageSettings, &valid, &fmt7PacketInfo);
+	auto i_retCode = m_camera.ValidateFormat7Settings(&fmt7ImageSettings, &valid, &fmt7PacketInfo);
 	if (valid) {
 		i_retCode = m_camera.SetFormat7Configuration(&fmt7ImageSettings, fmt7PacketInfo.recommendedBytesPerPacket);
 	}
@@ -380,6 +378,48 @@ void PointGrey::applySettings(const CAMERA_SETTINGS& settings) {
 	readSettings();
 }
 
+bool PointGrey::applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) {
+	if ((bool)(changes & CAMERA_SETTINGS_CHANGE::EXPOSURE)) {
+		m_settings.exposureTime = settings.exposureTime;
+		setExposureTime(m_settings.exposureTime);
+	}
+	if ((bool)(changes & CAMERA_SETTINGS_CHANGE::GAIN)) {
+		m_settings.gain = settings.gain;
+		setGain(m_settings.gain);
+	}
+	return true;
+}
+
+void PointGrey::setExposureTime(double exposureTime) {
+	auto prop = FlyCapture2::Property{};
+	//Define the property to adjust.
+	prop.type = FlyCapture2::SHUTTER;
+	//Ensure the property is on.
+	prop.onOff = true;
+	// Ensure auto - adjust mode is off.
+	prop.autoManualMode = false;
+	//Ensure the property is set up to use absolute value control.
+	prop.absControl = true;
+	//Set the absolute value of shutter
+	prop.absValue = 1e3 * exposureTime;
+	//Set the property.
+	auto i_retCode = m_camera.SetProperty(&prop);
+}
+
+void PointGrey::setGain(double gain) {
+	auto propGain = FlyCapture2::Property{};
+	// Define the property to adjust.
+	propGain.type = FlyCapture2::GAIN;
+	// Ensure auto-adjust mode is off.
+	propGain.autoManualMode = false;
+	// Ensure the property is set up to use absolute value control.
+	propGain.absControl = true;
+	//Set the absolute value of gain
+	propGain.absValue = gain;
+	//Set the property.
+	auto i_retCode = m_camera.SetProperty(&propGain);
+}
+
 void PointGrey::preparePreview() {
 	// set ROI and readout parameters to default preview values, exposure time and gain will be kept
 	m_settings.roi.left = 0;
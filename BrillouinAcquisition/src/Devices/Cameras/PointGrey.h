@@ -24,6 +24,7 @@ public slots:
 	void startAcquisition(const CAMERA_SETTINGS&) override;
 	void stopAcquisition() override;
 	void getImageForAcquisition(std::byte* buffer, bool preview = true) override;
+	int getImagesForAcquisition(std::byte* buffer, int frameCount) override;
 
 private:
 	int acquireImage(std::byte* buffer) override;
@@ -31,6 +32,10 @@ private:
 	void readOptions() override;
 	void readSettings() override;
 	void applySettings(const CAMERA_SETTINGS& settings) override;
+	bool applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) override;
+
+	void setExposureTime(double exposureTime);
+	void setGain(double gain);
 
 	void preparePreview();
 
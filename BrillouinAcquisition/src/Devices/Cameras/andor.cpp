@@ -129,7 +129,21 @@ void Andor::getImageForAcquisition(std::byte* buffer, bool preview) {
 }
 
 void Andor::setCalibrationExposureTime(double exposureTime) {
+	if (exposureTime == m_settings.exposureTime) {
+		return;
+	}
 	m_settings.exposureTime = exposureTime;
+	m_appliedSettings.exposureTime = exposureTime;
+
+	// The exposure time can be changed during a running acquisition on most cameras,
+	// only stop and restart the acquisition if that is not the case.
+	auto isWritable = AT_BOOL{ AT_FALSE };
+	AT_IsWritable(m_camera, L"ExposureTime", &isWritable);
+	if (isWritable) {
+		AT_SetFloat(m_camera, L"ExposureTime", m_settings.exposureTime);
+		return;
+	}
+
 	AT_Command(m_camera, L"AcquisitionStop");
 	// Set the exposure time
 	AT_SetFloat(m_camera, L"ExposureTime", m_settings.exposureTime);
@@ -329,6 +343,15 @@ void Andor::applySettings(const CAMERA_SETTINGS& settings) {
 	readSettings();
 }
 
+bool Andor::applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) {
+	if ((bool)(changes & CAMERA_SETTINGS_CHANGE::EXPOSURE)) {
+		setCalibrationExposureTime(settings.exposureTime);
+	}
+	// The camera has no gain setting
+	m_settings.gain = settings.gain;
+	return true;
+}
+
 bool Andor::initialize() {
 	if (!m_isInitialised) {
 		auto i_retCode = AT_InitialiseLibrary();
@@ -35,6 +35,7 @@ private:
 	void readOptions() override;
 	void readSettings() override;
 	void applySettings(const CAMERA_SETTINGS& settings) override;
+	bool applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) override;
 
 	bool initialize();
 
@@ -116,10 +116,13 @@ void uEyeCam::startAcquisition(const CAMERA_SETTINGS& settings) {
 		m_wasPreviewRunning = false;
 	}
 
+	auto skipped = m_reconfigurations.skipped;
 	setSettings(settings);
 
-	// Wait for camera to really apply settings
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	// Wait for camera to really apply settings, unless nothing changed
+	if (m_reconfigurations.skipped == skipped) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	}
 
 	auto bufferSettings = BUFFER_SETTINGS{ 1, (unsigned int)m_settings.roi.bytesPerFrame, "unsigned char", m_settings.roi };
 	m_previewBuffer->initializeBuffer(bufferSettings);
@@ -165,15 +168,63 @@ void uEyeCam::getImageForAcquisition(std::byte* buffer, bool preview) {
 	}
 }
 
+/*
+ * The camera captures continuously into a ring of image memories, so that frames triggered during the readout
+ * of the previous frame are not lost as with a single memory armed per frame.
+ */
+void uEyeCam::prepareImagesForAcquisition(int frameCount) {
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	if (!m_ring.empty()) {
+		return;
+	}
+
+	m_ring.resize((std::min)(m_ringBufferSize, frameCount));
+	for (auto& memory : m_ring) {
+		uEye::is_AllocImageMem(m_camera, m_settings.roi.width_physical, m_settings.roi.height_physical, 8, &memory.first, &memory.second);
+		uEye::is_AddToSequence(m_camera, memory.first, memory.second);
+	}
+	uEye::is_InitImageQueue(m_camera, 0);
+	uEye::is_CaptureVideo(m_camera, IS_DONT_WAIT);
+}
+
+int uEyeCam::getImagesForAcquisition(std::byte* buffer, int frameCount) {
+	prepareImagesForAcquisition(frameCount);
+
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	// the first frame might only be triggered once the trigger source started
+	auto timeout{ (int)(1e3 * m_settings.exposureTime) + 1000 };
+	auto framesRead{ 0 };
+	for (; framesRead < frameCount; framesRead++) {
+		char* memory{ nullptr };
+		auto memoryId{ 0 };
+		if (uEye::is_WaitForNextImage(m_camera, timeout, &memory, &memoryId) != IS_SUCCESS) {
+			break;
+		}
+		applySoftwareBinning((std::byte*)memory, buffer + (gsl::index)framesRead * m_settings.roi.bytesPerFrame);
+		uEye::is_UnlockSeqBuf(m_camera, memoryId, memory);
+	}
+
+	uEye::is_StopLiveVideo(m_camera, IS_FORCE_VIDEO_STOP);
+	uEye::is_ExitImageQueue(m_camera);
+	uEye::is_ClearSequence(m_camera);
+	for (auto& memory : m_ring) {
+		uEye::is_FreeImageMem(m_camera, memory.first, memory.second);
+	}
+	m_ring.clear();
+	// single frames are read into the acquisition memory again
+	uEye::is_SetImageMem(m_camera, m_imageBuffer, m_imageBufferId);
+	return framesRead;
+}
+
 /*
  * Private definitions
  */
 
 int uEyeCam::acquireImage(std::byte* buffer) {
 
-	// Copy data to provided buffer
+	// Copy data to provided buffer, the camera cannot bin in hardware
 	if (m_imageBuffer != NULL && buffer != nullptr) {
-		memcpy(buffer, m_imageBuffer, m_settings.roi.bytesPerFrame);
+		applySoftwareBinning((std::byte*)m_imageBuffer, buffer);
 		return 1;
 	}
 	return 0;
@@ -276,6 +327,9 @@ void uEyeCam::readSettings() {
 void uEyeCam::applySettings(const CAMERA_SETTINGS& settings) {
 	m_settings = settings;
 
+	// Select the software binning and crop the ROI accordingly
+	setSoftwareBinning(m_settings.roi);
+
 	// If the preview is currently running, stop it and apply the settings.
 	if (m_isPreviewRunning) {
 		uEye::is_StopLiveVideo(m_camera, IS_FORCE_VIDEO_STOP);
@@ -349,13 +403,11 @@ void uEyeCam::applySettings(const CAMERA_SETTINGS& settings) {
 	// Read changed options
 	readOptions();
 
-	m_settings.roi.width_binned = m_settings.roi.width_physical;
-	m_settings.roi.height_binned = m_settings.roi.height_physical;
-
 	m_settings.roi.bottom = m_options.ROIHeightLimits[1] - m_settings.roi.top - m_settings.roi.height_physical + 2;
 	m_settings.roi.right = m_options.ROIWidthLimits[1] - m_settings.roi.left - m_settings.roi.width_physical + 2;
 
-	m_settings.roi.bytesPerFrame = m_settings.roi.width_binned * m_settings.roi.height_binned;
+	// The images are always transferred with 8 bit per pixel
+	updateSoftwareBinning(1);
 
 	// If the preview was running, start it again.
 	if (m_isPreviewRunning) {
@@ -363,6 +415,17 @@ void uEyeCam::applySettings(const CAMERA_SETTINGS& settings) {
 	}
 }
 
+bool uEyeCam::applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) {
+	if ((bool)(changes & CAMERA_SETTINGS_CHANGE::EXPOSURE)) {
+		m_settings.exposureTime = settings.exposureTime;
+		auto exposureTemp = (double)1e3 * m_settings.exposureTime;
+		uEye::is_Exposure(m_camera, uEye::IS_EXPOSURE_CMD_SET_EXPOSURE, (void*)&exposureTemp, sizeof(exposureTemp));
+	}
+	// Setting the gain is not implemented for this camera
+	m_settings.gain = settings.gain;
+	return true;
+}
+
 void uEyeCam::preparePreview() {
 	// set ROI and readout parameters to default preview values, exposure time and gain will be kept
 	m_settings.roi.left = 0;
@@ -24,6 +24,8 @@ public slots:
 	void startAcquisition(const CAMERA_SETTINGS&) override;
 	void stopAcquisition() override;
 	void getImageForAcquisition(std::byte* buffer, bool preview = true) override;
+	void prepareImagesForAcquisition(int frameCount) override;
+	int getImagesForAcquisition(std::byte* buffer, int frameCount) override;
 
 private:
 	int acquireImage(std::byte* buffer) override;
@@ -31,6 +33,7 @@ private:
 	void readOptions() override;
 	void readSettings() override;
 	void applySettings(const CAMERA_SETTINGS& settings) override;
+	bool applyAcquisitionSettings(const CAMERA_SETTINGS& settings, CAMERA_SETTINGS_CHANGE changes) override;
 
 	void preparePreview();
 
@@ -38,6 +41,9 @@ private:
 
 	char* m_imageBuffer{ nullptr };
 	int m_imageBufferId{ 0 };
+
+	int m_ringBufferSize{ 16 };		// [1]	number of frames the camera can deliver ahead of the readout
+	std::vector<std::pair<char*, int>> m_ring;	// image memories and their ids of a prepared stream
 };
 
 #endif // UEYECAM_H
\ No newline at end of file
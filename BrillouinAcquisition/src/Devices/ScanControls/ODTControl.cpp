@@ -78,7 +78,11 @@ int ODTControl::getLEDLamp() {
 	return (int)m_LEDon;
 }
 
-void ODTControl::setAcquisitionVoltages(ACQ_VOLTAGES voltages) {
+/*
+ * Uploads the voltages, the trigger task is only started if requested,
+ * so that a camera can be armed before the first trigger is fired
+ */
+void ODTControl::setAcquisitionVoltages(ACQ_VOLTAGES voltages, bool start) {
 	// Stop DAQ tasks
 	DAQmxStopTask(AOtaskHandle);
 	DAQmxStopTask(DOtaskHandle);
@@ -88,6 +92,12 @@ void ODTControl::setAcquisitionVoltages(ACQ_VOLTAGES voltages) {
 	// Write digital voltages
 	DAQmxWriteDigitalLines(DOtaskHandle, voltages.numberSamples, false, 10, DAQmx_Val_GroupByChannel, &voltages.trigger[0], NULL, NULL);
 
+	if (start) {
+		startAcquisitionVoltages();
+	}
+}
+
+void ODTControl::startAcquisitionVoltages() {
 	// Start DAQ tasks
 	DAQmxStartTask(DOtaskHandle);
 	DAQmxStartTask(AOtaskHandle);
@@ -42,7 +42,8 @@ public slots:
 	void setLEDLamp(bool enabled);
 	int getLEDLamp();
 
-	void setAcquisitionVoltages(ACQ_VOLTAGES voltages);
+	void setAcquisitionVoltages(ACQ_VOLTAGES voltages, bool start = true);
+	void startAcquisitionVoltages();
 	virtual void setVoltageCalibration(VoltageCalibrationData voltageCalibration) {};
 
 protected:
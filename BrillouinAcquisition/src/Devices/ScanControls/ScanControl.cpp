@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "ScanControl.h"
 
+#include <thread>
+
 /*
  * Public definitions
  */
@@ -9,6 +11,79 @@ bool ScanControl::getConnectionStatus() {
 	return m_isConnected && m_isCompatible;
 }
 
+bool ScanControl::waitForPosition(const POINT3& target, int timeout, double tolerance) {
+	auto timer = QElapsedTimer{};
+	timer.start();
+	while (true) {
+		if (abs(getPosition() - target) <= tolerance) {
+			return true;
+		}
+		if (timer.elapsed() > timeout) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool ScanControl::moveTo(const POINT3& target, int timeout, double tolerance) {
+	// the commanded position is reached immediately for devices without a measured position,
+	// so there is nothing to wait for and nothing to learn about the duration of the move
+	if (!supportsCapability(Capabilities::PositionReadback)) {
+		setPosition(target);
+		return true;
+	}
+
+	auto distance = abs(getPosition() - target);
+	auto timer = QElapsedTimer{};
+	timer.start();
+	setPosition(target);
+
+	// we don't query the device while the move certainly is not completed yet
+	auto earliest = (std::min)((int)m_settleModel.earliestCompletion(distance), timeout);
+	auto remaining = earliest - (int)timer.elapsed();
+	if (remaining > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(remaining));
+	}
+
+	auto reached = waitForPosition(target, (std::max)(timeout - (int)timer.elapsed(), 0), tolerance);
+	if (reached) {
+		m_settleModel.add(distance, (double)timer.elapsed());
+	}
+	return reached;
+}
+
+/*
+ * Three times the learned duration of the move, but at least as long as the move takes at the minimal speed,
+ * since the model might only have seen the short moves of a scan
+ */
+int ScanControl::getMoveTimeout(double distance) {
+	auto duration = (std::max)(3 * m_settleModel.predict(distance), 1e3 * distance / m_minimalStageSpeed);
+	return 1000 + (int)duration;
+}
+
+bool ScanControl::waitForPreset(ScanPreset presetType, int timeout) {
+	auto timer = QElapsedTimer{};
+	timer.start();
+	// the devices report the target positions of the elements before they stopped moving,
+	// so the moved elements need their settle time counted from the switch
+	auto minimalTime = (std::min)(m_presetSettleTime - (m_presetTimer.isValid() ? (int)m_presetTimer.elapsed() : 0), timeout);
+	while (true) {
+		// setPreset assumes the elements in place, so we have to query the device
+		getElements();
+		if (isPresetActive(presetType)) {
+			auto remaining = minimalTime - (int)timer.elapsed();
+			if (remaining > 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(remaining));
+			}
+			return true;
+		}
+		if (timer.elapsed() > timeout) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
 void ScanControl::movePosition(POINT2 distance) {
 	auto position = getPosition();
 	auto newPosition = POINT2{ position.x, position.y } + distance;
@@ -119,11 +194,15 @@ void ScanControl::setPreset(ScanPreset presetType) {
 	auto preset = getPreset(presetType);
 	getElements();
 
+	// only the elements which move have to settle
+	m_presetSettleTime = 0;
+	m_presetTimer.start();
 	for (gsl::index ii{ 0 }; ii < m_deviceElements.size(); ii++) {
 		// check if element position needs to be changed
 		if (!preset.elementPositions[ii].empty() && !simplemath::contains(preset.elementPositions[ii], m_elementPositions[ii])) {
 			setElement(m_deviceElements[ii], preset.elementPositions[ii][0]);
 			m_elementPositions[ii] = preset.elementPositions[ii][0];
+			m_presetSettleTime = (std::max)(m_presetSettleTime, m_deviceElements[ii].settleTime);
 		}
 	}
 	checkPresets();
@@ -234,6 +313,10 @@ void ScanControl::deleteSavedPosition(int index) {
 	}
 }
 
+std::vector<POINT3> ScanControl::getSavedPositions() {
+	return m_savedPositions;
+}
+
 std::vector<POINT3> ScanControl::getSavedPositionsNormalized() {
 	auto savedPositionsNormalized = m_savedPositions;
 	std::transform(savedPositionsNormalized.begin(), savedPositionsNormalized.end(), savedPositionsNormalized.begin(),
@@ -4,6 +4,7 @@
 #include "../Device.h"
 #include "../../lib/TypesafeBitmask.h"
 #include "../../lib/math/points.h"
+#include "../../lib/math/settleModel.h"
 #include "../../Acquisition/AcquisitionModes/ScaleCalibrationHelper.h"
 
 enum class ScanPreset {
@@ -37,6 +38,7 @@ enum class Capabilities {
 	ScaleCalibration,
 	VoltageCalibration,
 	LaserScanner,
+	PositionReadback,	// the position is measured by the device, not only the commanded one
 	COUNT
 };
 
@@ -70,6 +72,7 @@ public:
 	int index{ 0 };
 	std::vector<std::string> optionNames;
 	DEVICE_INPUT_TYPE inputType{ enDeviceInput::PUSHBUTTON }; // possible types are "pushButtons", "intBox" or "doubleBox"
+	int settleTime{ 100 };		// [ms]	time the element needs to settle after a move, it is reported in place before
 
 	std::vector<std::string> checkNames(int count, std::vector<std::string> names = {}) {
 		//check that the number of names fits the number of options
@@ -128,6 +131,15 @@ public:
 	virtual void movePosition(POINT2 distance);
 	virtual void movePosition(const POINT3& distance);
 	virtual POINT3 getPosition(PositionType positionType = PositionType::BOTH);
+	// waits until the measured position reached the target position or the timeout [ms] passed
+	bool waitForPosition(const POINT3& target, int timeout = 500, double tolerance = 0.5);
+	// moves to the target position and waits until it was reached or the timeout [ms] passed,
+	// returns immediately for devices without PositionReadback
+	bool moveTo(const POINT3& target, int timeout = 500, double tolerance = 0.5);
+	// returns the time [ms] a move of the given distance [m] may take before it is considered failed
+	int getMoveTimeout(double distance);
+	// waits until the device reports all elements of the preset in place and the optics settled, or the timeout [ms] passed
+	bool waitForPreset(ScanPreset presetType, int timeout = 500);
 
 	typedef enum class enScanDevice {
 		ZEISSECU = 0,
@@ -181,6 +193,7 @@ public slots:
 	void moveToSavedPosition(int index);
 	void deleteSavedPosition(int index);
 
+	std::vector<POINT3> getSavedPositions();
 	std::vector<POINT3> getSavedPositionsNormalized();
 	void announceSavedPositionsNormalized();
 	
@@ -226,6 +239,11 @@ protected:
 	BOUNDS m_currentPositionBounds;
 
 	bool m_measurementMode{ false };
+	settleModel m_settleModel;				// learned duration of the stage moves of this device
+	double m_minimalStageSpeed{ 500 };		// [m/s]	speed of the slowest stage, used until the durations of the moves are learned
+	int m_presetSettleTime{ 0 };			// [ms]	minimal time for the optics to settle after the last preset switch,
+											//		the longest settle time of the elements it moved
+	QElapsedTimer m_presetTimer;			// measures the time since the last preset switch
 	POINT2 m_positionStageOld{ 0, 0 };
 	POINT2 m_positionScannerOld{ 0, 0 };
 
@@ -38,6 +38,7 @@ ZeissECU::ZeissECU() noexcept {
 	// Register capabilities
 	registerCapability(Capabilities::TranslationStage);
 	registerCapability(Capabilities::ScaleCalibration);
+	registerCapability(Capabilities::PositionReadback);
 
 	/*
 	 * Initialize the scale calibration with default values (determined for a 40x objective)
@@ -34,6 +34,7 @@ ZeissMTB_Erlangen::ZeissMTB_Erlangen() noexcept {
 	registerCapability(Capabilities::ODT);
 	registerCapability(Capabilities::TranslationStage);
 	registerCapability(Capabilities::ScaleCalibration);
+	registerCapability(Capabilities::PositionReadback);
 
 	/*
 	 * Initialize the scale calibration with default values (determined for a 20x objective)
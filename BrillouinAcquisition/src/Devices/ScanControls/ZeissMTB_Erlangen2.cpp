@@ -29,6 +29,7 @@ ZeissMTB_Erlangen2::ZeissMTB_Erlangen2() noexcept {
 	// Register capabilities
 	registerCapability(Capabilities::TranslationStage);
 	registerCapability(Capabilities::ScaleCalibration);
+	registerCapability(Capabilities::PositionReadback);
 
 	/*
 	 * Initialize the scale calibration with default values (determined for a 20x objective)
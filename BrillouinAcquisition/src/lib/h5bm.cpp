@@ -81,6 +81,30 @@ void H5BM::newRepetition(ACQUISITION_MODE mode) {
 	getRepetitionHandle(*handle, true);
 }
 
+/*
+ * Selects an existing repetition to continue writing to it, e.g. to resume an interrupted scan
+ */
+bool H5BM::resumeRepetition(ACQUISITION_MODE mode, int repetition) {
+	auto handle = getModeHandle(mode);
+	if (!m_fileWritable || !handle) {
+		return false;
+	}
+	auto repetitionHandle = H5Gopen2(handle->rootHandle, std::to_string(repetition).c_str(), H5P_DEFAULT);
+	if (repetitionHandle < 0) {
+		return false;
+	}
+	if (handle->groups) {
+		handle->groups->close();
+	}
+	closeGroup(handle->currentRepetitionHandle);
+	handle->currentRepetitionHandle = repetitionHandle;
+	handle->repetitionCount = repetition;
+
+	setAttribute("last-modified", getNow());
+	handle->groups = std::make_unique <RepetitionHandles>(handle->mode, handle->currentRepetitionHandle, true);
+	return true;
+}
+
 void H5BM::getRepetitionHandle(ModeHandles &handle, bool create) {
 	closeGroup(handle.currentRepetitionHandle);
 
@@ -286,6 +310,82 @@ void H5BM::setPositions(std::string direction, const std::vector<double>& positi
 	setAttribute("last-modified", getNow());
 }
 
+/*
+ * Writes a block of the positions, so that the positions of large scans never have to be held in memory at once
+ */
+void H5BM::setPositions(std::string direction, const std::vector<double>& positions, const int rank, const hsize_t *dims,
+	const hsize_t *offset, const hsize_t *count) {
+	if (!m_fileWritable) {
+		return;
+	}
+	direction = "positions-" + direction;
+
+	hid_t dset_id = setDataset(m_Brillouin.groups->payload, positions, direction, rank, dims, offset, count);
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
+void H5BM::setScanPath(const std::string& path, const std::vector<int>& order, const int rank, const hsize_t *dims) {
+	if (!m_fileWritable) {
+		return;
+	}
+	setAttribute("scanPath", path, m_Brillouin.groups->payload);
+
+	// the step at which every position was measured, same layout as the positions
+	hid_t dset_id = setDataset(m_Brillouin.groups->payload, order, "positions-order", rank, dims);
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
+/*
+ * Writes a block of the scan path, the attribute is only set with the first block
+ */
+void H5BM::setScanPath(const std::string& path, const std::vector<int>& order, const int rank, const hsize_t *dims,
+	const hsize_t *offset, const hsize_t *count) {
+	if (!m_fileWritable) {
+		return;
+	}
+	if (std::all_of(offset, offset + rank, [](hsize_t value) { return value == 0; })) {
+		setAttribute("scanPath", path, m_Brillouin.groups->payload);
+	}
+
+	hid_t dset_id = setDataset(m_Brillouin.groups->payload, order, "positions-order", rank, dims, offset, count);
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
+/*
+ * Stores the irregular positions of an adaptive scan in the order they were measured.
+ * "indices" holds the x, y and z index of every position, "parents" the number of the position
+ * at the first corner of the refined cell, or -1 for the positions of the coarse grid.
+ */
+void H5BM::setAdaptiveScan(const std::vector<int>& indices, const std::vector<int>& levels, const std::vector<int>& parents,
+	const std::vector<double>& values) {
+	if (!m_fileWritable || levels.empty()) {
+		return;
+	}
+	hsize_t dimsIndices[2] = { (hsize_t)levels.size(), 3 };
+	hid_t dset_id = setDataset(m_Brillouin.groups->payload, indices, "adaptive-indices", 2, dimsIndices);
+	closeDataset(dset_id);
+
+	hsize_t dims[1] = { (hsize_t)levels.size() };
+	dset_id = setDataset(m_Brillouin.groups->payload, levels, "adaptive-levels", 1, dims);
+	closeDataset(dset_id);
+	dset_id = setDataset(m_Brillouin.groups->payload, parents, "adaptive-parents", 1, dims);
+	closeDataset(dset_id);
+	dset_id = setDataset(m_Brillouin.groups->payload, values, "adaptive-values", 1, dims);
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
 std::vector<double> H5BM::getPositions(std::string direction) {
 	direction = "positions-" + direction;
 
@@ -298,6 +398,34 @@ std::vector<double> H5BM::getPositions(std::string direction) {
 	return positions;
 }
 
+void H5BM::setCameraAttributes(hid_t dset_id, double exposure, double gain, const CAMERA_ROI& roi) {
+	setAttribute("exposure", exposure, dset_id);
+	setAttribute("gain", gain, dset_id);
+
+	// TODO: Should be replaced by a proper conversion from std::wstring to std::string
+	auto binning = std::string{ "unknown" };
+	if (roi.binning == L"1x1") {
+		binning = "1x1";
+	} else if (roi.binning == L"2x2") {
+		binning = "2x2";
+	} else if (roi.binning == L"3x3") {
+		binning = "3x3";
+	} else if (roi.binning == L"4x4") {
+		binning = "4x4";
+	} else if (roi.binning == L"8x8") {
+		binning = "8x8";
+	}
+	setAttribute("binning", binning, dset_id);
+	setAttribute("ROI_left", (int)roi.left, dset_id);
+	setAttribute("ROI_right", (int)roi.right, dset_id);
+	setAttribute("ROI_top", (int)roi.top, dset_id);
+	setAttribute("ROI_bottom", (int)roi.bottom, dset_id);
+	setAttribute("ROI_height_physical", (int)roi.height_physical, dset_id);
+	setAttribute("ROI_width_physical", (int)roi.width_physical, dset_id);
+	setAttribute("ROI_height_binned", (int)roi.height_binned, dset_id);
+	setAttribute("ROI_width_binned", (int)roi.width_binned, dset_id);
+}
+
 std::vector<double> H5BM::getData(const std::string& name, hid_t parent) {
 	std::vector<double> data;
 	try {
@@ -321,11 +449,94 @@ std::string H5BM::getDate(std::string name, hid_t parent) {
 	return date;
 }
 
+void H5BM::setPayloadVariance(IMAGE<float>* image) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto& groups = m_Brillouin.groups;
+	if (groups->payloadVariance < 0) {
+		groups->payloadVariance = H5Gcreate2(groups->payload, "variance", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	}
+
+	auto name = calculateIndex(image->indX, image->indY, image->indZ);
+
+	setData(image->data, name, groups->payloadVariance, image->rank, image->dims, image->date,
+		"", NULL, "", image->exposure, image->gain, image->roi);
+}
+
+/*
+ * Stores the spectra extracted from the frames of a position instead of or in addition to the frames
+ */
+void H5BM::setPayloadSpectra(IMAGE<float>* image) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto& groups = m_Brillouin.groups;
+	if (groups->payloadSpectra < 0) {
+		groups->payloadSpectra = H5Gcreate2(groups->payload, "spectra", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	}
+
+	auto name = calculateIndex(image->indX, image->indY, image->indZ);
+
+	setData(image->data, name, groups->payloadSpectra, image->rank, image->dims, image->date,
+		"", NULL, "", image->exposure, image->gain, image->roi);
+
+	if (image->accumulatedFrames > 0) {
+		auto dset_id = H5Dopen2(groups->payloadSpectra, name.c_str(), H5P_DEFAULT);
+		setAttribute("accumulatedFrames", image->accumulatedFrames, dset_id);
+		closeDataset(dset_id);
+	}
+}
+
+/*
+ * Stores the geometry of the line the spectra are extracted along, so that they can be related to the camera frames.
+ * "vertices" holds the x and y coordinate of every vertex of the polyline, "positions" those of every sample.
+ */
+void H5BM::setSpectrumLine(const std::vector<double>& vertices, const std::vector<double>& positions, int halfWidth) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto& groups = m_Brillouin.groups;
+	if (groups->payloadSpectra < 0) {
+		groups->payloadSpectra = H5Gcreate2(groups->payload, "spectra", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	}
+
+	hsize_t dimsVertices[2] = { (hsize_t)vertices.size() / 2, 2 };
+	hid_t dset_id = setDataset(groups->payloadSpectra, vertices, "line-vertices", 2, dimsVertices);
+	closeDataset(dset_id);
+
+	hsize_t dimsPositions[2] = { (hsize_t)positions.size() / 2, 2 };
+	dset_id = setDataset(groups->payloadSpectra, positions, "line-positions", 2, dimsPositions);
+	closeDataset(dset_id);
+
+	setAttribute("halfWidth", halfWidth, groups->payloadSpectra);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
 std::vector<double> H5BM::getPayloadData(int indX, int indY, int indZ) {
 	auto name = calculateIndex(indX, indY, indZ);
 	return getData(name, m_Brillouin.groups->payload);
 }
 
+/*
+ * Checks whether the frames or the spectra of the given position were written to the current repetition
+ */
+bool H5BM::isPayloadStored(int indX, int indY, int indZ) {
+	auto& groups = m_Brillouin.groups;
+	if (!groups) {
+		return false;
+	}
+	auto name = calculateIndex(indX, indY, indZ);
+	for (auto group : { groups->payloadData, groups->payloadSpectra }) {
+		if (group > -1 && H5Lexists(group, name.c_str(), H5P_DEFAULT) > 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 std::string H5BM::getPayloadDate(int indX, int indY, int indZ) {
 	auto name = calculateIndex(indX, indY, indZ);
 	return getDate(name, m_Brillouin.groups->payload);
@@ -369,6 +580,110 @@ double H5BM::getCalibrationShift(int index) {
 	return 0.0;
 }
 
+/*
+ * Returns the number of calibrations written to the current repetition
+ */
+int H5BM::getCalibrationCount() {
+	auto& groups = m_Brillouin.groups;
+	if (!groups || groups->calibrationData < 0) {
+		return 0;
+	}
+	H5G_info_t info;
+	if (H5Gget_info(groups->calibrationData, &info) < 0) {
+		return 0;
+	}
+	return (int)info.nlinks;
+}
+
+/*
+ * Attaches the fitted frequency axis to the calibration with the same index, which has to be written already
+ */
+void H5BM::setCalibrationFit(CALIBRATION_FIT* calibration) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto name = std::to_string(calibration->index);
+	auto dset_id = H5Dopen2(m_Brillouin.groups->calibrationData, name.c_str(), H5P_DEFAULT);
+	if (dset_id < 0) {
+		return;
+	}
+	auto& fit = calibration->fit;
+	setAttribute("fitValid", (int)fit.valid, dset_id);
+	setAttribute("fitOffset", fit.offset, dset_id);
+	setAttribute("fitDispersion", fit.dispersion, dset_id);
+	setAttribute("fitFreeSpectralRange", fit.freeSpectralRange, dset_id);
+	setAttribute("fitPeakAntiStokes", fit.peaks[0], dset_id);
+	setAttribute("fitPeakStokes", fit.peaks[1], dset_id);
+	setAttribute("fitResidual", fit.residual, dset_id);
+	closeDataset(dset_id);
+}
+
+/*
+ * Stores the duration histograms of the phases of the current repetition in the group "timing" of its payload
+ */
+void H5BM::setPhaseTimes(ACQUISITION_MODE mode, const std::vector<PHASE_STATISTICS>& phases, double elapsed) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto modeHandle = getModeHandle(mode);
+	if (!modeHandle || !modeHandle->groups || modeHandle->groups->payload < 0) {
+		return;
+	}
+	auto timingGroup = H5Gopen2(modeHandle->groups->payload, "timing", H5P_DEFAULT);
+	if (timingGroup < 0) {
+		timingGroup = H5Gcreate2(modeHandle->groups->payload, "timing", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	}
+	// a resumed repetition already contains the timing of its first part
+	if (H5Aexists(timingGroup, "elapsed") > 0) {
+		elapsed += getAttribute<double>("elapsed", timingGroup);
+	}
+	setAttribute("elapsed", elapsed, timingGroup);
+
+	auto edges = phaseTimer::binEdges();
+	hsize_t dims[1] = { (hsize_t)edges.size() };
+	hid_t dset_id = setDataset(timingGroup, edges, "bin-edges", 1, dims);
+	closeDataset(dset_id);
+
+	for (auto phase : phases) {
+		// a resumed repetition already contains the phases of its first part, which we merge with the new ones
+		hid_t phaseGroup{ -1 };
+		if (H5Lexists(timingGroup, phase.name.c_str(), H5P_DEFAULT) > 0) {
+			phaseGroup = H5Gopen2(timingGroup, phase.name.c_str(), H5P_DEFAULT);
+			if (phaseGroup > -1) {
+				auto stored = PHASE_STATISTICS{};
+				stored.name = phase.name;
+				stored.count = getAttribute<int>("count", phaseGroup);
+				stored.total = getAttribute<double>("total", phaseGroup);
+				stored.min = getAttribute<double>("min", phaseGroup);
+				stored.max = getAttribute<double>("max", phaseGroup);
+				auto histogram = std::vector<double>{};
+				getDataset(&histogram, phaseGroup, "histogram");
+				for (auto binCount : histogram) {
+					stored.histogram.push_back((int)binCount);
+				}
+				phase = phaseTimer::merge(stored, phase);
+			}
+		} else {
+			phaseGroup = H5Gcreate2(timingGroup, phase.name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		}
+		if (phaseGroup < 0) {
+			continue;
+		}
+		setAttribute("count", phase.count, phaseGroup);
+		setAttribute("total", phase.total, phaseGroup);
+		setAttribute("min", phase.min, phaseGroup);
+		setAttribute("max", phase.max, phaseGroup);
+		hsize_t dimsHistogram[1] = { (hsize_t)phase.histogram.size() };
+		dset_id = setDataset(phaseGroup, phase.histogram, "histogram", 1, dimsHistogram);
+		closeDataset(dset_id);
+		closeGroup(phaseGroup);
+	}
+	closeGroup(timingGroup);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+}
+
 void H5BM::closeGroup(hid_t& group) {
 	if (group > -1) {
 		if (H5Gclose(group) > -1) {
@@ -1,23 +1,28 @@
 #ifndef H5BM_H
 #define H5BM_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <bitset>
+#include <memory>
 #include <QtWidgets>
 
 #include "hdf5.h"
 #include "TypesafeBitmask.h"
 #include "..\..\src\Acquisition\AcquisitionModes\ScaleCalibrationHelper.h"
 #include "..\..\src\Devices\Cameras\cameraParameters.h"
+#include "math\vipa.h"
+#include "phaseTimer.h"
 
 template <typename T>
 struct IMAGE {
 public:
 	template <typename T>
 	IMAGE(int indX, int indY, int indZ, int rank, hsize_t* dims, const std::string& date, const std::vector<T>& data,
-		double exposure = 0, double gain = 1, const CAMERA_ROI& roi = CAMERA_ROI{}) :
-		indX(indX), indY(indY), indZ(indZ), rank(rank), dims(dims), date(date), data(data), exposure(exposure), gain(gain), roi(roi) {};
+		double exposure = 0, double gain = 1, const CAMERA_ROI& roi = CAMERA_ROI{}, int accumulatedFrames = 0) :
+		indX(indX), indY(indY), indZ(indZ), rank(rank), dims(dims), date(date), data(data), exposure(exposure), gain(gain), roi(roi),
+		accumulatedFrames(accumulatedFrames) {};
 
 	const int indX;
 	const int indY;
@@ -29,6 +34,7 @@ public:
 	const double exposure;
 	const double gain;
 	const CAMERA_ROI roi;
+	const int accumulatedFrames;	// number of frames summed up in data, 0 if the frames are stored individually
 };
 
 template <typename T>
@@ -50,6 +56,14 @@ public:
 	const CAMERA_ROI roi;
 };
 
+struct CALIBRATION_FIT {
+public:
+	CALIBRATION_FIT(int index, const VIPA_CALIBRATION& fit) : index(index), fit(fit) {};
+
+	const int index;
+	const VIPA_CALIBRATION fit;
+};
+
 template <typename T>
 struct ODTIMAGE {
 public:
@@ -67,6 +81,25 @@ public:
 	const CAMERA_ROI roi;
 };
 
+/*
+ * All angles of a streamed ODT acquisition, which are stored as one [angle, height, width] dataset.
+ * The frames are not copied, the acquisition keeps them alive until the storage has finished writing.
+ */
+template <typename T>
+struct ODTSTACK {
+public:
+	ODTSTACK(int angles, int height, int width, const std::string& date, const T* data,
+		double exposure = 0, double gain = 1, const CAMERA_ROI& roi = CAMERA_ROI{}) :
+		dims{ (hsize_t)angles, (hsize_t)height, (hsize_t)width }, date(date), data(data), exposure(exposure), gain(gain), roi(roi) {};
+
+	const hsize_t dims[3];
+	const std::string date;
+	const T* data;
+	const double exposure;
+	const double gain;
+	const CAMERA_ROI roi;
+};
+
 template <typename T>
 struct FLUOIMAGE {
 public:
@@ -85,6 +118,36 @@ public:
 	const CAMERA_ROI roi;
 };
 
+/*
+ * Describes a fluorescence stack, which is stored as one [channel, plane, tile, height, width] dataset.
+ * It is shared by all frames of the stack and written together with the first frame that arrives.
+ */
+struct FLUOSTACK_LAYOUT {
+	std::vector<std::string> channels;	// names of the channels
+	std::vector<double> exposures;		// [s]	exposure time of every channel
+	std::vector<double> gains;			// [1]	gain of every channel
+	std::vector<double> planes;			// [µm]	z-position of every plane relative to the start position
+	std::vector<POINT2> tiles;			// [µm]	position of every tile relative to the start position
+	hsize_t height{ 0 };				// [pix]	height of a frame
+	hsize_t width{ 0 };					// [pix]	width of a frame
+};
+
+template <typename T>
+struct FLUOSTACK {
+public:
+	FLUOSTACK(const std::shared_ptr<const FLUOSTACK_LAYOUT>& layout, int channel, int plane, int tile, const std::string& date,
+		const std::vector<T>& data, const CAMERA_ROI& roi = CAMERA_ROI{}) :
+		layout(layout), channel(channel), plane(plane), tile(tile), date(date), data(data), roi(roi) {};
+
+	const std::shared_ptr<const FLUOSTACK_LAYOUT> layout;
+	const int channel;
+	const int plane;
+	const int tile;
+	const std::string date;
+	const std::vector<T> data;
+	const CAMERA_ROI roi;
+};
+
 struct ScaleCalibrationDataExtended : ScaleCalibrationData {
 	POINT3 positionStage{ 0, 0, 0 };	// [micrometer] position of the stage
 	POINT3 positionScanner{ 0, 0, 0 };	// [micrometer] position of the scanner
@@ -97,6 +160,7 @@ enum class ACQUISITION_MODE {
 	FLUORESCENCE = 0x8,
 	VOLTAGECALIBRATION = 0x10,
 	SCALECALIBRATION = 0x12,
+	AUTOFOCUS = 0x20,
 	MODECOUNT
 };
 ENABLE_BITMASK_OPERATORS(ACQUISITION_MODE)
@@ -104,6 +168,9 @@ ENABLE_BITMASK_OPERATORS(ACQUISITION_MODE)
 struct RepetitionHandles {
 	hid_t payload{ -1 };
 	hid_t payloadData{ -1 };
+	hid_t payloadVariance{ -1 };
+	hid_t payloadBrightfield{ -1 };
+	hid_t payloadSpectra{ -1 };
 
 	hid_t calibration{ -1 };
 	hid_t calibrationData{ -1 };
@@ -121,6 +188,9 @@ public:
 		closeGroup(calibration);
 		closeGroup(backgroundData);
 		closeGroup(background);
+		closeGroup(payloadVariance);
+		closeGroup(payloadBrightfield);
+		closeGroup(payloadSpectra);
 		closeGroup(payloadData);
 		closeGroup(payload);
 	}
@@ -140,6 +210,12 @@ private:
 		* Only Brillouin mode writes calibration and background data
 		*/
 		if ((bool)(mode & ACQUISITION_MODE::BRILLOUIN)) {
+			// the variance group is only created when accumulated frames are written
+			payloadVariance = H5Gopen2(payload, "variance", H5P_DEFAULT);
+			// the brightfield group is only created when brightfield images are tracked
+			payloadBrightfield = H5Gopen2(payload, "brightfield", H5P_DEFAULT);
+			// the spectra group is only created when spectra are stored
+			payloadSpectra = H5Gopen2(payload, "spectra", H5P_DEFAULT);
 			// background handles
 			background = H5Gopen2(handle, "background", H5P_DEFAULT);
 			if (background < 0 && create) {
@@ -217,6 +293,7 @@ public:
 
 	ModeHandles* getModeHandle(ACQUISITION_MODE mode);
 	void newRepetition(ACQUISITION_MODE mode);
+	bool resumeRepetition(ACQUISITION_MODE mode, int repetition);
 
 	// date
 	void setDate(const std::string& datestring);
@@ -239,8 +316,17 @@ public:
 
 	// positions
 	void setPositions(std::string direction, const std::vector<double>& positions, const int rank, const hsize_t *dims);
+	void setPositions(std::string direction, const std::vector<double>& positions, const int rank, const hsize_t *dims,
+		const hsize_t *offset, const hsize_t *count);
 	std::vector<double> getPositions(std::string direction);
 
+	// scan path
+	void setScanPath(const std::string& path, const std::vector<int>& order, const int rank, const hsize_t *dims);
+	void setScanPath(const std::string& path, const std::vector<int>& order, const int rank, const hsize_t *dims,
+		const hsize_t *offset, const hsize_t *count);
+	void setAdaptiveScan(const std::vector<int>& indices, const std::vector<int>& levels, const std::vector<int>& parents,
+		const std::vector<double>& values);
+
 	// payload data
 	template <typename T>
 	void setPayloadData(int indX, int indY, int indZ, const std::vector<T>& data, const int rank, const hsize_t *dims, const std::string& date = "now",
@@ -248,12 +334,22 @@ public:
 
 	template <typename T>
 	void setPayloadData(IMAGE<T>*);
+	void setPayloadVariance(IMAGE<float>*);
+	void setPayloadSpectra(IMAGE<float>*);
+	void setSpectrumLine(const std::vector<double>& vertices, const std::vector<double>& positions, int halfWidth);
+	template <typename T>
+	void setPayloadBrightfield(IMAGE<T>*);
 	template <typename T>
 	void setPayloadData(ODTIMAGE<T>*);
 	template <typename T>
+	void setPayloadData(ODTSTACK<T>*);
+	template <typename T>
 	void setPayloadData(FLUOIMAGE<T>*);
+	template <typename T>
+	void setPayloadData(FLUOSTACK<T>*);
 
 	std::vector<double> getPayloadData(int indX, int indY, int indZ);
+	bool isPayloadStored(int indX, int indY, int indZ);
 	std::string getPayloadDate(int indX, int indY, int indZ);
 
 	// background data
@@ -271,6 +367,11 @@ public:
 	std::string getCalibrationDate(int index);
 	std::string getCalibrationSample(int index);
 	double getCalibrationShift(int index);
+	int getCalibrationCount();
+	void setCalibrationFit(CALIBRATION_FIT*);
+
+	// phase timing
+	void setPhaseTimes(ACQUISITION_MODE mode, const std::vector<PHASE_STATISTICS>& phases, double elapsed);
 
 private:
 	bool m_fileWritable = false;
@@ -346,12 +447,16 @@ private:
 
 	template <typename T>
 	hid_t setDataset(hid_t parent, std::vector<T> data, std::string name, const int rank, const hsize_t* dims);
+	template <typename T>
+	hid_t setDataset(hid_t parent, const std::vector<T>& data, std::string name, const int rank, const hsize_t* dims,
+		const hsize_t* offset, const hsize_t* count);
 	void getDataset(std::vector<double>* data, hid_t parent, std::string name);
 
 	template <typename T>
 	void setData(const std::vector<T>& data, const std::string& name, hid_t parent, const int rank, const hsize_t* dims,
 		std::string date, const std::string& sample = "", double shift = NULL, const std::string& channel = "",
 		double exposure = 0, double gain = 1, CAMERA_ROI roi = CAMERA_ROI{});
+	void setCameraAttributes(hid_t dset_id, double exposure, double gain, const CAMERA_ROI& roi);
 
 	std::vector<double> getData(const std::string& name, hid_t parent);
 	std::string getDate(std::string name, hid_t parent);
@@ -381,6 +486,34 @@ hid_t H5BM::setDataset(hid_t parent, std::vector<T> data, std::string name, cons
 	return dset_id;
 }
 
+/*
+ * Writes the block at offset with the size count into the dataset, which is created with the size dims if it does not exist.
+ */
+template <typename T>
+hid_t H5BM::setDataset(hid_t parent, const std::vector<T>& data, std::string name, const int rank, const hsize_t* dims,
+	const hsize_t* offset, const hsize_t* count) {
+	hid_t type_id = get_memtype<T>();
+
+	hid_t dset_id;
+	dset_id = H5Dopen2(parent, name.c_str(), H5P_DEFAULT);
+	if (dset_id < 0) {
+		hid_t space_id = H5Screate_simple(rank, dims, dims);
+		dset_id = H5Dcreate2(parent, name.c_str(), type_id, space_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		H5Sclose(space_id);
+	}
+
+	auto filespace_id = H5Dget_space(dset_id);
+	H5Sselect_hyperslab(filespace_id, H5S_SELECT_SET, offset, NULL, count, NULL);
+	auto memspace_id = H5Screate_simple(rank, count, count);
+	H5Dwrite(dset_id, type_id, memspace_id, filespace_id, H5P_DEFAULT, data.data());
+
+	H5Sclose(memspace_id);
+	H5Sclose(filespace_id);
+	H5Tclose(type_id);
+
+	return dset_id;
+}
+
 template <typename T>
 void H5BM::setData(const std::vector<T>& data, const std::string& name, hid_t parent, const int rank, const hsize_t *dims,
 	std::string date, const std::string& sample, double shift, const std::string& channel, double exposure, double gain, CAMERA_ROI roi) {
@@ -419,29 +552,7 @@ void H5BM::setData(const std::vector<T>& data, const std::string& name, hid_t pa
 	}
 
 	// set camera meta data
-	setAttribute("exposure", exposure, dset_id);
-	setAttribute("gain", gain, dset_id);
-
-	// TODO: Should be replaced by a proper conversion from std::wstring to std::string
-	auto binning = std::string{ "unknown" };
-	if (roi.binning == L"1x1") {
-		binning = "1x1";
-	} else if (roi.binning == L"2x2") {
-		binning = "2x2";
-	} else if (roi.binning == L"4x4") {
-		binning = "4x4";
-	} else if (roi.binning == L"8x8") {
-		binning = "8x8";
-	}
-	setAttribute("binning", binning, dset_id);
-	setAttribute("ROI_left", (int)roi.left, dset_id);
-	setAttribute("ROI_right", (int)roi.right, dset_id);
-	setAttribute("ROI_top", (int)roi.top, dset_id);
-	setAttribute("ROI_bottom", (int)roi.bottom, dset_id);
-	setAttribute("ROI_height_physical", (int)roi.height_physical, dset_id);
-	setAttribute("ROI_width_physical", (int)roi.width_physical, dset_id);
-	setAttribute("ROI_height_binned", (int)roi.height_binned, dset_id);
-	setAttribute("ROI_width_binned", (int)roi.width_binned, dset_id);
+	setCameraAttributes(dset_id, exposure, gain, roi);
 
 	closeDataset(dset_id);
 
@@ -472,12 +583,35 @@ void H5BM::setBackgroundData(const std::vector<T>& data, const int rank, const h
 	setData(data, "1", m_Brillouin.groups->background, rank, dims, date, "", NULL, "", exposure, gain, roi);
 }
 
+template <typename T>
+void H5BM::setPayloadBrightfield(IMAGE<T>* image) {
+	if (!m_fileWritable) {
+		return;
+	}
+	auto& groups = m_Brillouin.groups;
+	if (groups->payloadBrightfield < 0) {
+		groups->payloadBrightfield = H5Gcreate2(groups->payload, "brightfield", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	}
+
+	auto name = calculateIndex(image->indX, image->indY, image->indZ);
+
+	setData(image->data, name, groups->payloadBrightfield, image->rank, image->dims, image->date,
+		"", NULL, "", image->exposure, image->gain, image->roi);
+}
+
 template <typename T>
 void H5BM::setPayloadData(IMAGE<T>* image) {
 	auto name = calculateIndex(image->indX, image->indY, image->indZ);
 
 	setData(image->data, name, m_Brillouin.groups->payloadData, image->rank, image->dims, image->date,
 		"", NULL, "", image->exposure, image->gain, image->roi);
+
+	// mark datasets which contain the sum of several frames
+	if (m_fileWritable && image->accumulatedFrames > 0) {
+		auto dset_id = H5Dopen2(m_Brillouin.groups->payloadData, name.c_str(), H5P_DEFAULT);
+		setAttribute("accumulatedFrames", image->accumulatedFrames, dset_id);
+		closeDataset(dset_id);
+	}
 }
 
 template <typename T>
@@ -488,6 +622,38 @@ void H5BM::setPayloadData(ODTIMAGE<T>* image) {
 		"", NULL, "", image->exposure, image->gain, image->roi);
 }
 
+template <typename T>
+void H5BM::setPayloadData(ODTSTACK<T>* stack) {
+	if (!m_fileWritable) {
+		return;
+	}
+
+	auto type_id = get_memtype<T>();
+	auto space_id = H5Screate_simple(3, stack->dims, stack->dims);
+	// every angle is stored in its own chunk, so that single angles can be read without reading the whole stack
+	hsize_t chunk[3] = { 1, stack->dims[1], stack->dims[2] };
+	auto plist_id = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(plist_id, 3, chunk);
+
+	auto dset_id = H5Dcreate2(m_ODT.groups->payloadData, "stack", type_id, space_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+	H5Dwrite(dset_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, stack->data);
+
+	H5Pclose(plist_id);
+	H5Sclose(space_id);
+	H5Tclose(type_id);
+
+	setAttribute("date", stack->date, dset_id);
+	setAttribute("angles", (int)stack->dims[0], dset_id);
+	setCameraAttributes(dset_id, stack->exposure, stack->gain, stack->roi);
+
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+
+	H5Fflush(m_file, H5F_SCOPE_GLOBAL);
+}
+
 template <typename T>
 void H5BM::setPayloadData(FLUOIMAGE<T>* image) {
 	auto name = std::to_string(image->ind);
@@ -496,4 +662,77 @@ void H5BM::setPayloadData(FLUOIMAGE<T>* image) {
 		image->exposure, image->gain, image->roi);
 }
 
+template <typename T>
+void H5BM::setPayloadData(FLUOSTACK<T>* frame) {
+	if (!m_fileWritable) {
+		return;
+	}
+
+	auto& layout = *frame->layout;
+	hsize_t dims[5] = { (hsize_t)layout.channels.size(), (hsize_t)layout.planes.size(), (hsize_t)layout.tiles.size(),
+		layout.height, layout.width };
+	if ((hsize_t)frame->data.size() != layout.height * layout.width) {
+		return;
+	}
+
+	auto type_id = get_memtype<T>();
+	auto dset_id = H5Dopen2(m_Fluorescence.groups->payloadData, "stack", H5P_DEFAULT);
+	if (dset_id < 0) {
+		auto space_id = H5Screate_simple(5, dims, dims);
+		// every frame is stored in its own chunk, so that single frames can be read without reading the whole stack
+		hsize_t chunk[5] = { 1, 1, 1, layout.height, layout.width };
+		auto plist_id = H5Pcreate(H5P_DATASET_CREATE);
+		H5Pset_chunk(plist_id, 5, chunk);
+		dset_id = H5Dcreate2(m_Fluorescence.groups->payloadData, "stack", type_id, space_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+		H5Pclose(plist_id);
+		H5Sclose(space_id);
+
+		auto channels = std::string{};
+		for (const auto& channel : layout.channels) {
+			channels += (channels.empty() ? "" : ",") + channel;
+		}
+		setAttribute("date", frame->date, dset_id);
+		setAttribute("channels", channels, dset_id);
+		setAttribute("planes", (int)dims[1], dset_id);
+		setAttribute("tiles", (int)dims[2], dset_id);
+		// exposure time and gain differ between the channels, they are stored in separate datasets
+		setCameraAttributes(dset_id, NAN, NAN, frame->roi);
+
+		hsize_t dims_channels[1] = { dims[0] };
+		auto exposure_id = setDataset(m_Fluorescence.groups->payloadData, layout.exposures, "stack-exposure", 1, dims_channels);
+		closeDataset(exposure_id);
+		auto gain_id = setDataset(m_Fluorescence.groups->payloadData, layout.gains, "stack-gain", 1, dims_channels);
+		closeDataset(gain_id);
+		hsize_t dims_planes[1] = { dims[1] };
+		auto planes_id = setDataset(m_Fluorescence.groups->payloadData, layout.planes, "stack-z", 1, dims_planes);
+		closeDataset(planes_id);
+		auto tiles = std::vector<double>{};
+		for (const auto& tile : layout.tiles) {
+			tiles.push_back(tile.x);
+			tiles.push_back(tile.y);
+		}
+		hsize_t dims_tiles[2] = { dims[2], 2 };
+		auto tiles_id = setDataset(m_Fluorescence.groups->payloadData, tiles, "stack-tiles", 2, dims_tiles);
+		closeDataset(tiles_id);
+	}
+
+	// write the frame into its place in the stack
+	auto filespace_id = H5Dget_space(dset_id);
+	hsize_t offset[5] = { (hsize_t)frame->channel, (hsize_t)frame->plane, (hsize_t)frame->tile, 0, 0 };
+	hsize_t count[5] = { 1, 1, 1, layout.height, layout.width };
+	H5Sselect_hyperslab(filespace_id, H5S_SELECT_SET, offset, NULL, count, NULL);
+	auto memspace_id = H5Screate_simple(5, count, count);
+	H5Dwrite(dset_id, type_id, memspace_id, filespace_id, H5P_DEFAULT, frame->data.data());
+
+	H5Sclose(memspace_id);
+	H5Sclose(filespace_id);
+	H5Tclose(type_id);
+	closeDataset(dset_id);
+
+	// write last-modified date to file
+	setAttribute("last-modified", getNow());
+
+	H5Fflush(m_file, H5F_SCOPE_GLOBAL);
+}
+
 #endif // H5BM_H
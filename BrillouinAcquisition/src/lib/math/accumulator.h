@@ -0,0 +1,78 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include <gsl/gsl>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Sums up camera frames pixel by pixel into an accumulator of a wider integer type,
+ * so that only the sum (and optionally the per-pixel variance) has to be stored.
+ */
+template <typename T_acc = unsigned int>
+class accumulator {
+
+public:
+	accumulator() {};
+	~accumulator() {};
+
+	void reset(size_t pixelCount, bool withVariance = false) {
+		m_count = 0;
+		m_withVariance = withVariance;
+		m_sum.assign(pixelCount, 0);
+		if (m_withVariance) {
+			m_sumSquares.assign(pixelCount, 0);
+		} else {
+			m_sumSquares.clear();
+		}
+	}
+
+	template <typename T>
+	void add(const T* frame) {
+		auto pixelCount = (gsl::index)m_sum.size();
+		auto sum = m_sum.data();
+		// Separate loops without branches in the body, so the compiler can vectorize them
+		for (gsl::index i{ 0 }; i < pixelCount; i++) {
+			sum[i] += (T_acc)frame[i];
+		}
+		if (m_withVariance) {
+			auto sumSquares = m_sumSquares.data();
+			for (gsl::index i{ 0 }; i < pixelCount; i++) {
+				sumSquares[i] += (uint64_t)frame[i] * frame[i];
+			}
+		}
+		m_count++;
+	}
+
+	int count() {
+		return m_count;
+	}
+
+	const std::vector<T_acc>& sum() {
+		return m_sum;
+	}
+
+	/*
+	 * Returns the unbiased per-pixel variance of the accumulated frames.
+	 */
+	std::vector<float> variance() {
+		auto variance = std::vector<float>(m_sum.size(), 0);
+		if (!m_withVariance || m_count < 2) {
+			return variance;
+		}
+		auto n = (double)m_count;
+		for (gsl::index i{ 0 }; i < (gsl::index)m_sum.size(); i++) {
+			auto mean = m_sum[i] / n;
+			variance[i] = (float)((m_sumSquares[i] - mean * m_sum[i]) / (n - 1));
+		}
+		return variance;
+	}
+
+private:
+	std::vector<T_acc> m_sum;
+	std::vector<uint64_t> m_sumSquares;
+	int m_count{ 0 };
+	bool m_withVariance{ false };
+};
+
+#endif // ACCUMULATOR_H
@@ -0,0 +1,286 @@
+#ifndef ADAPTIVESCAN_H
+#define ADAPTIVESCAN_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "points.h"
+
+struct ADAPTIVE_POINT {
+	INDEX3 grid;			// grid index in scan order
+	int level{ 0 };			// refinement level, 0 is the coarse grid
+	int parent{ -1 };		// number of the point at the first corner of the refined cell, -1 on the coarse grid
+	double value{ NAN };	// measured feature of the point
+};
+
+/*
+ * Plans an adaptive coarse-to-fine scan on a regular grid.
+ *
+ * Every plane of the two fastest directions is first measured on a coarse grid. Afterwards, the cell with the
+ * largest difference between the features of its corners is split into four, as long as the difference exceeds
+ * the threshold and the point budget is not used up. The slowest direction is always measured completely.
+ */
+class adaptiveScan {
+
+public:
+	adaptiveScan() {};
+	adaptiveScan(const INDEX3& size, int coarseStride, double threshold, gsl::index budget)
+		: m_size(size), m_threshold(threshold), m_budget(budget) {
+		m_size.x = std::max(m_size.x, 1);
+		m_size.y = std::max(m_size.y, 1);
+		m_size.z = std::max(m_size.z, 1);
+		coarseStride = std::max(coarseStride, 1);
+
+		for (int z{ 0 }; z < m_size.z; z++) {
+			auto xs = coarseIndices(m_size.x, coarseStride);
+			auto ys = coarseIndices(m_size.y, coarseStride);
+
+			// measure the coarse grid in a serpentine order
+			for (gsl::index jj{ 0 }; jj < (gsl::index)ys.size(); jj++) {
+				auto y = (z % 2) ? ys[ys.size() - 1 - jj] : ys[jj];
+				auto reverse = ((z * ys.size() + jj) % 2) == 1;
+				for (gsl::index kk{ 0 }; kk < (gsl::index)xs.size(); kk++) {
+					auto x = reverse ? xs[xs.size() - 1 - kk] : xs[kk];
+					addPoint(INDEX3{ x, y, z }, 0, -1);
+				}
+			}
+
+			addCells(xs, ys, z, 0);
+		}
+		// the coarse grid is always measured
+		m_budget = std::max(m_budget, (gsl::index)m_points.size());
+	}
+
+	/*
+	 * Returns the next point to measure, false if the scan is finished.
+	 */
+	bool next(INDEX3& grid) {
+		if (m_pending.empty()) {
+			refine();
+		}
+		if (m_pending.empty()) {
+			return false;
+		}
+		m_current = m_pending.front();
+		m_pending.pop_front();
+		grid = m_points[m_current].grid;
+		return true;
+	}
+
+	/*
+	 * Sets the feature of the point returned last by next().
+	 */
+	void setValue(double value) {
+		if (m_current >= 0) {
+			m_points[m_current].value = value;
+		}
+	}
+
+	/*
+	 * Returns all points in the order they were planned.
+	 */
+	const std::vector<ADAPTIVE_POINT>& points() {
+		return m_points;
+	}
+
+	gsl::index budget() {
+		return m_budget;
+	}
+
+	/*
+	 * Returns the intensity-weighted centroid of the column sums of the given frames in pixel.
+	 * This is a cheap estimate for the position of the spectral peaks.
+	 */
+	template <typename T>
+	static double centroid(const T* frames, int width, int height, int frameCount) {
+		auto columns = std::vector<double>(width, 0);
+		for (gsl::index ii{ 0 }; ii < (gsl::index)frameCount * height; ii++) {
+			auto row = &frames[ii * width];
+			for (gsl::index jj{ 0 }; jj < width; jj++) {
+				columns[jj] += row[jj];
+			}
+		}
+		if (columns.empty()) {
+			return 0;
+		}
+		// remove the background
+		auto background = *std::min_element(columns.begin(), columns.end());
+		auto sum = double{ 0 };
+		auto weighted = double{ 0 };
+		for (gsl::index jj{ 0 }; jj < width; jj++) {
+			sum += columns[jj] - background;
+			weighted += jj * (columns[jj] - background);
+		}
+		return (sum > 0) ? weighted / sum : 0.5 * (width - 1);
+	}
+
+private:
+	struct CELL {
+		int x0{ 0 };
+		int y0{ 0 };
+		int x1{ 0 };
+		int y1{ 0 };
+		int z{ 0 };
+		int level{ 0 };
+	};
+
+	struct CANDIDATE {
+		double difference{ 0 };
+		CELL cell;
+		bool operator<(const CANDIDATE& candidate) const {
+			return difference < candidate.difference;
+		}
+	};
+
+	static std::vector<int> coarseIndices(int count, int stride) {
+		auto indices = std::vector<int>{};
+		for (int i{ 0 }; i < count; i += stride) {
+			indices.push_back(i);
+		}
+		if (indices.back() != count - 1) {
+			indices.push_back(count - 1);
+		}
+		return indices;
+	}
+
+	int64_t key(const INDEX3& grid) {
+		return ((int64_t)grid.z * m_size.y + grid.y) * m_size.x + grid.x;
+	}
+
+	gsl::index find(const INDEX3& grid) {
+		auto point = m_lookup.find(key(grid));
+		return (point == m_lookup.end()) ? -1 : point->second;
+	}
+
+	void addPoint(const INDEX3& grid, int level, int parent) {
+		if (find(grid) >= 0) {
+			return;
+		}
+		auto point = ADAPTIVE_POINT{};
+		point.grid = grid;
+		point.level = level;
+		point.parent = parent;
+		m_lookup[key(grid)] = (gsl::index)m_points.size();
+		m_pending.push_back((gsl::index)m_points.size());
+		m_points.push_back(point);
+	}
+
+	/*
+	 * Splits the cell with the largest difference of its corners, if there is one above the threshold.
+	 */
+	void refine() {
+		while (true) {
+			evaluateWaiting();
+			if (m_candidates.empty()) {
+				return;
+			}
+			auto cell = m_candidates.top().cell;
+			m_candidates.pop();
+
+			auto xs = split(cell.x0, cell.x1);
+			auto ys = split(cell.y0, cell.y1);
+
+			// count the new points first, a cell is either refined completely or not at all
+			auto newPoints = gsl::index{ 0 };
+			for (auto y : ys) {
+				for (auto x : xs) {
+					newPoints += (find(INDEX3{ x, y, cell.z }) < 0);
+				}
+			}
+			if ((gsl::index)m_points.size() + newPoints > m_budget) {
+				continue;
+			}
+
+			auto parent = (int)find(INDEX3{ cell.x0, cell.y0, cell.z });
+			for (auto y : ys) {
+				for (auto x : xs) {
+					addPoint(INDEX3{ x, y, cell.z }, cell.level + 1, parent);
+				}
+			}
+			addCells(xs, ys, cell.z, cell.level + 1);
+			// if the neighbours already covered the cell, its children can be evaluated directly
+			if (newPoints > 0) {
+				return;
+			}
+		}
+	}
+
+	/*
+	 * Queues the waiting cells for refinement, which is only possible once all their corners are measured.
+	 */
+	void evaluateWaiting() {
+		for (auto& cell : m_waiting) {
+			auto corners = std::vector<gsl::index>{
+				find(INDEX3{ cell.x0, cell.y0, cell.z }),
+				find(INDEX3{ cell.x1, cell.y0, cell.z }),
+				find(INDEX3{ cell.x0, cell.y1, cell.z }),
+				find(INDEX3{ cell.x1, cell.y1, cell.z })
+			};
+			auto minimum = double{ INFINITY };
+			auto maximum = double{ -INFINITY };
+			for (auto corner : corners) {
+				auto value = m_points[corner].value;
+				if (!std::isnan(value)) {
+					minimum = std::min(minimum, value);
+					maximum = std::max(maximum, value);
+				}
+			}
+			auto difference = maximum - minimum;
+			auto divisible = (cell.x1 - cell.x0 > 1) || (cell.y1 - cell.y0 > 1);
+			if (divisible && difference > m_threshold) {
+				m_candidates.push(CANDIDATE{ difference, cell });
+			}
+		}
+		m_waiting.clear();
+	}
+
+	static std::vector<int> split(int first, int last) {
+		if (last - first > 1) {
+			return { first, (first + last) / 2, last };
+		}
+		if (last == first) {
+			return { first };
+		}
+		return { first, last };
+	}
+
+	/*
+	 * Adds the cells between the given indices, a direction with a single index gives flat cells.
+	 */
+	void addCells(const std::vector<int>& xs, const std::vector<int>& ys, int z, int level) {
+		auto pairs = [](const std::vector<int>& indices) {
+			auto result = std::vector<std::pair<int, int>>{};
+			for (gsl::index i{ 0 }; i + 1 < (gsl::index)indices.size(); i++) {
+				result.push_back({ indices[i], indices[i + 1] });
+			}
+			if (indices.size() == 1) {
+				result.push_back({ indices[0], indices[0] });
+			}
+			return result;
+		};
+		for (auto& y : pairs(ys)) {
+			for (auto& x : pairs(xs)) {
+				m_waiting.push_back(CELL{ x.first, y.first, x.second, y.second, z, level });
+			}
+		}
+	}
+
+	INDEX3 m_size{ 1, 1, 1 };			// number of grid positions in scan order
+	double m_threshold{ 1 };			// minimum difference of the corners of a cell to refine it
+	gsl::index m_budget{ 0 };			// maximum number of points to measure
+
+	std::vector<ADAPTIVE_POINT> m_points;
+	std::unordered_map<int64_t, gsl::index> m_lookup;	// number of the point at a grid index
+	std::deque<gsl::index> m_pending;	// points planned but not measured yet
+	gsl::index m_current{ -1 };			// point returned last
+	std::vector<CELL> m_waiting;		// cells whose corners are not all measured yet
+	std::priority_queue<CANDIDATE> m_candidates;	// cells to refine, largest difference first
+};
+
+#endif // ADAPTIVESCAN_H
@@ -0,0 +1,120 @@
+#ifndef BINNING_H
+#define BINNING_H
+
+#include <gsl/gsl>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+typedef enum class binningMode {
+	SUM,
+	MEAN
+} BINNING_MODE;
+
+/*
+ * Software binning and cropping of camera images.
+ *
+ * The kernels sum up a horizontal run of pixels into a row accumulator of a wider integer type
+ * and afterwards scale or saturate the accumulated values into the output type. The binning factor
+ * is a template parameter for the supported factors, so the compiler can unroll and vectorize
+ * the inner loops.
+ */
+class binning {
+
+public:
+	/*
+	 * Returns the binning factor for a binning string like "4x4" or 1 if the string is not valid.
+	 */
+	static int factor(const std::wstring& binning) {
+		if (binning == L"2x2") {
+			return 2;
+		} else if (binning == L"3x3") {
+			return 3;
+		} else if (binning == L"4x4") {
+			return 4;
+		} else if (binning == L"8x8") {
+			return 8;
+		}
+		return 1;
+	}
+
+	/*
+	 * Bins the image "in" of size dim_x * dim_y by the given factor into "out".
+	 * Pixels which do not fill a complete bin at the right and bottom border are cropped.
+	 */
+	template <typename T>
+	static void bin(const T* in, T* out, int dim_x, int dim_y, int factor, BINNING_MODE mode = BINNING_MODE::MEAN) {
+		switch (factor) {
+			case 2:
+				binFixed<2>(in, out, dim_x, dim_y, mode);
+				break;
+			case 3:
+				binFixed<3>(in, out, dim_x, dim_y, mode);
+				break;
+			case 4:
+				binFixed<4>(in, out, dim_x, dim_y, mode);
+				break;
+			case 8:
+				binFixed<8>(in, out, dim_x, dim_y, mode);
+				break;
+			default:
+				crop(in, out, dim_x, 0, 0, dim_x, dim_y);
+				break;
+		}
+	}
+
+	/*
+	 * Copies the region of interest given by left, top, width and height from the image "in"
+	 * with the row length dim_x into "out".
+	 */
+	template <typename T>
+	static void crop(const T* in, T* out, int dim_x, int left, int top, int width, int height) {
+		for (gsl::index y{ 0 }; y < height; y++) {
+			auto row = &in[(top + y) * dim_x + left];
+			std::copy(row, row + width, &out[y * width]);
+		}
+	}
+
+private:
+	template <int F, typename T>
+	static void binFixed(const T* in, T* out, int dim_x, int dim_y, BINNING_MODE mode) {
+		// Use an accumulator type which cannot overflow for the largest bin
+		using acc_t = std::conditional_t<(sizeof(T) < sizeof(uint32_t)), uint32_t, uint64_t>;
+
+		auto dim_x_binned = dim_x / F;
+		auto dim_y_binned = dim_y / F;
+
+		auto accumulator = std::vector<acc_t>(dim_x_binned);
+		constexpr auto maxValue = (acc_t)std::numeric_limits<T>::max();
+		constexpr auto pixelCount = (acc_t)(F * F);
+
+		for (gsl::index y{ 0 }; y < dim_y_binned; y++) {
+			std::fill(accumulator.begin(), accumulator.end(), 0);
+			for (gsl::index yy{ 0 }; yy < F; yy++) {
+				auto row = &in[(y * F + yy) * dim_x];
+				for (gsl::index x{ 0 }; x < dim_x_binned; x++) {
+					auto sum = acc_t{ 0 };
+					for (gsl::index xx{ 0 }; xx < F; xx++) {
+						sum += row[x * F + xx];
+					}
+					accumulator[x] += sum;
+				}
+			}
+
+			auto rowOut = &out[y * dim_x_binned];
+			if (mode == BINNING_MODE::SUM) {
+				for (gsl::index x{ 0 }; x < dim_x_binned; x++) {
+					rowOut[x] = (T)(accumulator[x] < maxValue ? accumulator[x] : maxValue);
+				}
+			} else {
+				for (gsl::index x{ 0 }; x < dim_x_binned; x++) {
+					rowOut[x] = (T)((accumulator[x] + pixelCount / 2) / pixelCount);
+				}
+			}
+		}
+	}
+};
+
+#endif // BINNING_H
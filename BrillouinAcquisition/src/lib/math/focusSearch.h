@@ -0,0 +1,111 @@
+#ifndef FOCUSSEARCH_H
+#define FOCUSSEARCH_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+
+struct FOCUS_SEARCH_SETTINGS {
+	double range{ 20 };				// [µm]	range of the coarse sweep, centred on the start position
+	int steps{ 9 };					// [1]	number of positions of the coarse sweep
+	double tolerance{ 0.25 };		// [µm]	width of the interval at which the refinement stops
+	double minimalContrast{ 0.05 };	// [1]	minimal relative increase of the sharpness over the sweep for a valid focus
+};
+
+struct FOCUS_RESULT {
+	double z{ 0 };					// [µm]	position of the largest sharpness
+	double sharpness{ 0 };			// [1]	sharpness at this position
+	int evaluations{ 0 };			// [1]	number of positions the sharpness was measured at
+	bool atBorder{ false };			// the focus is at the border of the sweep and might be outside of it
+	bool valid{ false };			// the sharpness changes enough over the sweep to locate the focus
+};
+
+/*
+ * Searches the position of the largest sharpness with as few measurements as possible.
+ *
+ * The sharpness is measured at equidistant positions across the range first, starting at the lowest position. The
+ * sharpness curve of a brightfield image is a narrow peak, which the coarse sweep can only bracket. A golden-section
+ * search refines the position between the neighbours of the sharpest coarse position, it needs one measurement per step
+ * and shrinks the interval by a factor of 1.618 every step. The sharpest position measured is returned, so that a curve
+ * which is not unimodal within the bracket does not make the result worse than the coarse sweep. Aborting the search
+ * is possible by returning NaN from the measurement, the search then stops and returns an invalid result.
+ */
+class focusSearch {
+
+public:
+	template <typename F>
+	static FOCUS_RESULT maximize(F&& measure, double centre, const FOCUS_SEARCH_SETTINGS& settings = FOCUS_SEARCH_SETTINGS{}) {
+		auto result = FOCUS_RESULT{};
+		result.z = centre;
+		auto aborted{ false };
+		double minimum{ INFINITY };
+		result.sharpness = -INFINITY;
+		auto evaluate = [&](double z) -> double {
+			auto value = measure(z);
+			result.evaluations++;
+			if (std::isnan(value)) {
+				aborted = true;
+				return -INFINITY;
+			}
+			minimum = (std::min)(minimum, value);
+			if (value > result.sharpness) {
+				result.sharpness = value;
+				result.z = z;
+			}
+			return value;
+		};
+
+		auto steps = (std::max)(settings.steps, 2);
+		auto step = settings.range / (steps - 1);
+		auto start = centre - 0.5 * settings.range;
+		gsl::index best{ 0 };
+		double bestValue{ -INFINITY };
+		for (gsl::index i{ 0 }; i < steps; i++) {
+			auto value = evaluate(start + i * step);
+			if (aborted) {
+				return result;
+			}
+			if (value > bestValue) {
+				bestValue = value;
+				best = i;
+			}
+		}
+		result.atBorder = (best == 0 || best == steps - 1);
+
+		// refine between the neighbours of the sharpest position of the sweep
+		auto lower = start + (std::max)(best - 1, gsl::index{ 0 }) * step;
+		auto upper = start + (std::min)(best + 1, (gsl::index)steps - 1) * step;
+		auto ratio = 0.5 * (sqrt(5.0) - 1);
+		auto left = upper - ratio * (upper - lower);
+		auto right = lower + ratio * (upper - lower);
+		auto valueLeft = evaluate(left);
+		auto valueRight = evaluate(right);
+		while (!aborted) {
+			if (valueLeft > valueRight) {
+				upper = right;
+			} else {
+				lower = left;
+			}
+			// the sharper of the two inner positions lies in the remaining interval and is already measured
+			if (upper - lower <= settings.tolerance) {
+				break;
+			}
+			if (valueLeft > valueRight) {
+				right = left;
+				valueRight = valueLeft;
+				left = upper - ratio * (upper - lower);
+				valueLeft = evaluate(left);
+			} else {
+				left = right;
+				valueLeft = valueRight;
+				right = lower + ratio * (upper - lower);
+				valueRight = evaluate(right);
+			}
+		}
+
+		result.valid = !aborted && result.sharpness > (1 + settings.minimalContrast) * minimum;
+		return result;
+	}
+};
+
+#endif // FOCUSSEARCH_H
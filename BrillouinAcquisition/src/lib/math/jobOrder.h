@@ -0,0 +1,103 @@
+#ifndef JOBORDER_H
+#define JOBORDER_H
+
+#include <gsl/gsl>
+#include <vector>
+
+#include "points.h"
+#include "scanPath.h"
+
+struct JOB {
+	gsl::index position{ 0 };	// index of the position the job is acquired at
+	int task{ 0 };				// index of the task, tasks with different indices need different presets
+};
+
+struct JOB_ORDER_COSTS {
+	double presetSwitchTime{ 5 };	// [s]	duration of switching between the presets of two tasks
+	double stageSpeed{ 1000 };		// [µm/s]	average speed of the stage between two positions
+};
+
+/*
+ * Orders the jobs of an experiment, which acquires every task at every position.
+ *
+ * Either all tasks are acquired at a position before the stage moves on, or a task is acquired at all positions
+ * before the presets are switched. The positions are visited along a nearest neighbour tour starting at the current
+ * stage position. Tasks alternate their order at every position and the tour alternates its direction for every task,
+ * so that neighbouring jobs share the preset or the position. The order with the lower estimated duration is used.
+ */
+class jobOrder {
+
+public:
+	static std::vector<JOB> plan(const std::vector<POINT3>& positions, const POINT3& start, int taskCount,
+		const JOB_ORDER_COSTS& costs = JOB_ORDER_COSTS{}) {
+		auto tour = positionTour(positions, start);
+
+		auto byPosition = positionMajor(tour, taskCount);
+		auto byTask = taskMajor(tour, taskCount);
+		return (duration(byTask, positions, start, costs) < duration(byPosition, positions, start, costs)) ? byTask : byPosition;
+	}
+
+	/*
+	 * Returns the estimated time [s] spent on switching presets and moving the stage between the jobs.
+	 */
+	static double duration(const std::vector<JOB>& jobs, const std::vector<POINT3>& positions, const POINT3& start,
+		const JOB_ORDER_COSTS& costs) {
+		auto switches{ 0 };
+		auto distance = double{ 0 };
+		auto current = start;
+		for (gsl::index i{ 0 }; i < (gsl::index)jobs.size(); i++) {
+			if (i > 0 && jobs[i].task != jobs[i - 1].task) {
+				switches++;
+			}
+			auto position = positions[jobs[i].position];
+			distance += abs(position - current);
+			current = position;
+		}
+		auto travelTime = (costs.stageSpeed > 0) ? distance / costs.stageSpeed : 0;
+		return switches * costs.presetSwitchTime + travelTime;
+	}
+
+	/*
+	 * Returns the indices of the positions in the order of a nearest neighbour tour from the start position.
+	 */
+	static std::vector<gsl::index> positionTour(const std::vector<POINT3>& positions, const POINT3& start) {
+		auto points = std::vector<POINT3>{ start };
+		points.insert(points.end(), positions.begin(), positions.end());
+		auto order = scanPath::nearestNeighbour(points);
+
+		// the first entry is the start position itself
+		auto tour = std::vector<gsl::index>{};
+		tour.reserve(positions.size());
+		for (gsl::index i{ 1 }; i < (gsl::index)order.size(); i++) {
+			tour.push_back(order[i] - 1);
+		}
+		return tour;
+	}
+
+private:
+	static std::vector<JOB> positionMajor(const std::vector<gsl::index>& tour, int taskCount) {
+		auto jobs = std::vector<JOB>{};
+		jobs.reserve(tour.size() * taskCount);
+		for (gsl::index i{ 0 }; i < (gsl::index)tour.size(); i++) {
+			for (int kk{ 0 }; kk < taskCount; kk++) {
+				auto task = (i % 2) ? taskCount - 1 - kk : kk;
+				jobs.push_back(JOB{ tour[i], task });
+			}
+		}
+		return jobs;
+	}
+
+	static std::vector<JOB> taskMajor(const std::vector<gsl::index>& tour, int taskCount) {
+		auto jobs = std::vector<JOB>{};
+		jobs.reserve(tour.size() * taskCount);
+		for (int task{ 0 }; task < taskCount; task++) {
+			for (gsl::index i{ 0 }; i < (gsl::index)tour.size(); i++) {
+				auto position = (task % 2) ? tour[tour.size() - 1 - i] : tour[i];
+				jobs.push_back(JOB{ position, task });
+			}
+		}
+		return jobs;
+	}
+};
+
+#endif // JOBORDER_H
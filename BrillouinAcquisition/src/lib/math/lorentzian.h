@@ -0,0 +1,283 @@
+#ifndef LORENTZIAN_H
+#define LORENTZIAN_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+struct LORENTZIAN_PEAK {
+	double position{ 0 };	// [pix]	center of the peak
+	double width{ 0 };		// [pix]	full width at half maximum
+	double amplitude{ 0 };	// [1]	height of the peak above the offset
+};
+
+struct LORENTZIAN_FIT {
+	std::array<LORENTZIAN_PEAK, 2> peaks;	// fitted peaks, sorted by their position
+	int peakCount{ 0 };						// number of valid entries in peaks
+	double offset{ 0 };						// [1]	constant background
+	double residual{ 0 };					// [1]	sum of the squared residuals
+	int iterations{ 0 };					// number of Levenberg-Marquardt iterations
+	bool converged{ false };
+};
+
+/*
+ * Fits one or two Lorentzian peaks on a constant offset to a spectrum with the Levenberg-Marquardt algorithm.
+ *
+ * The model is	f(x) = offset + sum A / (1 + (2 * (x - x0) / w)^2),
+ * where w is the full width at half maximum. The Jacobian is evaluated analytically and all buffers
+ * are kept between fits, so that a fitter can be reused for every spectrum of a scan without allocations.
+ * The Jacobian is stored column by column, so that the model, its derivatives and the normal equations are
+ * computed in branch-free loops over contiguous samples, which the compiler vectorizes.
+ * A fit which stops because no damping reduces the residual anymore is not reported as converged.
+ */
+class lorentzian {
+
+public:
+	lorentzian(int peakCount = 2, int maxIterations = 100, double tolerance = 1e-8)
+		: m_peakCount(std::clamp(peakCount, 1, 2)), m_maxIterations(maxIterations), m_tolerance(tolerance) {};
+
+	static double model(double x, double offset, const LORENTZIAN_PEAK* peaks, int peakCount) {
+		auto value = offset;
+		for (gsl::index k{ 0 }; k < peakCount; k++) {
+			auto u = 2 * (x - peaks[k].position) / peaks[k].width;
+			value += peaks[k].amplitude / (1 + u * u);
+		}
+		return value;
+	}
+
+	LORENTZIAN_FIT fit(const double* spectrum, int count) {
+		auto result = LORENTZIAN_FIT{};
+		auto parameterCount = 1 + 3 * m_peakCount;
+		if (count < parameterCount) {
+			return result;
+		}
+		m_jacobian.resize((size_t)count * parameterCount);
+		m_residuals.resize(count);
+		m_model.resize(count);
+		// the derivative by the offset is constant
+		std::fill_n(m_jacobian.begin(), count, 1.0);
+
+		auto parameters = std::array<double, 7>{};
+		initialGuess(spectrum, count, parameters);
+
+		auto lambda = 1e-3;
+		auto chiSquared = evaluate(spectrum, count, parameters, true);
+		auto alpha = std::array<double, 49>{};
+		auto beta = std::array<double, 7>{};
+		auto step = std::array<double, 7>{};
+		auto trial = std::array<double, 7>{};
+
+		for (result.iterations = 0; result.iterations < m_maxIterations; result.iterations++) {
+			// normal equations J^T J and J^T r
+			for (gsl::index i{ 0 }; i < parameterCount; i++) {
+				auto column = &m_jacobian[i * count];
+				beta[i] = dot(column, m_residuals.data(), count);
+				for (gsl::index j{ 0 }; j <= i; j++) {
+					alpha[i * parameterCount + j] = dot(column, &m_jacobian[j * count], count);
+					alpha[j * parameterCount + i] = alpha[i * parameterCount + j];
+				}
+			}
+
+			// increase the damping until a step reduces the residual
+			auto improved = false;
+			while (lambda < 1e10) {
+				auto damped = alpha;
+				for (gsl::index i{ 0 }; i < parameterCount; i++) {
+					damped[i * parameterCount + i] *= 1 + lambda;
+				}
+				if (solve(damped, beta, step, parameterCount)) {
+					for (gsl::index i{ 0 }; i < parameterCount; i++) {
+						trial[i] = parameters[i] + step[i];
+					}
+					auto trialChiSquared = evaluate(spectrum, count, trial, false);
+					if (std::isfinite(trialChiSquared) && trialChiSquared <= chiSquared) {
+						// converged if neither the residual nor the parameters change noticeably anymore
+						auto change = chiSquared - trialChiSquared;
+						auto stepSize = double{ 0 };
+						for (gsl::index i{ 0 }; i < parameterCount; i++) {
+							stepSize = std::max(stepSize, std::abs(step[i]) / (std::abs(parameters[i]) + m_tolerance));
+						}
+						parameters = trial;
+						lambda = std::max(lambda / 10, 1e-12);
+						result.converged = change <= m_tolerance * std::max(chiSquared, 1e-30) || stepSize <= m_tolerance;
+						chiSquared = evaluate(spectrum, count, parameters, true);
+						improved = true;
+						break;
+					}
+				}
+				lambda *= 10;
+			}
+			// the damping saturated without finding a step which reduces the residual
+			if (!improved || result.converged) {
+				result.iterations++;
+				break;
+			}
+		}
+
+		result.offset = parameters[0];
+		result.residual = chiSquared;
+		result.peakCount = m_peakCount;
+		for (gsl::index k{ 0 }; k < m_peakCount; k++) {
+			result.peaks[k].amplitude = parameters[1 + 3 * k];
+			result.peaks[k].position = parameters[2 + 3 * k];
+			result.peaks[k].width = std::abs(parameters[3 + 3 * k]);
+		}
+		if (m_peakCount == 2 && result.peaks[0].position > result.peaks[1].position) {
+			std::swap(result.peaks[0], result.peaks[1]);
+		}
+		return result;
+	}
+
+private:
+	/*
+	 * Starts with the highest sample and the highest sample outside of its width, the offset is the minimum.
+	 */
+	void initialGuess(const double* spectrum, int count, std::array<double, 7>& parameters) {
+		auto offset = *std::min_element(spectrum, spectrum + count);
+		parameters[0] = offset;
+
+		auto excludedFirst = gsl::index{ 0 };
+		auto excludedLast = gsl::index{ -1 };
+		for (gsl::index k{ 0 }; k < m_peakCount; k++) {
+			auto peak = gsl::index{ -1 };
+			for (gsl::index n{ 0 }; n < count; n++) {
+				if (n >= excludedFirst && n <= excludedLast) {
+					continue;
+				}
+				if (peak < 0 || spectrum[n] > spectrum[peak]) {
+					peak = n;
+				}
+			}
+			if (peak < 0) {
+				peak = count / 2;
+			}
+			auto amplitude = spectrum[peak] - offset;
+
+			// walk to the half maximum on both sides
+			auto halfMaximum = offset + amplitude / 2;
+			auto left = peak;
+			while (left > 0 && spectrum[left] > halfMaximum) {
+				left--;
+			}
+			auto right = peak;
+			while (right < count - 1 && spectrum[right] > halfMaximum) {
+				right++;
+			}
+			auto width = std::max((double)(right - left), 1.0);
+
+			parameters[1 + 3 * k] = amplitude;
+			parameters[2 + 3 * k] = (double)peak;
+			parameters[3 + 3 * k] = width;
+
+			excludedFirst = peak - (gsl::index)std::ceil(width);
+			excludedLast = peak + (gsl::index)std::ceil(width);
+		}
+	}
+
+	/*
+	 * Returns the sum of the squared residuals and optionally updates the residuals and the Jacobian.
+	 */
+	double evaluate(const double* spectrum, int count, const std::array<double, 7>& parameters, bool jacobian) {
+		auto model = m_model.data();
+		std::fill_n(model, count, parameters[0]);
+		for (gsl::index k{ 0 }; k < m_peakCount; k++) {
+			auto amplitude = parameters[1 + 3 * k];
+			auto position = parameters[2 + 3 * k];
+			auto scale = 2 / parameters[3 + 3 * k];
+			if (jacobian) {
+				auto byAmplitude = &m_jacobian[(1 + 3 * k) * count];
+				auto byPosition = &m_jacobian[(2 + 3 * k) * count];
+				auto byWidth = &m_jacobian[(3 + 3 * k) * count];
+				for (gsl::index n{ 0 }; n < count; n++) {
+					auto u = ((double)n - position) * scale;
+					auto denominator = 1 / (1 + u * u);
+					auto derivative = amplitude * u * denominator * denominator * scale;
+					model[n] += amplitude * denominator;
+					byAmplitude[n] = denominator;
+					byPosition[n] = 2 * derivative;
+					byWidth[n] = derivative * u;
+				}
+			} else {
+				for (gsl::index n{ 0 }; n < count; n++) {
+					auto u = ((double)n - position) * scale;
+					model[n] += amplitude / (1 + u * u);
+				}
+			}
+		}
+
+		// the residuals of a trial step are not kept, they overwrite the model
+		auto residuals = jacobian ? m_residuals.data() : model;
+		for (gsl::index n{ 0 }; n < count; n++) {
+			residuals[n] = spectrum[n] - model[n];
+		}
+		return dot(residuals, residuals, count);
+	}
+
+	/*
+	 * The sum is split into four partial sums, since the compiler must not reorder a single floating point sum
+	 */
+	static double dot(const double* first, const double* second, int count) {
+		auto sums = std::array<double, 4>{};
+		auto blocks = (gsl::index)count / 4;
+		for (gsl::index b{ 0 }; b < blocks; b++) {
+			auto n = 4 * b;
+			for (gsl::index i{ 0 }; i < 4; i++) {
+				sums[i] += first[n + i] * second[n + i];
+			}
+		}
+		for (auto n = 4 * blocks; n < count; n++) {
+			sums[0] += first[n] * second[n];
+		}
+		return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+	}
+
+	/*
+	 * Solves the linear system by Gaussian elimination with partial pivoting, false if it is singular.
+	 */
+	static bool solve(std::array<double, 49>& matrix, const std::array<double, 7>& vector, std::array<double, 7>& solution, int size) {
+		solution = vector;
+		for (gsl::index col{ 0 }; col < size; col++) {
+			auto pivot = col;
+			for (gsl::index row = col + 1; row < size; row++) {
+				if (std::abs(matrix[row * size + col]) > std::abs(matrix[pivot * size + col])) {
+					pivot = row;
+				}
+			}
+			if (std::abs(matrix[pivot * size + col]) < 1e-300) {
+				return false;
+			}
+			if (pivot != col) {
+				for (gsl::index i{ 0 }; i < size; i++) {
+					std::swap(matrix[col * size + i], matrix[pivot * size + i]);
+				}
+				std::swap(solution[col], solution[pivot]);
+			}
+			for (gsl::index row = col + 1; row < size; row++) {
+				auto factor = matrix[row * size + col] / matrix[col * size + col];
+				for (gsl::index i = col; i < size; i++) {
+					matrix[row * size + i] -= factor * matrix[col * size + i];
+				}
+				solution[row] -= factor * solution[col];
+			}
+		}
+		for (gsl::index row = size - 1; row >= 0; row--) {
+			for (gsl::index i = row + 1; i < size; i++) {
+				solution[row] -= matrix[row * size + i] * solution[i];
+			}
+			solution[row] /= matrix[row * size + row];
+		}
+		return true;
+	}
+
+	int m_peakCount{ 2 };
+	int m_maxIterations{ 100 };
+	double m_tolerance{ 1e-8 };				// relative change of the residual to stop at
+
+	std::vector<double> m_jacobian;			// column-major, one column per parameter
+	std::vector<double> m_residuals;
+	std::vector<double> m_model;
+};
+
+#endif // LORENTZIAN_H
@@ -28,10 +28,6 @@ private:
 	int m_dim_x{ 0 }, m_dim_y{ 0 }, m_max_x{ 0 }, m_max_y{ 0 }, m_dim_background_x{ 0 }, m_dim_background_y{ 0 };
 	bool m_initialized{ false };
 
-	double m_pixelSize = 4.8 / (90.4762 * 63 / 100);
-	double m_NA{ 1.2 };
-	double m_lambda{ 0.532 };
-
 	double m_maskRadius{ 0 };
 	std::vector<int> m_mask;
 
@@ -51,7 +47,7 @@ private:
 			m_dim_x = dim_x;
 			m_dim_y = dim_y;
 
-			m_maskRadius = round(m_dim_x * m_pixelSize * m_NA / m_lambda);
+			m_maskRadius = maskRadius(m_dim_x);
 
 			m_mask = createMask(dim_x, dim_y, m_maskRadius);
 
@@ -80,19 +76,6 @@ private:
 		}
 	}
 
-	std::vector<int> createMask(int dim_x, int dim_y, double maskRadius) {
-		std::vector<int> mask((size_t)dim_x * dim_y, 0);
-		for (gsl::index x{ (int)round(dim_x / 2.0 - m_maskRadius) }; x < round(dim_x / 2.0 + m_maskRadius); x++) {
-			for (gsl::index y{ (int)round(dim_y / 2.0 - m_maskRadius) }; y < round(dim_y / 2.0 + m_maskRadius); y++) {
-				if (sqrt(pow((x - dim_x/2.0), 2) + pow(y - dim_y/2.0, 2)) <= m_maskRadius) {
-					mask[x + (size_t)dim_x * y] = 1;
-				}
-			}
-		}
-
-		return mask;
-	}
-
 	template <typename T_in = double>
 	void copyToInput(fftw_complex* dest, T_in* intensity, int dim_x, int dim_y) {
 		for (gsl::index i{ 0 }; i < (gsl::index)dim_x * dim_y; i++) {
@@ -118,6 +101,10 @@ private:
 
 public:
 
+	static constexpr double PIXEL_SIZE{ 4.8 / (90.4762 * 63 / 100) };	// [µm]	pixel size in the sample plane
+	static constexpr double NA{ 1.2 };									// [1]	numerical aperture of the objective
+	static constexpr double LAMBDA{ 0.532 };							// [µm]	wavelength of the illumination
+
 	bool m_updateBackground{ false };
 
 	phase() {}
@@ -180,11 +167,38 @@ public:
 		m_dim_background_x = dim_x;
 		m_dim_background_y = dim_y;
 
+		findCarrier(m_out_FFT, dim_x, dim_y, m_max_x, m_max_y);
+	}
+
+	/*
+	 * Radius [pix] of the aperture of the objective in the Fourier space
+	 */
+	static double maskRadius(int dim_x) {
+		return round(dim_x * PIXEL_SIZE * NA / LAMBDA);
+	}
+
+	static std::vector<int> createMask(int dim_x, int dim_y, double radius) {
+		std::vector<int> mask((size_t)dim_x * dim_y, 0);
+		for (gsl::index x{ (int)round(dim_x / 2.0 - radius) }; x < round(dim_x / 2.0 + radius); x++) {
+			for (gsl::index y{ (int)round(dim_y / 2.0 - radius) }; y < round(dim_y / 2.0 + radius); y++) {
+				if (sqrt(pow((x - dim_x/2.0), 2) + pow(y - dim_y/2.0, 2)) <= radius) {
+					mask[x + (size_t)dim_x * y] = 1;
+				}
+			}
+		}
+
+		return mask;
+	}
+
+	/*
+	 * Find the shift of the carrier peak of the hologram relative to the center of the spectrum
+	 */
+	static void findCarrier(const fftw_complex* spectrum, int dim_x, int dim_y, int& max_x, int& max_y) {
 		// Calculate magnitude of background image to find the indices of the largest element
 		std::vector<double> background;
 		background.resize((size_t)dim_x * dim_y);
 		for (gsl::index i{ 0 }; i < (gsl::index)dim_x * dim_y; i++) {
-			background[i] = pow(m_out_FFT[i][0], 2) + pow(m_out_FFT[i][1], 2);
+			background[i] = pow(spectrum[i][0], 2) + pow(spectrum[i][1], 2);
 		}
 
 		// Find indices of largest element in given range
@@ -197,11 +211,11 @@ public:
 		std::vector<double>::iterator result = std::max_element(itl, itr);
 		int ind = std::distance(std::begin(background), result);
 		
-		m_max_y = floor(ind / dim_x);
-		m_max_x = ind - m_max_y * dim_x;
+		max_y = floor(ind / dim_x);
+		max_x = ind - max_y * dim_x;
 
-		m_max_x = round(m_max_x - dim_x / 2.0 - 1);
-		m_max_y = round(m_max_y - dim_y / 2.0 - 1);
+		max_x = round(max_x - dim_x / 2.0 - 1);
+		max_y = round(max_y - dim_y / 2.0 - 1);
 	}
 
 	template <typename T_in = double, typename T_out = double>
@@ -0,0 +1,244 @@
+#ifndef PHASECORRELATION_H
+#define PHASECORRELATION_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "points.h"
+#include "../../../external/fftw/fftw3.h"
+
+struct SHIFT_ESTIMATE {
+	POINT2 shift{ 0, 0 };		// [pix]	shift of the image content relative to the reference
+	double peak{ 0 };			// [1]	height of the correlation peak, 1 for identical images
+};
+
+/*
+ * Estimates the translation between two images by phase correlation.
+ *
+ * Both images are windowed with a Hann window to suppress the edges and transformed with FFTW. The inverse transform
+ * of the normalised cross-power spectrum has a sharp peak at the shift. The cross-power spectrum is weighted with a
+ * Gaussian, so that the peak has the shape of a Gaussian of one pixel width instead of a sinc. Its position is refined
+ * to sub-pixel precision by fitting a parabola to the logarithm of the peak and its neighbours, which is exact for a
+ * Gaussian. Since the window does not move with the image content, it pulls the peak towards zero for large shifts.
+ * The image is therefore shifted back by the integer part of the shift and correlated a second time, so that only the
+ * remaining fraction of a pixel is refined. Shifts up to half of the image size in every direction are found. The plans
+ * and the spectrum of the reference are kept, so that many images can be compared to the same reference.
+ */
+class phaseCorrelation {
+
+public:
+	phaseCorrelation() {};
+	~phaseCorrelation() {
+		clear();
+	};
+
+	template <typename T>
+	void setReference(const T* image, int dim_x, int dim_y) {
+		initialize(dim_x, dim_y);
+		transform(image);
+		memcpy(m_reference, m_spectrum, sizeof(fftw_complex) * m_dim_x * m_dim_y);
+	}
+
+	template <typename T>
+	SHIFT_ESTIMATE shift(const T* image) {
+		auto estimate = SHIFT_ESTIMATE{};
+		if (!m_reference) {
+			return estimate;
+		}
+		gsl::index max_x{ 0 };
+		gsl::index max_y{ 0 };
+		transform(image);
+		correlate(max_x, max_y);
+
+		// shifts beyond half of the image size are negative shifts
+		auto shift_x = max_x > m_dim_x / 2 ? max_x - m_dim_x : max_x;
+		auto shift_y = max_y > m_dim_y / 2 ? max_y - m_dim_y : max_y;
+
+		// correlate the image shifted back by the integer shift again, the remaining shift is below one pixel
+		if (shift_x != 0 || shift_y != 0) {
+			transform(image, shift_x, shift_y);
+			correlate(max_x, max_y);
+			shift_x += max_x > m_dim_x / 2 ? max_x - m_dim_x : max_x;
+			shift_y += max_y > m_dim_y / 2 ? max_y - m_dim_y : max_y;
+		}
+
+		auto value = [this](gsl::index x, gsl::index y) {
+			x = (x % m_dim_x + m_dim_x) % m_dim_x;
+			y = (y % m_dim_y + m_dim_y) % m_dim_y;
+			return m_out[y * m_dim_x + x][0];
+		};
+		auto maximum = value(max_x, max_y);
+		auto dx = refine(value(max_x - 1, max_y), maximum, value(max_x + 1, max_y));
+		auto dy = refine(value(max_x, max_y - 1), maximum, value(max_x, max_y + 1));
+
+		// the inverse transform is not normalised, the peak of identical images is the sum of the weights
+		estimate.peak = maximum / m_lowpassSum;
+		estimate.shift = POINT2{ shift_x + dx, shift_y + dy };
+		return estimate;
+	}
+
+private:
+	/*
+	 * Calculates the inverse transform of the weighted cross-power spectrum of m_spectrum and the reference into m_out
+	 * and returns the position of its maximum
+	 */
+	void correlate(gsl::index& max_x, gsl::index& max_y) {
+		// normalised cross-power spectrum, only the phase difference is kept
+		for (gsl::index y{ 0 }; y < m_dim_y; y++) {
+			for (gsl::index x{ 0 }; x < m_dim_x; x++) {
+				auto i = y * m_dim_x + x;
+				auto re = m_spectrum[i][0] * m_reference[i][0] + m_spectrum[i][1] * m_reference[i][1];
+				auto im = m_spectrum[i][1] * m_reference[i][0] - m_spectrum[i][0] * m_reference[i][1];
+				auto norm = sqrt(re * re + im * im);
+				auto weight = norm > 1e-12 ? m_lowpass_y[y] * m_lowpass_x[x] / norm : 0.0;
+				m_in[i][0] = weight * re;
+				m_in[i][1] = weight * im;
+			}
+		}
+		fftw_execute(m_IFFT);
+
+		double maximum{ -INFINITY };
+		for (gsl::index y{ 0 }; y < m_dim_y; y++) {
+			for (gsl::index x{ 0 }; x < m_dim_x; x++) {
+				auto value = m_out[y * m_dim_x + x][0];
+				if (value > maximum) {
+					maximum = value;
+					max_x = x;
+					max_y = y;
+				}
+			}
+		}
+	}
+
+	void initialize(int dim_x, int dim_y) {
+		if (m_dim_x == dim_x && m_dim_y == dim_y && m_reference) {
+			return;
+		}
+		clear();
+		m_dim_x = dim_x;
+		m_dim_y = dim_y;
+
+		auto N = (size_t)dim_x * dim_y;
+		m_in = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+		m_out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+		m_spectrum = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+		m_reference = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+		m_FFT = fftw_plan_dft_2d(dim_y, dim_x, m_in, m_spectrum, FFTW_FORWARD, FFTW_ESTIMATE);
+		m_IFFT = fftw_plan_dft_2d(dim_y, dim_x, m_in, m_out, FFTW_BACKWARD, FFTW_ESTIMATE);
+
+		// the window is separable, so only its rows and columns are kept
+		m_window_x.resize(dim_x);
+		m_window_y.resize(dim_y);
+		for (gsl::index x{ 0 }; x < dim_x; x++) {
+			m_window_x[x] = 0.5 - 0.5 * cos(2 * M_PI * x / dim_x);
+		}
+		for (gsl::index y{ 0 }; y < dim_y; y++) {
+			m_window_y[y] = 0.5 - 0.5 * cos(2 * M_PI * y / dim_y);
+		}
+
+		// the Gaussian weight of the cross-power spectrum is separable as well, the frequencies are in FFTW order
+		auto lowpass = [](int dim, std::vector<double>& weight) {
+			weight.resize(dim);
+			for (gsl::index k{ 0 }; k < dim; k++) {
+				auto frequency = (double)(k > dim / 2 ? k - dim : k) / dim;
+				weight[k] = exp(-2 * pow(M_PI * PEAK_WIDTH * frequency, 2));
+			}
+		};
+		lowpass(dim_x, m_lowpass_x);
+		lowpass(dim_y, m_lowpass_y);
+		m_lowpassSum = 0;
+		for (auto weight_y : m_lowpass_y) {
+			for (auto weight_x : m_lowpass_x) {
+				m_lowpassSum += weight_y * weight_x;
+			}
+		}
+	}
+
+	void clear() {
+		if (m_FFT) {
+			fftw_destroy_plan(m_FFT);
+			m_FFT = nullptr;
+		}
+		if (m_IFFT) {
+			fftw_destroy_plan(m_IFFT);
+			m_IFFT = nullptr;
+		}
+		for (auto buffer : { &m_in, &m_out, &m_spectrum, &m_reference }) {
+			if (*buffer) {
+				fftw_free(*buffer);
+				*buffer = nullptr;
+			}
+		}
+	}
+
+	/*
+	 * Transforms the windowed image without its mean into m_spectrum. The image is cyclically shifted back by the
+	 * given offset before, the content wrapped around is suppressed by the window.
+	 */
+	template <typename T>
+	void transform(const T* image, gsl::index offset_x = 0, gsl::index offset_y = 0) {
+		auto N = (gsl::index)m_dim_x * m_dim_y;
+		double mean{ 0 };
+		for (gsl::index i{ 0 }; i < N; i++) {
+			mean += image[i];
+		}
+		mean /= N;
+
+		offset_x = (offset_x % m_dim_x + m_dim_x) % m_dim_x;
+		offset_y = (offset_y % m_dim_y + m_dim_y) % m_dim_y;
+		for (gsl::index y{ 0 }; y < m_dim_y; y++) {
+			auto row = &image[((y + offset_y) % m_dim_y) * m_dim_x];
+			auto in = &m_in[y * m_dim_x];
+			// the row is copied in two contiguous parts to avoid the modulo in the inner loop
+			auto split = m_dim_x - offset_x;
+			for (gsl::index x{ 0 }; x < split; x++) {
+				in[x][0] = m_window_y[y] * m_window_x[x] * (row[x + offset_x] - mean);
+				in[x][1] = 0;
+			}
+			for (gsl::index x{ split }; x < m_dim_x; x++) {
+				in[x][0] = m_window_y[y] * m_window_x[x] * (row[x - split] - mean);
+				in[x][1] = 0;
+			}
+		}
+		fftw_execute(m_FFT);
+	}
+
+	/*
+	 * Returns the offset of the vertex of the parabola through the logarithm of the three values from the centre.
+	 * The peak of a slightly smoothed delta is close to a Gaussian, for which this is exact.
+	 */
+	static double refine(double left, double centre, double right) {
+		// the logarithm requires positive values, the neighbours can be negative for integer shifts
+		auto floor = 1e-3 * centre;
+		left = log((std::max)(left, floor));
+		right = log((std::max)(right, floor));
+		centre = log(centre);
+		auto denominator = left - 2 * centre + right;
+		if (denominator >= 0) {
+			return 0;
+		}
+		return (std::max)(-0.5, (std::min)(0.5, 0.5 * (left - right) / denominator));
+	}
+
+	static constexpr double PEAK_WIDTH{ 1.0 };	// [pix]	standard deviation of the correlation peak
+
+	int m_dim_x{ 0 };
+	int m_dim_y{ 0 };
+	std::vector<double> m_window_x;			// Hann window applied to the images
+	std::vector<double> m_window_y;
+	std::vector<double> m_lowpass_x;		// Gaussian weight of the cross-power spectrum
+	std::vector<double> m_lowpass_y;
+	double m_lowpassSum{ 0 };
+
+	fftw_complex* m_in{ nullptr };
+	fftw_complex* m_out{ nullptr };
+	fftw_complex* m_spectrum{ nullptr };
+	fftw_complex* m_reference{ nullptr };		// spectrum of the reference image
+	fftw_plan m_FFT{ nullptr };
+	fftw_plan m_IFFT{ nullptr };
+};
+
+#endif // PHASECORRELATION_H
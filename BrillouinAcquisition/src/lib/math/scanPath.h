@@ -0,0 +1,227 @@
+#ifndef SCANPATH_H
+#define SCANPATH_H
+
+#include <gsl/gsl>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "points.h"
+
+typedef enum class enScanPath {
+	RASTER,				// every line starts at the minimum of the fastest axis
+	SERPENTINE,			// every axis reverses its direction on every line
+	HILBERT,			// space-filling curve in the plane of the two fastest axes
+	NEAREST_NEIGHBOUR	// greedily moves to the closest position not yet measured
+} SCAN_PATH;
+
+/*
+ * Determines the order in which the positions of a scan are visited.
+ *
+ * The grid orders return indices along the axes in scan order,
+ * i.e. x is the fastest and z the slowest axis.
+ */
+class scanPath {
+
+public:
+	static std::string toString(SCAN_PATH path) {
+		switch (path) {
+			case SCAN_PATH::SERPENTINE:
+				return "serpentine";
+			case SCAN_PATH::HILBERT:
+				return "hilbert";
+			case SCAN_PATH::NEAREST_NEIGHBOUR:
+				return "nearest-neighbour";
+			default:
+				return "raster";
+		}
+	}
+
+	static std::vector<INDEX3> grid(SCAN_PATH path, int nx, int ny, int nz) {
+		switch (path) {
+			case SCAN_PATH::SERPENTINE:
+				return serpentine(nx, ny, nz);
+			case SCAN_PATH::HILBERT:
+				return hilbert(nx, ny, nz);
+			default:
+				return raster(nx, ny, nz);
+		}
+	}
+
+	static std::vector<INDEX3> raster(int nx, int ny, int nz) {
+		auto order = std::vector<INDEX3>{};
+		order.reserve((size_t)nx * ny * nz);
+		for (int z{ 0 }; z < nz; z++) {
+			for (int y{ 0 }; y < ny; y++) {
+				for (int x{ 0 }; x < nx; x++) {
+					order.push_back(INDEX3{ x, y, z });
+				}
+			}
+		}
+		return order;
+	}
+
+	static std::vector<INDEX3> serpentine(int nx, int ny, int nz) {
+		auto order = std::vector<INDEX3>{};
+		order.reserve((size_t)nx * ny * nz);
+		for (int z{ 0 }; z < nz; z++) {
+			for (int jj{ 0 }; jj < ny; jj++) {
+				// every line starts where the previous one ended
+				auto y = (z % 2) ? ny - 1 - jj : jj;
+				auto reverse = ((z * ny + jj) % 2) == 1;
+				for (int kk{ 0 }; kk < nx; kk++) {
+					auto x = reverse ? nx - 1 - kk : kk;
+					order.push_back(INDEX3{ x, y, z });
+				}
+			}
+		}
+		return order;
+	}
+
+	/*
+	 * Generalized Hilbert curve, which also covers rectangles which are not a power of two.
+	 * Consecutive planes are traversed in opposite directions.
+	 */
+	static std::vector<INDEX3> hilbert(int nx, int ny, int nz) {
+		auto plane = std::vector<INDEX3>{};
+		plane.reserve((size_t)nx * ny);
+		if (nx >= ny) {
+			hilbertRectangle(plane, 0, 0, nx, 0, 0, ny);
+		} else {
+			hilbertRectangle(plane, 0, 0, 0, ny, nx, 0);
+		}
+
+		auto order = std::vector<INDEX3>{};
+		order.reserve((size_t)nx * ny * nz);
+		for (int z{ 0 }; z < nz; z++) {
+			for (gsl::index i{ 0 }; i < (gsl::index)plane.size(); i++) {
+				auto point = (z % 2) ? plane[plane.size() - 1 - i] : plane[i];
+				order.push_back(INDEX3{ point.x, point.y, z });
+			}
+		}
+		return order;
+	}
+
+	/*
+	 * Returns the order of the given positions when always moving to the closest position not yet visited,
+	 * starting at the first position. The effort scales quadratically with the number of positions.
+	 */
+	static std::vector<gsl::index> nearestNeighbour(const std::vector<POINT3>& positions) {
+		auto order = std::vector<gsl::index>{};
+		if (positions.empty()) {
+			return order;
+		}
+		order.reserve(positions.size());
+
+		// positions not visited yet
+		auto remaining = std::vector<gsl::index>(positions.size() - 1);
+		for (gsl::index i{ 0 }; i < (gsl::index)remaining.size(); i++) {
+			remaining[i] = i + 1;
+		}
+
+		auto current = gsl::index{ 0 };
+		order.push_back(current);
+		while (!remaining.empty()) {
+			auto best = gsl::index{ 0 };
+			auto bestDistance = distanceSquared(positions[current], positions[remaining[0]]);
+			for (gsl::index i{ 1 }; i < (gsl::index)remaining.size(); i++) {
+				auto distance = distanceSquared(positions[current], positions[remaining[i]]);
+				// prefer the position listed first on ties, so the result is deterministic
+				if (distance < bestDistance
+					|| (distance == bestDistance && remaining[i] < remaining[best])) {
+					bestDistance = distance;
+					best = i;
+				}
+			}
+			current = remaining[best];
+			order.push_back(current);
+			remaining[best] = remaining.back();
+			remaining.pop_back();
+		}
+		return order;
+	}
+
+	/*
+	 * Returns the total distance travelled when visiting the positions in the given order.
+	 */
+	static double travel(const std::vector<POINT3>& positions) {
+		auto distance = double{ 0 };
+		for (gsl::index i{ 1 }; i < (gsl::index)positions.size(); i++) {
+			distance += abs(POINT3{ positions[i] } - positions[i - 1]);
+		}
+		return distance;
+	}
+
+private:
+	static int sign(int value) {
+		return (value > 0) - (value < 0);
+	}
+
+	static int floorHalf(int value) {
+		return (value >= 0) ? value / 2 : -((-value + 1) / 2);
+	}
+
+	static double distanceSquared(const POINT3& a, const POINT3& b) {
+		return pow(a.x - b.x, 2) + pow(a.y - b.y, 2) + pow(a.z - b.z, 2);
+	}
+
+	/*
+	 * Fills the rectangle starting at (x, y) spanned by the major axis (ax, ay) and the minor axis (bx, by).
+	 */
+	static void hilbertRectangle(std::vector<INDEX3>& plane, int x, int y, int ax, int ay, int bx, int by) {
+		auto w = std::abs(ax + ay);
+		auto h = std::abs(bx + by);
+		auto dax = sign(ax);
+		auto day = sign(ay);
+		auto dbx = sign(bx);
+		auto dby = sign(by);
+
+		// trivial rows and columns
+		if (h == 1) {
+			for (int i{ 0 }; i < w; i++) {
+				plane.push_back(INDEX3{ x, y, 0 });
+				x += dax;
+				y += day;
+			}
+			return;
+		}
+		if (w == 1) {
+			for (int i{ 0 }; i < h; i++) {
+				plane.push_back(INDEX3{ x, y, 0 });
+				x += dbx;
+				y += dby;
+			}
+			return;
+		}
+
+		auto ax2 = floorHalf(ax);
+		auto ay2 = floorHalf(ay);
+		auto bx2 = floorHalf(bx);
+		auto by2 = floorHalf(by);
+		auto w2 = std::abs(ax2 + ay2);
+		auto h2 = std::abs(bx2 + by2);
+
+		if (2 * w > 3 * h) {
+			// long rectangle, split it in two halves along the major axis
+			if ((w2 % 2) && (w > 2)) {
+				ax2 += dax;
+				ay2 += day;
+			}
+			hilbertRectangle(plane, x, y, ax2, ay2, bx, by);
+			hilbertRectangle(plane, x + ax2, y + ay2, ax - ax2, ay - ay2, bx, by);
+		} else {
+			// standard case, one step up, one long horizontal step and one step down
+			if ((h2 % 2) && (h > 2)) {
+				bx2 += dbx;
+				by2 += dby;
+			}
+			hilbertRectangle(plane, x, y, bx2, by2, ax2, ay2);
+			hilbertRectangle(plane, x + bx2, y + by2, ax, ay, bx - bx2, by - by2);
+			hilbertRectangle(plane, x + (ax - dax) + (bx2 - dbx), y + (ay - day) + (by2 - dby),
+				-bx2, -by2, -(ax - ax2), -(ay - ay2));
+		}
+	}
+};
+
+#endif // SCANPATH_H
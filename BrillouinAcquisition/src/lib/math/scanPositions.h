@@ -0,0 +1,294 @@
+#ifndef SCANPOSITIONS_H
+#define SCANPOSITIONS_H
+
+#include <gsl/gsl>
+#include <array>
+#include <vector>
+
+#include "points.h"
+#include "scanPath.h"
+
+struct SCAN_POSITION {
+	POINT3 position;					// [µm]	position relative to the start position
+	INDEX3 index;						// [1]	index of the position in the x, y and z direction
+	bool calibrationAllowed{ false };	// a new line starts, so a calibration is allowed
+};
+
+/*
+ * Generates the positions of a scan on demand, so that they never have to be held in memory at once.
+ *
+ * Raster and serpentine paths are computed in O(1) from the number of the position.
+ * The Hilbert path stores the order of a single plane and the nearest-neighbour path the order
+ * of all positions, both are only computed once a position is requested.
+ */
+class scanPositions {
+
+public:
+	scanPositions() {};
+	/*
+	 * "order" gives the rank of every direction in the scan order, 0 is the fastest direction.
+	 */
+	scanPositions(const POINT3& min, const POINT3& max, const INDEX3& steps, const INDEX3& order, SCAN_PATH path)
+		: m_path(path) {
+		auto mins = std::array<double, 3>{ min.x, min.y, min.z };
+		auto maxs = std::array<double, 3>{ max.x, max.y, max.z };
+		auto counts = std::array<int, 3>{ steps.x, steps.y, steps.z };
+		auto ranks = std::array<int, 3>{ order.x, order.y, order.z };
+		for (gsl::index direction{ 0 }; direction < 3; direction++) {
+			auto axis = ranks[direction];
+			m_direction[axis] = (int)direction;
+			m_min[axis] = mins[direction];
+			m_count[axis] = counts[direction] > 0 ? counts[direction] : 1;
+			m_spacing[axis] = (m_count[axis] > 1) ? (maxs[direction] - mins[direction]) / (m_count[axis] - 1) : 0;
+		}
+		m_size = (gsl::index)m_count[0] * m_count[1] * m_count[2];
+
+		// fall back to a serpentine path if the order would take too long to compute or too much memory
+		if (m_path == SCAN_PATH::HILBERT && (gsl::index)m_count[0] * m_count[1] > m_hilbertLimit) {
+			m_path = SCAN_PATH::SERPENTINE;
+		}
+		if (m_path == SCAN_PATH::NEAREST_NEIGHBOUR && m_size > m_nearestNeighbourLimit) {
+			m_path = SCAN_PATH::SERPENTINE;
+		}
+	}
+
+	/*
+	 * Returns the path that is actually used, which might differ from the requested one for large scans.
+	 */
+	SCAN_PATH path() {
+		return m_path;
+	}
+
+	gsl::index size() {
+		return m_size;
+	}
+
+	/*
+	 * Returns the number of positions in every direction, in scan order.
+	 */
+	INDEX3 gridSize() {
+		return INDEX3{ m_count[0], m_count[1], m_count[2] };
+	}
+
+	/*
+	 * Returns the position at the given grid index in scan order, independent of the path.
+	 */
+	SCAN_POSITION fromGrid(const INDEX3& grid) {
+		auto position = SCAN_POSITION{};
+		position.position = toPosition(grid);
+		position.index = toIndex(grid);
+		return position;
+	}
+
+	SCAN_POSITION at(gsl::index ll) {
+		auto grid = gridIndex(ll);
+
+		auto position = fromGrid(grid);
+		if (ll == 0) {
+			position.calibrationAllowed = true;
+		} else {
+			// the path leaves the line of the fastest direction
+			auto previous = gridIndex(ll - 1);
+			position.calibrationAllowed = (grid.y != previous.y) || (grid.z != previous.z);
+		}
+		return position;
+	}
+
+	/*
+	 * Returns the number of the step at which the position with the given index in x, y and z is measured,
+	 * the inverse of at().
+	 */
+	gsl::index step(const INDEX3& index) {
+		auto indices = std::array<int, 3>{ index.x, index.y, index.z };
+		auto grid = std::array<gsl::index, 3>{};
+		for (gsl::index axis{ 0 }; axis < 3; axis++) {
+			grid[axis] = indices[m_direction[axis]];
+		}
+		auto nx = (gsl::index)m_count[0];
+		auto ny = (gsl::index)m_count[1];
+		auto raster = (grid[2] * ny + grid[1]) * nx + grid[0];
+		switch (m_path) {
+			case SCAN_PATH::SERPENTINE: {
+				auto z = grid[2];
+				auto jj = (z % 2) ? ny - 1 - grid[1] : grid[1];
+				auto kk = ((z * ny + jj) % 2) ? nx - 1 - grid[0] : grid[0];
+				return (z * ny + jj) * nx + kk;
+			}
+			case SCAN_PATH::HILBERT: {
+				if (m_planeSteps.empty()) {
+					gridIndex(0);
+					m_planeSteps.resize(m_plane.size());
+					for (gsl::index i{ 0 }; i < (gsl::index)m_plane.size(); i++) {
+						m_planeSteps[(gsl::index)m_plane[i].y * nx + m_plane[i].x] = i;
+					}
+				}
+				auto z = grid[2];
+				auto i = m_planeSteps[grid[1] * nx + grid[0]];
+				return z * nx * ny + ((z % 2) ? nx * ny - 1 - i : i);
+			}
+			case SCAN_PATH::NEAREST_NEIGHBOUR: {
+				if (m_steps.empty()) {
+					gridIndex(0);
+					m_steps.resize(m_order.size());
+					for (gsl::index ll{ 0 }; ll < (gsl::index)m_order.size(); ll++) {
+						m_steps[m_order[ll]] = ll;
+					}
+				}
+				return m_steps[raster];
+			}
+			default:
+				return raster;
+		}
+	}
+
+	/*
+	 * Returns the total distance travelled along the path.
+	 */
+	double travel() {
+		auto distance = double{ 0 };
+		auto previous = toPosition(gridIndex(0));
+		for (gsl::index ll{ 1 }; ll < m_size; ll++) {
+			auto position = toPosition(gridIndex(ll));
+			distance += abs(POINT3{ position } - previous);
+			previous = position;
+		}
+		return distance;
+	}
+
+	/*
+	 * Returns at most maxPositions positions evenly spread over the scanned volume,
+	 * including its borders. The order of the returned positions does not follow the path.
+	 */
+	std::vector<POINT3> preview(gsl::index maxPositions) {
+		// increase the stride of the direction with the most remaining positions until the limit is met
+		auto stride = std::array<int, 3>{ 1, 1, 1 };
+		auto sampled = [&](gsl::index axis) {
+			// every stride-th position plus the last one
+			return (m_count[axis] - 1) / stride[axis] + 1 + (((m_count[axis] - 1) % stride[axis]) ? 1 : 0);
+		};
+		while ((gsl::index)sampled(0) * sampled(1) * sampled(2) > maxPositions) {
+			auto largest = gsl::index{ 0 };
+			for (gsl::index axis{ 1 }; axis < 3; axis++) {
+				if (sampled(axis) > sampled(largest)) {
+					largest = axis;
+				}
+			}
+			if (sampled(largest) <= 2) {
+				break;
+			}
+			stride[largest]++;
+		}
+
+		auto samples = std::array<std::vector<int>, 3>{};
+		for (gsl::index axis{ 0 }; axis < 3; axis++) {
+			for (int i{ 0 }; i < m_count[axis]; i += stride[axis]) {
+				samples[axis].push_back(i);
+			}
+			if (samples[axis].back() != m_count[axis] - 1) {
+				samples[axis].push_back(m_count[axis] - 1);
+			}
+		}
+
+		auto positions = std::vector<POINT3>{};
+		positions.reserve(samples[0].size() * samples[1].size() * samples[2].size());
+		for (auto z : samples[2]) {
+			for (auto y : samples[1]) {
+				for (auto x : samples[0]) {
+					positions.push_back(toPosition(INDEX3{ x, y, z }));
+				}
+			}
+		}
+		return positions;
+	}
+
+private:
+	/*
+	 * Returns the grid index of the ll-th position, in scan order.
+	 */
+	INDEX3 gridIndex(gsl::index ll) {
+		auto nx = (gsl::index)m_count[0];
+		auto ny = (gsl::index)m_count[1];
+		switch (m_path) {
+			case SCAN_PATH::SERPENTINE: {
+				auto z = ll / (nx * ny);
+				auto jj = (ll % (nx * ny)) / nx;
+				auto kk = ll % nx;
+				// every line starts where the previous one ended
+				auto y = (z % 2) ? ny - 1 - jj : jj;
+				auto x = ((z * ny + jj) % 2) ? nx - 1 - kk : kk;
+				return INDEX3{ (int)x, (int)y, (int)z };
+			}
+			case SCAN_PATH::HILBERT: {
+				if (m_plane.empty()) {
+					m_plane = scanPath::hilbert((int)nx, (int)ny, 1);
+				}
+				auto z = ll / (nx * ny);
+				auto i = ll % (nx * ny);
+				// consecutive planes are traversed in opposite directions
+				auto point = (z % 2) ? m_plane[nx * ny - 1 - i] : m_plane[i];
+				return INDEX3{ point.x, point.y, (int)z };
+			}
+			case SCAN_PATH::NEAREST_NEIGHBOUR: {
+				if (m_order.empty()) {
+					auto positions = std::vector<POINT3>(m_size);
+					for (gsl::index i{ 0 }; i < m_size; i++) {
+						positions[i] = toPosition(rasterIndex(i));
+					}
+					m_order = scanPath::nearestNeighbour(positions);
+				}
+				return rasterIndex(m_order[ll]);
+			}
+			default:
+				return rasterIndex(ll);
+		}
+	}
+
+	INDEX3 rasterIndex(gsl::index ll) {
+		auto nx = (gsl::index)m_count[0];
+		auto ny = (gsl::index)m_count[1];
+		return INDEX3{ (int)(ll % nx), (int)((ll / nx) % ny), (int)(ll / (nx * ny)) };
+	}
+
+	/*
+	 * Converts a grid index in scan order into the position in x, y and z.
+	 */
+	POINT3 toPosition(const INDEX3& grid) {
+		auto indices = std::array<int, 3>{ grid.x, grid.y, grid.z };
+		auto position = std::array<double, 3>{};
+		for (gsl::index axis{ 0 }; axis < 3; axis++) {
+			position[m_direction[axis]] = m_min[axis] + indices[axis] * m_spacing[axis];
+		}
+		return POINT3{ position[0], position[1], position[2] };
+	}
+
+	/*
+	 * Converts a grid index in scan order into the index in x, y and z.
+	 */
+	INDEX3 toIndex(const INDEX3& grid) {
+		auto indices = std::array<int, 3>{ grid.x, grid.y, grid.z };
+		auto index = std::array<int, 3>{};
+		for (gsl::index axis{ 0 }; axis < 3; axis++) {
+			index[m_direction[axis]] = indices[axis];
+		}
+		return INDEX3{ index[0], index[1], index[2] };
+	}
+
+	SCAN_PATH m_path{ SCAN_PATH::RASTER };
+	gsl::index m_size{ 1 };
+
+	// parameters of the directions in scan order
+	std::array<int, 3> m_direction{ 0, 1, 2 };	// the direction (x, y or z) of the axis
+	std::array<double, 3> m_min{ 0, 0, 0 };		// [µm]	first position
+	std::array<double, 3> m_spacing{ 0, 0, 0 };	// [µm]	distance between two positions
+	std::array<int, 3> m_count{ 1, 1, 1 };		// [1]	number of positions
+
+	std::vector<INDEX3> m_plane;				// order of a single plane of the Hilbert path
+	std::vector<gsl::index> m_order;			// order of all positions of the nearest-neighbour path
+	std::vector<gsl::index> m_planeSteps;		// step of every position of a single plane of the Hilbert path
+	std::vector<gsl::index> m_steps;			// step of every position of the nearest-neighbour path
+
+	gsl::index m_hilbertLimit{ 1000000 };		// maximum number of positions per plane for a Hilbert path
+	gsl::index m_nearestNeighbourLimit{ 20000 };	// maximum number of positions for a nearest-neighbour path
+};
+
+#endif // SCANPOSITIONS_H
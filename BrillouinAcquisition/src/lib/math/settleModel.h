@@ -0,0 +1,119 @@
+#ifndef SETTLEMODEL_H
+#define SETTLEMODEL_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+/*
+ * Learns how long a device needs to complete a move of a given distance.
+ *
+ * The durations of the last completed moves are fitted linearly to their distances. A move is expected to complete
+ * no earlier than the fit minus twice the standard deviation of its residuals, so that waiting this long before polling
+ * the device does not delay faster moves. Until enough moves were recorded, no move is expected to take any time.
+ */
+class settleModel {
+
+public:
+	settleModel(gsl::index capacity = 100) : m_capacity((std::max)(capacity, (gsl::index)MIN_SAMPLES)) {};
+
+	void add(double distance, double duration) {
+		if (!std::isfinite(distance) || !std::isfinite(duration)) {
+			return;
+		}
+		m_samples.push_back({ distance, duration });
+		if ((gsl::index)m_samples.size() > m_capacity) {
+			m_samples.pop_front();
+		}
+		fit();
+	}
+
+	void clear() {
+		m_samples.clear();
+		m_offset = 0;
+		m_slope = 0;
+		m_spread = 0;
+	}
+
+	bool isTrained() const {
+		return (gsl::index)m_samples.size() >= MIN_SAMPLES;
+	}
+
+	/*
+	 * Returns the expected duration [ms] of a move of the given distance
+	 */
+	double predict(double distance) const {
+		if (!isTrained()) {
+			return 0;
+		}
+		return (std::max)(0.0, m_offset + m_slope * distance);
+	}
+
+	/*
+	 * Returns the duration [ms] a move of the given distance takes at least
+	 */
+	double earliestCompletion(double distance) const {
+		if (!isTrained()) {
+			return 0;
+		}
+		return (std::max)(0.0, m_offset + m_slope * distance - 2 * m_spread);
+	}
+
+	double offset() const {
+		return m_offset;
+	}
+
+	double slope() const {
+		return m_slope;
+	}
+
+	double spread() const {
+		return m_spread;
+	}
+
+	static constexpr gsl::index MIN_SAMPLES{ 5 };	// [1]	number of moves required before the model is used
+
+private:
+	struct SAMPLE {
+		double distance{ 0 };	// [µm]	distance of the move
+		double duration{ 0 };	// [ms]	time until the move completed
+	};
+
+	void fit() {
+		auto count = (double)m_samples.size();
+		auto meanDistance = double{ 0 };
+		auto meanDuration = double{ 0 };
+		for (const auto& sample : m_samples) {
+			meanDistance += sample.distance;
+			meanDuration += sample.duration;
+		}
+		meanDistance /= count;
+		meanDuration /= count;
+
+		auto covariance = double{ 0 };
+		auto variance = double{ 0 };
+		for (const auto& sample : m_samples) {
+			covariance += (sample.distance - meanDistance) * (sample.duration - meanDuration);
+			variance += (sample.distance - meanDistance) * (sample.distance - meanDistance);
+		}
+		// without different distances we can only learn the mean duration
+		m_slope = (variance > 0) ? covariance / variance : 0;
+		m_offset = meanDuration - m_slope * meanDistance;
+
+		auto residuals = double{ 0 };
+		for (const auto& sample : m_samples) {
+			auto residual = sample.duration - (m_offset + m_slope * sample.distance);
+			residuals += residual * residual;
+		}
+		m_spread = std::sqrt(residuals / count);
+	}
+
+	gsl::index m_capacity;
+	std::deque<SAMPLE> m_samples;
+	double m_offset{ 0 };	// [ms]		duration of a move without distance
+	double m_slope{ 0 };	// [ms/µm]	additional duration per distance
+	double m_spread{ 0 };	// [ms]		standard deviation of the durations around the fit
+};
+
+#endif // SETTLEMODEL_H
@@ -0,0 +1,110 @@
+#ifndef SHARPNESS_H
+#define SHARPNESS_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+enum class SHARPNESS_METRIC {
+	NORMALIZED_VARIANCE,
+	TENENGRAD
+};
+
+/*
+ * Measures the sharpness of a brightfield image, the sharpness is largest in focus.
+ *
+ * The normalized variance is the variance of the intensity divided by its mean. The Tenengrad is the mean squared
+ * magnitude of the Sobel gradient, it is divided by the squared mean intensity here, so that it does not change with
+ * the brightness of the illumination. The Tenengrad is more selective for fine structures, the normalized variance is
+ * less sensitive to noise. Integer images are summed up exactly in 64 bit integers, so that the branch-free loops over
+ * the contiguous rows can be vectorized by the compiler independent of the floating point model.
+ */
+class sharpness {
+
+public:
+	template <typename T>
+	static double evaluate(const T* image, int dim_x, int dim_y, SHARPNESS_METRIC metric = SHARPNESS_METRIC::TENENGRAD) {
+		switch (metric) {
+			case SHARPNESS_METRIC::NORMALIZED_VARIANCE:
+				return normalizedVariance(image, dim_x, dim_y);
+			default:
+				return tenengrad(image, dim_x, dim_y);
+		}
+	}
+
+	template <typename T>
+	static double normalizedVariance(const T* image, int dim_x, int dim_y) {
+		if (dim_x < 1 || dim_y < 1) {
+			return 0;
+		}
+		auto sum = accumulator_t<T>{ 0 };
+		auto sumSquares = accumulator_t<T>{ 0 };
+		for (gsl::index y{ 0 }; y < dim_y; y++) {
+			auto row = &image[y * dim_x];
+			auto rowSum = accumulator_t<T>{ 0 };
+			auto rowSquares = accumulator_t<T>{ 0 };
+			for (gsl::index x{ 0 }; x < dim_x; x++) {
+				auto value = (accumulator_t<T>)row[x];
+				rowSum += value;
+				rowSquares += value * value;
+			}
+			sum += rowSum;
+			sumSquares += rowSquares;
+		}
+		auto N = (double)dim_x * dim_y;
+		auto mean = sum / N;
+		if (mean <= 0) {
+			return 0;
+		}
+		auto variance = (std::max)(sumSquares / N - mean * mean, 0.0);
+		return variance / mean;
+	}
+
+	template <typename T>
+	static double tenengrad(const T* image, int dim_x, int dim_y) {
+		// the Sobel operator needs a neighbour on every side
+		if (dim_x < 3 || dim_y < 3) {
+			return 0;
+		}
+		auto sum = accumulator_t<T>{ 0 };
+		auto gradient = accumulator_t<T>{ 0 };
+		for (gsl::index y{ 0 }; y < dim_y; y++) {
+			auto row = &image[y * dim_x];
+			auto rowSum = accumulator_t<T>{ 0 };
+			for (gsl::index x{ 0 }; x < dim_x; x++) {
+				rowSum += (accumulator_t<T>)row[x];
+			}
+			sum += rowSum;
+		}
+		for (gsl::index y{ 1 }; y < dim_y - 1; y++) {
+			auto above = &image[(y - 1) * dim_x];
+			auto row = &image[y * dim_x];
+			auto below = &image[(y + 1) * dim_x];
+			auto rowGradient = accumulator_t<T>{ 0 };
+			for (gsl::index x{ 1 }; x < dim_x - 1; x++) {
+				auto g_x = (gradient_t<T>)above[x + 1] - above[x - 1] + 2 * ((gradient_t<T>)row[x + 1] - row[x - 1])
+					+ below[x + 1] - below[x - 1];
+				auto g_y = (gradient_t<T>)below[x - 1] + 2 * below[x] + below[x + 1]
+					- above[x - 1] - 2 * above[x] - above[x + 1];
+				rowGradient += (accumulator_t<T>)g_x * g_x + (accumulator_t<T>)g_y * g_y;
+			}
+			gradient += rowGradient;
+		}
+		auto mean = sum / ((double)dim_x * dim_y);
+		if (mean <= 0) {
+			return 0;
+		}
+		return gradient / ((double)(dim_x - 2) * (dim_y - 2)) / (mean * mean);
+	}
+
+private:
+	// the Sobel gradient of 8 and 16 bit images fits into 32 bit, its square and the sums need 64 bit
+	template <typename T>
+	using gradient_t = std::conditional_t<std::is_integral_v<T> && sizeof(T) <= 2, int32_t, double>;
+	template <typename T>
+	using accumulator_t = std::conditional_t<std::is_integral_v<T> && sizeof(T) <= 2, int64_t, double>;
+};
+
+#endif // SHARPNESS_H
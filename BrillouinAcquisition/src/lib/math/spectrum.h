@@ -0,0 +1,210 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "points.h"
+
+struct SPECTRUM_LINE {
+	std::vector<POINT2> points;	// [pix]	vertices of the polyline through the spectrum on the camera
+	int samples{ 0 };			// [1]	number of samples along the line, 0 samples every pixel
+	int halfWidth{ 2 };			// [pix]	number of parallel lines on each side that are averaged
+};
+
+/*
+ * Extracts the one dimensional spectrum along a polyline from a camera frame.
+ *
+ * The samples are spaced evenly along the polyline. For every sample and parallel line the first pixel and the four
+ * bilinear weights are computed once for a given line and frame size. Extracting a spectrum is then a branch-free
+ * pass over contiguous arrays, which the compiler can vectorise.
+ */
+class spectrumExtractor {
+
+public:
+	spectrumExtractor() {};
+	spectrumExtractor(const SPECTRUM_LINE& line, int width, int height) {
+		auto points = line.points;
+		if (points.empty()) {
+			points.push_back(POINT2{ 0, 0 });
+		}
+
+		// cumulative length of the polyline at every vertex
+		auto lengths = std::vector<double>(points.size(), 0);
+		for (gsl::index i{ 1 }; i < (gsl::index)points.size(); i++) {
+			lengths[i] = lengths[i - 1] + abs(points[i] - points[i - 1]);
+		}
+		auto length = lengths.back();
+
+		m_samples = (line.samples > 0) ? line.samples : (int)std::floor(length) + 1;
+		m_rows = 2 * (gsl::index)std::max(line.halfWidth, 0) + 1;
+		m_dx = (width > 1) ? 1 : 0;
+		m_dy = (height > 1) ? width : 0;
+
+		auto count = (size_t)m_samples * m_rows;
+		m_base.assign(count, 0);
+		m_w00.assign(count, 0);
+		m_w10.assign(count, 0);
+		m_w01.assign(count, 0);
+		m_w11.assign(count, 0);
+		m_positions.resize(m_samples);
+		auto norm = std::vector<int>(m_samples, 0);
+
+		auto segment = gsl::index{ 0 };
+		for (gsl::index i{ 0 }; i < m_samples; i++) {
+			auto distance = (m_samples > 1) ? i * length / (m_samples - 1) : 0;
+			while (segment + 2 < (gsl::index)points.size() && distance > lengths[segment + 1]) {
+				segment++;
+			}
+
+			// unit vectors along and perpendicular to the current segment
+			auto along = POINT2{ 1, 0 };
+			auto position = points[0];
+			if (points.size() > 1) {
+				auto direction = points[segment + 1] - points[segment];
+				auto segmentLength = abs(direction);
+				if (segmentLength > 0) {
+					along = direction / segmentLength;
+				}
+				position = points[segment] + (distance - lengths[segment]) * along;
+			}
+			auto across = POINT2{ -along.y, along.x };
+			m_positions[i] = position;
+
+			for (gsl::index row{ 0 }; row < m_rows; row++) {
+				auto offset = (double)(row - m_rows / 2);
+				norm[i] += setWeights(row * m_samples + i, position.x + offset * across.x, position.y + offset * across.y, width, height);
+			}
+		}
+
+		m_scale.resize(m_samples);
+		for (gsl::index i{ 0 }; i < m_samples; i++) {
+			m_scale[i] = (norm[i] > 0) ? 1.0 / norm[i] : 0;
+		}
+	}
+
+	int samples() {
+		return m_samples;
+	}
+
+	/*
+	 * Returns the position of every sample on the camera.
+	 */
+	const std::vector<POINT2>& positions() {
+		return m_positions;
+	}
+
+	/*
+	 * Writes the mean intensity of every sample of a single frame to "spectrum", which has to hold samples() values.
+	 */
+	template <typename T, typename S>
+	void extractFrame(const T* frame, S* spectrum) {
+		m_sums.assign(m_samples, 0);
+		accumulate(frame, m_sums.data());
+		for (gsl::index i{ 0 }; i < m_samples; i++) {
+			spectrum[i] = (S)(m_sums[i] * m_scale[i]);
+		}
+	}
+
+	/*
+	 * Writes the mean intensity of every sample averaged over "frameCount" consecutive frames to "spectrum".
+	 */
+	template <typename T>
+	void extract(const T* frames, int frameCount, gsl::index pixelsPerFrame, double* spectrum) {
+		m_sums.assign(m_samples, 0);
+		for (gsl::index frame{ 0 }; frame < frameCount; frame++) {
+			accumulate(&frames[frame * pixelsPerFrame], m_sums.data());
+		}
+		for (gsl::index i{ 0 }; i < m_samples; i++) {
+			spectrum[i] = (frameCount > 0) ? m_sums[i] * m_scale[i] / frameCount : 0;
+		}
+	}
+
+	/*
+	 * Converts a polyline to and from the form "x1, y1; x2, y2; ...".
+	 */
+	static std::string toString(const std::vector<POINT2>& points) {
+		auto stream = std::ostringstream{};
+		for (gsl::index i{ 0 }; i < (gsl::index)points.size(); i++) {
+			stream << (i ? "; " : "") << points[i].x << ", " << points[i].y;
+		}
+		return stream.str();
+	}
+
+	static std::vector<POINT2> fromString(const std::string& string) {
+		auto points = std::vector<POINT2>{};
+		auto stream = std::istringstream{ string };
+		auto vertex = std::string{};
+		while (std::getline(stream, vertex, ';')) {
+			auto separator = vertex.find(',');
+			if (separator == std::string::npos) {
+				continue;
+			}
+			try {
+				points.push_back(POINT2{ std::stod(vertex.substr(0, separator)), std::stod(vertex.substr(separator + 1)) });
+			} catch (std::exception&) {
+				// skip vertices which are no numbers
+			}
+		}
+		return points;
+	}
+
+private:
+	/*
+	 * Sets the first pixel and the bilinear weights of the given entry, returns false if (x, y) is outside the frame.
+	 */
+	bool setWeights(gsl::index entry, double x, double y, int width, int height) {
+		if (x < 0 || y < 0 || x > width - 1 || y > height - 1) {
+			return false;
+		}
+		// keep all four pixels inside the frame, on the last pixel the weight moves to the far neighbour
+		auto x0 = std::min((int)std::floor(x), std::max(width - 2, 0));
+		auto y0 = std::min((int)std::floor(y), std::max(height - 2, 0));
+		auto fx = (m_dx > 0) ? x - x0 : 0;
+		auto fy = (m_dy > 0) ? y - y0 : 0;
+
+		m_base[entry] = (gsl::index)y0 * width + x0;
+		m_w00[entry] = (1 - fx) * (1 - fy);
+		m_w10[entry] = fx * (1 - fy);
+		m_w01[entry] = (1 - fx) * fy;
+		m_w11[entry] = fx * fy;
+		return true;
+	}
+
+	template <typename T>
+	void accumulate(const T* frame, double* sums) {
+		for (gsl::index row{ 0 }; row < m_rows; row++) {
+			auto base = &m_base[row * m_samples];
+			auto w00 = &m_w00[row * m_samples];
+			auto w10 = &m_w10[row * m_samples];
+			auto w01 = &m_w01[row * m_samples];
+			auto w11 = &m_w11[row * m_samples];
+			for (gsl::index i{ 0 }; i < m_samples; i++) {
+				auto pixel = &frame[base[i]];
+				sums[i] += w00[i] * pixel[0] + w10[i] * pixel[m_dx] + w01[i] * pixel[m_dy] + w11[i] * pixel[m_dx + m_dy];
+			}
+		}
+	}
+
+	int m_samples{ 0 };
+	gsl::index m_rows{ 1 };				// number of parallel lines
+	gsl::index m_dx{ 1 };				// offset to the neighbouring pixel in x
+	gsl::index m_dy{ 0 };				// offset to the neighbouring pixel in y
+
+	// lookup table with one entry per parallel line and sample, samples outside the frame have zero weights
+	std::vector<gsl::index> m_base;		// first of the four pixels
+	std::vector<double> m_w00;
+	std::vector<double> m_w10;
+	std::vector<double> m_w01;
+	std::vector<double> m_w11;
+
+	std::vector<double> m_scale;		// inverse number of parallel lines inside the frame for every sample
+	std::vector<POINT2> m_positions;	// [pix]	position of every sample
+	std::vector<double> m_sums;
+};
+
+#endif // SPECTRUM_H
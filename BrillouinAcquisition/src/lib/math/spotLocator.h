@@ -0,0 +1,298 @@
+#ifndef SPOTLOCATOR_H
+#define SPOTLOCATOR_H
+
+#include "../parallel.h"
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class SPOT_METHOD {
+	CENTROID,
+	GAUSSIAN
+};
+
+struct SPOT_SETTINGS {
+	SPOT_METHOD method{ SPOT_METHOD::GAUSSIAN };
+	int radius{ 6 };					// [pix]	half edge length of the window around the maximum
+	int coarseFactor{ 4 };				// [1]	downsampling of the coarse search, 1 searches every pixel
+	double minimalIntensity{ 100 };		// [1]	minimal peak intensity above the background for a valid spot
+};
+
+struct SPOT {
+	double x{ 0 };						// [pix]	position of the spot
+	double y{ 0 };						// [pix]
+	double width{ 0 };					// [pix]	standard deviation of the spot, only fitted by the Gaussian method
+	double peak{ 0 };					// [1]	peak intensity above the background
+	double background{ 0 };				// [1]	median intensity at the border of the window
+	bool valid{ false };
+};
+
+/*
+ * Locates a single bright spot, e.g. the focus of the laser, in a camera image with sub-pixel precision.
+ *
+ * The brightest block of coarseFactor x coarseFactor pixels is searched first, the maximum is only looked for inside
+ * this block. Summing up blocks is robust against single hot pixels and the loops run over contiguous rows, so that the
+ * compiler can vectorize them. The background is the median of the border of the window around the maximum and is
+ * subtracted before the spot is evaluated, either by its centroid or by a weighted least-squares fit of a Gaussian to
+ * the logarithm of the intensity. The fit is linear and needs no iterations, if it fails the centroid is returned.
+ * Several images are distributed over a pool of worker threads.
+ */
+class spotLocator {
+
+public:
+	template <typename T>
+	static SPOT locate(const T* image, int dim_x, int dim_y, const SPOT_SETTINGS& settings = SPOT_SETTINGS{}) {
+		auto spot = SPOT{};
+		if (dim_x < 1 || dim_y < 1) {
+			return spot;
+		}
+
+		gsl::index max_x{ 0 };
+		gsl::index max_y{ 0 };
+		findMaximum(image, dim_x, dim_y, settings.coarseFactor, max_x, max_y);
+
+		// the window is shifted at the border of the image, so that it always has the same size if possible
+		auto radius = (gsl::index)(std::max)(settings.radius, 1);
+		auto left = (std::max)((gsl::index)0, (std::min)(max_x - radius, (gsl::index)dim_x - 2 * radius - 1));
+		auto top = (std::max)((gsl::index)0, (std::min)(max_y - radius, (gsl::index)dim_y - 2 * radius - 1));
+		auto right = (std::min)(left + 2 * radius, (gsl::index)dim_x - 1);
+		auto bottom = (std::min)(top + 2 * radius, (gsl::index)dim_y - 1);
+
+		spot.background = background(image, dim_x, left, top, right, bottom);
+		spot.peak = image[max_y * dim_x + max_x] - spot.background;
+		if (spot.peak <= settings.minimalIntensity) {
+			spot.x = (double)max_x;
+			spot.y = (double)max_y;
+			return spot;
+		}
+
+		auto centroidFound = centroid(image, dim_x, left, top, right, bottom, spot);
+		if (settings.method == SPOT_METHOD::GAUSSIAN && gaussian(image, dim_x, left, top, right, bottom, spot)) {
+			spot.valid = true;
+		} else {
+			spot.valid = centroidFound;
+		}
+		return spot;
+	}
+
+	/*
+	 * Locates the spot in every image of the stack, which is ordered [image, y, x].
+	 */
+	template <typename T>
+	static std::vector<SPOT> locate(const T* images, int count, int dim_x, int dim_y, const SPOT_SETTINGS& settings = SPOT_SETTINGS{},
+		int threadCount = 0) {
+		auto spots = std::vector<SPOT>((std::max)(count, 0));
+		if (count < 1) {
+			return spots;
+		}
+		if (threadCount < 1) {
+			threadCount = (std::max)((int)std::thread::hardware_concurrency(), 1);
+		}
+
+		auto pixels = (gsl::index)dim_x * dim_y;
+		parallel::forEach(count, threadCount, [images, dim_x, dim_y, pixels, &settings, &spots](gsl::index, gsl::index i) {
+			spots[i] = locate(images + i * pixels, dim_x, dim_y, settings);
+		});
+		return spots;
+	}
+
+private:
+	/*
+	 * Finds the brightest pixel inside of the brightest block of factor x factor pixels.
+	 */
+	template <typename T>
+	static void findMaximum(const T* image, int dim_x, int dim_y, int factor, gsl::index& max_x, gsl::index& max_y) {
+		using acc_t = std::conditional_t<(sizeof(T) < sizeof(uint32_t)), uint32_t, uint64_t>;
+
+		// the blocks cover the whole image, the last block in every direction may be smaller
+		factor = (std::max)(factor, 1);
+		auto blocks_x = (dim_x + factor - 1) / factor;
+		auto blocks_y = (dim_y + factor - 1) / factor;
+
+		auto search_left = gsl::index{ 0 };
+		auto search_top = gsl::index{ 0 };
+		auto search_right = (gsl::index)dim_x;
+		auto search_bottom = (gsl::index)dim_y;
+
+		if (factor > 1 && blocks_x * blocks_y > 1) {
+			auto accumulator = std::vector<acc_t>(blocks_x);
+			auto rowSum = std::vector<acc_t>(dim_x);
+			auto best = acc_t{ 0 };
+			gsl::index best_x{ 0 };
+			gsl::index best_y{ 0 };
+			for (gsl::index by{ 0 }; by < blocks_y; by++) {
+				// sum up the rows of the block first, the pixels of a row are contiguous
+				std::fill(rowSum.begin(), rowSum.end(), 0);
+				auto rows = (std::min)((gsl::index)factor, (gsl::index)dim_y - by * factor);
+				for (gsl::index yy{ 0 }; yy < rows; yy++) {
+					auto row = &image[(by * factor + yy) * dim_x];
+					for (gsl::index x{ 0 }; x < dim_x; x++) {
+						rowSum[x] += row[x];
+					}
+				}
+				std::fill(accumulator.begin(), accumulator.end(), 0);
+				for (gsl::index x{ 0 }; x < dim_x; x++) {
+					accumulator[x / factor] += rowSum[x];
+				}
+				for (gsl::index bx{ 0 }; bx < blocks_x; bx++) {
+					if (accumulator[bx] > best) {
+						best = accumulator[bx];
+						best_x = bx;
+						best_y = by;
+					}
+				}
+			}
+			// the maximum may lie just outside of the brightest block if the spot is centred at its border
+			search_left = (std::max)((gsl::index)0, (best_x - 1) * factor);
+			search_top = (std::max)((gsl::index)0, (best_y - 1) * factor);
+			search_right = (std::min)((gsl::index)dim_x, (best_x + 2) * factor);
+			search_bottom = (std::min)((gsl::index)dim_y, (best_y + 2) * factor);
+		}
+
+		max_x = search_left;
+		max_y = search_top;
+		auto maximum = image[search_top * dim_x + search_left];
+		for (gsl::index y{ search_top }; y < search_bottom; y++) {
+			auto row = &image[y * dim_x];
+			auto rowMax = std::max_element(row + search_left, row + search_right);
+			if (*rowMax > maximum) {
+				maximum = *rowMax;
+				max_x = rowMax - row;
+				max_y = y;
+			}
+		}
+	}
+
+	template <typename T>
+	static double background(const T* image, int dim_x, gsl::index left, gsl::index top, gsl::index right, gsl::index bottom) {
+		auto border = std::vector<double>{};
+		border.reserve(2 * (right - left + bottom - top) + 4);
+		for (gsl::index x{ left }; x <= right; x++) {
+			border.push_back(image[top * dim_x + x]);
+			border.push_back(image[bottom * dim_x + x]);
+		}
+		for (gsl::index y{ top + 1 }; y < bottom; y++) {
+			border.push_back(image[y * dim_x + left]);
+			border.push_back(image[y * dim_x + right]);
+		}
+		auto middle = border.begin() + border.size() / 2;
+		std::nth_element(border.begin(), middle, border.end());
+		return *middle;
+	}
+
+	template <typename T>
+	static bool centroid(const T* image, int dim_x, gsl::index left, gsl::index top, gsl::index right, gsl::index bottom, SPOT& spot) {
+		double sum{ 0 };
+		double sum_x{ 0 };
+		double sum_y{ 0 };
+		for (gsl::index y{ top }; y <= bottom; y++) {
+			for (gsl::index x{ left }; x <= right; x++) {
+				auto value = (std::max)(image[y * dim_x + x] - spot.background, 0.0);
+				sum += value;
+				sum_x += value * x;
+				sum_y += value * y;
+			}
+		}
+		if (sum <= 0) {
+			return false;
+		}
+		spot.x = sum_x / sum;
+		spot.y = sum_y / sum;
+		return true;
+	}
+
+	/*
+	 * Fits ln(I) = a + b x + c y + d x^2 + e y^2 to the window. Every pixel is weighted by its squared intensity,
+	 * which compensates for the noise being amplified by the logarithm of dim pixels.
+	 */
+	template <typename T>
+	static bool gaussian(const T* image, int dim_x, gsl::index left, gsl::index top, gsl::index right, gsl::index bottom, SPOT& spot) {
+		// the coordinates are relative to the centroid to keep the normal equations well conditioned
+		auto x0 = spot.x;
+		auto y0 = spot.y;
+		auto A = std::array<std::array<double, 5>, 5>{};
+		auto b = std::array<double, 5>{};
+		// pixels below this fraction of the peak are dominated by noise
+		auto threshold = 0.05 * spot.peak;
+		for (gsl::index y{ top }; y <= bottom; y++) {
+			for (gsl::index x{ left }; x <= right; x++) {
+				auto value = image[y * dim_x + x] - spot.background;
+				if (value <= threshold) {
+					continue;
+				}
+				auto dx = x - x0;
+				auto dy = y - y0;
+				auto weight = value * value;
+				auto basis = std::array<double, 5>{ 1, dx, dy, dx * dx, dy * dy };
+				auto logValue = log(value);
+				for (gsl::index i{ 0 }; i < 5; i++) {
+					for (gsl::index j{ i }; j < 5; j++) {
+						A[i][j] += weight * basis[i] * basis[j];
+					}
+					b[i] += weight * basis[i] * logValue;
+				}
+			}
+		}
+		for (gsl::index i{ 0 }; i < 5; i++) {
+			for (gsl::index j{ 0 }; j < i; j++) {
+				A[i][j] = A[j][i];
+			}
+		}
+
+		auto p = std::array<double, 5>{};
+		if (!solve(A, b, p) || p[3] >= 0 || p[4] >= 0) {
+			return false;
+		}
+		auto x = x0 - p[1] / (2 * p[3]);
+		auto y = y0 - p[2] / (2 * p[4]);
+		// a vertex outside of the window is not trustworthy
+		if (!std::isfinite(x) || !std::isfinite(y) || x < left || x > right || y < top || y > bottom) {
+			return false;
+		}
+		spot.x = x;
+		spot.y = y;
+		spot.width = sqrt(0.5 * (-1 / (2 * p[3]) - 1 / (2 * p[4])));
+		return true;
+	}
+
+	// Gaussian elimination with partial pivoting
+	template <std::size_t N>
+	static bool solve(std::array<std::array<double, N>, N> A, std::array<double, N> b, std::array<double, N>& x) {
+		for (gsl::index col{ 0 }; col < (gsl::index)N; col++) {
+			auto pivot = col;
+			for (gsl::index row{ col + 1 }; row < (gsl::index)N; row++) {
+				if (std::abs(A[row][col]) > std::abs(A[pivot][col])) {
+					pivot = row;
+				}
+			}
+			if (std::abs(A[pivot][col]) < 1e-12) {
+				return false;
+			}
+			std::swap(A[col], A[pivot]);
+			std::swap(b[col], b[pivot]);
+			for (gsl::index row{ col + 1 }; row < (gsl::index)N; row++) {
+				auto factor = A[row][col] / A[col][col];
+				for (gsl::index k{ col }; k < (gsl::index)N; k++) {
+					A[row][k] -= factor * A[col][k];
+				}
+				b[row] -= factor * b[col];
+			}
+		}
+		for (auto row = (gsl::index)N - 1; row >= 0; row--) {
+			auto sum = b[row];
+			for (gsl::index k{ row + 1 }; k < (gsl::index)N; k++) {
+				sum -= A[row][k] * x[k];
+			}
+			x[row] = sum / A[row][row];
+		}
+		return true;
+	}
+};
+
+#endif // SPOTLOCATOR_H
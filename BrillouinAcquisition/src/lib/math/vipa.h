@@ -0,0 +1,87 @@
+#ifndef VIPA_H
+#define VIPA_H
+
+#include <gsl/gsl>
+#include <array>
+#include <cmath>
+
+#include "lorentzian.h"
+
+struct VIPA_CALIBRATION {
+	double offset{ NAN };				// [GHz]	frequency at the first sample of the spectrum
+	double dispersion{ NAN };			// [GHz/pix]	frequency change per sample
+	double freeSpectralRange{ NAN };	// [GHz]	free spectral range of the VIPA
+	std::array<double, 2> peaks{ NAN, NAN };	// [pix]	fitted positions of the anti-Stokes and the Stokes peak
+	double residual{ NAN };				// [1]	sum of the squared residuals of the peak fit
+	bool valid{ false };
+
+	/*
+	 * Returns the frequency of the given position in the spectrum relative to the Rayleigh peak of the lower order.
+	 */
+	double frequency(double position) const {
+		return offset + dispersion * position;
+	}
+
+	/*
+	 * Returns the Brillouin shift of a sample from the positions of its anti-Stokes and Stokes peak.
+	 * The peaks belong to neighbouring orders, so they are one free spectral range minus twice the shift apart.
+	 */
+	double shift(double antiStokes, double stokes) const {
+		if (!valid) {
+			return NAN;
+		}
+		return 0.5 * (freeSpectralRange - (frequency(stokes) - frequency(antiStokes)));
+	}
+};
+
+/*
+ * Calibrates the frequency axis of a VIPA spectrometer from the spectrum of a reference sample with a known Brillouin shift.
+ *
+ * The spectrum shows the anti-Stokes peak of one interference order at the frequency "shift" and the Stokes peak of the
+ * next order at "freeSpectralRange - shift", both relative to the Rayleigh peak of the lower order. With a single reference
+ * sample only these two frequencies are known, so the dispersion is approximated linearly across the spectrum.
+ * The frequency is assumed to increase with the position in the spectrum.
+ */
+class vipaCalibration {
+
+public:
+	vipaCalibration(double shift = 5.088, double freeSpectralRange = 15)
+		: m_shift(shift), m_freeSpectralRange(freeSpectralRange) {};
+
+	VIPA_CALIBRATION fit(const double* spectrum, int count) {
+		auto calibration = VIPA_CALIBRATION{};
+		calibration.freeSpectralRange = m_freeSpectralRange;
+		if (m_freeSpectralRange <= 2 * m_shift) {
+			return calibration;
+		}
+
+		auto peaks = m_fitter.fit(spectrum, count);
+		calibration.residual = peaks.residual;
+		if (!peaks.converged || peaks.peakCount != 2) {
+			return calibration;
+		}
+		// both peaks have to be present inside the spectrum
+		for (const auto& peak : peaks.peaks) {
+			if (!(peak.amplitude > 0) || peak.position < 0 || peak.position > count - 1) {
+				return calibration;
+			}
+		}
+		calibration.peaks = { peaks.peaks[0].position, peaks.peaks[1].position };
+
+		auto distance = calibration.peaks[1] - calibration.peaks[0];
+		if (!(distance > 0)) {
+			return calibration;
+		}
+		calibration.dispersion = (m_freeSpectralRange - 2 * m_shift) / distance;
+		calibration.offset = m_shift - calibration.dispersion * calibration.peaks[0];
+		calibration.valid = std::isfinite(calibration.offset) && std::isfinite(calibration.dispersion);
+		return calibration;
+	}
+
+private:
+	double m_shift{ 5.088 };				// [GHz]	Brillouin shift of the reference sample
+	double m_freeSpectralRange{ 15 };		// [GHz]	free spectral range of the VIPA
+	lorentzian m_fitter{ 2 };
+};
+
+#endif // VIPA_H
@@ -0,0 +1,42 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/*
+ * Distributes independent work items over a pool of threads.
+ *
+ * Every thread takes the next item until all are done, so that items of different duration are balanced without
+ * a scheduler. The calling thread is the first worker, the function is called with the number of the worker
+ * and the item, so that every worker can use its own buffers.
+ */
+class parallel {
+
+public:
+	template <typename Function>
+	static void forEach(gsl::index count, int threadCount, Function&& work) {
+		threadCount = (int)(std::min)((gsl::index)(std::max)(threadCount, 1), (std::max)(count, gsl::index{ 1 }));
+
+		std::atomic<gsl::index> next{ 0 };
+		auto worker = [count, &next, &work](gsl::index thread) {
+			for (auto item = next++; item < count; item = next++) {
+				work(thread, item);
+			}
+		};
+
+		auto workers = std::vector<std::thread>{};
+		for (gsl::index thread{ 1 }; thread < threadCount; thread++) {
+			workers.emplace_back(worker, thread);
+		}
+		worker(0);
+		for (auto& thread : workers) {
+			thread.join();
+		}
+	}
+};
+
+#endif // PARALLEL_H
@@ -0,0 +1,191 @@
+#ifndef PHASETIMER_H
+#define PHASETIMER_H
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct PHASE_STATISTICS {
+	std::string name;
+	int count{ 0 };				// [1]	number of recorded durations
+	double total{ 0 };			// [ms]	sum of all durations
+	double min{ NAN };			// [ms]	shortest duration
+	double max{ NAN };			// [ms]	longest duration
+	std::vector<int> histogram;	// [1]	number of durations per bin, see phaseTimer::binEdges()
+
+	double mean() const {
+		return count ? total / count : NAN;
+	}
+};
+
+/*
+ * Records the durations of the phases of an acquisition, e.g. moving the stage or reading out the camera.
+ *
+ * The durations are sorted into logarithmic histogram bins, so that recording is cheap and the memory does not
+ * grow with the number of recordings. Percentiles are estimated from the histogram. Phases may be nested, e.g.
+ * the frames of a calibration are part of the calibration, so the totals of all phases can exceed the elapsed time.
+ * Recording is thread-safe, so phases running in parallel to the acquisition thread can be measured as well.
+ */
+class phaseTimer {
+
+public:
+	/*
+	 * Records the time from its construction until it is stopped or destroyed
+	 */
+	class scope {
+
+	public:
+		scope(phaseTimer* timer, const std::string& phase)
+			: m_timer(timer), m_phase(phase), m_start(std::chrono::steady_clock::now()) {};
+		~scope() {
+			stop();
+		}
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+		scope(scope&& other) noexcept
+			: m_timer(other.m_timer), m_phase(std::move(other.m_phase)), m_start(other.m_start) {
+			other.m_timer = nullptr;
+		}
+
+		void stop() {
+			if (!m_timer) {
+				return;
+			}
+			auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start);
+			m_timer->record(m_phase, duration.count());
+			m_timer = nullptr;
+		}
+
+	private:
+		phaseTimer* m_timer{ nullptr };
+		std::string m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	phaseTimer() {
+		reset();
+	};
+
+	/*
+	 * Removes all recordings and restarts the elapsed time
+	 */
+	void reset() {
+		std::lock_guard<std::mutex> lockGuard(m_mutex);
+		m_phases.clear();
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	scope measure(const std::string& phase) {
+		return scope(this, phase);
+	}
+
+	void record(const std::string& phase, double duration) {
+		std::lock_guard<std::mutex> lockGuard(m_mutex);
+		auto it = std::find_if(m_phases.begin(), m_phases.end(), [&phase](const PHASE_STATISTICS& statistics) {
+			return statistics.name == phase;
+		});
+		if (it == m_phases.end()) {
+			auto statistics = PHASE_STATISTICS{};
+			statistics.name = phase;
+			statistics.histogram.resize(BIN_COUNT, 0);
+			m_phases.push_back(statistics);
+			it = m_phases.end() - 1;
+		}
+		it->count++;
+		it->total += duration;
+		it->min = std::isnan(it->min) ? duration : (std::min)(it->min, duration);
+		it->max = std::isnan(it->max) ? duration : (std::max)(it->max, duration);
+		it->histogram[bin(duration)]++;
+	}
+
+	/*
+	 * Returns the statistics of all phases in the order they were first recorded
+	 */
+	std::vector<PHASE_STATISTICS> statistics() {
+		std::lock_guard<std::mutex> lockGuard(m_mutex);
+		return m_phases;
+	}
+
+	/*
+	 * Returns the time [ms] since the last reset
+	 */
+	double elapsed() {
+		std::lock_guard<std::mutex> lockGuard(m_mutex);
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+	/*
+	 * Returns the lower edges [ms] of the histogram bins, the last bin is open-ended
+	 */
+	static std::vector<double> binEdges() {
+		auto edges = std::vector<double>(BIN_COUNT);
+		edges[0] = 0;
+		for (gsl::index i{ 1 }; i < BIN_COUNT; i++) {
+			edges[i] = FIRST_EDGE * std::pow(2.0, (double)i - 1);
+		}
+		return edges;
+	}
+
+	/*
+	 * Estimates the given percentile [0 - 100] of the durations [ms] by interpolating within the histogram bins
+	 */
+	static double percentile(const PHASE_STATISTICS& statistics, double percent) {
+		if (!statistics.count || statistics.histogram.size() != BIN_COUNT) {
+			return NAN;
+		}
+		auto edges = binEdges();
+		auto rank = 1e-2 * std::clamp(percent, 0.0, 100.0) * statistics.count;
+		auto cumulated = double{ 0 };
+		for (gsl::index i{ 0 }; i < BIN_COUNT; i++) {
+			auto binCount = statistics.histogram[i];
+			if (binCount > 0 && cumulated + binCount >= rank) {
+				// the recorded extrema are tighter bounds than the bin edges
+				auto lower = (std::max)(edges[i], statistics.min);
+				auto upper = (i + 1 < BIN_COUNT) ? (std::min)(edges[i + 1], statistics.max) : statistics.max;
+				auto fraction = (rank - cumulated) / binCount;
+				return lower + fraction * (upper - lower);
+			}
+			cumulated += binCount;
+		}
+		return statistics.max;
+	}
+
+	/*
+	 * Combines the statistics of two recordings of the same phase, e.g. of the parts of a resumed repetition
+	 */
+	static PHASE_STATISTICS merge(const PHASE_STATISTICS& first, const PHASE_STATISTICS& second) {
+		auto merged = first;
+		merged.count += second.count;
+		merged.total += second.total;
+		// NaN marks a phase without recordings
+		merged.min = std::isnan(first.min) ? second.min : (std::isnan(second.min) ? first.min : (std::min)(first.min, second.min));
+		merged.max = std::isnan(first.max) ? second.max : (std::isnan(second.max) ? first.max : (std::max)(first.max, second.max));
+		merged.histogram.resize((std::max)(first.histogram.size(), second.histogram.size()), 0);
+		for (gsl::index i{ 0 }; i < (gsl::index)second.histogram.size(); i++) {
+			merged.histogram[i] += second.histogram[i];
+		}
+		return merged;
+	}
+
+	static gsl::index bin(double duration) {
+		if (!(duration >= FIRST_EDGE)) {
+			return 0;
+		}
+		auto index = (gsl::index)std::floor(std::log2(duration / FIRST_EDGE)) + 1;
+		return (std::min)(index, (gsl::index)BIN_COUNT - 1);
+	}
+
+	static constexpr int BIN_COUNT{ 28 };				// [1]	number of histogram bins
+	static constexpr double FIRST_EDGE{ 0.001 };		// [ms]	upper edge of the first bin, the following bins double in width
+
+private:
+	std::mutex m_mutex;
+	std::vector<PHASE_STATISTICS> m_phases;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#endif // PHASETIMER_H
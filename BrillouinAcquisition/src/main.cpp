@@ -9,6 +9,7 @@
 #include <QLoggingCategory>
 
 #include "src/helper/logger.h"
+#include "external/fftw/fftw3.h"
 
 // Smart pointer for log file
 QScopedPointer<QFile> m_logFile;
@@ -27,6 +28,10 @@ int main(int argc, char *argv[]) {
 		qputenv("QT_DEVICE_PIXEL_RATIO", QByteArray("1"));
 	#endif // QT_VERSION
 
+	// the previews, the phase retrieval and the tomographic reconstruction create FFTW plans in different threads
+	fftw_init_threads();
+	fftw_make_planner_thread_safe();
+
 	QApplication a(argc, argv);
 	BrillouinAcquisition w;
 
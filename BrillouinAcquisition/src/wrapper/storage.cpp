@@ -15,6 +15,26 @@ StorageWrapper::~StorageWrapper() {
 			auto img = m_payloadQueueBrillouin_short.dequeue();
 			delete img;
 		}
+		while (!m_payloadQueueBrillouin_int.isEmpty()) {
+			auto img = m_payloadQueueBrillouin_int.dequeue();
+			delete img;
+		}
+		while (!m_payloadVarianceQueueBrillouin.isEmpty()) {
+			auto img = m_payloadVarianceQueueBrillouin.dequeue();
+			delete img;
+		}
+		while (!m_payloadSpectraQueueBrillouin.isEmpty()) {
+			auto img = m_payloadSpectraQueueBrillouin.dequeue();
+			delete img;
+		}
+		while (!m_brightfieldQueueBrillouin_char.isEmpty()) {
+			auto img = m_brightfieldQueueBrillouin_char.dequeue();
+			delete img;
+		}
+		while (!m_brightfieldQueueBrillouin_short.isEmpty()) {
+			auto img = m_brightfieldQueueBrillouin_short.dequeue();
+			delete img;
+		}
 		while (!m_payloadQueueODT_char.isEmpty()) {
 			auto img = m_payloadQueueODT_char.dequeue();
 			delete img;
@@ -23,6 +43,14 @@ StorageWrapper::~StorageWrapper() {
 			auto img = m_payloadQueueODT_short.dequeue();
 			delete img;
 		}
+		while (!m_payloadStackQueueODT_char.isEmpty()) {
+			auto stack = m_payloadStackQueueODT_char.dequeue();
+			delete stack;
+		}
+		while (!m_payloadStackQueueODT_short.isEmpty()) {
+			auto stack = m_payloadStackQueueODT_short.dequeue();
+			delete stack;
+		}
 		while (!m_payloadQueueFluorescence_char.isEmpty()) {
 			auto img = m_payloadQueueFluorescence_char.dequeue();
 			delete img;
@@ -31,6 +59,14 @@ StorageWrapper::~StorageWrapper() {
 			auto img = m_payloadQueueFluorescence_short.dequeue();
 			delete img;
 		}
+		while (!m_payloadStackQueueFluorescence_char.isEmpty()) {
+			auto frame = m_payloadStackQueueFluorescence_char.dequeue();
+			delete frame;
+		}
+		while (!m_payloadStackQueueFluorescence_short.isEmpty()) {
+			auto frame = m_payloadStackQueueFluorescence_short.dequeue();
+			delete frame;
+		}
 		while (!m_calibrationQueue_char.isEmpty()) {
 			auto cal = m_calibrationQueue_char.dequeue();
 			delete cal;
@@ -43,6 +79,10 @@ StorageWrapper::~StorageWrapper() {
 			auto cal = m_calibrationQueue_int.dequeue();
 			delete cal;
 		}
+		while (!m_calibrationFitQueue.isEmpty()) {
+			auto fit = m_calibrationFitQueue.dequeue();
+			delete fit;
+		}
 	}
 	if (m_queueTimer) {
 		m_queueTimer->stop();
@@ -73,6 +113,22 @@ void StorageWrapper::s_enqueuePayload(IMAGE<unsigned int>* img) {
 	m_payloadQueueBrillouin_int.enqueue(img);
 }
 
+void StorageWrapper::s_enqueuePayloadVariance(IMAGE<float>* img) {
+	m_payloadVarianceQueueBrillouin.enqueue(img);
+}
+
+void StorageWrapper::s_enqueuePayloadSpectra(IMAGE<float>* img) {
+	m_payloadSpectraQueueBrillouin.enqueue(img);
+}
+
+void StorageWrapper::s_enqueueBrightfield(IMAGE<unsigned char>* img) {
+	m_brightfieldQueueBrillouin_char.enqueue(img);
+}
+
+void StorageWrapper::s_enqueueBrightfield(IMAGE<unsigned short>* img) {
+	m_brightfieldQueueBrillouin_short.enqueue(img);
+}
+
 void StorageWrapper::s_enqueuePayload(ODTIMAGE<unsigned char>*img) {
 	m_payloadQueueODT_char.enqueue(img);
 }
@@ -81,6 +137,14 @@ void StorageWrapper::s_enqueuePayload(ODTIMAGE<unsigned short>* img) {
 	m_payloadQueueODT_short.enqueue(img);
 }
 
+void StorageWrapper::s_enqueuePayload(ODTSTACK<unsigned char>* stack) {
+	m_payloadStackQueueODT_char.enqueue(stack);
+}
+
+void StorageWrapper::s_enqueuePayload(ODTSTACK<unsigned short>* stack) {
+	m_payloadStackQueueODT_short.enqueue(stack);
+}
+
 void StorageWrapper::s_enqueuePayload(FLUOIMAGE<unsigned char>*img) {
 	m_payloadQueueFluorescence_char.enqueue(img);
 }
@@ -89,6 +153,14 @@ void StorageWrapper::s_enqueuePayload(FLUOIMAGE<unsigned short>* img) {
 	m_payloadQueueFluorescence_short.enqueue(img);
 }
 
+void StorageWrapper::s_enqueuePayload(FLUOSTACK<unsigned char>* frame) {
+	m_payloadStackQueueFluorescence_char.enqueue(frame);
+}
+
+void StorageWrapper::s_enqueuePayload(FLUOSTACK<unsigned short>* frame) {
+	m_payloadStackQueueFluorescence_short.enqueue(frame);
+}
+
 void StorageWrapper::s_enqueueCalibration(CALIBRATION<unsigned char>*cal) {
 	m_calibrationQueue_char.enqueue(cal);
 }
@@ -101,6 +173,10 @@ void StorageWrapper::s_enqueueCalibration(CALIBRATION<unsigned int>* cal) {
 	m_calibrationQueue_int.enqueue(cal);
 }
 
+void StorageWrapper::s_enqueueCalibrationFit(CALIBRATION_FIT* fit) {
+	m_calibrationFitQueue.enqueue(fit);
+}
+
 void StorageWrapper::s_finishedQueueing() {
 	m_finishedQueueing = true;
 }
@@ -160,6 +236,46 @@ void StorageWrapper::s_writeQueues() {
 		delete img;
 		img = nullptr;
 	}
+	while (!m_payloadVarianceQueueBrillouin.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto img = m_payloadVarianceQueueBrillouin.dequeue();
+		setPayloadVariance(img);
+		delete img;
+		img = nullptr;
+	}
+	while (!m_payloadSpectraQueueBrillouin.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto img = m_payloadSpectraQueueBrillouin.dequeue();
+		setPayloadSpectra(img);
+		delete img;
+		img = nullptr;
+	}
+	while (!m_brightfieldQueueBrillouin_char.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto img = m_brightfieldQueueBrillouin_char.dequeue();
+		setPayloadBrightfield(img);
+		delete img;
+		img = nullptr;
+	}
+	while (!m_brightfieldQueueBrillouin_short.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto img = m_brightfieldQueueBrillouin_short.dequeue();
+		setPayloadBrightfield(img);
+		delete img;
+		img = nullptr;
+	}
 
 	while (!m_payloadQueueODT_char.isEmpty()) {
 		if (m_abort) {
@@ -187,6 +303,28 @@ void StorageWrapper::s_writeQueues() {
 		delete img;
 		img = nullptr;
 	}
+	while (!m_payloadStackQueueODT_char.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto stack = m_payloadStackQueueODT_char.dequeue();
+		setPayloadData(stack);
+		m_writtenImagesNr += (int)stack->dims[0];
+		delete stack;
+		stack = nullptr;
+	}
+	while (!m_payloadStackQueueODT_short.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto stack = m_payloadStackQueueODT_short.dequeue();
+		setPayloadData(stack);
+		m_writtenImagesNr += (int)stack->dims[0];
+		delete stack;
+		stack = nullptr;
+	}
 
 	while (!m_payloadQueueFluorescence_char.isEmpty()) {
 		if (m_abort) {
@@ -214,6 +352,28 @@ void StorageWrapper::s_writeQueues() {
 		delete img;
 		img = nullptr;
 	}
+	while (!m_payloadStackQueueFluorescence_char.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto frame = m_payloadStackQueueFluorescence_char.dequeue();
+		setPayloadData(frame);
+		m_writtenImagesNr++;
+		delete frame;
+		frame = nullptr;
+	}
+	while (!m_payloadStackQueueFluorescence_short.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto frame = m_payloadStackQueueFluorescence_short.dequeue();
+		setPayloadData(frame);
+		m_writtenImagesNr++;
+		delete frame;
+		frame = nullptr;
+	}
 
 	while (!m_calibrationQueue_char.isEmpty()) {
 		if (m_abort) {
@@ -243,6 +403,18 @@ void StorageWrapper::s_writeQueues() {
 		cal = nullptr;
 	}
 
+	// the fits are queued after their calibrations, so these are written already
+	while (!m_calibrationFitQueue.isEmpty()) {
+		if (m_abort) {
+			stopWritingQueues();
+			return;
+		}
+		auto fit = m_calibrationFitQueue.dequeue();
+		setCalibrationFit(fit);
+		delete fit;
+		fit = nullptr;
+	}
+
 	if (m_finishedQueueing) {
 		m_queueTimer->stop();
 		emit(finished());
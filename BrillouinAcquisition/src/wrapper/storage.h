@@ -30,16 +30,25 @@ public:
 	QQueue<IMAGE<unsigned char>*> m_payloadQueueBrillouin_char;
 	QQueue<IMAGE<unsigned short>*> m_payloadQueueBrillouin_short;
 	QQueue<IMAGE<unsigned int>*> m_payloadQueueBrillouin_int;
+	QQueue<IMAGE<float>*> m_payloadVarianceQueueBrillouin;
+	QQueue<IMAGE<float>*> m_payloadSpectraQueueBrillouin;
+	QQueue<IMAGE<unsigned char>*> m_brightfieldQueueBrillouin_char;
+	QQueue<IMAGE<unsigned short>*> m_brightfieldQueueBrillouin_short;
 
 	QQueue<ODTIMAGE<unsigned char>*> m_payloadQueueODT_char;
 	QQueue<ODTIMAGE<unsigned short>*> m_payloadQueueODT_short;
+	QQueue<ODTSTACK<unsigned char>*> m_payloadStackQueueODT_char;
+	QQueue<ODTSTACK<unsigned short>*> m_payloadStackQueueODT_short;
 
 	QQueue<FLUOIMAGE<unsigned char>*> m_payloadQueueFluorescence_char;
 	QQueue<FLUOIMAGE<unsigned short>*> m_payloadQueueFluorescence_short;
+	QQueue<FLUOSTACK<unsigned char>*> m_payloadStackQueueFluorescence_char;
+	QQueue<FLUOSTACK<unsigned short>*> m_payloadStackQueueFluorescence_short;
 
 	QQueue<CALIBRATION<unsigned char>*> m_calibrationQueue_char;
 	QQueue<CALIBRATION<unsigned short>*> m_calibrationQueue_short;
 	QQueue<CALIBRATION<unsigned int>*> m_calibrationQueue_int;
+	QQueue<CALIBRATION_FIT*> m_calibrationFitQueue;
 
 	bool m_abort{ false };
 
@@ -57,16 +66,25 @@ public slots:
 	void s_enqueuePayload(IMAGE<unsigned char>*);
 	void s_enqueuePayload(IMAGE<unsigned short>*);
 	void s_enqueuePayload(IMAGE<unsigned int>*);
+	void s_enqueuePayloadVariance(IMAGE<float>*);
+	void s_enqueuePayloadSpectra(IMAGE<float>*);
+	void s_enqueueBrightfield(IMAGE<unsigned char>*);
+	void s_enqueueBrightfield(IMAGE<unsigned short>*);
 
 	void s_enqueuePayload(ODTIMAGE<unsigned char>*);
 	void s_enqueuePayload(ODTIMAGE<unsigned short>*);
+	void s_enqueuePayload(ODTSTACK<unsigned char>*);
+	void s_enqueuePayload(ODTSTACK<unsigned short>*);
 
 	void s_enqueuePayload(FLUOIMAGE<unsigned char>*);
 	void s_enqueuePayload(FLUOIMAGE<unsigned short>*);
+	void s_enqueuePayload(FLUOSTACK<unsigned char>*);
+	void s_enqueuePayload(FLUOSTACK<unsigned short>*);
 
 	void s_enqueueCalibration(CALIBRATION<unsigned char>* cal);
 	void s_enqueueCalibration(CALIBRATION<unsigned short>* cal);
 	void s_enqueueCalibration(CALIBRATION<unsigned int>* cal);
+	void s_enqueueCalibrationFit(CALIBRATION_FIT* fit);
 
 	void s_finishedQueueing();
 
@@ -0,0 +1,50 @@
+#include "stdafx.h"
+#include "MockScanControl.h"
+
+MockScanControl::MockScanControl(double speed, double settleTime, bool positionReadback)
+	: m_speed(speed), m_settleTime(settleTime), m_moveStart(std::chrono::steady_clock::now()) {
+	registerCapability(Capabilities::TranslationStage);
+	if (positionReadback) {
+		registerCapability(Capabilities::PositionReadback);
+	}
+
+	m_deviceElements = {
+		DeviceElement{ "Shutter", 2, 0 },
+		DeviceElement{ "Filter", 2, 1 }
+	};
+	m_deviceElements[0].settleTime = 20;
+	m_deviceElements[1].settleTime = 80;
+	m_presets = {
+		{ "Brillouin", ScanPreset::SCAN_BRILLOUIN, { { 0 }, { 0 } } },
+		{ "Calibration", ScanPreset::SCAN_CALIBRATION, { { 1 }, { 0 } } },
+		{ "Brightfield", ScanPreset::SCAN_BRIGHTFIELD, { { 1 }, { 1 } } }
+	};
+	m_elementPositions = { 0, 0 };
+	checkPresets();
+}
+
+MockScanControl::~MockScanControl() {
+}
+
+void MockScanControl::setPosition(POINT2 position) {
+	setPosition(POINT3{ position.x, position.y, m_target.z });
+}
+
+void MockScanControl::setPosition(POINT3 position) {
+	auto start = getPosition();
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	m_start = start;
+	m_target = position;
+	m_moveStart = std::chrono::steady_clock::now();
+}
+
+POINT3 MockScanControl::getPosition(PositionType positionType) {
+	std::lock_guard<std::mutex> lockGuard(m_mutex);
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_moveStart).count();
+	auto distance = m_target - m_start;
+	auto duration = m_settleTime + abs(distance) / m_speed;
+	if (elapsed >= duration) {
+		return m_target;
+	}
+	return m_start + (elapsed / duration) * distance;
+}
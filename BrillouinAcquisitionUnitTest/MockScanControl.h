@@ -0,0 +1,42 @@
+#ifndef MOCKSCANCONTROL_H
+#define MOCKSCANCONTROL_H
+
+#include "..\BrillouinAcquisition\src\Devices\ScanControls\ScanControl.h"
+#include <QObject>
+
+#include <chrono>
+#include <mutex>
+
+/*
+ * A stage which needs a settle time plus the travel time at the given speed to reach a position.
+ * The measured position moves linearly from the start to the target, so that moves can wait for it.
+ * A shutter and a filter wheel, which settle in 20 ms and 80 ms, are switched by the Brillouin, calibration and
+ * brightfield presets. Like the real devices, they are reported in place right away.
+ */
+class MockScanControl : public ScanControl {
+	Q_OBJECT
+private:
+	double m_speed{ 1 };			// [µm/ms]	travel speed of the stage
+	double m_settleTime{ 5 };		// [ms]	time the stage needs in addition to the travel time
+	POINT3 m_start{ 0, 0, 0 };
+	POINT3 m_target{ 0, 0, 0 };
+	std::chrono::steady_clock::time_point m_moveStart;
+	std::mutex m_mutex;
+public:
+	MockScanControl(double speed, double settleTime, bool positionReadback = true);
+	~MockScanControl();
+
+	void setPosition(POINT2 position) override;
+	void setPosition(POINT3 position) override;
+	POINT3 getPosition(PositionType positionType = PositionType::BOTH) override;
+
+public slots:
+	void init() override {};
+	void connectDevice() override {};
+	void disconnectDevice() override {};
+	void setElement(DeviceElement element, double position) override {};
+	int getElement(const DeviceElement& element) override { return (int)m_elementPositions[element.index]; };
+	void getElements() override {};
+};
+
+#endif // MOCKSCANCONTROL_H
@@ -155,6 +155,58 @@ namespace BrillouinAcquisitionUnitTest
 			checkIntegrity(&scaleCalibration);
 		}
 
+		TEST_METHOD(initializeFromShifts_TwoTranslations) {
+			auto scaleCalibration = ScaleCalibrationData{};
+
+			// shifts of the image content for a translation of 10 µm in x- and y-direction
+			auto translations = std::vector<POINT2>{ { 10, 0 }, { 0, 10 } };
+			auto shifts = std::vector<POINT2>{ { 100, 100 }, { 100, -100 } };
+
+			ScaleCalibrationHelper::initializeCalibrationFromShifts(&scaleCalibration, translations, shifts);
+
+			Assert::AreEqual(-10.0, scaleCalibration.micrometerToPixX.x, 1e-10);
+			Assert::AreEqual(10.0, scaleCalibration.micrometerToPixX.y, 1e-10);
+
+			Assert::AreEqual(-10.0, scaleCalibration.micrometerToPixY.x, 1e-10);
+			Assert::AreEqual(-10.0, scaleCalibration.micrometerToPixY.y, 1e-10);
+
+			checkIntegrity(&scaleCalibration);
+		}
+
+		TEST_METHOD(initializeFromShifts_LeastSquares) {
+			auto scaleCalibration = ScaleCalibrationData{};
+
+			auto translations = std::vector<POINT2>{ { 10, 0 }, { 0, 10 }, { -10, 0 }, { 0, -10 }, { 10, 10 }, { -10, -10 }, { 10, -10 }, { -10, 10 } };
+			// shifts of a rotated and scaled image with a constant error, e.g. caused by the hysteresis of the stage
+			auto shifts = std::vector<POINT2>{};
+			for (const auto& translation : translations) {
+				shifts.push_back({ 4 * translation.x - 3 * translation.y + 0.5, 3 * translation.x + 4 * translation.y - 0.5 });
+			}
+
+			ScaleCalibrationHelper::initializeCalibrationFromShifts(&scaleCalibration, translations, shifts);
+
+			// the error cancels out for opposite translations
+			Assert::AreEqual(-4.0, scaleCalibration.micrometerToPixX.x, 1e-10);
+			Assert::AreEqual(3.0, scaleCalibration.micrometerToPixX.y, 1e-10);
+
+			Assert::AreEqual(3.0, scaleCalibration.micrometerToPixY.x, 1e-10);
+			Assert::AreEqual(4.0, scaleCalibration.micrometerToPixY.y, 1e-10);
+
+			checkIntegrity(&scaleCalibration);
+		}
+
+		TEST_METHOD(initializeFromShifts_Collinear) {
+			auto scaleCalibration = ScaleCalibrationData{};
+
+			auto translations = std::vector<POINT2>{ { 10, 0 }, { -10, 0 } };
+			auto shifts = std::vector<POINT2>{ { 100, 0 }, { -100, 0 } };
+
+			auto initialize = [&scaleCalibration, &translations, &shifts]() {
+				ScaleCalibrationHelper::initializeCalibrationFromShifts(&scaleCalibration, translations, shifts);
+			};
+			Assert::ExpectException<std::exception>(initialize);
+		}
+
 	private:
 		void checkIntegrity(ScaleCalibrationData* scaleCalibration) {
 
@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/accumulator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestAccumulator) {
+		public:
+			TEST_METHOD(TestAccumulatorSum) {
+				auto acc = accumulator<unsigned int>{};
+				acc.reset(3);
+
+				std::vector<unsigned short> frame1{ 1, 2, 65535 };
+				std::vector<unsigned short> frame2{ 3, 4, 65535 };
+				acc.add(&frame1[0]);
+				acc.add(&frame2[0]);
+
+				std::vector<unsigned int> expected{ 4, 6, 131070 };
+
+				Assert::AreEqual(2, acc.count());
+				Assert::IsTrue(expected == acc.sum());
+			}
+
+			TEST_METHOD(TestAccumulatorVariance) {
+				auto acc = accumulator<unsigned int>{};
+				acc.reset(2, true);
+
+				std::vector<unsigned char> frame1{ 2, 10 };
+				std::vector<unsigned char> frame2{ 4, 10 };
+				std::vector<unsigned char> frame3{ 6, 10 };
+				acc.add(&frame1[0]);
+				acc.add(&frame2[0]);
+				acc.add(&frame3[0]);
+
+				auto variance = acc.variance();
+
+				Assert::AreEqual(4.0, (double)variance[0], 1e-6);
+				Assert::AreEqual(0.0, (double)variance[1], 1e-6);
+			}
+
+			TEST_METHOD(TestAccumulatorReset) {
+				auto acc = accumulator<unsigned int>{};
+				acc.reset(2);
+
+				std::vector<unsigned char> frame{ 7, 8 };
+				acc.add(&frame[0]);
+				acc.reset(2);
+
+				std::vector<unsigned int> expected{ 0, 0 };
+
+				Assert::AreEqual(0, acc.count());
+				Assert::IsTrue(expected == acc.sum());
+			}
+	};
+}
@@ -0,0 +1,87 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/adaptiveScan.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestAdaptiveScan) {
+		public:
+			TEST_METHOD(TestHomogeneousSample) {
+				auto scan = adaptiveScan({ 17, 17, 1 }, 4, 0.5, 289);
+
+				auto grid = INDEX3{};
+				auto count{ 0 };
+				while (scan.next(grid)) {
+					scan.setValue(1.0);
+					count++;
+				}
+
+				// only the coarse grid is measured
+				Assert::AreEqual(25, count);
+			}
+
+			TEST_METHOD(TestRefinesEdge) {
+				auto scan = adaptiveScan({ 17, 17, 1 }, 4, 0.5, 289);
+
+				// step along x at 7.5
+				auto grid = INDEX3{};
+				while (scan.next(grid)) {
+					scan.setValue(grid.x > 7 ? 1.0 : 0.0);
+				}
+				auto& points = scan.points();
+
+				// both neighbours of the edge are measured in every row
+				auto rows{ 0 };
+				for (int y{ 0 }; y < 17; y++) {
+					auto left = std::find_if(points.begin(), points.end(),
+						[y](const ADAPTIVE_POINT& point) { return point.grid.x == 7 && point.grid.y == y; });
+					auto right = std::find_if(points.begin(), points.end(),
+						[y](const ADAPTIVE_POINT& point) { return point.grid.x == 8 && point.grid.y == y; });
+					rows += (left != points.end() && right != points.end());
+				}
+				Assert::AreEqual(17, rows);
+				Assert::IsTrue(points.size() < 289);
+				Assert::IsTrue(points.back().level > 0);
+				Assert::IsTrue(points.back().parent >= 0);
+			}
+
+			TEST_METHOD(TestBudget) {
+				auto scan = adaptiveScan({ 33, 33, 1 }, 8, 0.5, 40);
+
+				auto grid = INDEX3{};
+				auto count{ 0 };
+				while (scan.next(grid)) {
+					scan.setValue((double)grid.x * grid.y);
+					count++;
+				}
+
+				Assert::IsTrue(count <= 40);
+				Assert::IsTrue(count > 25);
+			}
+
+			TEST_METHOD(TestLine) {
+				auto scan = adaptiveScan({ 9, 1, 1 }, 4, 0.5, 9);
+
+				auto grid = INDEX3{};
+				auto count{ 0 };
+				while (scan.next(grid)) {
+					scan.setValue(grid.x > 4 ? 1.0 : 0.0);
+					count++;
+				}
+
+				// 0, 4, 8 coarse, then 6 and 5
+				Assert::AreEqual(5, count);
+			}
+
+			TEST_METHOD(TestCentroid) {
+				std::vector<unsigned short> frames{
+					1, 1, 5, 1,
+					1, 1, 5, 1,
+				};
+
+				Assert::AreEqual(2.0, adaptiveScan::centroid(&frames[0], 4, 2, 1), 1e-9);
+			}
+	};
+}
@@ -0,0 +1,34 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "CppUnitTest.h"
+
+#include <chrono>
+#include <string>
+
+namespace BrillouinAcquisitionUnitTest {
+
+	/*
+	 * Calls the function repeatedly for at least the given duration [s] and logs the mean duration of a call.
+	 * The durations depend on the build configuration and the load of the machine, so the benchmarks only report them
+	 * and do not assert them. Returns the mean duration [ms] of a call.
+	 */
+	template <typename F>
+	double benchmark(const std::string& name, F&& function, double duration = 0.5) {
+		auto calls{ 0 };
+		auto start = std::chrono::steady_clock::now();
+		auto elapsed = std::chrono::duration<double>(0);
+		while (elapsed.count() < duration) {
+			function();
+			calls++;
+			elapsed = std::chrono::steady_clock::now() - start;
+		}
+		auto mean = 1e3 * elapsed.count() / calls;
+
+		auto message = name + ": " + std::to_string(mean) + " ms\n";
+		Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(message.c_str());
+		return mean;
+	}
+}
+
+#endif // BENCHMARK_H
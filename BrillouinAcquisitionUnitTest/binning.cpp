@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/binning.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestBinning) {
+		public:
+			TEST_METHOD(TestBinningFactor) {
+				Assert::AreEqual(1, binning::factor(L"1x1"));
+				Assert::AreEqual(2, binning::factor(L"2x2"));
+				Assert::AreEqual(3, binning::factor(L"3x3"));
+				Assert::AreEqual(4, binning::factor(L"4x4"));
+				Assert::AreEqual(8, binning::factor(L"8x8"));
+				Assert::AreEqual(1, binning::factor(L"5x5"));
+			}
+
+			TEST_METHOD(TestBinning2x2Mean) {
+				int dim_x{ 4 };
+				int dim_y{ 4 };
+				std::vector<unsigned char> input(dim_x * dim_y, 0);
+				for (int i{ 0 }; i < dim_x * dim_y; i++) {
+					input[i] = i + 1;
+				}
+
+				std::vector<unsigned char> expected{ 4, 6, 12, 14 };
+
+				std::vector<unsigned char> output(4, 0);
+				binning::bin(&input[0], &output[0], dim_x, dim_y, 2, BINNING_MODE::MEAN);
+
+				Assert::IsTrue(expected == output);
+			}
+
+			TEST_METHOD(TestBinning2x2Sum) {
+				int dim_x{ 4 };
+				int dim_y{ 4 };
+				std::vector<unsigned short> input(dim_x * dim_y, 0);
+				for (int i{ 0 }; i < dim_x * dim_y; i++) {
+					input[i] = i + 1;
+				}
+
+				std::vector<unsigned short> expected{ 14, 22, 46, 54 };
+
+				std::vector<unsigned short> output(4, 0);
+				binning::bin(&input[0], &output[0], dim_x, dim_y, 2, BINNING_MODE::SUM);
+
+				Assert::IsTrue(expected == output);
+			}
+
+			TEST_METHOD(TestBinningSumSaturates) {
+				int dim_x{ 8 };
+				int dim_y{ 8 };
+				std::vector<unsigned char> input(dim_x * dim_y, 200);
+
+				std::vector<unsigned char> expected{ 255 };
+
+				std::vector<unsigned char> output(1, 0);
+				binning::bin(&input[0], &output[0], dim_x, dim_y, 8, BINNING_MODE::SUM);
+
+				Assert::IsTrue(expected == output);
+			}
+
+			TEST_METHOD(TestBinning3x3CropsBorder) {
+				// A 7x5 image only fills 2x1 complete bins, the remaining pixels are cropped
+				int dim_x{ 7 };
+				int dim_y{ 5 };
+				std::vector<unsigned short> input(dim_x * dim_y, 0);
+				for (int i{ 0 }; i < dim_x * dim_y; i++) {
+					input[i] = i;
+				}
+
+				std::vector<unsigned short> expected{ 8, 11 };
+
+				std::vector<unsigned short> output(2, 0);
+				binning::bin(&input[0], &output[0], dim_x, dim_y, 3, BINNING_MODE::MEAN);
+
+				Assert::IsTrue(expected == output);
+			}
+
+			TEST_METHOD(TestBinning4x4Mean) {
+				int dim_x{ 640 };
+				int dim_y{ 512 };
+				std::vector<unsigned short> input(dim_x * dim_y, 1000);
+
+				std::vector<unsigned short> expected(160 * 128, 1000);
+
+				std::vector<unsigned short> output(160 * 128, 0);
+				binning::bin(&input[0], &output[0], dim_x, dim_y, 4, BINNING_MODE::MEAN);
+
+				Assert::IsTrue(expected == output);
+			}
+
+			TEST_METHOD(TestCrop) {
+				int dim_x{ 4 };
+				int dim_y{ 4 };
+				std::vector<unsigned char> input(dim_x * dim_y, 0);
+				for (int i{ 0 }; i < dim_x * dim_y; i++) {
+					input[i] = i;
+				}
+
+				std::vector<unsigned char> expected{ 5, 6, 9, 10, 13, 14 };
+
+				std::vector<unsigned char> output(6, 0);
+				binning::crop(&input[0], &output[0], dim_x, 1, 1, 2, 3);
+
+				Assert::IsTrue(expected == output);
+			}
+	};
+}
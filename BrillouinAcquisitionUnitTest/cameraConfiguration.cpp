@@ -0,0 +1,48 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/Devices/Cameras/MockCamera.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestCameraConfiguration) {
+		public:
+			TEST_METHOD(TestSwitchExposureTime) {
+				MockCamera camera;
+				camera.connectDevice();
+				auto settings = camera.getSettings();
+				camera.setSettings(settings);
+
+				auto calibration = settings;
+				calibration.exposureTime = 2 * settings.exposureTime;
+				camera.armConfiguration("calibration", calibration);
+
+				Assert::IsTrue(camera.switchConfiguration("calibration"));
+				Assert::AreEqual(calibration.exposureTime, camera.getSettings().exposureTime);
+				Assert::AreEqual(1, camera.getReconfigurations().partial);
+			}
+
+			TEST_METHOD(TestSwitchRequiresReconfiguration) {
+				MockCamera camera;
+				camera.connectDevice();
+				auto settings = camera.getSettings();
+				camera.setSettings(settings);
+
+				// the region of interest cannot be changed while the acquisition is running
+				auto cropped = settings;
+				cropped.roi.width_physical = settings.roi.width_physical / 2;
+				camera.armConfiguration("cropped", cropped);
+
+				Assert::IsFalse(camera.switchConfiguration("cropped"));
+				Assert::AreEqual(settings.roi.width_physical, camera.getSettings().roi.width_physical);
+			}
+
+			TEST_METHOD(TestSwitchUnknownConfiguration) {
+				MockCamera camera;
+				camera.connectDevice();
+
+				Assert::IsFalse(camera.switchConfiguration("unknown"));
+			}
+	};
+}
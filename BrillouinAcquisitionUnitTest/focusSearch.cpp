@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/focusSearch.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestFocusSearch) {
+		public:
+			TEST_METHOD(TestFindsFocus) {
+				for (auto focus : { -7.3, -0.4, 0.0, 2.6, 8.1 }) {
+					auto result = focusSearch::maximize([focus](double z) { return curve(z, focus); }, 0.0);
+
+					Assert::IsTrue(result.valid);
+					Assert::IsFalse(result.atBorder);
+					Assert::AreEqual(focus, result.z, 0.25);
+				}
+			}
+
+			TEST_METHOD(TestNumberOfEvaluations) {
+				auto settings = FOCUS_SEARCH_SETTINGS{ 20, 9, 0.25 };
+				auto evaluations{ 0 };
+				auto result = focusSearch::maximize([&evaluations](double z) { evaluations++; return curve(z, 1.3); }, 0.0, settings);
+
+				Assert::AreEqual(evaluations, result.evaluations);
+				// the bracket of 5 µm shrinks by 1.618 every step until it is below 0.25 µm
+				Assert::IsTrue(result.evaluations <= 9 + 8);
+			}
+
+			TEST_METHOD(TestSweepStartsAtLowestPosition) {
+				auto positions = std::vector<double>{};
+				focusSearch::maximize([&positions](double z) { positions.push_back(z); return curve(z, 0.0); }, 50.0);
+
+				Assert::AreEqual(40.0, positions[0], 1e-9);
+				for (gsl::index i{ 1 }; i < 9; i++) {
+					Assert::IsTrue(positions[i] > positions[i - 1]);
+				}
+				Assert::AreEqual(60.0, positions[8], 1e-9);
+			}
+
+			TEST_METHOD(TestFocusOutsideOfRange) {
+				auto result = focusSearch::maximize([](double z) { return curve(z, 25.0); }, 0.0);
+
+				Assert::IsTrue(result.atBorder);
+				Assert::AreEqual(10.0, result.z, 0.25);
+			}
+
+			TEST_METHOD(TestNoStructure) {
+				auto result = focusSearch::maximize([](double z) { return 1.0 + 1e-3 * sin(z); }, 0.0);
+
+				Assert::IsFalse(result.valid);
+			}
+
+			TEST_METHOD(TestAbort) {
+				auto evaluations{ 0 };
+				auto result = focusSearch::maximize([&evaluations](double z) {
+					return ++evaluations > 3 ? NAN : curve(z, 0.0);
+				}, 0.0);
+
+				Assert::IsFalse(result.valid);
+				Assert::AreEqual(4, result.evaluations);
+			}
+
+		private:
+			// a sharpness curve with a narrow peak on a background
+			static double curve(double z, double focus) {
+				return 1.0 + 4.0 / (1 + pow((z - focus) / 2.0, 2));
+			}
+	};
+}
@@ -0,0 +1,68 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/jobOrder.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestJobOrder) {
+		public:
+			TEST_METHOD(TestPositionTour) {
+				auto positions = std::vector<POINT3>{ { 300, 0, 0 }, { 100, 0, 0 }, { 200, 0, 0 } };
+				auto tour = jobOrder::positionTour(positions, POINT3{ 0, 0, 0 });
+
+				auto expected = std::vector<gsl::index>{ 1, 2, 0 };
+				Assert::AreEqual(expected.size(), tour.size());
+				for (gsl::index i{ 0 }; i < (gsl::index)expected.size(); i++) {
+					Assert::AreEqual(expected[i], tour[i]);
+				}
+			}
+
+			TEST_METHOD(TestSlowPresetsGroupTasks) {
+				auto positions = std::vector<POINT3>{ { 100, 0, 0 }, { 200, 0, 0 }, { 300, 0, 0 } };
+				// switching presets takes much longer than moving the stage
+				auto costs = JOB_ORDER_COSTS{ 10, 1000 };
+				auto jobs = jobOrder::plan(positions, POINT3{ 0, 0, 0 }, 2, costs);
+
+				Assert::AreEqual((size_t)6, jobs.size());
+				auto switches{ 0 };
+				for (gsl::index i{ 1 }; i < (gsl::index)jobs.size(); i++) {
+					switches += jobs[i].task != jobs[i - 1].task;
+				}
+				Assert::AreEqual(1, switches);
+				// the second task visits the positions backwards
+				Assert::AreEqual((gsl::index)2, jobs[2].position);
+				Assert::AreEqual((gsl::index)2, jobs[3].position);
+				Assert::AreEqual((gsl::index)0, jobs[5].position);
+			}
+
+			TEST_METHOD(TestLongTravelGroupsPositions) {
+				auto positions = std::vector<POINT3>{ { 10000, 0, 0 }, { 20000, 0, 0 } };
+				// moving the stage takes much longer than switching presets
+				auto costs = JOB_ORDER_COSTS{ 1, 100 };
+				auto jobs = jobOrder::plan(positions, POINT3{ 0, 0, 0 }, 3, costs);
+
+				Assert::AreEqual((size_t)6, jobs.size());
+				for (gsl::index i{ 0 }; i < 3; i++) {
+					Assert::AreEqual((gsl::index)0, jobs[i].position);
+					Assert::AreEqual((gsl::index)1, jobs[3 + i].position);
+				}
+				// the tasks alternate their order, so the preset is kept when the stage moves
+				Assert::AreEqual(jobs[2].task, jobs[3].task);
+			}
+
+			TEST_METHOD(TestDuration) {
+				auto positions = std::vector<POINT3>{ { 100, 0, 0 }, { 100, 200, 0 } };
+				auto jobs = std::vector<JOB>{ { 0, 0 }, { 1, 0 }, { 1, 1 } };
+				auto duration = jobOrder::duration(jobs, positions, POINT3{ 0, 0, 0 }, JOB_ORDER_COSTS{ 2, 100 });
+				// 300 µm of travel and a single preset switch
+				Assert::AreEqual(5.0, duration, 1e-12);
+			}
+
+			TEST_METHOD(TestNoPositions) {
+				auto jobs = jobOrder::plan({}, POINT3{ 0, 0, 0 }, 3);
+				Assert::IsTrue(jobs.empty());
+			}
+	};
+}
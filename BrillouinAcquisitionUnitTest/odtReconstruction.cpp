@@ -0,0 +1,100 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/Acquisition/ODTReconstruction.h"
+#include "benchmark.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestODTReconstruction) {
+		public:
+			TEST_CLASS_INITIALIZE(Initialize) {
+				fftw_init_threads();
+			}
+
+			TEST_METHOD(TestEmptyMedium) {
+				auto voltages = getVoltages(20);
+				auto stack = getStack(voltages, 64);
+				auto reconstruction = ODTReconstruction(2);
+
+				auto volume = reconstruction.reconstruct(stack, voltages);
+
+				Assert::AreEqual(16, volume.dim);
+				Assert::AreEqual(20, volume.angles);
+				Assert::IsTrue(volume.calibrated);
+				auto mediumIndex = reconstruction.getSettings().mediumIndex;
+				for (auto index : volume.index) {
+					Assert::AreEqual(mediumIndex, (double)index, 1e-4);
+				}
+			}
+
+			TEST_METHOD(TestRepeatedReconstruction) {
+				auto voltages = getVoltages(20);
+				auto stack = getStack(voltages, 64);
+				// a weak phase object in the center, so that the volume is not constant
+				for (gsl::index angle{ 0 }; angle < stack.angles; angle++) {
+					for (gsl::index y{ 28 }; y < 36; y++) {
+						for (gsl::index x{ 28 }; x < 36; x++) {
+							stack.phase[(angle * 64 + y) * 64 + x] += 0.2f;
+						}
+					}
+				}
+				auto reconstruction = ODTReconstruction(2);
+
+				// the spectrum is released after every reconstruction and has to be recreated for the next one
+				auto first = reconstruction.reconstruct(stack, voltages);
+				auto second = reconstruction.reconstruct(stack, voltages);
+
+				Assert::AreEqual(first.index.size(), second.index.size());
+				for (gsl::index i{ 0 }; i < (gsl::index)first.index.size(); i++) {
+					Assert::AreEqual(first.index[i], second.index[i], 1e-6f);
+				}
+			}
+
+			/*
+			 * A full acquisition of 150 angles at 1024 x 1024 pixels, reconstructed into a volume of 256^3 voxels
+			 */
+			TEST_METHOD(BenchmarkFullAcquisition) {
+				auto voltages = getVoltages(150);
+				auto stack = getStack(voltages, 1024);
+				auto reconstruction = ODTReconstruction();
+
+				auto volume = ODT_VOLUME{};
+				benchmark("Reconstruction of 150 angles at 1024 x 1024 pixels with " + std::to_string(reconstruction.getThreadCount())
+					+ " threads", [&]() { volume = reconstruction.reconstruct(stack, voltages); }, 0);
+
+				Assert::AreEqual(256, volume.dim);
+				Assert::AreEqual(150, volume.angles);
+			}
+
+		private:
+			// mirror voltages on a spiral, so that the ramps can be fitted against them
+			static std::vector<VOLTAGE2> getVoltages(int angles) {
+				auto voltages = std::vector<VOLTAGE2>(angles);
+				for (gsl::index i{ 0 }; i < angles; i++) {
+					auto radius = 0.2 + 0.8 * i / angles;
+					voltages[i] = { radius * cos(0.5 * i), radius * sin(0.5 * i) };
+				}
+				return voltages;
+			}
+
+			// the phase ramps of an empty medium, the reference adds a constant tilt to all angles
+			static PHASE_STACK getStack(const std::vector<VOLTAGE2>& voltages, int dim) {
+				auto stack = PHASE_STACK{ (int)voltages.size(), dim, dim };
+				auto pixels = (gsl::index)dim * dim;
+				stack.phase.resize(stack.angles * pixels);
+				stack.logAmplitude.resize(stack.angles * pixels);
+				for (gsl::index angle{ 0 }; angle < stack.angles; angle++) {
+					auto ramp_x = 0.5 * voltages[angle].Ux + 0.05;
+					auto ramp_y = 0.5 * voltages[angle].Uy - 0.02;
+					for (gsl::index y{ 0 }; y < dim; y++) {
+						for (gsl::index x{ 0 }; x < dim; x++) {
+							stack.phase[angle * pixels + y * dim + x] = (float)(ramp_x * x + ramp_y * y);
+						}
+					}
+				}
+				return stack;
+			}
+	};
+}
@@ -189,4 +189,30 @@ namespace BrillouinAcquisitionUnitTest {
 			//	Assert::IsTrue(expected == output);
 			//}
 	};
+
+	TEST_CLASS(TestCarrier) {
+		public:
+			TEST_METHOD(TestCreateMask) {
+				auto mask = phase::createMask(8, 8, 2);
+				Assert::AreEqual(11, (int)std::count(mask.begin(), mask.end(), 1));
+				Assert::AreEqual(1, mask[4 + 8 * 4]);
+				Assert::AreEqual(0, mask[0]);
+			}
+
+			TEST_METHOD(TestFindCarrier) {
+				fftw_complex spectrum[16 * 16];
+				for (int jj{ 0 }; jj < 16 * 16; jj++) {
+					spectrum[jj][0] = 1;
+					spectrum[jj][1] = 0;
+				}
+				// carrier peak at x = 3, y = 4
+				spectrum[3 + 16 * 4][1] = 10;
+				int max_x{ 0 };
+				int max_y{ 0 };
+				phase::findCarrier(spectrum, 16, 16, max_x, max_y);
+				// shift of the peak relative to the center of the spectrum
+				Assert::AreEqual(-6, max_x);
+				Assert::AreEqual(-5, max_y);
+			}
+	};
 }
\ No newline at end of file
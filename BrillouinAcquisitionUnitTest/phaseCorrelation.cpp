@@ -0,0 +1,73 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/phaseCorrelation.h"
+#include "synthetic.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestPhaseCorrelation) {
+		public:
+			TEST_METHOD(TestIdenticalImages) {
+				auto reference = shiftedImage(0, 0);
+
+				auto correlation = phaseCorrelation();
+				correlation.setReference(&reference[0], DIM_X, DIM_Y);
+				auto estimate = correlation.shift(&reference[0]);
+
+				Assert::AreEqual(0.0, estimate.shift.x, 1e-6);
+				Assert::AreEqual(0.0, estimate.shift.y, 1e-6);
+				Assert::AreEqual(1.0, estimate.peak, 1e-3);
+			}
+
+			TEST_METHOD(TestIntegerShift) {
+				auto reference = shiftedImage(0, 0);
+				auto shifted = shiftedImage(7, -4);
+
+				auto correlation = phaseCorrelation();
+				correlation.setReference(&reference[0], DIM_X, DIM_Y);
+				auto estimate = correlation.shift(&shifted[0]);
+
+				Assert::AreEqual(7.0, estimate.shift.x, 0.05);
+				Assert::AreEqual(-4.0, estimate.shift.y, 0.05);
+			}
+
+			TEST_METHOD(TestSubPixelShift) {
+				auto reference = shiftedImage(0, 0);
+				auto correlation = phaseCorrelation();
+				correlation.setReference(&reference[0], DIM_X, DIM_Y);
+
+				auto shifts = std::vector<POINT2>{ { 0.3, -0.6 }, { -2.75, 1.5 }, { 21.4, 13.2 }, { -30.6, -17.9 } };
+				for (const auto& shift : shifts) {
+					auto shifted = shiftedImage(shift.x, shift.y);
+					auto estimate = correlation.shift(&shifted[0]);
+
+					Assert::AreEqual(shift.x, estimate.shift.x, 0.05);
+					Assert::AreEqual(shift.y, estimate.shift.y, 0.05);
+				}
+			}
+
+			TEST_METHOD(TestUnsignedChar) {
+				auto reference = shiftedImage<unsigned char>(0, 0);
+				auto shifted = shiftedImage<unsigned char>(-5.5, 3.25);
+
+				auto correlation = phaseCorrelation();
+				correlation.setReference(&reference[0], DIM_X, DIM_Y);
+				auto estimate = correlation.shift(&shifted[0]);
+
+				Assert::AreEqual(-5.5, estimate.shift.x, 0.1);
+				Assert::AreEqual(3.25, estimate.shift.y, 0.1);
+			}
+
+		private:
+			static constexpr int DIM_X{ 128 };
+			static constexpr int DIM_Y{ 96 };
+
+			// the same blobs in every image, moved by the given shift
+			template <typename T = unsigned short>
+			static std::vector<T> shiftedImage(double shift_x, double shift_y) {
+				return synthetic::blobs<T>(DIM_X, DIM_Y, 1.5, 20, 225, shift_x, shift_y);
+			}
+	};
+}
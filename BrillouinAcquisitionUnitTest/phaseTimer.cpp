@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/phaseTimer.h"
+
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestPhaseTimer) {
+		public:
+			TEST_METHOD(TestBins) {
+				Assert::AreEqual((gsl::index)0, phaseTimer::bin(0));
+				Assert::AreEqual((gsl::index)0, phaseTimer::bin(0.0005));
+				Assert::AreEqual((gsl::index)1, phaseTimer::bin(0.001));
+				Assert::AreEqual((gsl::index)2, phaseTimer::bin(0.003));
+				Assert::AreEqual((gsl::index)10, phaseTimer::bin(1));
+				Assert::AreEqual((gsl::index)phaseTimer::BIN_COUNT - 1, phaseTimer::bin(1e9));
+
+				// every duration lies inside the bin it is sorted into
+				auto edges = phaseTimer::binEdges();
+				for (auto duration : { 0.0015, 0.7, 12.0, 480.0 }) {
+					auto index = phaseTimer::bin(duration);
+					Assert::IsTrue(edges[index] <= duration);
+					Assert::IsTrue(duration < edges[index + 1]);
+				}
+			}
+
+			TEST_METHOD(TestRecord) {
+				auto timer = phaseTimer{};
+				timer.record("move", 10);
+				timer.record("frame", 2);
+				timer.record("move", 30);
+
+				auto statistics = timer.statistics();
+				Assert::AreEqual((size_t)2, statistics.size());
+				Assert::AreEqual(std::string{ "move" }, statistics[0].name);
+				Assert::AreEqual(2, statistics[0].count);
+				Assert::AreEqual(40.0, statistics[0].total, 1e-12);
+				Assert::AreEqual(20.0, statistics[0].mean(), 1e-12);
+				Assert::AreEqual(10.0, statistics[0].min, 1e-12);
+				Assert::AreEqual(30.0, statistics[0].max, 1e-12);
+				Assert::AreEqual(1, statistics[0].histogram[phaseTimer::bin(10)]);
+				Assert::AreEqual(1, statistics[0].histogram[phaseTimer::bin(30)]);
+
+				timer.reset();
+				Assert::IsTrue(timer.statistics().empty());
+			}
+
+			TEST_METHOD(TestScope) {
+				auto timer = phaseTimer{};
+				{
+					auto scope = timer.measure("settle");
+					std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				}
+				auto scope = timer.measure("stopped");
+				scope.stop();
+				scope.stop();
+
+				auto statistics = timer.statistics();
+				Assert::AreEqual((size_t)2, statistics.size());
+				Assert::IsTrue(statistics[0].total >= 20);
+				Assert::AreEqual(1, statistics[1].count);
+				Assert::IsTrue(timer.elapsed() >= statistics[0].total);
+			}
+
+			TEST_METHOD(TestPercentile) {
+				auto timer = phaseTimer{};
+				for (gsl::index i{ 0 }; i < 99; i++) {
+					timer.record("frame", 5);
+				}
+				// identical durations are reproduced exactly
+				auto statistics = timer.statistics()[0];
+				Assert::AreEqual(5.0, phaseTimer::percentile(statistics, 50), 1e-12);
+
+				timer.record("frame", 500);
+				statistics = timer.statistics()[0];
+				auto edges = phaseTimer::binEdges();
+				auto median = phaseTimer::percentile(statistics, 50);
+				Assert::IsTrue(median >= 5 && median < edges[phaseTimer::bin(5) + 1]);
+				Assert::AreEqual(500.0, phaseTimer::percentile(statistics, 100), 1e-12);
+				Assert::IsTrue(std::isnan(phaseTimer::percentile(PHASE_STATISTICS{}, 50)));
+			}
+
+			TEST_METHOD(TestMerge) {
+				auto first = phaseTimer{};
+				first.record("move", 10);
+				first.record("move", 30);
+				auto second = phaseTimer{};
+				second.record("move", 2);
+
+				auto merged = phaseTimer::merge(first.statistics()[0], second.statistics()[0]);
+				Assert::AreEqual(std::string{ "move" }, merged.name);
+				Assert::AreEqual(3, merged.count);
+				Assert::AreEqual(42.0, merged.total, 1e-12);
+				Assert::AreEqual(2.0, merged.min, 1e-12);
+				Assert::AreEqual(30.0, merged.max, 1e-12);
+				Assert::AreEqual(1, merged.histogram[phaseTimer::bin(2)]);
+				Assert::AreEqual(1, merged.histogram[phaseTimer::bin(30)]);
+
+				// a phase without recordings does not change the extrema
+				auto empty = PHASE_STATISTICS{};
+				empty.name = "move";
+				merged = phaseTimer::merge(empty, second.statistics()[0]);
+				Assert::AreEqual(1, merged.count);
+				Assert::AreEqual(2.0, merged.min, 1e-12);
+				Assert::AreEqual(2.0, merged.max, 1e-12);
+			}
+	};
+}
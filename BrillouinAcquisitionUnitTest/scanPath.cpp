@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/scanPath.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	/*
+	 * Checks that every grid position is visited exactly once.
+	 */
+	bool visitsAllOnce(const std::vector<INDEX3>& order, int nx, int ny, int nz) {
+		std::vector<int> visited((size_t)nx * ny * nz, 0);
+		for (auto& index : order) {
+			visited[((size_t)index.z * ny + index.y) * nx + index.x]++;
+		}
+		for (auto& count : visited) {
+			if (count != 1) {
+				return false;
+			}
+		}
+		return order.size() == visited.size();
+	}
+
+	/*
+	 * Checks that consecutive positions are direct neighbours.
+	 */
+	bool movesSingleSteps(const std::vector<INDEX3>& order) {
+		for (gsl::index i{ 1 }; i < (gsl::index)order.size(); i++) {
+			auto step = INDEX3{ order[i] } - order[i - 1];
+			if (std::abs(step.x) + std::abs(step.y) + std::abs(step.z) != 1) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TEST_CLASS(TestScanPath) {
+		public:
+			TEST_METHOD(TestRaster) {
+				auto order = scanPath::raster(3, 2, 1);
+
+				Assert::IsTrue(visitsAllOnce(order, 3, 2, 1));
+				Assert::AreEqual(0, order[3].x);
+				Assert::AreEqual(1, order[3].y);
+			}
+
+			TEST_METHOD(TestSerpentine) {
+				auto order = scanPath::serpentine(4, 3, 3);
+
+				Assert::IsTrue(visitsAllOnce(order, 4, 3, 3));
+				Assert::IsTrue(movesSingleSteps(order));
+			}
+
+			TEST_METHOD(TestHilbertSquare) {
+				auto order = scanPath::hilbert(8, 8, 2);
+
+				Assert::IsTrue(visitsAllOnce(order, 8, 8, 2));
+				Assert::IsTrue(movesSingleSteps(order));
+			}
+
+			TEST_METHOD(TestHilbertRectangle) {
+				auto order = scanPath::hilbert(10, 4, 1);
+
+				Assert::IsTrue(visitsAllOnce(order, 10, 4, 1));
+				Assert::IsTrue(movesSingleSteps(order));
+
+				order = scanPath::hilbert(5, 7, 1);
+				Assert::IsTrue(visitsAllOnce(order, 5, 7, 1));
+			}
+
+			TEST_METHOD(TestNearestNeighbour) {
+				std::vector<POINT3> positions{ { 0, 0, 0 }, { 10, 0, 0 }, { 1, 0, 0 }, { 5, 0, 0 } };
+
+				auto order = scanPath::nearestNeighbour(positions);
+
+				std::vector<gsl::index> expected{ 0, 2, 3, 1 };
+				Assert::IsTrue(expected == order);
+			}
+
+			TEST_METHOD(TestTravel) {
+				std::vector<POINT3> raster;
+				std::vector<POINT3> serpentine;
+				for (auto& index : scanPath::raster(10, 10, 1)) {
+					raster.push_back(POINT3{ (double)index.x, (double)index.y, 0 });
+				}
+				for (auto& index : scanPath::serpentine(10, 10, 1)) {
+					serpentine.push_back(POINT3{ (double)index.x, (double)index.y, 0 });
+				}
+
+				Assert::AreEqual(99.0, scanPath::travel(serpentine), 1e-9);
+				Assert::IsTrue(scanPath::travel(serpentine) < scanPath::travel(raster));
+			}
+	};
+}
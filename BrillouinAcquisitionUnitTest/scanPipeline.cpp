@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "MockScanControl.h"
+#include "../BrillouinAcquisition/src/Devices/Cameras/MockCamera.h"
+#include "../BrillouinAcquisition/src/lib/math/spectrum.h"
+
+#include <chrono>
+#include <future>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestScanPipeline) {
+		public:
+			TEST_METHOD(TestMoveWaitsForStage) {
+				MockScanControl stage(1.0, 5.0);
+
+				auto start = std::chrono::steady_clock::now();
+				Assert::IsTrue(stage.moveTo(POINT3{ 10, 0, 0 }, 500));
+				auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+				// 5 ms to settle and 10 ms to travel
+				Assert::IsTrue(elapsed >= 15);
+				Assert::AreEqual(10.0, stage.getPosition().x, 0.5);
+			}
+
+			TEST_METHOD(TestMoveTimeout) {
+				MockScanControl stage(0.1, 5.0);
+
+				Assert::IsFalse(stage.moveTo(POINT3{ 100, 0, 0 }, 50));
+			}
+
+			TEST_METHOD(TestMoveWithoutReadback) {
+				MockScanControl stage(0.1, 5.0, false);
+
+				// the commanded position is all we know, so there is nothing to wait for
+				auto start = std::chrono::steady_clock::now();
+				Assert::IsTrue(stage.moveTo(POINT3{ 100, 0, 0 }, 500));
+				auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				Assert::IsTrue(elapsed < 500);
+			}
+
+			TEST_METHOD(TestPresetWaitsForMovedElements) {
+				MockScanControl stage(1.0, 5.0);
+
+				// the shutter and the filter move, the filter needs 80 ms to settle
+				auto start = std::chrono::steady_clock::now();
+				stage.setPreset(ScanPreset::SCAN_BRIGHTFIELD);
+				Assert::IsTrue(stage.waitForPreset(ScanPreset::SCAN_BRIGHTFIELD, 500));
+				auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+				Assert::IsTrue(elapsed >= 80);
+				Assert::IsTrue(elapsed < 500);
+			}
+
+			TEST_METHOD(TestActivePresetDoesNotWait) {
+				MockScanControl stage(1.0, 5.0);
+
+				// the Brillouin preset is already active, so no element moves
+				auto start = std::chrono::steady_clock::now();
+				stage.setPreset(ScanPreset::SCAN_BRILLOUIN);
+				Assert::IsTrue(stage.waitForPreset(ScanPreset::SCAN_BRILLOUIN, 500));
+				auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+				Assert::IsTrue(elapsed < 20);
+			}
+
+			TEST_METHOD(BenchmarkPresetSettle) {
+				MockScanControl stage(1.0, 5.0);
+
+				// the presets of a Brillouin scan with two calibrations, followed by a brightfield image
+				auto presets = std::vector<ScanPreset>{
+					ScanPreset::SCAN_BRILLOUIN,
+					ScanPreset::SCAN_CALIBRATION,
+					ScanPreset::SCAN_BRILLOUIN,
+					ScanPreset::SCAN_CALIBRATION,
+					ScanPreset::SCAN_BRILLOUIN,
+					ScanPreset::SCAN_BRIGHTFIELD
+				};
+				auto fixed{ 500.0 };
+				auto start = std::chrono::steady_clock::now();
+				for (auto preset : presets) {
+					stage.setPreset(preset);
+					Assert::IsTrue(stage.waitForPreset(preset, (int)fixed));
+				}
+				auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+				auto message = "Settling after " + std::to_string(presets.size()) + " preset switches: " + std::to_string(elapsed)
+					+ " ms instead of " + std::to_string(fixed * presets.size()) + " ms with the fixed settle time\n";
+				Logger::WriteMessage(message.c_str());
+			}
+
+			TEST_METHOD(BenchmarkPointsPerSecond) {
+				// two frames of 400 x 100 pixels per position and a stage which needs 5 ms plus 1 ms/µm for a move
+				MockCamera camera;
+				camera.connectDevice();
+				auto settings = camera.getSettings();
+				settings.roi.left = 1;
+				settings.roi.top = 1;
+				settings.roi.width_physical = 400;
+				settings.roi.height_physical = 100;
+				settings.roi.binning = L"1x1";
+				settings.readout.pixelEncoding = L"16 bit";
+				settings.readout.dataType = "unsigned short";
+				settings.exposureTime = 0.005;
+				settings.frameCount = 2;
+				camera.startAcquisition(settings);
+				settings = camera.getSettings();
+
+				MockScanControl stage(1.0, 5.0);
+				auto sequential = pointsPerSecond(camera, stage, settings, false);
+				auto pipelined = pointsPerSecond(camera, stage, settings, true);
+				camera.stopAcquisition();
+
+				auto message = "Brillouin scan with mock devices: " + std::to_string(sequential) + " points/s sequential, "
+					+ std::to_string(pipelined) + " points/s with the hand-off during the stage move\n";
+				Logger::WriteMessage(message.c_str());
+			}
+
+		private:
+			/*
+			 * Acquires a line of positions like Brillouin::acquire: the frames are captured, handed over and the stage
+			 * moves to the next position. The hand-off copies the frames for the storage queue and extracts their spectra.
+			 */
+			static double pointsPerSecond(MockCamera& camera, MockScanControl& stage, const CAMERA_SETTINGS& settings, bool pipelined) {
+				auto positions{ 40 };
+				auto bytesPerFrame = (size_t)settings.roi.bytesPerFrame;
+				auto frames = std::vector<std::byte>(bytesPerFrame * settings.frameCount);
+
+				auto width = settings.roi.width_binned;
+				auto height = settings.roi.height_binned;
+				auto line = SPECTRUM_LINE{ { POINT2{ 0, 0.5 * (height - 1) }, POINT2{ width - 1.0, 0.5 * (height - 1) } } };
+				auto extractor = spectrumExtractor(line, width, height);
+				auto samples = extractor.samples();
+				auto spectra = std::vector<float>((size_t)samples * settings.frameCount);
+				auto queue = std::vector<std::vector<std::byte>>{};
+				auto handOff = [&]() {
+					queue.push_back(frames);
+					for (gsl::index mm{ 0 }; mm < settings.frameCount; mm++) {
+						extractor.extractFrame((const unsigned short*)&frames[bytesPerFrame * mm], &spectra[mm * samples]);
+					}
+				};
+
+				Assert::IsTrue(stage.moveTo(POINT3{ 0, 0, 0 }, 1000));
+				auto start = std::chrono::steady_clock::now();
+				for (gsl::index i{ 0 }; i < positions; i++) {
+					for (gsl::index mm{ 0 }; mm < settings.frameCount; mm++) {
+						camera.getImageForAcquisition(&frames[bytesPerFrame * mm], false);
+					}
+					// steps of 2 µm
+					auto target = POINT3{ 2.0 * (i + 1), 0, 0 };
+					if (pipelined) {
+						auto handingOff = std::async(std::launch::async, handOff);
+						Assert::IsTrue(stage.moveTo(target, 1000));
+						handingOff.get();
+					} else {
+						handOff();
+						Assert::IsTrue(stage.moveTo(target, 1000));
+					}
+				}
+				auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+				return positions / elapsed.count();
+			}
+	};
+}
@@ -0,0 +1,75 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/scanPositions.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestScanPositions) {
+		public:
+			TEST_METHOD(TestRasterPositions) {
+				// scan in y-direction first, then in x-direction
+				auto positions = scanPositions({ 0, 10, 0 }, { 4, 20, 0 }, { 3, 2, 1 }, { 1, 0, 2 }, SCAN_PATH::RASTER);
+
+				Assert::AreEqual((gsl::index)6, positions.size());
+
+				auto position = positions.at(1);
+				Assert::AreEqual(0.0, position.position.x, 1e-9);
+				Assert::AreEqual(20.0, position.position.y, 1e-9);
+				Assert::AreEqual(0, position.index.x);
+				Assert::AreEqual(1, position.index.y);
+				Assert::IsFalse(position.calibrationAllowed);
+
+				position = positions.at(2);
+				Assert::AreEqual(2.0, position.position.x, 1e-9);
+				Assert::AreEqual(10.0, position.position.y, 1e-9);
+				Assert::IsTrue(position.calibrationAllowed);
+			}
+
+			TEST_METHOD(TestPathsMatchGrid) {
+				for (auto path : { SCAN_PATH::RASTER, SCAN_PATH::SERPENTINE, SCAN_PATH::HILBERT }) {
+					auto positions = scanPositions({ 0, 0, 0 }, { 4, 3, 1 }, { 5, 4, 2 }, { 0, 1, 2 }, path);
+					auto grid = scanPath::grid(path, 5, 4, 2);
+
+					for (gsl::index ll{ 0 }; ll < positions.size(); ll++) {
+						auto position = positions.at(ll);
+						Assert::AreEqual(grid[ll].x, position.index.x);
+						Assert::AreEqual(grid[ll].y, position.index.y);
+						Assert::AreEqual(grid[ll].z, position.index.z);
+					}
+				}
+			}
+
+			TEST_METHOD(TestStepInvertsPath) {
+				for (auto path : { SCAN_PATH::RASTER, SCAN_PATH::SERPENTINE, SCAN_PATH::HILBERT, SCAN_PATH::NEAREST_NEIGHBOUR }) {
+					// scan in z-direction first, so that the grid and the direction indices differ
+					auto positions = scanPositions({ 0, 0, 0 }, { 4, 3, 2 }, { 5, 4, 3 }, { 1, 2, 0 }, path);
+
+					for (gsl::index ll{ 0 }; ll < positions.size(); ll++) {
+						Assert::AreEqual(ll, positions.step(positions.at(ll).index));
+					}
+				}
+			}
+
+			TEST_METHOD(TestNearestNeighbourFallback) {
+				auto positions = scanPositions({ 0, 0, 0 }, { 1000, 1000, 0 }, { 1000, 1000, 1 }, { 0, 1, 2 }, SCAN_PATH::NEAREST_NEIGHBOUR);
+
+				Assert::IsTrue(SCAN_PATH::SERPENTINE == positions.path());
+				Assert::AreEqual((gsl::index)1000000, positions.size());
+			}
+
+			TEST_METHOD(TestPreview) {
+				auto positions = scanPositions({ 0, 0, 0 }, { 99999, 9, 0 }, { 100000, 10, 1 }, { 0, 1, 2 }, SCAN_PATH::RASTER);
+
+				auto preview = positions.preview(1000);
+
+				Assert::IsTrue(preview.size() <= 1000);
+				Assert::IsTrue(preview.size() > 500);
+				// the borders of the scanned area are included
+				Assert::AreEqual(0.0, preview.front().x, 1e-9);
+				Assert::AreEqual(99999.0, preview.back().x, 1e-9);
+				Assert::AreEqual(9.0, preview.back().y, 1e-9);
+			}
+	};
+}
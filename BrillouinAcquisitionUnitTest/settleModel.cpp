@@ -0,0 +1,65 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/settleModel.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestSettleModel) {
+		public:
+			TEST_METHOD(TestUntrained) {
+				auto model = settleModel{};
+				for (gsl::index i{ 0 }; i < settleModel::MIN_SAMPLES - 1; i++) {
+					model.add(100, 50);
+				}
+				Assert::IsFalse(model.isTrained());
+				Assert::AreEqual(0.0, model.predict(100), 1e-12);
+				Assert::AreEqual(0.0, model.earliestCompletion(100), 1e-12);
+			}
+
+			TEST_METHOD(TestLinearFit) {
+				auto model = settleModel{};
+				// 20 ms plus 0.5 ms per µm
+				for (auto distance : { 0.0, 10.0, 20.0, 40.0, 80.0, 160.0 }) {
+					model.add(distance, 20 + 0.5 * distance);
+				}
+				Assert::IsTrue(model.isTrained());
+				Assert::AreEqual(20.0, model.offset(), 1e-9);
+				Assert::AreEqual(0.5, model.slope(), 1e-9);
+				Assert::AreEqual(0.0, model.spread(), 1e-9);
+				Assert::AreEqual(70.0, model.predict(100), 1e-9);
+				Assert::AreEqual(70.0, model.earliestCompletion(100), 1e-9);
+			}
+
+			TEST_METHOD(TestSpread) {
+				auto model = settleModel{};
+				// identical distances only allow to learn the mean duration
+				for (auto duration : { 90.0, 110.0, 90.0, 110.0 }) {
+					model.add(5, duration);
+				}
+				model.add(std::nan(""), 1000);
+				Assert::IsFalse(model.isTrained());
+				model.add(5, 100);
+				Assert::AreEqual(0.0, model.slope(), 1e-12);
+				Assert::AreEqual(100.0, model.predict(50), 1e-9);
+				Assert::IsTrue(model.spread() > 0);
+				Assert::AreEqual(100.0 - 2 * model.spread(), model.earliestCompletion(50), 1e-9);
+
+				model.clear();
+				Assert::IsFalse(model.isTrained());
+			}
+
+			TEST_METHOD(TestCapacity) {
+				auto model = settleModel{ 5 };
+				for (gsl::index i{ 0 }; i < 5; i++) {
+					model.add((double)i, 500);
+				}
+				// the stage became faster, the old moves are forgotten
+				for (gsl::index i{ 0 }; i < 5; i++) {
+					model.add((double)i, 10);
+				}
+				Assert::AreEqual(10.0, model.predict(2), 1e-9);
+			}
+	};
+}
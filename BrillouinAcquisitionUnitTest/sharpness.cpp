@@ -0,0 +1,96 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/sharpness.h"
+#include "benchmark.h"
+#include "synthetic.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestSharpness) {
+		public:
+			TEST_METHOD(TestUniformImage) {
+				auto image = std::vector<unsigned short>(64 * 48, 1000);
+
+				Assert::AreEqual(0.0, sharpness::normalizedVariance(&image[0], 64, 48));
+				Assert::AreEqual(0.0, sharpness::tenengrad(&image[0], 64, 48));
+			}
+
+			TEST_METHOD(TestBlackImage) {
+				auto image = std::vector<unsigned char>(64 * 48, 0);
+
+				Assert::AreEqual(0.0, sharpness::normalizedVariance(&image[0], 64, 48));
+				Assert::AreEqual(0.0, sharpness::tenengrad(&image[0], 64, 48));
+			}
+
+			TEST_METHOD(TestNormalizedVariance) {
+				// half of the pixels at 100, half at 300: mean 200, variance 10000
+				auto image = std::vector<unsigned short>(64 * 48);
+				for (gsl::index i{ 0 }; i < (gsl::index)image.size(); i++) {
+					image[i] = (i % 2) ? 300 : 100;
+				}
+
+				Assert::AreEqual(50.0, sharpness::normalizedVariance(&image[0], 64, 48), 1e-9);
+			}
+
+			TEST_METHOD(TestTenengradRamp) {
+				// a ramp in x-direction has the constant Sobel gradient 8 * slope
+				auto image = std::vector<double>(32 * 16);
+				for (gsl::index y{ 0 }; y < 16; y++) {
+					for (gsl::index x{ 0 }; x < 32; x++) {
+						image[y * 32 + x] = 100.0 + 2.0 * x;
+					}
+				}
+				auto mean = 100.0 + 31.0;
+
+				Assert::AreEqual(16.0 * 16.0 / (mean * mean), sharpness::tenengrad(&image[0], 32, 16), 1e-12);
+			}
+
+			TEST_METHOD(TestFocusIsSharpest) {
+				// the sharpness decreases monotonically with the blur for both metrics
+				auto metrics = { SHARPNESS_METRIC::NORMALIZED_VARIANCE, SHARPNESS_METRIC::TENENGRAD };
+				for (auto metric : metrics) {
+					auto previous{ INFINITY };
+					for (auto blur : { 0.7, 1.5, 3.0, 6.0 }) {
+						auto image = blurredImage(128, 96, blur);
+						auto value = sharpness::evaluate(&image[0], 128, 96, metric);
+						Assert::IsTrue(value < previous);
+						previous = value;
+					}
+				}
+			}
+
+			TEST_METHOD(TestTenengradIndependentOfBrightness) {
+				auto image = blurredImage(128, 96, 1.5);
+				auto brighter = image;
+				for (auto& value : brighter) {
+					value *= 3;
+				}
+
+				auto reference = sharpness::tenengrad(&image[0], 128, 96);
+				Assert::AreEqual(reference, sharpness::tenengrad(&brighter[0], 128, 96), 1e-9 * reference);
+			}
+
+			TEST_METHOD(BenchmarkTenengrad) {
+				// a full frame of the brightfield camera
+				int dim_x{ 1280 };
+				int dim_y{ 1024 };
+				auto image = blurredImage(dim_x, dim_y, 1.5);
+
+				auto value{ 0.0 };
+				benchmark("Tenengrad of a " + std::to_string(dim_x) + " x " + std::to_string(dim_y) + " image", [&]() {
+					value += sharpness::tenengrad(&image[0], dim_x, dim_y);
+				});
+
+				Assert::IsTrue(value > 0);
+			}
+
+
+		private:
+			// the same blobs in every image, blurred by the given width
+			static std::vector<unsigned short> blurredImage(int dim_x, int dim_y, double blur) {
+				return synthetic::blobs(dim_x, dim_y, blur, 500, 2000);
+			}
+	};
+}
@@ -0,0 +1,277 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/spectrum.h"
+#include "../BrillouinAcquisition/src/lib/math/lorentzian.h"
+#include "../BrillouinAcquisition/src/Acquisition/SpectrumAnalysis.h"
+#include "benchmark.h"
+#include "synthetic.h"
+
+#include <chrono>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestSpectrum) {
+		public:
+			TEST_METHOD(TestExtractHorizontalLine) {
+				// every pixel holds its column index
+				auto width{ 20 };
+				auto height{ 10 };
+				auto frame = std::vector<unsigned short>((size_t)width * height);
+				for (int y{ 0 }; y < height; y++) {
+					for (int x{ 0 }; x < width; x++) {
+						frame[y * width + x] = x;
+					}
+				}
+
+				auto line = SPECTRUM_LINE{ { { 2, 5 }, { 12, 5 } }, 0, 2 };
+				auto extractor = spectrumExtractor(line, width, height);
+				Assert::AreEqual(11, extractor.samples());
+
+				auto spectrum = std::vector<double>(extractor.samples());
+				extractor.extract(&frame[0], 1, (gsl::index)width * height, &spectrum[0]);
+				for (gsl::index i{ 0 }; i < (gsl::index)spectrum.size(); i++) {
+					Assert::AreEqual(2.0 + i, spectrum[i], 1e-9);
+				}
+			}
+
+			TEST_METHOD(TestExtractInterpolates) {
+				// the intensity increases along the diagonal
+				auto width{ 16 };
+				auto height{ 16 };
+				auto frame = std::vector<double>((size_t)width * height);
+				for (int y{ 0 }; y < height; y++) {
+					for (int x{ 0 }; x < width; x++) {
+						frame[y * width + x] = x + y;
+					}
+				}
+
+				auto line = SPECTRUM_LINE{ { { 1, 1 }, { 11, 11 } }, 21, 0 };
+				auto extractor = spectrumExtractor(line, width, height);
+
+				auto spectrum = std::vector<double>(extractor.samples());
+				extractor.extract(&frame[0], 1, (gsl::index)width * height, &spectrum[0]);
+				// samples are half a pixel apart in x and y
+				for (gsl::index i{ 0 }; i < (gsl::index)spectrum.size(); i++) {
+					Assert::AreEqual(2.0 + i, spectrum[i], 1e-9);
+				}
+			}
+
+			TEST_METHOD(TestExtractAveragesFrames) {
+				auto width{ 8 };
+				auto height{ 4 };
+				auto pixels = (gsl::index)width * height;
+				auto frames = std::vector<unsigned char>(2 * pixels);
+				for (gsl::index i{ 0 }; i < pixels; i++) {
+					frames[i] = 10;
+					frames[pixels + i] = 30;
+				}
+
+				// the line leaves the frame on the right, these samples are skipped
+				auto line = SPECTRUM_LINE{ { { 0, 2 }, { 9, 2 } }, 0, 1 };
+				auto extractor = spectrumExtractor(line, width, height);
+
+				auto spectrum = std::vector<double>(extractor.samples());
+				extractor.extract(&frames[0], 2, pixels, &spectrum[0]);
+				for (gsl::index i{ 0 }; i < width; i++) {
+					Assert::AreEqual(20.0, spectrum[i], 1e-9);
+				}
+				Assert::AreEqual(0.0, spectrum[9], 1e-9);
+			}
+
+			TEST_METHOD(TestExtractPolyline) {
+				// every pixel holds the sum of its coordinates
+				auto width{ 16 };
+				auto height{ 16 };
+				auto frame = std::vector<unsigned short>((size_t)width * height);
+				for (int y{ 0 }; y < height; y++) {
+					for (int x{ 0 }; x < width; x++) {
+						frame[y * width + x] = x + y;
+					}
+				}
+
+				// right along y = 3, then down along x = 10
+				auto line = SPECTRUM_LINE{ { { 2, 3 }, { 10, 3 }, { 10, 15 } }, 0, 1 };
+				auto extractor = spectrumExtractor(line, width, height);
+				Assert::AreEqual(21, extractor.samples());
+
+				auto spectrum = std::vector<float>(extractor.samples());
+				extractor.extractFrame(&frame[0], &spectrum[0]);
+				auto& positions = extractor.positions();
+				for (gsl::index i{ 0 }; i < (gsl::index)spectrum.size(); i++) {
+					// the sample positions follow the polyline
+					auto expected = (i <= 8) ? POINT2{ 2.0 + i, 3 } : POINT2{ 10, 3.0 + i - 8 };
+					Assert::AreEqual(expected.x, positions[i].x, 1e-9);
+					Assert::AreEqual(expected.y, positions[i].y, 1e-9);
+					// the parallel lines average out on both sides of a linear gradient, except at the corner
+					if (i != 8) {
+						Assert::AreEqual(expected.x + expected.y, (double)spectrum[i], 1e-4);
+					}
+				}
+			}
+
+			TEST_METHOD(TestExtractLastPixel) {
+				// samples on the last row and column use the last pixel
+				auto width{ 4 };
+				auto height{ 3 };
+				auto frame = std::vector<unsigned char>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+				auto line = SPECTRUM_LINE{ { { 0, 2 }, { 3, 2 } }, 0, 0 };
+				auto extractor = spectrumExtractor(line, width, height);
+
+				auto spectrum = std::vector<double>(extractor.samples());
+				extractor.extractFrame(&frame[0], &spectrum[0]);
+				Assert::AreEqual(9.0, spectrum[0], 1e-9);
+				Assert::AreEqual(12.0, spectrum[3], 1e-9);
+			}
+
+			TEST_METHOD(TestPolylineString) {
+				auto points = std::vector<POINT2>{ { 1.5, 2 }, { 10, 20.25 } };
+				auto string = spectrumExtractor::toString(points);
+				Assert::AreEqual(std::string{ "1.5, 2; 10, 20.25" }, string);
+
+				auto parsed = spectrumExtractor::fromString(string);
+				Assert::AreEqual((size_t)2, parsed.size());
+				Assert::AreEqual(20.25, parsed[1].y, 1e-12);
+
+				// invalid vertices are skipped
+				Assert::AreEqual((size_t)1, spectrumExtractor::fromString("3, 4; a, b; 5").size());
+			}
+	};
+
+	TEST_CLASS(TestLorentzian) {
+		public:
+			TEST_METHOD(TestFitTwoPeaks) {
+				auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ 32.3, 4.2, 800 }, LORENTZIAN_PEAK{ 71.8, 5.1, 650 } };
+				auto spectrum = synthetic::spectrum(100, 120, peaks, 0);
+
+				auto fitter = lorentzian();
+				auto fit = fitter.fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsTrue(fit.converged);
+				Assert::AreEqual(2, fit.peakCount);
+				Assert::AreEqual(120.0, fit.offset, 1e-4);
+				for (gsl::index k{ 0 }; k < 2; k++) {
+					Assert::AreEqual(peaks[k].position, fit.peaks[k].position, 1e-6);
+					Assert::AreEqual(peaks[k].width, fit.peaks[k].width, 1e-6);
+					Assert::AreEqual(peaks[k].amplitude, fit.peaks[k].amplitude, 1e-4);
+				}
+			}
+
+			TEST_METHOD(TestFitNoisyPeaks) {
+				// the weaker peak is left of the stronger one
+				auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ 20.6, 6, 300 }, LORENTZIAN_PEAK{ 58.1, 6, 500 } };
+				auto spectrum = synthetic::spectrum(80, 100, peaks, 20);
+
+				auto fitter = lorentzian();
+				auto fit = fitter.fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsTrue(fit.converged);
+				Assert::AreEqual(20.6, fit.peaks[0].position, 0.1);
+				Assert::AreEqual(58.1, fit.peaks[1].position, 0.1);
+				Assert::AreEqual(37.5, fit.peaks[1].position - fit.peaks[0].position, 0.15);
+				Assert::AreEqual(6.0, fit.peaks[0].width, 0.5);
+			}
+
+			TEST_METHOD(TestFitSinglePeak) {
+				auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ 12.5, 3, 100 }, LORENTZIAN_PEAK{ 0, 1, 0 } };
+				auto spectrum = synthetic::spectrum(30, 5, peaks, 0);
+
+				auto fitter = lorentzian(1);
+				auto fit = fitter.fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsTrue(fit.converged);
+				Assert::AreEqual(1, fit.peakCount);
+				Assert::AreEqual(12.5, fit.peaks[0].position, 1e-6);
+				Assert::AreEqual(3.0, fit.peaks[0].width, 1e-6);
+			}
+
+			TEST_METHOD(TestFitFlatSpectrum) {
+				// without a peak no step reduces the residual, the damping saturates
+				auto spectrum = std::vector<double>(50, 100.0);
+				auto fitter = lorentzian();
+				auto fit = fitter.fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsFalse(fit.converged);
+			}
+
+			TEST_METHOD(TestFitTooShort) {
+				auto spectrum = std::vector<double>{ 1, 2, 3 };
+				auto fitter = lorentzian();
+				auto fit = fitter.fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsFalse(fit.converged);
+				Assert::AreEqual(0, fit.peakCount);
+			}
+
+			TEST_METHOD(BenchmarkFit) {
+				// typical width of a spectrum on the camera
+				auto count{ 120 };
+				auto spectra = std::vector<std::vector<double>>{};
+				for (gsl::index i{ 0 }; i < 16; i++) {
+					auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ 35.0 + 0.1 * i, 5, 700 }, LORENTZIAN_PEAK{ 85.0 - 0.1 * i, 5, 600 } };
+					spectra.push_back(synthetic::spectrum(count, 100, peaks, 15));
+				}
+
+				auto fitter = lorentzian();
+				auto fits{ 0 };
+				auto converged{ 0 };
+				benchmark(std::to_string(spectra.size()) + " Lorentzian fits of " + std::to_string(count) + " samples", [&]() {
+					for (auto& spectrum : spectra) {
+						converged += fitter.fit(&spectrum[0], count).converged;
+						fits++;
+					}
+				});
+
+				Assert::AreEqual(fits, converged);
+			}
+	};
+
+	TEST_CLASS(TestSpectrumAnalysis) {
+		public:
+			TEST_METHOD(BenchmarkEnqueue) {
+				// two frames of 400 x 100 pixels per position, the spectrum lies along the centre row
+				auto width{ 400 };
+				auto height{ 100 };
+				auto frameCount{ 2 };
+				auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ 120, 8, 700 }, LORENTZIAN_PEAK{ 280, 8, 600 } };
+				auto spectrum = synthetic::spectrum(width, 100, peaks, 15);
+				auto frames = std::vector<unsigned short>((size_t)width * height * frameCount, 100);
+				for (gsl::index mm{ 0 }; mm < frameCount; mm++) {
+					for (gsl::index y{ 45 }; y < 56; y++) {
+						for (gsl::index x{ 0 }; x < width; x++) {
+							frames[(mm * height + y) * width + x] = (unsigned short)spectrum[x];
+						}
+					}
+				}
+				auto line = SPECTRUM_LINE{ { POINT2{ 0, 50 }, POINT2{ width - 1.0, 50 } } };
+
+				// the acquisition thread only extracts the spectrum and queues it, the fits run on the workers
+				SpectrumAnalysis analysis;
+				analysis.start(line, width, height, "unsigned short");
+				auto positions{ 0 };
+				auto start = std::chrono::steady_clock::now();
+				benchmark("Extraction and queueing of a position with " + std::to_string(frameCount) + " frames of "
+					+ std::to_string(width) + " x " + std::to_string(height) + " pixels", [&]() {
+					analysis.enqueue(INDEX3{ positions, 0, 0 }, (const std::byte*)frames.data(), frameCount);
+					positions++;
+				});
+				analysis.stop();
+				auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				auto statistics = analysis.getStatistics();
+				auto results = analysis.takeResults();
+				auto message = std::to_string(positions) + " positions queued, " + std::to_string(statistics.fitted)
+					+ " fitted at " + std::to_string(statistics.fitted / elapsed) + " positions/s on "
+					+ std::to_string(analysis.getThreadCount()) + " workers, " + std::to_string(statistics.dropped) + " dropped\n";
+				Logger::WriteMessage(message.c_str());
+
+				Assert::AreEqual((gsl::index)positions, statistics.fitted + statistics.dropped);
+				Assert::AreEqual((size_t)statistics.fitted, results.size());
+				Assert::IsTrue(results[0].valid);
+				Assert::AreEqual(160.0, results[0].shift, 0.5);
+			}
+	};
+}
@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/spotLocator.h"
+#include "benchmark.h"
+#include "synthetic.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestSpotLocator) {
+		public:
+			TEST_METHOD(TestGaussianSubPixel) {
+				auto image = synthetic::spot(200, 150, 83.37, 61.72, 2.0, 3000, 100, 20);
+
+				auto spot = spotLocator::locate(&image[0], 200, 150);
+
+				Assert::IsTrue(spot.valid);
+				Assert::AreEqual(83.37, spot.x, 0.02);
+				Assert::AreEqual(61.72, spot.y, 0.02);
+				Assert::AreEqual(2.0, spot.width, 0.1);
+			}
+
+			TEST_METHOD(TestCentroidSubPixel) {
+				auto image = synthetic::spot(200, 150, 120.5, 30.25, 2.0, 3000, 100, 20);
+				auto settings = SPOT_SETTINGS{};
+				settings.method = SPOT_METHOD::CENTROID;
+
+				auto spot = spotLocator::locate(&image[0], 200, 150, settings);
+
+				Assert::IsTrue(spot.valid);
+				Assert::AreEqual(120.5, spot.x, 0.05);
+				Assert::AreEqual(30.25, spot.y, 0.05);
+			}
+
+			TEST_METHOD(TestSpotAtBorder) {
+				auto image = synthetic::spot(200, 150, 1.3, 148.2, 1.5, 3000, 100, 0);
+
+				auto spot = spotLocator::locate(&image[0], 200, 150);
+
+				Assert::IsTrue(spot.valid);
+				Assert::AreEqual(1.3, spot.x, 0.1);
+				Assert::AreEqual(148.2, spot.y, 0.1);
+			}
+
+			TEST_METHOD(TestCoarseSearchIgnoresHotPixel) {
+				auto image = synthetic::spot(200, 150, 50.4, 100.6, 2.0, 1000, 100, 0);
+				// a single hot pixel brighter than the spot
+				image[20 * 200 + 170] = 4000;
+
+				auto spot = spotLocator::locate(&image[0], 200, 150);
+				Assert::IsTrue(spot.valid);
+				Assert::AreEqual(50.4, spot.x, 0.05);
+				Assert::AreEqual(100.6, spot.y, 0.05);
+
+				// without the coarse search the hot pixel is taken for the spot
+				auto settings = SPOT_SETTINGS{};
+				settings.coarseFactor = 1;
+				spot = spotLocator::locate(&image[0], 200, 150, settings);
+				Assert::AreEqual(170.0, spot.x, 0.5);
+			}
+
+			TEST_METHOD(TestNoSpot) {
+				auto image = synthetic::spot(200, 150, 100, 75, 2.0, 0, 100, 20);
+
+				auto spot = spotLocator::locate(&image[0], 200, 150);
+
+				Assert::IsFalse(spot.valid);
+			}
+
+			TEST_METHOD(TestStack) {
+				int dim_x{ 160 };
+				int dim_y{ 120 };
+				int count{ 9 };
+				auto stack = std::vector<unsigned char>{};
+				for (gsl::index i{ 0 }; i < count; i++) {
+					auto image = synthetic::spot<unsigned char>(dim_x, dim_y, 20.0 + 13.1 * i, 100.0 - 8.7 * i, 2.0, 200, 10, 4);
+					stack.insert(stack.end(), image.begin(), image.end());
+				}
+
+				auto spots = spotLocator::locate(&stack[0], count, dim_x, dim_y, SPOT_SETTINGS{ SPOT_METHOD::GAUSSIAN, 6, 4, 50 }, 4);
+
+				Assert::AreEqual(count, (int)spots.size());
+				for (gsl::index i{ 0 }; i < count; i++) {
+					Assert::IsTrue(spots[i].valid);
+					Assert::AreEqual(20.0 + 13.1 * i, spots[i].x, 0.05);
+					Assert::AreEqual(100.0 - 8.7 * i, spots[i].y, 0.05);
+				}
+			}
+
+			TEST_METHOD(BenchmarkLocate) {
+				// a full frame of the calibration camera
+				int dim_x{ 1280 };
+				int dim_y{ 1024 };
+				int count{ 32 };
+				auto stack = std::vector<unsigned short>{};
+				for (gsl::index i{ 0 }; i < count; i++) {
+					auto image = synthetic::spot(dim_x, dim_y, 100.0 + 33.3 * i, 900.0 - 25.1 * i, 2.0, 3000, 100, 20);
+					stack.insert(stack.end(), image.begin(), image.end());
+				}
+
+				auto located{ 0 };
+				auto images{ 0 };
+				benchmark("Spot location in " + std::to_string(count) + " images of " + std::to_string(dim_x) + " x "
+					+ std::to_string(dim_y) + " pixels", [&]() {
+					auto spots = spotLocator::locate(&stack[0], count, dim_x, dim_y);
+					for (const auto& spot : spots) {
+						located += spot.valid;
+					}
+					images += count;
+				});
+
+				Assert::AreEqual(images, located);
+			}
+	};
+}
@@ -0,0 +1,109 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include "../BrillouinAcquisition/src/lib/math/lorentzian.h"
+
+#include <gsl/gsl>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace BrillouinAcquisitionUnitTest {
+
+	/*
+	 * Deterministic test data, so that the tests do not depend on the random numbers of the platform
+	 */
+	class synthetic {
+
+	public:
+		// uniformly distributed numbers in [0, 1) from a linear congruential generator
+		class random {
+
+		public:
+			double operator()() {
+				m_state = m_state * 1664525 + 1013904223;
+				return (double)(m_state >> 8) / (1 << 24);
+			}
+
+		private:
+			uint32_t m_state{ 12345 };
+		};
+
+		// two Lorentzian peaks on an offset with uniform noise of the given peak-to-peak amplitude
+		static std::vector<double> spectrum(int count, double offset, const std::array<LORENTZIAN_PEAK, 2>& peaks, double noise = 0) {
+			auto spectrum = std::vector<double>(count);
+			auto uniform = random{};
+			for (gsl::index n{ 0 }; n < count; n++) {
+				spectrum[n] = lorentzian::model((double)n, offset, &peaks[0], 2) + noise * (uniform() - 0.5);
+			}
+			return spectrum;
+		}
+
+		// a single Gaussian spot on an offset with uniform noise of the given peak-to-peak amplitude
+		template <typename T = unsigned short>
+		static std::vector<T> spot(int dim_x, int dim_y, double x0, double y0, double sigma, double amplitude,
+			double offset, double noise = 0) {
+			auto image = std::vector<T>((size_t)dim_x * dim_y);
+			auto uniform = random{};
+			for (gsl::index y{ 0 }; y < dim_y; y++) {
+				for (gsl::index x{ 0 }; x < dim_x; x++) {
+					auto r2 = pow(x - x0, 2) + pow(y - y0, 2);
+					auto value = offset + amplitude * exp(-r2 / (2 * sigma * sigma)) + noise * (uniform() - 0.5);
+					image[y * dim_x + x] = clip<T>(value);
+				}
+			}
+			return image;
+		}
+
+		/*
+		 * Gaussian blobs of the given width at pseudo-random positions on a background, the content is moved by the shift.
+		 * The blobs also cover a margin around the image, so that new content moves into a shifted image. The amplitude
+		 * of a blob is scaled with its width, so that its total intensity does not change with the blur.
+		 */
+		template <typename T = unsigned short>
+		static std::vector<T> blobs(int dim_x, int dim_y, double blur, double background, double intensity,
+			double shift_x = 0, double shift_y = 0) {
+			auto sum = std::vector<double>((size_t)dim_x * dim_y, background);
+			auto uniform = random{};
+			// one blob per 64 pixels of the image and its margin
+			auto count = (gsl::index)(1.5 * dim_x * 1.5 * dim_y / 64);
+			auto radius = (gsl::index)ceil(4 * blur);
+			for (gsl::index i{ 0 }; i < count; i++) {
+				auto x0 = 1.5 * dim_x * uniform() - 0.25 * dim_x + shift_x;
+				auto y0 = 1.5 * dim_y * uniform() - 0.25 * dim_y + shift_y;
+				auto amplitude = (0.5 + uniform()) * intensity / (blur * blur);
+				auto x_min = (std::max)((gsl::index)floor(x0) - radius, gsl::index{ 0 });
+				auto x_max = (std::min)((gsl::index)floor(x0) + radius, (gsl::index)dim_x - 1);
+				auto y_min = (std::max)((gsl::index)floor(y0) - radius, gsl::index{ 0 });
+				auto y_max = (std::min)((gsl::index)floor(y0) + radius, (gsl::index)dim_y - 1);
+				for (auto y = y_min; y <= y_max; y++) {
+					for (auto x = x_min; x <= x_max; x++) {
+						auto r2 = pow(x - x0, 2) + pow(y - y0, 2);
+						sum[y * dim_x + x] += amplitude * exp(-r2 / (2 * blur * blur));
+					}
+				}
+			}
+			auto image = std::vector<T>(sum.size());
+			for (gsl::index i{ 0 }; i < (gsl::index)sum.size(); i++) {
+				image[i] = clip<T>(sum[i]);
+			}
+			return image;
+		}
+
+	private:
+		template <typename T>
+		static T clip(double value) {
+			if constexpr (std::is_integral_v<T>) {
+				return (T)(std::min)((std::max)(value, 0.0), (double)(std::numeric_limits<T>::max)());
+			} else {
+				return (T)value;
+			}
+		}
+	};
+}
+
+#endif // SYNTHETIC_H
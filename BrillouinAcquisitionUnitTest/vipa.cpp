@@ -0,0 +1,58 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../BrillouinAcquisition/src/lib/math/vipa.h"
+#include "synthetic.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BrillouinAcquisitionUnitTest {
+
+	TEST_CLASS(TestVipa) {
+		public:
+			TEST_METHOD(TestFitCalibration) {
+				// water with a shift of 5.088 GHz, 0.1 GHz per pixel
+				auto freeSpectralRange{ 15.0 };
+				auto shift{ 5.088 };
+				auto spectrum = calibrationSpectrum(120, shift / 0.1 - 5, (freeSpectralRange - shift) / 0.1 - 5);
+
+				auto calibration = vipaCalibration(shift, freeSpectralRange).fit(&spectrum[0], (int)spectrum.size());
+
+				Assert::IsTrue(calibration.valid);
+				Assert::AreEqual(0.1, calibration.dispersion, 1e-6);
+				Assert::AreEqual(0.5, calibration.offset, 1e-4);
+				Assert::AreEqual(shift, calibration.frequency(calibration.peaks[0]), 1e-9);
+				Assert::AreEqual(freeSpectralRange - shift, calibration.frequency(calibration.peaks[1]), 1e-9);
+				// the calibration sample itself has to yield its shift
+				Assert::AreEqual(shift, calibration.shift(calibration.peaks[0], calibration.peaks[1]), 1e-9);
+			}
+
+			TEST_METHOD(TestShift) {
+				auto calibration = VIPA_CALIBRATION{};
+				calibration.offset = 0;
+				calibration.dispersion = 0.1;
+				calibration.freeSpectralRange = 15;
+				Assert::IsTrue(std::isnan(calibration.shift(40, 70)));
+
+				calibration.valid = true;
+				// the peaks of a sample with a larger shift are closer together
+				Assert::AreEqual(6.0, calibration.shift(40, 70), 1e-9);
+				Assert::AreEqual(5.0, calibration.shift(40, 90), 1e-9);
+			}
+
+			TEST_METHOD(TestFitInvalid) {
+				// the free spectral range has to be larger than twice the shift
+				auto spectrum = calibrationSpectrum(120, 30, 80);
+				Assert::IsFalse(vipaCalibration(8, 15).fit(&spectrum[0], (int)spectrum.size()).valid);
+
+				// a flat spectrum has no peaks
+				auto flat = std::vector<double>(120, 100);
+				Assert::IsFalse(vipaCalibration().fit(&flat[0], (int)flat.size()).valid);
+			}
+
+		private:
+			static std::vector<double> calibrationSpectrum(int count, double antiStokes, double stokes) {
+				auto peaks = std::array<LORENTZIAN_PEAK, 2>{ LORENTZIAN_PEAK{ antiStokes, 4, 800 }, LORENTZIAN_PEAK{ stokes, 4, 700 } };
+				return synthetic::spectrum(count, 100, peaks);
+			}
+	};
+}